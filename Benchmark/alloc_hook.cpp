@@ -0,0 +1,134 @@
+﻿//*********************************************************
+// 文件名称 : alloc_hook.cpp
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 文件说明 : 只链接到性能测试程序中, 替换全局的 operator new 和 operator delete,
+//            把每次分配报告给 sql::mariadb::alloc_scope::record; 类库本身不替换,
+//            使用类库的其他程序不受影响
+//*********************************************************
+
+#include "../LibMariaDbConnectivity/mariadb.h"
+#include <cstdlib>
+#include <new>
+
+
+//*********************************************************
+// 函数名称 : operator new
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 替换全局的 operator new, 统计 alloc_scope 中的分配
+// 函数参数 : std::size_t size 字节数
+// 返 回 值 : void * 内存
+// 异    常 : 如果分配失败则抛出 std::bad_alloc 异常
+//*********************************************************
+void * operator new(std::size_t size)
+{
+	sql::mariadb::alloc_scope::record(size);
+
+	const auto pointer = std::malloc(size == 0 ? 1 : size);
+	if (pointer == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return pointer;
+}
+
+
+//*********************************************************
+// 函数名称 : operator new[]
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 替换全局的 operator new[], 统计 alloc_scope 中的分配
+// 函数参数 : std::size_t size 字节数
+// 返 回 值 : void * 内存
+// 异    常 : 如果分配失败则抛出 std::bad_alloc 异常
+//*********************************************************
+void * operator new[](std::size_t size)
+{
+	return ::operator new(size);
+}
+
+
+//*********************************************************
+// 函数名称 : operator new
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 替换全局的不抛出异常的 operator new
+// 函数参数 : std::size_t size 字节数
+// 函数参数 : const std::nothrow_t &
+// 返 回 值 : void * 内存, 失败时为 nullptr
+//*********************************************************
+void * operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+	sql::mariadb::alloc_scope::record(size);
+	return std::malloc(size == 0 ? 1 : size);
+}
+
+
+//*********************************************************
+// 函数名称 : operator new[]
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 替换全局的不抛出异常的 operator new[]
+// 函数参数 : std::size_t size 字节数
+// 函数参数 : const std::nothrow_t &
+// 返 回 值 : void * 内存, 失败时为 nullptr
+//*********************************************************
+void * operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+	return ::operator new(size, std::nothrow);
+}
+
+
+//*********************************************************
+// 函数名称 : operator delete
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 释放替换后的 operator new 分配的内存
+// 函数参数 : void * pointer 内存
+//*********************************************************
+void operator delete(void *pointer) noexcept
+{
+	std::free(pointer);
+}
+
+
+//*********************************************************
+// 函数名称 : operator delete[]
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 释放替换后的 operator new[] 分配的内存
+// 函数参数 : void * pointer 内存
+//*********************************************************
+void operator delete[](void *pointer) noexcept
+{
+	std::free(pointer);
+}
+
+
+//*********************************************************
+// 函数名称 : operator delete
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 释放替换后的不抛出异常的 operator new 分配的内存
+// 函数参数 : void * pointer 内存
+// 函数参数 : const std::nothrow_t &
+//*********************************************************
+void operator delete(void *pointer, const std::nothrow_t &) noexcept
+{
+	std::free(pointer);
+}
+
+
+//*********************************************************
+// 函数名称 : operator delete[]
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 释放替换后的不抛出异常的 operator new[] 分配的内存
+// 函数参数 : void * pointer 内存
+// 函数参数 : const std::nothrow_t &
+//*********************************************************
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept
+{
+	std::free(pointer);
+}
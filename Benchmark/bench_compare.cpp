@@ -0,0 +1,676 @@
+﻿//*********************************************************
+// 文件名称 : bench_compare.cpp
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 文件说明 : 性能回归检查: 多次运行性能测试程序 (--json 输出), 把每个测试的每个指标
+//            (ns_per_op, allocs_per_op 等) 的所有样本保存为 JSON, 然后与基准结果比较;
+//            使用单侧 Mann-Whitney U 检验判断当前结果是否显著变大, 并且中位数的增幅超过阈值时
+//            视为性能回归, 返回 1; 使用方法:
+//            bench_compare [--runs=5] [--alpha=0.05] [--threshold=0.05] [--alloc-threshold=0]
+//                          [--baseline=Benchmark/baseline.json] [--output=current.json] [--record]
+//                          -- 性能测试命令 [参数...]
+//            --record 把结果写入基准文件而不比较; --threshold 为 ns_per_op 允许的中位数增幅,
+//            --alloc-threshold 为 allocs_per_op 和 bytes_per_op 允许的中位数增幅
+//*********************************************************
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+	// 测试名称 -> 指标名称 -> 每次运行的样本
+	typedef std::map<std::string, std::map<std::string, std::vector<double>>> sample_table;
+
+	// 命令行参数
+	struct options
+	{
+		unsigned int runs = 5; // 运行次数
+		double alpha = 0.05; // 显著性水平
+		double threshold = 0.05; // ns_per_op 允许的中位数增幅
+		double alloc_threshold = 0; // allocs_per_op, bytes_per_op 允许的中位数增幅
+		std::string baseline = "Benchmark/baseline.json"; // 基准结果文件
+		std::string output; // 保存当前结果的文件, 空字符串代表不保存
+		bool record = false; // 是否把结果写入基准文件
+		std::string command; // 性能测试命令
+	};
+
+
+	// 读取 JSON 文本的类, 只支持本程序需要的对象、数组、字符串、数值、true、false 和 null
+	class json_parser
+	{
+	public:
+
+		//*********************************************************
+		// 函数名称 : json_parser
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 构造函数
+		// 访问方式 : public
+		// 函数参数 : const std::string & text JSON 文本
+		//*********************************************************
+		explicit json_parser(const std::string &text)
+			: m_text(text)
+			, m_pos(0)
+		{
+		}
+
+		//*********************************************************
+		// 函数名称 : peek
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 跳过空白后获取下一个字符
+		// 访问方式 : public
+		// 返 回 值 : char 下一个字符, 文本结束时为 '\0'
+		//*********************************************************
+		char peek(void)
+		{
+			while (m_pos < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_pos])))
+			{
+				++m_pos;
+			}
+			return m_pos < m_text.size() ? m_text[m_pos] : '\0';
+		}
+
+		//*********************************************************
+		// 函数名称 : expect
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 读取指定的字符
+		// 访问方式 : public
+		// 函数参数 : char ch 字符
+		// 异    常 : 如果下一个字符不是 ch 则抛出 std::runtime_error 异常
+		//*********************************************************
+		void expect(char ch)
+		{
+			if (this->peek() != ch)
+			{
+				throw std::runtime_error(std::string("invalid JSON: expected '") + ch + "' at offset " + std::to_string(m_pos));
+			}
+			++m_pos;
+		}
+
+		//*********************************************************
+		// 函数名称 : next_member
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 读取对象或者数组中的下一个元素之前的分隔符
+		// 访问方式 : public
+		// 函数参数 : char close 结束字符, '}' 或者 ']'
+		// 函数参数 : bool & first 是否第一个元素, 读取后设置为 false
+		// 返 回 值 : bool false 代表已经读取结束字符
+		// 异    常 : 如果格式错误则抛出 std::runtime_error 异常
+		//*********************************************************
+		bool next_member(char close, bool &first)
+		{
+			if (this->peek() == close)
+			{
+				++m_pos;
+				return false;
+			}
+			if (!first)
+			{
+				this->expect(',');
+			}
+			first = false;
+			return true;
+		}
+
+		//*********************************************************
+		// 函数名称 : read_string
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 读取字符串, 只处理 \" \\ \/ \n \t 转义
+		// 访问方式 : public
+		// 返 回 值 : std::string 字符串
+		// 异    常 : 如果格式错误则抛出 std::runtime_error 异常
+		//*********************************************************
+		std::string read_string(void)
+		{
+			this->expect('"');
+			std::string value;
+			while (m_pos < m_text.size() && m_text[m_pos] != '"')
+			{
+				auto ch = m_text[m_pos++];
+				if (ch == '\\' && m_pos < m_text.size())
+				{
+					ch = m_text[m_pos++];
+					ch = ch == 'n' ? '\n' : ch == 't' ? '\t' : ch;
+				}
+				value.push_back(ch);
+			}
+			this->expect('"');
+			return value;
+		}
+
+		//*********************************************************
+		// 函数名称 : read_number
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 读取数值
+		// 访问方式 : public
+		// 返 回 值 : double 数值
+		// 异    常 : 如果格式错误则抛出 std::runtime_error 异常
+		//*********************************************************
+		double read_number(void)
+		{
+			this->peek();
+			char *end = nullptr;
+			const auto value = std::strtod(m_text.c_str() + m_pos, &end);
+			if (end == m_text.c_str() + m_pos)
+			{
+				throw std::runtime_error("invalid JSON: expected number at offset " + std::to_string(m_pos));
+			}
+			m_pos = end - m_text.c_str();
+			return value;
+		}
+
+		//*********************************************************
+		// 函数名称 : skip_value
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 跳过任意一个值
+		// 访问方式 : public
+		// 异    常 : 如果格式错误则抛出 std::runtime_error 异常
+		//*********************************************************
+		void skip_value(void)
+		{
+			const auto ch = this->peek();
+			if (ch == '"')
+			{
+				this->read_string();
+			}
+			else if (ch == '{' || ch == '[')
+			{
+				const char close = ch == '{' ? '}' : ']';
+				++m_pos;
+				bool first = true;
+				while (this->next_member(close, first))
+				{
+					if (close == '}')
+					{
+						this->read_string();
+						this->expect(':');
+					}
+					this->skip_value();
+				}
+			}
+			else if (m_text.compare(m_pos, 4, "true") == 0 || m_text.compare(m_pos, 4, "null") == 0)
+			{
+				m_pos += 4;
+			}
+			else if (m_text.compare(m_pos, 5, "false") == 0)
+			{
+				m_pos += 5;
+			}
+			else
+			{
+				this->read_number();
+			}
+		}
+
+	private:
+		const std::string &m_text; // JSON 文本
+		size_t m_pos; // 读取位置
+	};
+
+
+	//*********************************************************
+	// 函数名称 : parse_options
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 解析命令行参数, "--" 之后的参数组成性能测试命令
+	// 函数参数 : int argc 参数个数
+	// 函数参数 : char * argv[] 参数
+	// 函数参数 : options & settings 解析结果
+	// 返 回 值 : bool false 代表参数错误
+	//*********************************************************
+	bool parse_options(int argc, char *argv[], options &settings)
+	{
+		int i = 1;
+		for (; i < argc; ++i)
+		{
+			const std::string argument(argv[i]);
+			if (argument == "--")
+			{
+				++i;
+				break;
+			}
+
+			const auto equal = argument.find('=');
+			const auto key = argument.substr(0, equal);
+			const auto value = equal == std::string::npos ? std::string() : argument.substr(equal + 1);
+			if (key == "--runs")
+			{
+				settings.runs = (unsigned int)std::strtoul(value.c_str(), nullptr, 10);
+			}
+			else if (key == "--alpha")
+			{
+				settings.alpha = std::strtod(value.c_str(), nullptr);
+			}
+			else if (key == "--threshold")
+			{
+				settings.threshold = std::strtod(value.c_str(), nullptr);
+			}
+			else if (key == "--alloc-threshold")
+			{
+				settings.alloc_threshold = std::strtod(value.c_str(), nullptr);
+			}
+			else if (key == "--baseline")
+			{
+				settings.baseline = value;
+			}
+			else if (key == "--output")
+			{
+				settings.output = value;
+			}
+			else if (key == "--record")
+			{
+				settings.record = true;
+			}
+			else
+			{
+				std::fprintf(stderr, "unknown option: %s\n", argv[i]);
+				return false;
+			}
+		}
+
+		for (; i < argc; ++i)
+		{
+			settings.command += settings.command.empty() ? "" : " ";
+			settings.command += argv[i];
+		}
+
+		if (settings.command.empty() || settings.runs == 0)
+		{
+			std::fprintf(stderr, "usage: bench_compare [--runs=5] [--alpha=0.05] [--threshold=0.05] [--alloc-threshold=0]\n"
+				"                     [--baseline=file] [--output=file] [--record] -- command [args...]\n");
+			return false;
+		}
+		return true;
+	}
+
+
+	//*********************************************************
+	// 函数名称 : run_suite
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 运行一次性能测试命令, 读取每行 JSON 中除 iterations 以外的所有数值指标
+	// 函数参数 : const std::string & command 性能测试命令
+	// 函数参数 : sample_table & samples 添加样本
+	// 异    常 : 如果命令运行失败或者输出格式错误则抛出 std::runtime_error 异常
+	//*********************************************************
+	void run_suite(const std::string &command, sample_table &samples)
+	{
+		const auto pipe = ::popen(command.c_str(), "r");
+		if (pipe == nullptr)
+		{
+			throw std::runtime_error("cannot run: " + command);
+		}
+
+		std::string line;
+		char buffer[4096];
+		while (std::fgets(buffer, sizeof(buffer), pipe) != nullptr)
+		{
+			line += buffer;
+			if (line.empty() || line.back() != '\n')
+			{
+				continue;
+			}
+
+			json_parser parser(line);
+			if (parser.peek() == '{')
+			{
+				std::string name;
+				std::map<std::string, double> metrics;
+				parser.expect('{');
+				bool first = true;
+				while (parser.next_member('}', first))
+				{
+					const auto key = parser.read_string();
+					parser.expect(':');
+					if (parser.peek() == '"')
+					{
+						const auto value = parser.read_string();
+						if (key == "name")
+						{
+							name = value;
+						}
+					}
+					else if (key == "iterations")
+					{
+						parser.skip_value();
+					}
+					else
+					{
+						metrics[key] = parser.read_number();
+					}
+				}
+
+				for (const auto &metric : metrics)
+				{
+					samples[name][metric.first].push_back(metric.second);
+				}
+			}
+			line.clear();
+		}
+
+		if (::pclose(pipe) != 0)
+		{
+			throw std::runtime_error("benchmark failed: " + command);
+		}
+	}
+
+
+	//*********************************************************
+	// 函数名称 : write_results
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 把所有样本写入 JSON 文件
+	// 函数参数 : const std::string & path 文件路径
+	// 函数参数 : const options & settings 命令行参数
+	// 函数参数 : const sample_table & samples 所有样本
+	// 异    常 : 如果写入失败则抛出 std::runtime_error 异常
+	//*********************************************************
+	void write_results(const std::string &path, const options &settings, const sample_table &samples)
+	{
+		std::ofstream file(path);
+		if (!file)
+		{
+			throw std::runtime_error("cannot write: " + path);
+		}
+
+		std::string command;
+		for (const auto ch : settings.command)
+		{
+			if (ch == '"' || ch == '\\')
+			{
+				command.push_back('\\');
+			}
+			command.push_back(ch);
+		}
+
+		file << "{\n  \"command\": \"" << command << "\",\n  \"runs\": " << settings.runs << ",\n  \"benchmarks\": {";
+		bool first_benchmark = true;
+		for (const auto &benchmark : samples)
+		{
+			file << (first_benchmark ? "\n" : ",\n") << "    \"" << benchmark.first << "\": {";
+			first_benchmark = false;
+
+			bool first_metric = true;
+			for (const auto &metric : benchmark.second)
+			{
+				file << (first_metric ? "" : ", ") << '"' << metric.first << "\": [";
+				first_metric = false;
+				for (size_t i = 0; i < metric.second.size(); ++i)
+				{
+					file << (i == 0 ? "" : ", ") << metric.second[i];
+				}
+				file << ']';
+			}
+			file << '}';
+		}
+		file << "\n  }\n}\n";
+
+		if (!file)
+		{
+			throw std::runtime_error("cannot write: " + path);
+		}
+	}
+
+
+	//*********************************************************
+	// 函数名称 : load_results
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 读取 write_results 写入的 JSON 文件
+	// 函数参数 : const std::string & path 文件路径
+	// 返 回 值 : sample_table 所有样本
+	// 异    常 : 如果读取失败或者格式错误则抛出 std::runtime_error 异常
+	//*********************************************************
+	sample_table load_results(const std::string &path)
+	{
+		std::ifstream file(path);
+		if (!file)
+		{
+			throw std::runtime_error("cannot read baseline: " + path + " (create it with --record)");
+		}
+
+		std::stringstream stream;
+		stream << file.rdbuf();
+		const auto text = stream.str();
+
+		sample_table samples;
+		json_parser parser(text);
+		parser.expect('{');
+		bool first = true;
+		while (parser.next_member('}', first))
+		{
+			if (parser.read_string() != "benchmarks")
+			{
+				parser.expect(':');
+				parser.skip_value();
+				continue;
+			}
+
+			parser.expect(':');
+			parser.expect('{');
+			bool first_benchmark = true;
+			while (parser.next_member('}', first_benchmark))
+			{
+				auto &metrics = samples[parser.read_string()];
+				parser.expect(':');
+				parser.expect('{');
+				bool first_metric = true;
+				while (parser.next_member('}', first_metric))
+				{
+					auto &values = metrics[parser.read_string()];
+					parser.expect(':');
+					parser.expect('[');
+					bool first_value = true;
+					while (parser.next_member(']', first_value))
+					{
+						values.push_back(parser.read_number());
+					}
+				}
+			}
+		}
+		return samples;
+	}
+
+
+	//*********************************************************
+	// 函数名称 : median
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 计算中位数
+	// 函数参数 : std::vector<double> values 样本, 不能为空
+	// 返 回 值 : double 中位数
+	//*********************************************************
+	double median(std::vector<double> values)
+	{
+		std::sort(values.begin(), values.end());
+		const auto n = values.size();
+		return n % 2 == 1 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+	}
+
+
+	//*********************************************************
+	// 函数名称 : mann_whitney
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 单侧 Mann-Whitney U 检验 (正态近似, 含连续性校正和结的校正),
+	//            原假设为 current 不比 baseline 大
+	// 函数参数 : const std::vector<double> & current 当前样本
+	// 函数参数 : const std::vector<double> & baseline 基准样本
+	// 返 回 值 : double p 值; 所有样本相等时为 1
+	//*********************************************************
+	double mann_whitney(const std::vector<double> &current, const std::vector<double> &baseline)
+	{
+		std::vector<std::pair<double, int>> all;
+		for (const auto value : current)
+		{
+			all.emplace_back(value, 0);
+		}
+		for (const auto value : baseline)
+		{
+			all.emplace_back(value, 1);
+		}
+		std::sort(all.begin(), all.end());
+
+		// 相同的值取平均秩
+		const auto n1 = (double)current.size(), n2 = (double)baseline.size(), n = n1 + n2;
+		double rank_sum = 0, ties = 0;
+		for (size_t i = 0; i < all.size(); )
+		{
+			size_t j = i;
+			while (j < all.size() && all[j].first == all[i].first)
+			{
+				++j;
+			}
+
+			const auto rank = (double)(i + j + 1) / 2;
+			for (size_t k = i; k < j; ++k)
+			{
+				rank_sum += all[k].second == 0 ? rank : 0;
+			}
+			const auto t = (double)(j - i);
+			ties += t * t * t - t;
+			i = j;
+		}
+
+		const auto u = rank_sum - n1 * (n1 + 1) / 2;
+		const auto mean = n1 * n2 / 2;
+		const auto variance = n1 * n2 / 12 * ((n + 1) - ties / (n * (n - 1)));
+		if (variance <= 0)
+		{
+			return 1;
+		}
+
+		const auto z = (u - mean - 0.5) / std::sqrt(variance);
+		return 0.5 * std::erfc(z / std::sqrt(2.0));
+	}
+
+
+	//*********************************************************
+	// 函数名称 : compare
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 比较当前结果和基准结果, 输出每个指标的变化和所有测试 ns_per_op 中位数比值的几何平均
+	// 函数参数 : const options & settings 命令行参数
+	// 函数参数 : const sample_table & current 当前结果
+	// 函数参数 : const sample_table & baseline 基准结果
+	// 返 回 值 : size_t 性能回归的指标数量
+	//*********************************************************
+	size_t compare(const options &settings, const sample_table &current, const sample_table &baseline)
+	{
+		size_t regressions = 0, timed = 0;
+		double log_ratio = 0;
+		std::printf("%-40s %-14s %12s %12s %9s %9s  %s\n", "benchmark", "metric", "baseline", "current", "change", "p", "verdict");
+		for (const auto &benchmark : baseline)
+		{
+			const auto found = current.find(benchmark.first);
+			if (found == current.end())
+			{
+				std::printf("%-40s missing from current run\n", benchmark.first.c_str());
+				continue;
+			}
+
+			for (const auto &metric : benchmark.second)
+			{
+				const auto samples = found->second.find(metric.first);
+				if (samples == found->second.end() || samples->second.empty() || metric.second.empty())
+				{
+					continue;
+				}
+
+				const auto before = median(metric.second);
+				const auto after = median(samples->second);
+				const auto change = before != 0 ? after / before - 1 : (after != 0 ? 1.0 : 0.0);
+				const auto p = mann_whitney(samples->second, metric.second);
+				const auto limit = metric.first == "ns_per_op" ? settings.threshold : settings.alloc_threshold;
+				if (metric.first == "ns_per_op" && before > 0 && after > 0)
+				{
+					log_ratio += std::log(after / before);
+					++timed;
+				}
+
+				const char *verdict = "ok";
+				if (p < settings.alpha && change > limit)
+				{
+					verdict = "REGRESSION";
+					++regressions;
+				}
+				else if (p < settings.alpha && change < -limit)
+				{
+					verdict = "improved";
+				}
+
+				std::printf("%-40s %-14s %12.2f %12.2f %+8.1f%% %9.4f  %s\n", benchmark.first.c_str(), metric.first.c_str(),
+					before, after, change * 100, p, verdict);
+			}
+		}
+
+		if (timed != 0)
+		{
+			const auto ratio = std::exp(log_ratio / (double)timed);
+			std::printf("ns_per_op geometric mean over %zu benchmarks: %+.1f%% (speedup %.3fx)\n", timed, (ratio - 1) * 100, 1 / ratio);
+		}
+		return regressions;
+	}
+}
+
+
+int main(int argc, char *argv[])
+{
+	options settings;
+	if (!parse_options(argc, argv, settings))
+	{
+		return 2;
+	}
+
+	try
+	{
+		sample_table current;
+		for (unsigned int run = 1; run <= settings.runs; ++run)
+		{
+			std::fprintf(stderr, "run %u/%u: %s\n", run, settings.runs, settings.command.c_str());
+			run_suite(settings.command, current);
+		}
+
+		if (!settings.output.empty())
+		{
+			write_results(settings.output, settings, current);
+		}
+
+		if (settings.record)
+		{
+			write_results(settings.baseline, settings, current);
+			std::fprintf(stderr, "baseline written to %s\n", settings.baseline.c_str());
+			return 0;
+		}
+
+		const auto regressions = compare(settings, current, load_results(settings.baseline));
+		if (regressions != 0)
+		{
+			std::printf("%zu significant regression(s) (alpha %.3f)\n", regressions, settings.alpha);
+			return 1;
+		}
+		std::printf("no significant regressions (alpha %.3f)\n", settings.alpha);
+	}
+	catch (const std::exception &e)
+	{
+		std::fprintf(stderr, "%s\n", e.what());
+		return 2;
+	}
+
+	return 0;
+}
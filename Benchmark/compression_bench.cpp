@@ -0,0 +1,295 @@
+﻿//*********************************************************
+// 文件名称 : compression_bench.cpp
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 文件说明 : 测量启用和不启用协议压缩时 query_vector 读取不同大小结果集的
+//            网络字节数 (服务器的 Bytes_sent 状态变量) 和耗时;
+//            由两者得到压缩比, 由耗时差拟合压缩解压速度和每个结果集的固定开销,
+//            再交给 compression_pays_off 估算每种大小在指定带宽下是否值得压缩;
+//            耗时差在本机或者高速链路上测量才只包含压缩解压的开销;
+//            使用方法:
+//            compression_bench user password [database] [host] [port] [bandwidth]
+//            bandwidth 为需要估算的链路带宽 (Mbit/s), 不指定时不输出建议;
+//            测试会创建并删除 bench_compression 表
+//*********************************************************
+
+#include "../LibMariaDbConnectivity/mariadb.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+	const unsigned int row_size = 1024; // 每行数据的大小 (字节)
+	const unsigned int total_rows = 16384; // 测试表的总行数
+
+
+	// 一种结果集大小在一个连接上的测量结果
+	struct sample
+	{
+		double seconds; // 每次查询的耗时 (秒)
+		unsigned long long wire_bytes; // 每次查询服务器发送的网络字节数
+	};
+
+
+	//*********************************************************
+	// 函数名称 : make_payload
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 生成类似导出数据的可压缩文本
+	// 函数参数 : unsigned int id 行号
+	// 返 回 值 : std::string 长度为 row_size 的文本
+	//*********************************************************
+	std::string make_payload(unsigned int id)
+	{
+		std::string text;
+		text.reserve(row_size + 64);
+
+		for (unsigned int i = 0; text.size() < row_size; ++i)
+		{
+			text += std::to_string(id) + ",customer_" + std::to_string((id * 7 + i) % 1000)
+				+ ",2026-10-19,shipped,standard;";
+		}
+
+		text.resize(row_size);
+		return text;
+	}
+
+
+	//*********************************************************
+	// 函数名称 : execute
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 执行SQL语句
+	// 函数参数 : const sql::mariadb::connection & connector 数据库连接
+	// 函数参数 : const std::string & text SQL语句
+	// 异    常 : 如果执行失败则抛出 sql::mariadb::mariadb_exception 异常
+	//*********************************************************
+	void execute(const sql::mariadb::connection &connector, const std::string &text)
+	{
+		sql::mariadb::command executer(connector);
+
+		if (!executer.execute(text))
+		{
+			throw sql::mariadb::mariadb_exception(executer.error(), __FILE__, __LINE__);
+		}
+	}
+
+
+	//*********************************************************
+	// 函数名称 : prepare_table
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 创建并填充测试表
+	// 函数参数 : const sql::mariadb::connection & connector 数据库连接
+	// 异    常 : 如果执行失败则抛出 sql::mariadb::mariadb_exception 异常
+	//*********************************************************
+	void prepare_table(const sql::mariadb::connection &connector)
+	{
+		execute(connector, "DROP TABLE IF EXISTS bench_compression");
+		execute(connector, "CREATE TABLE bench_compression (id INT PRIMARY KEY, payload TEXT NOT NULL)");
+
+		const unsigned int batch = 256;
+
+		for (unsigned int first = 0; first < total_rows; first += batch)
+		{
+			std::string text = "INSERT INTO bench_compression VALUES ";
+
+			for (unsigned int id = first; id < first + batch; ++id)
+			{
+				text += (id == first ? "(" : ",(") + std::to_string(id) + ",'" + make_payload(id) + "')";
+			}
+
+			execute(connector, text);
+		}
+	}
+
+
+	//*********************************************************
+	// 函数名称 : bytes_sent
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 读取当前会话中服务器已经发送的网络字节数 (压缩时为压缩后的字节数)
+	// 函数参数 : const sql::mariadb::command & executer 执行SQL语句的对象
+	// 返 回 值 : unsigned long long 字节数
+	// 异    常 : 如果执行失败则抛出 sql::mariadb::mariadb_exception 异常
+	//*********************************************************
+	unsigned long long bytes_sent(const sql::mariadb::command &executer)
+	{
+		const auto status = executer.query_vector<std::tuple<std::string, std::string>>("SHOW SESSION STATUS LIKE 'Bytes_sent'");
+
+		if (status.empty())
+		{
+			throw sql::mariadb::mariadb_exception("Bytes_sent is not available", __FILE__, __LINE__);
+		}
+
+		return std::strtoull(std::get<1>(status.front()).c_str(), nullptr, 10);
+	}
+
+
+	//*********************************************************
+	// 函数名称 : measure
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 测量读取结果集的耗时和网络字节数
+	// 函数参数 : const sql::mariadb::connection & connector 数据库连接
+	// 函数参数 : unsigned int rows 结果集行数
+	// 返 回 值 : sample 测量结果
+	// 异    常 : 如果执行失败则抛出 sql::mariadb::mariadb_exception 异常
+	//*********************************************************
+	sample measure(const sql::mariadb::connection &connector, unsigned int rows)
+	{
+		const std::string text = "SELECT payload FROM bench_compression ORDER BY id LIMIT " + std::to_string(rows);
+		const unsigned long long target = 64ULL * 1024 * 1024; // 每个测试读取的总数据量
+		const auto iterations = static_cast<unsigned int>(target / (static_cast<unsigned long long>(rows) * row_size)) + 1;
+		sql::mariadb::command executer(connector);
+		size_t count = 0;
+
+		executer.query_vector<std::tuple<std::string>>(text); // 预热
+
+		// 两次读取状态之间只有状态查询本身的响应, 用来扣除状态查询的字节数
+		const auto first = bytes_sent(executer);
+		const auto second = bytes_sent(executer);
+		executer.query_vector<std::tuple<std::string>>(text);
+		const auto third = bytes_sent(executer);
+
+		const auto begin = std::chrono::steady_clock::now();
+
+		for (unsigned int i = 0; i < iterations; ++i)
+		{
+			count += executer.query_vector<std::tuple<std::string>>(text).size();
+		}
+
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+		if (count != static_cast<size_t>(iterations) * rows)
+		{
+			throw sql::mariadb::mariadb_exception("unexpected row count", __FILE__, __LINE__);
+		}
+
+		return { elapsed.count() / iterations, (third - second) - (second - first) };
+	}
+
+
+	//*********************************************************
+	// 函数名称 : open
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 连接数据库
+	// 函数参数 : const sql::mariadb::connection & connector 数据库连接
+	// 函数参数 : bool compress 是否启用协议压缩
+	// 函数参数 : char * argv[] 命令行参数
+	// 函数参数 : int argc 命令行参数个数
+	// 返 回 值 : bool true 代表连接成功, false 代表连接失败
+	//*********************************************************
+	bool open(const sql::mariadb::connection &connector, bool compress, char *argv[], int argc)
+	{
+		sql::mariadb::connection_options options;
+		options.set_compress(compress);
+
+		const char *database = argc > 3 ? argv[3] : "test";
+		const char *host = argc > 4 ? argv[4] : "127.0.0.1";
+		const auto port = argc > 5 ? static_cast<unsigned int>(std::strtoul(argv[5], nullptr, 10)) : 3306U;
+
+		return connector.open(options, argv[1], argv[2], database, port, host);
+	}
+}
+
+
+int main(int argc, char *argv[])
+{
+	if (argc < 3)
+	{
+		std::cerr << "usage: " << argv[0] << " user password [database] [host] [port] [bandwidth Mbit/s]" << std::endl;
+		return 1;
+	}
+
+	const double bandwidth = argc > 6 ? std::strtod(argv[6], nullptr) * 1000 * 1000 / 8 : 0.0;
+
+	try
+	{
+		sql::mariadb::connection plain;
+		sql::mariadb::connection compressed;
+
+		if (!open(plain, false, argv, argc) || !open(compressed, true, argv, argc))
+		{
+			std::cerr << "connect failed: " << plain.error() << compressed.error() << std::endl;
+			return 1;
+		}
+
+		prepare_table(plain);
+
+		std::vector<unsigned int> sizes; // 结果集行数
+		std::vector<sample> plain_samples;
+		std::vector<sample> compressed_samples;
+
+		for (unsigned int rows = 1; rows <= total_rows; rows *= 4)
+		{
+			sizes.push_back(rows);
+			plain_samples.push_back(measure(plain, rows));
+			compressed_samples.push_back(measure(compressed, rows));
+		}
+
+		execute(plain, "DROP TABLE bench_compression");
+
+		// 压缩多出的耗时 = 固定开销 + 数据量 / 压缩解压速度, 用最小二乘法拟合
+		double mean_x = 0.0;
+		double mean_y = 0.0;
+
+		for (size_t i = 0; i < sizes.size(); ++i)
+		{
+			mean_x += static_cast<double>(plain_samples[i].wire_bytes);
+			mean_y += compressed_samples[i].seconds - plain_samples[i].seconds;
+		}
+
+		mean_x /= static_cast<double>(sizes.size());
+		mean_y /= static_cast<double>(sizes.size());
+
+		double covariance = 0.0;
+		double variance = 0.0;
+
+		for (size_t i = 0; i < sizes.size(); ++i)
+		{
+			const auto dx = static_cast<double>(plain_samples[i].wire_bytes) - mean_x;
+			covariance += dx * (compressed_samples[i].seconds - plain_samples[i].seconds - mean_y);
+			variance += dx * dx;
+		}
+
+		const auto slope = variance > 0.0 ? covariance / variance : 0.0;
+		const auto codec_speed = slope > 0.0 ? 1.0 / slope : std::numeric_limits<double>::infinity();
+		const auto fixed_cost = std::max(mean_y - slope * mean_x, 0.0);
+
+		std::printf("codec speed %.2f MB/s, fixed cost %.1f us per result\n", codec_speed / 1048576.0, fixed_cost * 1e6);
+		std::printf("%10s %12s %12s %10s %12s %12s %10s\n", "rows", "plain wire", "comp wire", "wire ratio", "plain us", "comp us", "advice");
+
+		for (size_t i = 0; i < sizes.size(); ++i)
+		{
+			const auto &p = plain_samples[i];
+			const auto &c = compressed_samples[i];
+			const auto ratio = p.wire_bytes > 0 ? static_cast<double>(c.wire_bytes) / static_cast<double>(p.wire_bytes) : 1.0;
+			const char *advice = "-";
+
+			if (bandwidth > 0.0)
+			{
+				advice = sql::mariadb::connection_options::compression_pays_off(p.wire_bytes, bandwidth,
+					ratio, codec_speed, fixed_cost) ? "compress" : "plain";
+			}
+
+			std::printf("%10u %12llu %12llu %10.3f %12.1f %12.1f %10s\n", sizes[i], p.wire_bytes, c.wire_bytes,
+				ratio, p.seconds * 1e6, c.seconds * 1e6, advice);
+		}
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
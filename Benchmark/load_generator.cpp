@@ -0,0 +1,566 @@
+﻿//*********************************************************
+// 文件名称 : load_generator.cpp
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 文件说明 : 类似 sysbench oltp 的负载生成程序, 通过 connection_pool 和 command 执行
+//            点查询、范围扫描、插入和更新的混合负载, 以 JSON 格式输出吞吐量和延迟分位数;
+//            闭环模式下每个线程执行完一个请求后立即执行下一个;
+//            开环模式下按固定速率安排请求, 延迟从计划开始的时间算起 (包括排队时间);
+//            使用方法:
+//            load_generator [--host=127.0.0.1] [--port=3306] [--user=root] [--password=]
+//                           [--database=test] [--table=sbtest1] [--table-size=10000]
+//                           [--threads=8] [--connections=8] [--duration=10] [--rate=0]
+//                           [--mix=point:70,range:10,insert:10,update:10] [--range-size=100]
+//                           [--prepare] [--mock] [--mock-latency=0]
+//            --rate 为每秒请求总数, 0 代表闭环模式; --prepare 先创建并填充数据表;
+//            --mock 在本进程中启动模拟服务器 (mock_server), 不需要数据库服务器
+//*********************************************************
+
+#include "../LibMariaDbConnectivity/mariadb.h"
+#include "mock_server.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+	// 请求类型
+	enum operation
+	{
+		point_select, // 按主键查询一行
+		range_scan, // 按主键范围查询多行
+		insert_row, // 插入一行
+		update_row, // 按主键更新一行
+		operation_count
+	};
+
+	const char *const operation_names[operation_count] = { "point_select", "range_scan", "insert", "update" };
+	const char *const operation_keys[operation_count] = { "point", "range", "insert", "update" };
+
+	// 命令行参数
+	struct options
+	{
+		std::string host = "127.0.0.1"; // 服务器 IP 地址
+		unsigned int port = 3306; // 服务器端口
+		std::string user = "root"; // 用户名
+		std::string password; // 密码
+		std::string database = "test"; // 数据库名
+		std::string table = "sbtest1"; // 数据表名
+		unsigned long long table_size = 10000; // 数据表的行数, 点查询和更新的主键范围
+		unsigned long long range_size = 100; // 范围扫描的行数
+		size_t threads = 8; // 线程数
+		size_t connections = 8; // 连接池的容量
+		double duration = 10; // 测量时间 (秒)
+		double rate = 0; // 每秒请求总数, 0 代表闭环模式
+		unsigned int mix[operation_count] = { 70, 10, 10, 10 }; // 各种请求的权重
+		bool prepare = false; // 是否先创建并填充数据表
+		bool mock = false; // 是否使用模拟服务器
+		unsigned long long mock_latency = 0; // 模拟服务器的延迟 (微秒)
+	};
+
+	// 一个线程的测量结果
+	struct worker_result
+	{
+		sql::mariadb::latency_histogram latency[operation_count]; // 每种请求的延迟
+		sql::mariadb::latency_histogram pool_wait; // 从连接池借出连接的等待时间
+		unsigned long long errors[operation_count] = { 0 }; // 每种请求的失败次数
+	};
+
+
+	//*********************************************************
+	// 函数名称 : parse_mix
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 解析请求的权重, 格式为 point:70,range:10,insert:10,update:10, 没有列出的请求权重为 0
+	// 函数参数 : const char * text 参数值
+	// 函数参数 : unsigned int (&mix)[operation_count] 各种请求的权重
+	// 返 回 值 : bool false 代表格式错误
+	//*********************************************************
+	bool parse_mix(const char *text, unsigned int (&mix)[operation_count])
+	{
+		unsigned int weights[operation_count] = { 0 };
+		while (*text != '\0')
+		{
+			const auto colon = std::strchr(text, ':');
+			if (colon == nullptr)
+			{
+				return false;
+			}
+
+			const std::string key(text, colon);
+			size_t n = 0;
+			while (n < operation_count && key != operation_keys[n])
+			{
+				++n;
+			}
+			if (n == operation_count)
+			{
+				return false;
+			}
+
+			char *end = nullptr;
+			weights[n] = (unsigned int)std::strtoul(colon + 1, &end, 10);
+			if (end == colon + 1 || (*end != ',' && *end != '\0'))
+			{
+				return false;
+			}
+			text = *end == ',' ? end + 1 : end;
+		}
+
+		unsigned int total = 0;
+		for (const auto weight : weights)
+		{
+			total += weight;
+		}
+		if (total == 0)
+		{
+			return false;
+		}
+
+		std::memcpy(mix, weights, sizeof(weights));
+		return true;
+	}
+
+
+	//*********************************************************
+	// 函数名称 : parse_options
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 解析命令行参数
+	// 函数参数 : int argc 参数个数
+	// 函数参数 : char * argv[] 参数
+	// 函数参数 : options & settings 解析结果
+	// 返 回 值 : bool false 代表参数错误
+	//*********************************************************
+	bool parse_options(int argc, char *argv[], options &settings)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string argument(argv[i]);
+			const auto equal = argument.find('=');
+			const auto key = argument.substr(0, equal);
+			const auto value = equal == std::string::npos ? std::string() : argument.substr(equal + 1);
+			const auto number = [&]() { return std::strtoull(value.c_str(), nullptr, 10); };
+
+			if (key == "--host")
+			{
+				settings.host = value;
+			}
+			else if (key == "--port")
+			{
+				settings.port = (unsigned int)number();
+			}
+			else if (key == "--user")
+			{
+				settings.user = value;
+			}
+			else if (key == "--password")
+			{
+				settings.password = value;
+			}
+			else if (key == "--database")
+			{
+				settings.database = value;
+			}
+			else if (key == "--table")
+			{
+				settings.table = value;
+			}
+			else if (key == "--table-size")
+			{
+				settings.table_size = number();
+			}
+			else if (key == "--range-size")
+			{
+				settings.range_size = number();
+			}
+			else if (key == "--threads")
+			{
+				settings.threads = (size_t)number();
+			}
+			else if (key == "--connections")
+			{
+				settings.connections = (size_t)number();
+			}
+			else if (key == "--duration")
+			{
+				settings.duration = std::strtod(value.c_str(), nullptr);
+			}
+			else if (key == "--rate")
+			{
+				settings.rate = std::strtod(value.c_str(), nullptr);
+			}
+			else if (key == "--mix")
+			{
+				if (!parse_mix(value.c_str(), settings.mix))
+				{
+					std::fprintf(stderr, "invalid --mix: %s\n", value.c_str());
+					return false;
+				}
+			}
+			else if (key == "--prepare")
+			{
+				settings.prepare = true;
+			}
+			else if (key == "--mock")
+			{
+				settings.mock = true;
+			}
+			else if (key == "--mock-latency")
+			{
+				settings.mock_latency = number();
+			}
+			else
+			{
+				std::fprintf(stderr, "unknown option: %s\n", argv[i]);
+				return false;
+			}
+		}
+
+		if (settings.threads == 0 || settings.connections == 0 || settings.table_size == 0
+			|| settings.range_size == 0 || settings.duration <= 0 || settings.rate < 0)
+		{
+			std::fprintf(stderr, "--threads, --connections, --table-size, --range-size and --duration must be positive\n");
+			return false;
+		}
+		return true;
+	}
+
+
+	//*********************************************************
+	// 函数名称 : respond
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 模拟服务器的处理函数: 点查询返回 1 行, 范围扫描返回范围内的行, 其他语句返回影响 1 行
+	// 函数参数 : const std::string & query SQL语句
+	// 返 回 值 : sql::mariadb::mock_result 响应
+	//*********************************************************
+	sql::mariadb::mock_result respond(const std::string &query)
+	{
+		if (query.compare(0, 7, "select ") != 0)
+		{
+			return sql::mariadb::mock_result::ok(1, 1);
+		}
+
+		unsigned long long count = 1;
+		const auto between = query.find(" between ");
+		if (between != std::string::npos)
+		{
+			char *end = nullptr;
+			const auto first = std::strtoull(query.c_str() + between + 9, &end, 10);
+			const auto separator = std::strstr(end, "and");
+			const auto last = separator == nullptr ? first : std::strtoull(separator + 3, nullptr, 10);
+			count = last >= first ? last - first + 1 : 0;
+		}
+
+		return sql::mariadb::mock_result::generated({ { "c", MYSQL_TYPE_STRING } }, count,
+			[](unsigned long long, std::vector<sql::mariadb::mock_cell> &row)
+		{
+			row[0] = std::string(120, 'c');
+		});
+	}
+
+
+	//*********************************************************
+	// 函数名称 : prepare_table
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 创建数据表并插入 table_size 行, 每条 insert 语句插入 1000 行
+	// 函数参数 : const sql::mariadb::connection & connector 数据库连接
+	// 函数参数 : const options & settings 命令行参数
+	// 返 回 值 : bool false 代表失败
+	//*********************************************************
+	bool prepare_table(const sql::mariadb::connection &connector, const options &settings)
+	{
+		const sql::mariadb::command executer(connector);
+		if (!executer.execute("drop table if exists " + settings.table)
+			|| !executer.execute("create table " + settings.table + "(id int unsigned not null auto_increment primary key, "
+				"k int unsigned not null default 0, c char(120) not null default '', pad char(60) not null default '', key k(k))"))
+		{
+			std::fprintf(stderr, "create table failed: %s\n", executer.error().c_str());
+			return false;
+		}
+
+		const std::string c(120, 'c'), pad(60, 'p');
+		std::string text;
+		for (unsigned long long id = 1; id <= settings.table_size; )
+		{
+			text = "insert into " + settings.table + "(id, k, c, pad) values";
+			for (unsigned int n = 0; n < 1000 && id <= settings.table_size; ++n, ++id)
+			{
+				text += (n == 0 ? "(" : ",(") + std::to_string(id) + "," + std::to_string(id % 1000) + ",'" + c + "','" + pad + "')";
+			}
+
+			if (!executer.execute(text))
+			{
+				std::fprintf(stderr, "insert failed: %s\n", executer.error().c_str());
+				return false;
+			}
+		}
+		return true;
+	}
+
+
+	//*********************************************************
+	// 函数名称 : perform
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 执行一个请求并读取全部结果
+	// 函数参数 : const sql::mariadb::connection & connector 数据库连接
+	// 函数参数 : operation type 请求类型
+	// 函数参数 : std::mt19937_64 & random 随机数生成器
+	// 函数参数 : const options & settings 命令行参数
+	// 返 回 值 : bool false 代表执行失败
+	// 异    常 : 如果执行失败可能抛出 mariadb_exception 异常
+	//*********************************************************
+	bool perform(const sql::mariadb::connection &connector, operation type, std::mt19937_64 &random, const options &settings)
+	{
+		const sql::mariadb::command executer(connector);
+		const auto id = std::uniform_int_distribution<unsigned long long>(1, settings.table_size)(random);
+		switch (type)
+		{
+		case point_select:
+		{
+			auto reader = executer.execute_reader("select c from " + settings.table + " where id = ?", std::make_tuple(id));
+			while (reader.read())
+			{
+			}
+			return true;
+		}
+		case range_scan:
+		{
+			auto reader = executer.execute_reader("select c from " + settings.table + " where id between ? and ?",
+				std::make_tuple(id, id + settings.range_size - 1));
+			while (reader.read())
+			{
+			}
+			return true;
+		}
+		case insert_row:
+			return executer.execute("insert into " + settings.table + "(k, c, pad) values(?, ?, ?)",
+				std::make_tuple(id % 1000, std::string(120, 'c'), std::string(60, 'p')));
+		default:
+			return executer.execute("update " + settings.table + " set k = k + 1 where id = ?", std::make_tuple(id));
+		}
+	}
+
+
+	//*********************************************************
+	// 函数名称 : work
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 工作线程, 在 deadline 之前按权重随机执行请求;
+	//            开环模式下第 n 个请求的计划开始时间为 start + n * interval, 落后时不等待
+	// 函数参数 : sql::mariadb::connection_pool & pool 连接池
+	// 函数参数 : const options & settings 命令行参数
+	// 函数参数 : size_t index 线程序号, 用作随机数种子
+	// 函数参数 : std::chrono::steady_clock::time_point start 开始时间
+	// 函数参数 : std::chrono::steady_clock::time_point deadline 结束时间
+	// 函数参数 : worker_result & result 测量结果
+	//*********************************************************
+	void work(sql::mariadb::connection_pool &pool, const options &settings, size_t index,
+		std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point deadline,
+		worker_result &result) noexcept
+	{
+		using std::chrono::steady_clock;
+		using std::chrono::duration_cast;
+		using std::chrono::microseconds;
+
+		std::mt19937_64 random(0x9e3779b97f4a7c15ULL * (index + 1));
+		std::discrete_distribution<int> choose(std::begin(settings.mix), std::end(settings.mix));
+
+		// 每个线程承担 rate / threads 的速率, 各线程的起点错开
+		const bool open_loop = settings.rate > 0;
+		const auto interval = open_loop
+			? std::chrono::duration<double>((double)settings.threads / settings.rate) : std::chrono::duration<double>(0);
+		auto scheduled = start + duration_cast<steady_clock::duration>(interval * ((double)index / (double)settings.threads));
+
+		while (true)
+		{
+			if (open_loop)
+			{
+				if (scheduled >= deadline)
+				{
+					break;
+				}
+				std::this_thread::sleep_until(scheduled);
+			}
+
+			const auto begin = open_loop ? scheduled : steady_clock::now();
+			if (begin >= deadline)
+			{
+				break;
+			}
+
+			const auto type = static_cast<operation>(choose(random));
+			bool success = false;
+			try
+			{
+				const auto acquire = steady_clock::now();
+				auto connector = pool.acquire();
+				result.pool_wait.record((unsigned long long)duration_cast<microseconds>(steady_clock::now() - acquire).count());
+				try
+				{
+					success = perform(connector, type, random, settings);
+				}
+				catch (const std::exception &)
+				{
+					// 出错的连接不放回连接池, 避免影响后面的请求
+					connector.discard();
+				}
+			}
+			catch (const std::exception &)
+			{
+			}
+
+			result.latency[type].record((unsigned long long)duration_cast<microseconds>(steady_clock::now() - begin).count());
+			if (!success)
+			{
+				++result.errors[type];
+			}
+
+			if (open_loop)
+			{
+				scheduled += duration_cast<steady_clock::duration>(interval);
+			}
+		}
+	}
+
+
+	//*********************************************************
+	// 函数名称 : print_latency
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 以 JSON 对象输出延迟分位数 (微秒)
+	// 函数参数 : const sql::mariadb::latency_histogram & latency 延迟直方图
+	//*********************************************************
+	void print_latency(const sql::mariadb::latency_histogram &latency)
+	{
+		std::printf("{\"p50\": %llu, \"p90\": %llu, \"p95\": %llu, \"p99\": %llu, \"p999\": %llu, \"max\": %llu}",
+			latency.percentile(0.5), latency.percentile(0.9), latency.percentile(0.95),
+			latency.percentile(0.99), latency.percentile(0.999), latency.percentile(1.0));
+	}
+
+
+	//*********************************************************
+	// 函数名称 : print_report
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 合并所有线程的测量结果并以 JSON 格式输出
+	// 函数参数 : const options & settings 命令行参数
+	// 函数参数 : const std::vector<worker_result> & results 所有线程的测量结果
+	// 函数参数 : double elapsed 实际测量时间 (秒)
+	//*********************************************************
+	void print_report(const options &settings, const std::vector<worker_result> &results, double elapsed)
+	{
+		sql::mariadb::latency_histogram total, pool_wait, latency[operation_count];
+		unsigned long long errors[operation_count] = { 0 }, error_count = 0;
+		for (const auto &result : results)
+		{
+			pool_wait.merge(result.pool_wait);
+			for (size_t n = 0; n < operation_count; ++n)
+			{
+				latency[n].merge(result.latency[n]);
+				total.merge(result.latency[n]);
+				errors[n] += result.errors[n];
+				error_count += result.errors[n];
+			}
+		}
+
+		std::printf("{\n");
+		std::printf("  \"mode\": \"%s\",\n", settings.rate > 0 ? "open" : "closed");
+		std::printf("  \"server\": \"%s\",\n", settings.mock ? "mock" : "mariadb");
+		std::printf("  \"threads\": %zu,\n", settings.threads);
+		std::printf("  \"connections\": %zu,\n", settings.connections);
+		std::printf("  \"target_rate\": %.1f,\n", settings.rate);
+		std::printf("  \"duration_s\": %.3f,\n", elapsed);
+		std::printf("  \"requests\": %llu,\n", total.count());
+		std::printf("  \"errors\": %llu,\n", error_count);
+		std::printf("  \"throughput_rps\": %.1f,\n", (double)total.count() / elapsed);
+		std::printf("  \"latency_us\": ");
+		print_latency(total);
+		std::printf(",\n  \"pool_wait_us\": ");
+		print_latency(pool_wait);
+		std::printf(",\n  \"operations\": {");
+		for (size_t n = 0; n < operation_count; ++n)
+		{
+			std::printf("%s\n    \"%s\": {\"weight\": %u, \"requests\": %llu, \"errors\": %llu, \"throughput_rps\": %.1f, \"latency_us\": ",
+				n == 0 ? "" : ",", operation_names[n], settings.mix[n], latency[n].count(), errors[n],
+				(double)latency[n].count() / elapsed);
+			print_latency(latency[n]);
+			std::printf("}");
+		}
+		std::printf("\n  }\n}\n");
+	}
+}
+
+
+int main(int argc, char *argv[])
+{
+	options settings;
+	if (!parse_options(argc, argv, settings))
+	{
+		return 2;
+	}
+
+	try
+	{
+		std::unique_ptr<sql::mariadb::mock_server> server;
+		if (settings.mock)
+		{
+			server.reset(new sql::mariadb::mock_server(respond));
+			server->set_latency(std::chrono::microseconds(settings.mock_latency));
+			settings.host = "127.0.0.1";
+			settings.port = server->port();
+		}
+
+		sql::mariadb::endpoint point(settings.user, settings.password, settings.database, settings.port, settings.host);
+		sql::mariadb::connection_pool pool(point, settings.connections);
+		if (settings.prepare && !settings.mock)
+		{
+			auto connector = pool.acquire();
+			if (!prepare_table(connector, settings))
+			{
+				return 1;
+			}
+		}
+
+		if (pool.warm_up(settings.connections) != settings.connections)
+		{
+			std::fprintf(stderr, "warning: only %zu of %zu connections opened\n", pool.size(), settings.connections);
+		}
+
+		std::vector<worker_result> results(settings.threads);
+		std::vector<std::thread> threads;
+		const auto start = std::chrono::steady_clock::now() + std::chrono::milliseconds(10);
+		const auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(settings.duration));
+		for (size_t i = 0; i < settings.threads; ++i)
+		{
+			threads.emplace_back(work, std::ref(pool), std::cref(settings), i, start, deadline, std::ref(results[i]));
+		}
+		for (auto &thread : threads)
+		{
+			thread.join();
+		}
+
+		const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		print_report(settings, results, elapsed);
+	}
+	catch (const std::exception &e)
+	{
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+
+	return 0;
+}
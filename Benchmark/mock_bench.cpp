@@ -0,0 +1,257 @@
+﻿//*********************************************************
+// 文件名称 : mock_bench.cpp
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 文件说明 : 通过本机的模拟服务器 (mock_server) 测量完整的请求往返, 包括网络协议的编码和解码;
+//            不需要真实的数据库服务器, 结果不受服务器执行时间的影响;
+//            使用方法:
+//            mock_bench [最短测量时间 (毫秒)] [模拟延迟 (微秒)] [--json]
+//            --json 时每个测试输出一行 JSON, 供 bench_compare 读取
+//*********************************************************
+
+#include "../LibMariaDbConnectivity/mariadb.h"
+#include "mock_server.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+	std::chrono::milliseconds min_time(200); // 每个测试最短的测量时间
+	volatile size_t sink = 0; // 保存测试结果, 防止编译器优化掉被测代码
+	bool json_output = false; // 是否以 JSON 格式输出
+
+
+	//*********************************************************
+	// 函数名称 : run
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 重复执行 function, 直到测量时间超过 min_time, 然后输出每次的耗时;
+	//            启用 SQL_MARIADB_ALLOC_STATS 时另外执行最多 1000 次, 输出客户端线程每次的分配次数和字节数
+	// 函数参数 : const char * name 测试名称
+	// 函数参数 : Function function 被测代码, 返回值保存到 sink
+	//*********************************************************
+	template <typename Function>
+	void run(const char *name, Function function)
+	{
+		sink = sink + function(); // 预热
+
+		unsigned long long iterations = 1;
+		while (true)
+		{
+			const auto begin = std::chrono::steady_clock::now();
+			for (unsigned long long i = 0; i < iterations; ++i)
+			{
+				sink = sink + function();
+			}
+			const auto elapsed = std::chrono::steady_clock::now() - begin;
+
+			if (elapsed >= min_time || iterations >= (1ULL << 32))
+			{
+				const auto nanoseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+				const auto ns_per_op = nanoseconds / (double)iterations;
+				if (!sql::mariadb::alloc_scope::enabled())
+				{
+					if (json_output)
+					{
+						std::printf("{\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.2f}\n", name, iterations, ns_per_op);
+					}
+					else
+					{
+						std::printf("%-40s %14llu %12.1f\n", name, iterations, ns_per_op);
+					}
+					std::fflush(stdout);
+					return;
+				}
+
+				// 分配统计单独执行, 不影响计时; 模拟服务器在其他线程中分配, 不计入
+				const auto samples = std::min(iterations, 1000ULL);
+				sql::mariadb::alloc_scope scope;
+				for (unsigned long long i = 0; i < samples; ++i)
+				{
+					sink = sink + function();
+				}
+				const auto allocs_per_op = (double)scope.allocations() / (double)samples;
+				const auto bytes_per_op = (double)scope.bytes() / (double)samples;
+
+				if (json_output)
+				{
+					std::printf("{\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.2f, \"allocs_per_op\": %.2f, \"bytes_per_op\": %.1f}\n",
+						name, iterations, ns_per_op, allocs_per_op, bytes_per_op);
+				}
+				else
+				{
+					std::printf("%-40s %14llu %12.1f %12.2f %12.1f\n", name, iterations, ns_per_op, allocs_per_op, bytes_per_op);
+				}
+				std::fflush(stdout);
+				return;
+			}
+
+			iterations *= 2;
+		}
+	}
+
+
+	//*********************************************************
+	// 函数名称 : respond
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 模拟服务器的处理函数: "select <n>" 返回 n 行 (int, varchar(32), double),
+	//            其他语句返回影响 1 行
+	// 函数参数 : const std::string & query SQL语句
+	// 返 回 值 : sql::mariadb::mock_result 响应
+	//*********************************************************
+	sql::mariadb::mock_result respond(const std::string &query)
+	{
+		if (query.compare(0, 7, "select ") != 0)
+		{
+			return sql::mariadb::mock_result::ok(1);
+		}
+
+		const auto count = std::strtoull(query.c_str() + 7, nullptr, 10);
+		std::vector<sql::mariadb::mock_column> columns =
+		{
+			{ "id", MYSQL_TYPE_LONG },
+			{ "name", MYSQL_TYPE_VAR_STRING },
+			{ "score", MYSQL_TYPE_DOUBLE }
+		};
+		return sql::mariadb::mock_result::generated(std::move(columns), count,
+			[](unsigned long long n, std::vector<sql::mariadb::mock_cell> &row)
+		{
+			row[0] = std::to_string(n);
+			row[1] = std::string(32, 'n');
+			row[2] = "3.25";
+		});
+	}
+
+
+	//*********************************************************
+	// 函数名称 : bench_round_trips
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 测量通过模拟服务器执行的常见操作
+	// 函数参数 : const sql::mariadb::connection & connector 已经连接模拟服务器的数据库连接
+	//*********************************************************
+	void bench_round_trips(const sql::mariadb::connection &connector)
+	{
+		typedef std::tuple<int, std::string, double> row;
+		const sql::mariadb::command executer(connector);
+
+		run("command::execute round trip", [&]()
+		{
+			return (size_t)executer.execute("update t set a = 1");
+		});
+
+		run("command::execute(text, tuple)", [&]()
+		{
+			return (size_t)executer.execute("update t set a = ?, b = ?", std::make_tuple(1, std::string(32, 'n')));
+		});
+
+		run("query_vector 1 row", [&]()
+		{
+			return executer.query_vector<row>("select 1").size();
+		});
+
+		run("query_vector 1000 rows", [&]()
+		{
+			return executer.query_vector<row>("select 1000").size();
+		});
+
+		const std::vector<std::string> batch = { "update t set a = 1", "select 1", "update t set b = 2" };
+		run("execute_batch 3 results", [&]()
+		{
+			size_t count = 1;
+			auto reader = executer.execute_batch(batch);
+			while (reader.next_result())
+			{
+				++count;
+			}
+			return count;
+		});
+
+		sql::mariadb::prepared_statement statement(connector);
+		if (!statement.prepare("select 100 where a = ?"))
+		{
+			std::fprintf(stderr, "prepare failed: %s\n", statement.error().c_str());
+			return;
+		}
+		run("prepared_statement 100 rows", [&]()
+		{
+			statement.add(0, 7);
+			size_t count = 0;
+			if (statement.execute())
+			{
+				while (statement.read())
+				{
+					count += statement.data_size(1);
+				}
+				statement.free_result();
+			}
+			return count;
+		});
+	}
+}
+
+
+int main(int argc, char *argv[])
+{
+	unsigned long latency = 0;
+	int position = 0;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--json") == 0)
+		{
+			json_output = true;
+		}
+		else if (position++ == 0)
+		{
+			min_time = std::chrono::milliseconds(std::strtoul(argv[i], nullptr, 10));
+		}
+		else
+		{
+			latency = std::strtoul(argv[i], nullptr, 10);
+		}
+	}
+
+	try
+	{
+		sql::mariadb::mock_server server(respond);
+		server.set_latency(std::chrono::microseconds(latency));
+
+		sql::mariadb::connection connector;
+		if (!connector.open("bench", "bench", "bench", server.port(), "127.0.0.1", nullptr, CLIENT_MULTI_STATEMENTS))
+		{
+			std::fprintf(stderr, "connect failed: %s\n", connector.error().c_str());
+			return 1;
+		}
+
+		if (json_output)
+		{
+			bench_round_trips(connector);
+			return 0;
+		}
+
+		if (sql::mariadb::alloc_scope::enabled())
+		{
+			std::printf("%-40s %14s %12s %12s %12s\n", "benchmark", "iterations", "ns/op", "allocs/op", "B/op");
+		}
+		else
+		{
+			std::printf("%-40s %14s %12s\n", "benchmark", "iterations", "ns/op");
+		}
+		bench_round_trips(connector);
+		std::printf("queries handled by mock server: %llu\n", server.queries());
+	}
+	catch (const std::exception &e)
+	{
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,1653 @@
+﻿//*********************************************************
+// 文件名称 : mock_server.cpp
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 文件说明 : 模拟 MariaDB 服务器的实现, 按 MariaDB/MySQL 客户端/服务器协议 (protocol 41) 收发数据包
+//*********************************************************
+
+#include "mock_server.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+	// 客户端命令
+	const unsigned char com_quit = 0x01;
+	const unsigned char com_init_db = 0x02;
+	const unsigned char com_query = 0x03;
+	const unsigned char com_ping = 0x0e;
+	const unsigned char com_stmt_prepare = 0x16;
+	const unsigned char com_stmt_execute = 0x17;
+	const unsigned char com_stmt_send_long_data = 0x18;
+	const unsigned char com_stmt_close = 0x19;
+	const unsigned char com_stmt_reset = 0x1a;
+	const unsigned char com_set_option = 0x1b;
+	const unsigned char com_reset_connection = 0x1f;
+
+	// 服务器能力: LONG_PASSWORD | FOUND_ROWS | LONG_FLAG | CONNECT_WITH_DB | PROTOCOL_41 | TRANSACTIONS
+	//             | SECURE_CONNECTION | MULTI_STATEMENTS | MULTI_RESULTS | PS_MULTI_RESULTS | PLUGIN_AUTH
+	const unsigned long server_capabilities = 0x0001 | 0x0002 | 0x0004 | 0x0008 | 0x0200 | 0x2000
+		| 0x8000 | 0x10000 | 0x20000 | 0x40000 | 0x80000;
+
+	const unsigned int status_autocommit = 0x0002; // SERVER_STATUS_AUTOCOMMIT
+	const unsigned int status_more_results = 0x0008; // SERVER_MORE_RESULTS_EXIST
+	const unsigned int charset_utf8 = 33; // utf8_general_ci
+	const unsigned int charset_binary = 63; // binary
+	const size_t max_payload = 0xffffff; // 一个数据包的最大长度
+	const size_t flush_size = 64 * 1024; // 输出缓冲区超过该大小时发送
+
+
+	//*********************************************************
+	// 函数名称 : put_int
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 按小端字节序写入整数
+	// 访问方式 : private
+	// 函数参数 : std::string & buffer 缓冲区
+	// 函数参数 : unsigned long long value 整数
+	// 函数参数 : size_t size 字节数
+	//*********************************************************
+	void put_int(std::string &buffer, unsigned long long value, size_t size)
+	{
+		for (size_t i = 0; i < size; ++i)
+		{
+			buffer.push_back(static_cast<char>((value >> (i * 8)) & 0xff));
+		}
+	}
+
+
+	//*********************************************************
+	// 函数名称 : put_lenenc
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 写入长度编码整数 (length-encoded integer)
+	// 访问方式 : private
+	// 函数参数 : std::string & buffer 缓冲区
+	// 函数参数 : unsigned long long value 整数
+	//*********************************************************
+	void put_lenenc(std::string &buffer, unsigned long long value)
+	{
+		if (value < 251)
+		{
+			put_int(buffer, value, 1);
+		}
+		else if (value < 0x10000)
+		{
+			buffer.push_back(static_cast<char>(0xfc));
+			put_int(buffer, value, 2);
+		}
+		else if (value < 0x1000000)
+		{
+			buffer.push_back(static_cast<char>(0xfd));
+			put_int(buffer, value, 3);
+		}
+		else
+		{
+			buffer.push_back(static_cast<char>(0xfe));
+			put_int(buffer, value, 8);
+		}
+	}
+
+
+	//*********************************************************
+	// 函数名称 : put_lenenc_string
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 写入长度编码字符串 (length-encoded string)
+	// 访问方式 : private
+	// 函数参数 : std::string & buffer 缓冲区
+	// 函数参数 : const std::string & value 字符串
+	//*********************************************************
+	void put_lenenc_string(std::string &buffer, const std::string &value)
+	{
+		put_lenenc(buffer, value.size());
+		buffer.append(value);
+	}
+
+
+	//*********************************************************
+	// 函数名称 : get_int
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 按小端字节序读取整数
+	// 访问方式 : private
+	// 函数参数 : const std::string & packet 数据包
+	// 函数参数 : size_t & pos 读取位置, 读取后移动到整数之后
+	// 函数参数 : size_t size 字节数
+	// 返 回 值 : unsigned long long 整数
+	// 异    常 : 如果数据包长度不足则抛出 std::runtime_error 异常
+	//*********************************************************
+	unsigned long long get_int(const std::string &packet, size_t &pos, size_t size)
+	{
+		if (packet.size() < pos + size)
+		{
+			throw std::runtime_error("malformed packet");
+		}
+
+		unsigned long long value = 0;
+		for (size_t i = 0; i < size; ++i)
+		{
+			value |= static_cast<unsigned long long>(static_cast<unsigned char>(packet[pos + i])) << (i * 8);
+		}
+		pos += size;
+		return value;
+	}
+
+
+	//*********************************************************
+	// 函数名称 : get_lenenc_string
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 读取长度编码字符串
+	// 访问方式 : private
+	// 函数参数 : const std::string & packet 数据包
+	// 函数参数 : size_t & pos 读取位置, 读取后移动到字符串之后
+	// 返 回 值 : std::string 字符串
+	// 异    常 : 如果数据包长度不足则抛出 std::runtime_error 异常
+	//*********************************************************
+	std::string get_lenenc_string(const std::string &packet, size_t &pos)
+	{
+		auto size = get_int(packet, pos, 1);
+		if (size == 0xfc)
+		{
+			size = get_int(packet, pos, 2);
+		}
+		else if (size == 0xfd)
+		{
+			size = get_int(packet, pos, 3);
+		}
+		else if (size == 0xfe)
+		{
+			size = get_int(packet, pos, 8);
+		}
+
+		if (packet.size() - pos < size)
+		{
+			throw std::runtime_error("malformed packet");
+		}
+
+		std::string value(packet, pos, static_cast<size_t>(size));
+		pos += static_cast<size_t>(size);
+		return value;
+	}
+
+
+	//*********************************************************
+	// 函数名称 : quote
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 用单引号引用字符串, 转义单引号和反斜杠
+	// 访问方式 : private
+	// 函数参数 : const std::string & value 字符串
+	// 返 回 值 : std::string 引用后的字符串
+	//*********************************************************
+	std::string quote(const std::string &value)
+	{
+		std::string text;
+		text.reserve(value.size() + 2);
+		text.push_back('\'');
+		for (const auto ch : value)
+		{
+			if (ch == '\'' || ch == '\\')
+			{
+				text.push_back('\\');
+			}
+			text.push_back(ch);
+		}
+		text.push_back('\'');
+		return text;
+	}
+
+
+	//*********************************************************
+	// 函数名称 : for_each_placeholder
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 按顺序处理SQL语句中不在引号内的问号
+	// 访问方式 : private
+	// 函数参数 : const std::string & text SQL语句
+	// 函数参数 : const std::function<void(size_t)> & callback 参数为问号的位置
+	//*********************************************************
+	void for_each_placeholder(const std::string &text, const std::function<void(size_t)> &callback)
+	{
+		char quoted = '\0';
+		for (size_t i = 0; i < text.size(); ++i)
+		{
+			const auto ch = text[i];
+			if (quoted != '\0')
+			{
+				if (ch == '\\')
+				{
+					++i;
+				}
+				else if (ch == quoted)
+				{
+					quoted = '\0';
+				}
+			}
+			else if (ch == '\'' || ch == '"' || ch == '`')
+			{
+				quoted = ch;
+			}
+			else if (ch == '?')
+			{
+				callback(i);
+			}
+		}
+	}
+
+
+	//*********************************************************
+	// 函数名称 : split_statements
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 按不在引号内的分号拆分多条SQL语句, 忽略空语句
+	// 访问方式 : private
+	// 函数参数 : const std::string & text SQL语句
+	// 返 回 值 : std::vector<std::string> 每条SQL语句
+	//*********************************************************
+	std::vector<std::string> split_statements(const std::string &text)
+	{
+		std::vector<std::string> statements;
+		const auto push = [&](size_t first, size_t last)
+		{
+			while (first < last && std::isspace(static_cast<unsigned char>(text[first])))
+			{
+				++first;
+			}
+			while (last > first && std::isspace(static_cast<unsigned char>(text[last - 1])))
+			{
+				--last;
+			}
+			if (first < last)
+			{
+				statements.emplace_back(text, first, last - first);
+			}
+		};
+
+		char quoted = '\0';
+		size_t begin = 0;
+		for (size_t i = 0; i < text.size(); ++i)
+		{
+			const auto ch = text[i];
+			if (quoted != '\0')
+			{
+				if (ch == '\\')
+				{
+					++i;
+				}
+				else if (ch == quoted)
+				{
+					quoted = '\0';
+				}
+			}
+			else if (ch == '\'' || ch == '"' || ch == '`')
+			{
+				quoted = ch;
+			}
+			else if (ch == ';')
+			{
+				push(begin, i);
+				begin = i + 1;
+			}
+		}
+		push(begin, text.size());
+
+		if (statements.empty())
+		{
+			statements.emplace_back();
+		}
+		return statements;
+	}
+
+
+	//*********************************************************
+	// 函数名称 : is_numeric
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 判断列类型在二进制结果集中是否按数值编码
+	// 访问方式 : private
+	// 函数参数 : enum_field_types type 列类型
+	// 返 回 值 : bool true 代表数值类型
+	//*********************************************************
+	bool is_numeric(enum_field_types type)
+	{
+		switch (type)
+		{
+		case MYSQL_TYPE_TINY:
+		case MYSQL_TYPE_SHORT:
+		case MYSQL_TYPE_YEAR:
+		case MYSQL_TYPE_LONG:
+		case MYSQL_TYPE_INT24:
+		case MYSQL_TYPE_LONGLONG:
+		case MYSQL_TYPE_FLOAT:
+		case MYSQL_TYPE_DOUBLE:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+
+	//*********************************************************
+	// 函数名称 : put_binary_value
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 按列类型把文本形式的值写入二进制结果集的行
+	// 访问方式 : private
+	// 函数参数 : std::string & buffer 缓冲区
+	// 函数参数 : enum_field_types type 列类型
+	// 函数参数 : const std::string & text 文本形式的值
+	//*********************************************************
+	void put_binary_value(std::string &buffer, enum_field_types type, const std::string &text)
+	{
+		const auto integer = [&]()
+		{
+			return text.find('-') == std::string::npos
+				? std::strtoull(text.c_str(), nullptr, 10)
+				: static_cast<unsigned long long>(std::strtoll(text.c_str(), nullptr, 10));
+		};
+
+		switch (type)
+		{
+		case MYSQL_TYPE_TINY:
+			put_int(buffer, integer(), 1);
+			return;
+		case MYSQL_TYPE_SHORT:
+		case MYSQL_TYPE_YEAR:
+			put_int(buffer, integer(), 2);
+			return;
+		case MYSQL_TYPE_LONG:
+		case MYSQL_TYPE_INT24:
+			put_int(buffer, integer(), 4);
+			return;
+		case MYSQL_TYPE_LONGLONG:
+			put_int(buffer, integer(), 8);
+			return;
+		case MYSQL_TYPE_FLOAT:
+		{
+			const auto value = std::strtof(text.c_str(), nullptr);
+			unsigned int bits = 0;
+			std::memcpy(&bits, &value, sizeof(bits));
+			put_int(buffer, bits, 4);
+			return;
+		}
+		case MYSQL_TYPE_DOUBLE:
+		{
+			const auto value = std::strtod(text.c_str(), nullptr);
+			unsigned long long bits = 0;
+			std::memcpy(&bits, &value, sizeof(bits));
+			put_int(buffer, bits, 8);
+			return;
+		}
+		case MYSQL_TYPE_DATE:
+		case MYSQL_TYPE_DATETIME:
+		case MYSQL_TYPE_TIMESTAMP:
+		{
+			unsigned int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0, micro = 0;
+			std::sscanf(text.c_str(), "%u-%u-%u %u:%u:%u.%u", &year, &month, &day, &hour, &minute, &second, &micro);
+			const size_t size = micro != 0 ? 11 : (hour != 0 || minute != 0 || second != 0) ? 7 : 4;
+			put_int(buffer, size, 1);
+			put_int(buffer, year, 2);
+			put_int(buffer, month, 1);
+			put_int(buffer, day, 1);
+			if (size > 4)
+			{
+				put_int(buffer, hour, 1);
+				put_int(buffer, minute, 1);
+				put_int(buffer, second, 1);
+			}
+			if (size > 7)
+			{
+				put_int(buffer, micro, 4);
+			}
+			return;
+		}
+		case MYSQL_TYPE_TIME:
+		{
+			const bool negative = !text.empty() && text[0] == '-';
+			unsigned int hour = 0, minute = 0, second = 0, micro = 0;
+			std::sscanf(text.c_str() + (negative ? 1 : 0), "%u:%u:%u.%u", &hour, &minute, &second, &micro);
+			const size_t size = micro != 0 ? 12 : 8;
+			put_int(buffer, size, 1);
+			put_int(buffer, negative ? 1 : 0, 1);
+			put_int(buffer, hour / 24, 4);
+			put_int(buffer, hour % 24, 1);
+			put_int(buffer, minute, 1);
+			put_int(buffer, second, 1);
+			if (size > 8)
+			{
+				put_int(buffer, micro, 4);
+			}
+			return;
+		}
+		default:
+			put_lenenc_string(buffer, text);
+			return;
+		}
+	}
+
+
+	//*********************************************************
+	// 函数名称 : get_binary_param
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 读取 COM_STMT_EXECUTE 中的一个参数, 转换为SQL语句中的字面值
+	// 访问方式 : private
+	// 函数参数 : const std::string & packet 数据包
+	// 函数参数 : size_t & pos 读取位置, 读取后移动到参数之后
+	// 函数参数 : unsigned int type 参数类型, 最高位代表无符号
+	// 返 回 值 : std::string 字面值
+	// 异    常 : 如果数据包长度不足则抛出 std::runtime_error 异常
+	//*********************************************************
+	std::string get_binary_param(const std::string &packet, size_t &pos, unsigned int type)
+	{
+		const bool is_unsigned = (type & 0x8000) != 0;
+		const auto integer = [&](size_t size)
+		{
+			const auto value = get_int(packet, pos, size);
+			if (is_unsigned || (size == 8 && value < 0x8000000000000000ULL))
+			{
+				return std::to_string(value);
+			}
+
+			const auto bits = size * 8;
+			const auto sign = 1ULL << (bits - 1);
+			if (size < 8 && (value & sign) == 0)
+			{
+				return std::to_string(value);
+			}
+			return std::to_string(static_cast<long long>(value | (size < 8 ? ~0ULL << bits : 0ULL)));
+		};
+
+		char text[64] = { 0 };
+		switch (static_cast<enum_field_types>(type & 0xff))
+		{
+		case MYSQL_TYPE_NULL:
+			return "NULL";
+		case MYSQL_TYPE_TINY:
+			return integer(1);
+		case MYSQL_TYPE_SHORT:
+		case MYSQL_TYPE_YEAR:
+			return integer(2);
+		case MYSQL_TYPE_LONG:
+		case MYSQL_TYPE_INT24:
+			return integer(4);
+		case MYSQL_TYPE_LONGLONG:
+			return integer(8);
+		case MYSQL_TYPE_FLOAT:
+		{
+			const auto bits = static_cast<unsigned int>(get_int(packet, pos, 4));
+			float value = 0;
+			std::memcpy(&value, &bits, sizeof(value));
+			std::snprintf(text, sizeof(text), "%.9g", value);
+			return text;
+		}
+		case MYSQL_TYPE_DOUBLE:
+		{
+			const auto bits = get_int(packet, pos, 8);
+			double value = 0;
+			std::memcpy(&value, &bits, sizeof(value));
+			std::snprintf(text, sizeof(text), "%.17g", value);
+			return text;
+		}
+		case MYSQL_TYPE_DATE:
+		case MYSQL_TYPE_DATETIME:
+		case MYSQL_TYPE_TIMESTAMP:
+		{
+			const auto size = get_int(packet, pos, 1);
+			const auto year = size >= 4 ? get_int(packet, pos, 2) : 0;
+			const auto month = size >= 4 ? get_int(packet, pos, 1) : 0;
+			const auto day = size >= 4 ? get_int(packet, pos, 1) : 0;
+			const auto hour = size >= 7 ? get_int(packet, pos, 1) : 0;
+			const auto minute = size >= 7 ? get_int(packet, pos, 1) : 0;
+			const auto second = size >= 7 ? get_int(packet, pos, 1) : 0;
+			const auto micro = size >= 11 ? get_int(packet, pos, 4) : 0;
+			std::snprintf(text, sizeof(text), "'%04u-%02u-%02u %02u:%02u:%02u.%06u'",
+				(unsigned int)year, (unsigned int)month, (unsigned int)day,
+				(unsigned int)hour, (unsigned int)minute, (unsigned int)second, (unsigned int)micro);
+			return text;
+		}
+		case MYSQL_TYPE_TIME:
+		{
+			const auto size = get_int(packet, pos, 1);
+			const auto negative = size >= 8 ? get_int(packet, pos, 1) : 0;
+			const auto days = size >= 8 ? get_int(packet, pos, 4) : 0;
+			const auto hour = size >= 8 ? get_int(packet, pos, 1) : 0;
+			const auto minute = size >= 8 ? get_int(packet, pos, 1) : 0;
+			const auto second = size >= 8 ? get_int(packet, pos, 1) : 0;
+			const auto micro = size >= 12 ? get_int(packet, pos, 4) : 0;
+			std::snprintf(text, sizeof(text), "'%s%02u:%02u:%02u.%06u'", negative != 0 ? "-" : "",
+				(unsigned int)(days * 24 + hour), (unsigned int)minute, (unsigned int)second, (unsigned int)micro);
+			return text;
+		}
+		default:
+			return quote(get_lenenc_string(packet, pos));
+		}
+	}
+}
+
+
+namespace sql
+{
+	namespace mariadb
+	{
+		// 一个客户端连接, 在自己的线程中按顺序处理命令
+		class mock_server::session
+		{
+		public:
+
+			//*********************************************************
+			// 函数名称 : session
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数, 创建处理命令的线程
+			// 访问方式 : public
+			// 函数参数 : mock_server & server 所属的服务器
+			// 函数参数 : int socket 客户端套接字
+			// 函数参数 : unsigned int id 连接ID
+			//*********************************************************
+			session(mock_server &server, int socket, unsigned int id)
+				: m_server(server)
+				, m_socket(socket)
+				, m_id(id)
+				, m_sequence(0)
+				, m_next_statement(1)
+				, m_finished(false)
+			{
+				m_thread = std::thread([this]() { this->run(); });
+			}
+
+			//*********************************************************
+			// 函数名称 : ~session
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 关闭套接字并等待线程结束
+			// 访问方式 : public
+			//*********************************************************
+			~session(void) noexcept
+			{
+				this->close();
+				if (m_thread.joinable())
+				{
+					m_thread.join();
+				}
+				::close(m_socket);
+			}
+
+			//*********************************************************
+			// 函数名称 : close
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 关闭套接字的读写, 使线程中阻塞的读取返回
+			// 访问方式 : public
+			//*********************************************************
+			void close(void) noexcept
+			{
+				::shutdown(m_socket, SHUT_RDWR);
+			}
+
+			//*********************************************************
+			// 函数名称 : finished
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 判断客户端是否已经断开
+			// 访问方式 : public
+			// 返 回 值 : bool true 代表已经断开
+			//*********************************************************
+			bool finished(void) const noexcept
+			{
+				return m_finished.load();
+			}
+
+		private:
+			// 预处理语句
+			struct statement
+			{
+				std::string text; // 带问号的SQL语句
+				size_t param_count; // 参数数量
+				std::vector<unsigned int> types; // 上一次执行时绑定的参数类型
+				std::map<unsigned int, std::string> long_data; // COM_STMT_SEND_LONG_DATA 发送的参数
+			};
+
+			//*********************************************************
+			// 函数名称 : session
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const session &
+			//*********************************************************
+			session(const session &) = delete;
+
+			//*********************************************************
+			// 函数名称 : operator=
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const session &
+			// 返 回 值 : session &
+			//*********************************************************
+			session & operator=(const session &) = delete;
+
+			//*********************************************************
+			// 函数名称 : run
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 线程函数, 握手后循环处理命令直到客户端断开
+			// 访问方式 : private
+			//*********************************************************
+			void run(void) noexcept
+			{
+				try
+				{
+					std::string packet;
+					this->handshake();
+					while (this->read_packet(packet) && !packet.empty())
+					{
+						if (!this->dispatch(packet))
+						{
+							break;
+						}
+						this->flush();
+					}
+				}
+				catch (const std::exception &)
+				{
+				}
+
+				// 出错或者断开连接的响应时客户端可能还在等待, 立即关闭使客户端读取失败
+				this->close();
+				m_finished = true;
+			}
+
+			//*********************************************************
+			// 函数名称 : handshake
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 发送握手包 (protocol 10, mysql_native_password), 接受任意用户和密码
+			// 访问方式 : private
+			// 异    常 : 如果客户端断开则抛出 std::runtime_error 异常
+			//*********************************************************
+			void handshake(void)
+			{
+				const std::string scramble = "mock-scramble-012345"; // 20 字节的挑战数据
+
+				std::string packet;
+				put_int(packet, 10, 1);
+				packet.append("5.5.5-10.6.0-MariaDB-mock");
+				packet.push_back('\0');
+				put_int(packet, m_id, 4);
+				packet.append(scramble, 0, 8);
+				packet.push_back('\0');
+				put_int(packet, server_capabilities & 0xffff, 2);
+				put_int(packet, charset_utf8, 1);
+				put_int(packet, status_autocommit, 2);
+				put_int(packet, server_capabilities >> 16, 2);
+				put_int(packet, 21, 1);
+				packet.append(10, '\0');
+				packet.append(scramble, 8, std::string::npos);
+				packet.push_back('\0');
+				packet.append("mysql_native_password");
+				packet.push_back('\0');
+
+				m_sequence = 0;
+				this->write_packet(packet);
+				this->flush();
+
+				// 不检查用户名和密码
+				if (!this->read_packet(packet))
+				{
+					throw std::runtime_error("client closed");
+				}
+				this->send_ok(0, 0, status_autocommit);
+				this->flush();
+			}
+
+			//*********************************************************
+			// 函数名称 : dispatch
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 处理一个命令
+			// 访问方式 : private
+			// 函数参数 : const std::string & packet 命令数据包
+			// 返 回 值 : bool false 代表客户端要求断开
+			// 异    常 : 如果数据包格式错误或者发送失败则抛出 std::runtime_error 异常
+			//*********************************************************
+			bool dispatch(const std::string &packet)
+			{
+				const auto command = static_cast<unsigned char>(packet[0]);
+				const std::string body(packet, 1);
+				if (command == com_quit)
+				{
+					return false;
+				}
+
+				this->wait();
+				switch (command)
+				{
+				case com_query:
+					this->on_query(body);
+					break;
+				case com_stmt_prepare:
+					this->on_prepare(body);
+					break;
+				case com_stmt_execute:
+					this->on_execute(body);
+					break;
+				case com_stmt_send_long_data:
+				{
+					size_t pos = 0;
+					const auto id = static_cast<unsigned int>(get_int(body, pos, 4));
+					const auto param = static_cast<unsigned int>(get_int(body, pos, 2));
+					const auto it = m_statements.find(id);
+					if (it != m_statements.end())
+					{
+						it->second.long_data[param].append(body, pos, std::string::npos);
+					}
+					break; // 没有响应
+				}
+				case com_stmt_close:
+				{
+					size_t pos = 0;
+					m_statements.erase(static_cast<unsigned int>(get_int(body, pos, 4)));
+					break; // 没有响应
+				}
+				case com_stmt_reset:
+				{
+					size_t pos = 0;
+					const auto it = m_statements.find(static_cast<unsigned int>(get_int(body, pos, 4)));
+					if (it == m_statements.end())
+					{
+						this->send_error(1243, "HY000", "Unknown prepared statement handler given to mysqld_stmt_reset");
+					}
+					else
+					{
+						it->second.long_data.clear();
+						this->send_ok(0, 0, status_autocommit);
+					}
+					break;
+				}
+				case com_reset_connection:
+					m_statements.clear();
+					this->send_ok(0, 0, status_autocommit);
+					break;
+				case com_init_db:
+				case com_ping:
+					this->send_ok(0, 0, status_autocommit);
+					break;
+				case com_set_option:
+					this->send_eof(status_autocommit);
+					break;
+				default:
+					this->send_error(1047, "08S01", "Unknown command");
+					break;
+				}
+				return true;
+			}
+
+			//*********************************************************
+			// 函数名称 : on_query
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 处理 COM_QUERY, 多条SQL语句依次响应, 遇到错误时停止
+			// 访问方式 : private
+			// 函数参数 : const std::string & text SQL语句
+			//*********************************************************
+			void on_query(const std::string &text)
+			{
+				const auto statements = split_statements(text);
+				for (size_t i = 0; i < statements.size(); ++i)
+				{
+					const auto result = this->handle(statements[i]);
+					const auto status = status_autocommit | (i + 1 < statements.size() ? status_more_results : 0);
+					this->send_result(result, false, status);
+					if (result.error_code != 0)
+					{
+						break;
+					}
+				}
+			}
+
+			//*********************************************************
+			// 函数名称 : on_prepare
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 处理 COM_STMT_PREPARE; 结果集的列通过把问号替换为 NULL 后调用处理函数得到,
+			//            这次调用不计入处理过的SQL语句数量
+			// 访问方式 : private
+			// 函数参数 : const std::string & text 带问号的SQL语句
+			//*********************************************************
+			void on_prepare(const std::string &text)
+			{
+				statement prepared;
+				prepared.text = text;
+				prepared.param_count = 0;
+
+				std::string probe;
+				size_t last = 0;
+				for_each_placeholder(text, [&](size_t pos)
+				{
+					probe.append(text, last, pos - last).append("NULL");
+					last = pos + 1;
+					++prepared.param_count;
+				});
+				probe.append(text, last, std::string::npos);
+
+				const auto result = this->call(probe);
+				if (result.error_code != 0)
+				{
+					this->send_error(result.error_code, result.sqlstate, result.message);
+					return;
+				}
+
+				const auto id = m_next_statement++;
+				std::string packet;
+				put_int(packet, 0, 1);
+				put_int(packet, id, 4);
+				put_int(packet, result.columns.size(), 2);
+				put_int(packet, prepared.param_count, 2);
+				put_int(packet, 0, 1);
+				put_int(packet, 0, 2);
+				this->write_packet(packet);
+
+				if (prepared.param_count != 0)
+				{
+					const mock_column param = { "?", MYSQL_TYPE_VAR_STRING };
+					for (size_t i = 0; i < prepared.param_count; ++i)
+					{
+						this->send_column(param);
+					}
+					this->send_eof(status_autocommit);
+				}
+
+				if (!result.columns.empty())
+				{
+					for (const auto &column : result.columns)
+					{
+						this->send_column(column);
+					}
+					this->send_eof(status_autocommit);
+				}
+
+				m_statements[id] = std::move(prepared);
+			}
+
+			//*********************************************************
+			// 函数名称 : on_execute
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 处理 COM_STMT_EXECUTE, 把参数替换到SQL语句中后调用处理函数, 以二进制结果集响应
+			// 访问方式 : private
+			// 函数参数 : const std::string & body 命令数据
+			// 异    常 : 如果数据包格式错误则抛出 std::runtime_error 异常
+			//*********************************************************
+			void on_execute(const std::string &body)
+			{
+				size_t pos = 0;
+				const auto id = static_cast<unsigned int>(get_int(body, pos, 4));
+				const auto it = m_statements.find(id);
+				if (it == m_statements.end())
+				{
+					this->send_error(1243, "HY000", "Unknown prepared statement handler given to mysqld_stmt_execute");
+					return;
+				}
+
+				auto &prepared = it->second;
+				get_int(body, pos, 1); // flags
+				get_int(body, pos, 4); // iteration count
+
+				std::vector<std::string> values(prepared.param_count);
+				if (prepared.param_count != 0)
+				{
+					const auto bitmap_pos = pos;
+					pos += (prepared.param_count + 7) / 8;
+					if (get_int(body, pos, 1) != 0)
+					{
+						prepared.types.resize(prepared.param_count);
+						for (auto &type : prepared.types)
+						{
+							type = static_cast<unsigned int>(get_int(body, pos, 2));
+						}
+					}
+					prepared.types.resize(prepared.param_count, MYSQL_TYPE_NULL);
+
+					for (size_t i = 0; i < prepared.param_count; ++i)
+					{
+						const auto long_data = prepared.long_data.find(static_cast<unsigned int>(i));
+						if ((static_cast<unsigned char>(body[bitmap_pos + i / 8]) >> (i % 8)) & 1)
+						{
+							values[i] = "NULL";
+						}
+						else if (long_data != prepared.long_data.end())
+						{
+							values[i] = quote(long_data->second);
+						}
+						else
+						{
+							values[i] = get_binary_param(body, pos, prepared.types[i]);
+						}
+					}
+					prepared.long_data.clear();
+				}
+
+				std::string text;
+				size_t last = 0, n = 0;
+				for_each_placeholder(prepared.text, [&](size_t position)
+				{
+					text.append(prepared.text, last, position - last).append(values[n++]);
+					last = position + 1;
+				});
+				text.append(prepared.text, last, std::string::npos);
+
+				this->send_result(this->handle(text), true, status_autocommit);
+			}
+
+			//*********************************************************
+			// 函数名称 : call
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 调用处理函数, 处理函数抛出的异常转换为错误响应
+			// 访问方式 : private
+			// 函数参数 : const std::string & text SQL语句
+			// 返 回 值 : mock_result 响应
+			//*********************************************************
+			mock_result call(const std::string &text)
+			{
+				try
+				{
+					return m_server.m_handler(text);
+				}
+				catch (const std::exception &e)
+				{
+					return mock_result::error(1105, "HY000", e.what());
+				}
+			}
+
+			//*********************************************************
+			// 函数名称 : handle
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 调用处理函数并计入处理过的SQL语句数量
+			// 访问方式 : private
+			// 函数参数 : const std::string & text SQL语句
+			// 返 回 值 : mock_result 响应
+			//*********************************************************
+			mock_result handle(const std::string &text)
+			{
+				++m_server.m_queries;
+				return this->call(text);
+			}
+
+			//*********************************************************
+			// 函数名称 : send_result
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 发送响应: 错误包, OK 包或者结果集
+			// 访问方式 : private
+			// 函数参数 : const mock_result & result 响应
+			// 函数参数 : bool binary true 代表二进制结果集, false 代表文本结果集
+			// 函数参数 : unsigned int status 服务器状态
+			// 异    常 : 如果响应要求断开连接则抛出 std::runtime_error 异常, 由 run 关闭连接
+			//*********************************************************
+			void send_result(const mock_result &result, bool binary, unsigned int status)
+			{
+				if (result.drop_connection)
+				{
+					throw std::runtime_error("disconnect");
+				}
+
+				if (result.error_code != 0)
+				{
+					this->send_error(result.error_code, result.sqlstate, result.message);
+					return;
+				}
+
+				if (result.columns.empty())
+				{
+					this->send_ok(result.affected_rows, result.insert_id, status);
+					return;
+				}
+
+				std::string packet;
+				put_lenenc(packet, result.columns.size());
+				this->write_packet(packet);
+				for (const auto &column : result.columns)
+				{
+					this->send_column(column);
+				}
+				this->send_eof(status);
+
+				if (result.generator)
+				{
+					std::vector<mock_cell> row;
+					for (unsigned long long i = 0; i < result.generated_rows; ++i)
+					{
+						row.assign(result.columns.size(), mock_cell());
+						result.generator(i, row);
+						this->send_row(result.columns, row, binary);
+					}
+				}
+				else
+				{
+					for (const auto &row : result.data)
+					{
+						this->send_row(result.columns, row, binary);
+					}
+				}
+				this->send_eof(status);
+			}
+
+			//*********************************************************
+			// 函数名称 : send_row
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 发送结果集中的一行, 缺少的值按 NULL 发送
+			// 访问方式 : private
+			// 函数参数 : const std::vector<mock_column> & columns 列
+			// 函数参数 : const std::vector<mock_cell> & row 行
+			// 函数参数 : bool binary true 代表二进制编码, false 代表文本编码
+			//*********************************************************
+			void send_row(const std::vector<mock_column> &columns, const std::vector<mock_cell> &row, bool binary)
+			{
+				m_row.clear();
+				if (!binary)
+				{
+					for (size_t i = 0; i < columns.size(); ++i)
+					{
+						if (i >= row.size() || row[i].null)
+						{
+							m_row.push_back(static_cast<char>(0xfb));
+						}
+						else
+						{
+							put_lenenc_string(m_row, row[i].text);
+						}
+					}
+					this->write_packet(m_row);
+					return;
+				}
+
+				// 二进制行: 0x00, NULL 位图 (偏移 2 位), 非 NULL 的值
+				m_row.push_back('\0');
+				const auto bitmap_pos = m_row.size();
+				m_row.append((columns.size() + 9) / 8, '\0');
+				for (size_t i = 0; i < columns.size(); ++i)
+				{
+					if (i >= row.size() || row[i].null)
+					{
+						m_row[bitmap_pos + (i + 2) / 8] |= static_cast<char>(1 << ((i + 2) % 8));
+					}
+					else
+					{
+						put_binary_value(m_row, columns[i].type, row[i].text);
+					}
+				}
+				this->write_packet(m_row);
+			}
+
+			//*********************************************************
+			// 函数名称 : send_column
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 发送列定义 (Protocol::ColumnDefinition41)
+			// 访问方式 : private
+			// 函数参数 : const mock_column & column 列
+			//*********************************************************
+			void send_column(const mock_column &column)
+			{
+				const bool numeric = is_numeric(column.type);
+				std::string packet;
+				put_lenenc_string(packet, "def");
+				put_lenenc_string(packet, "mock");
+				put_lenenc_string(packet, "mock");
+				put_lenenc_string(packet, "mock");
+				put_lenenc_string(packet, column.name);
+				put_lenenc_string(packet, column.name);
+				put_lenenc(packet, 0x0c);
+				put_int(packet, numeric ? charset_binary : charset_utf8, 2);
+				put_int(packet, numeric ? 20 : 65535, 4);
+				put_int(packet, column.type, 1);
+				put_int(packet, numeric ? 0x8000 : 0, 2); // NUM_FLAG
+				put_int(packet, numeric && column.type != MYSQL_TYPE_FLOAT && column.type != MYSQL_TYPE_DOUBLE ? 0 : 31, 1);
+				put_int(packet, 0, 2);
+				this->write_packet(packet);
+			}
+
+			//*********************************************************
+			// 函数名称 : send_ok
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 发送 OK 包
+			// 访问方式 : private
+			// 函数参数 : unsigned long long affected_rows 影响的行数
+			// 函数参数 : unsigned long long insert_id 最后插入的自增ID
+			// 函数参数 : unsigned int status 服务器状态
+			//*********************************************************
+			void send_ok(unsigned long long affected_rows, unsigned long long insert_id, unsigned int status)
+			{
+				std::string packet;
+				put_int(packet, 0, 1);
+				put_lenenc(packet, affected_rows);
+				put_lenenc(packet, insert_id);
+				put_int(packet, status, 2);
+				put_int(packet, 0, 2);
+				this->write_packet(packet);
+			}
+
+			//*********************************************************
+			// 函数名称 : send_eof
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 发送 EOF 包
+			// 访问方式 : private
+			// 函数参数 : unsigned int status 服务器状态
+			//*********************************************************
+			void send_eof(unsigned int status)
+			{
+				std::string packet;
+				put_int(packet, 0xfe, 1);
+				put_int(packet, 0, 2);
+				put_int(packet, status, 2);
+				this->write_packet(packet);
+			}
+
+			//*********************************************************
+			// 函数名称 : send_error
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 发送错误包
+			// 访问方式 : private
+			// 函数参数 : unsigned int code 错误代号
+			// 函数参数 : const std::string & sqlstate SQLSTATE, 不足 5 个字符时用 HY000
+			// 函数参数 : const std::string & message 错误信息
+			//*********************************************************
+			void send_error(unsigned int code, const std::string &sqlstate, const std::string &message)
+			{
+				std::string packet;
+				put_int(packet, 0xff, 1);
+				put_int(packet, code, 2);
+				packet.push_back('#');
+				packet.append(sqlstate.size() == 5 ? sqlstate : std::string("HY000"));
+				packet.append(message);
+				this->write_packet(packet);
+			}
+
+			//*********************************************************
+			// 函数名称 : read_packet
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 读取一个完整的数据包 (合并超过 16MB 被拆分的数据包), 记录下一个序号
+			// 访问方式 : private
+			// 函数参数 : std::string & packet 数据包内容
+			// 返 回 值 : bool false 代表客户端已经断开
+			//*********************************************************
+			bool read_packet(std::string &packet)
+			{
+				packet.clear();
+				size_t size = 0;
+				do
+				{
+					unsigned char header[4] = { 0 };
+					if (!this->read_exact(reinterpret_cast<char *>(header), sizeof(header)))
+					{
+						return false;
+					}
+
+					size = header[0] | (header[1] << 8) | (header[2] << 16);
+					m_sequence = static_cast<unsigned char>(header[3] + 1);
+
+					const auto offset = packet.size();
+					packet.resize(offset + size);
+					if (size != 0 && !this->read_exact(&packet[offset], size))
+					{
+						return false;
+					}
+				} while (size == max_payload);
+				return true;
+			}
+
+			//*********************************************************
+			// 函数名称 : read_exact
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 读取指定数量的字节
+			// 访问方式 : private
+			// 函数参数 : char * buffer 缓冲区
+			// 函数参数 : size_t size 字节数
+			// 返 回 值 : bool false 代表客户端已经断开
+			//*********************************************************
+			bool read_exact(char *buffer, size_t size)
+			{
+				while (size != 0)
+				{
+					const auto count = ::recv(m_socket, buffer, size, 0);
+					if (count <= 0)
+					{
+						return false;
+					}
+					buffer += count;
+					size -= static_cast<size_t>(count);
+				}
+				return true;
+			}
+
+			//*********************************************************
+			// 函数名称 : write_packet
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 把数据包写入输出缓冲区, 超过 16MB 时拆分
+			// 访问方式 : private
+			// 函数参数 : const std::string & packet 数据包内容
+			// 异    常 : 如果发送失败则抛出 std::runtime_error 异常
+			//*********************************************************
+			void write_packet(const std::string &packet)
+			{
+				size_t offset = 0;
+				do
+				{
+					const auto size = std::min(packet.size() - offset, max_payload);
+					put_int(m_output, size, 3);
+					put_int(m_output, m_sequence++, 1);
+					m_output.append(packet, offset, size);
+					offset += size;
+
+					// 长度正好是 16MB 的数据包后面需要一个空的数据包
+					if (size == max_payload && offset == packet.size())
+					{
+						put_int(m_output, 0, 3);
+						put_int(m_output, m_sequence++, 1);
+					}
+				} while (offset < packet.size());
+
+				if (m_output.size() >= flush_size)
+				{
+					this->flush();
+				}
+			}
+
+			//*********************************************************
+			// 函数名称 : flush
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 发送输出缓冲区, 设置了带宽时按带宽分块发送
+			// 访问方式 : private
+			// 异    常 : 如果发送失败则抛出 std::runtime_error 异常
+			//*********************************************************
+			void flush(void)
+			{
+				const auto bandwidth = m_server.m_bandwidth.load(std::memory_order_relaxed);
+				const auto chunk = bandwidth == 0 ? m_output.size() : std::min<size_t>(m_output.size(), 16 * 1024);
+
+				size_t offset = 0;
+				while (offset < m_output.size())
+				{
+					const auto begin = std::chrono::steady_clock::now();
+					const auto size = std::min(chunk, m_output.size() - offset);
+					size_t sent = 0;
+					while (sent < size)
+					{
+						const auto count = ::send(m_socket, m_output.data() + offset + sent, size - sent, MSG_NOSIGNAL);
+						if (count <= 0)
+						{
+							throw std::runtime_error("client closed");
+						}
+						sent += static_cast<size_t>(count);
+					}
+					offset += size;
+
+					if (bandwidth != 0)
+					{
+						const auto cost = std::chrono::microseconds(size * 1000000ULL / bandwidth);
+						std::this_thread::sleep_until(begin + cost);
+					}
+				}
+				m_output.clear();
+			}
+
+			//*********************************************************
+			// 函数名称 : wait
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 响应前等待设置的延迟
+			// 访问方式 : private
+			//*********************************************************
+			void wait(void) const
+			{
+				const auto latency = m_server.m_latency.load(std::memory_order_relaxed);
+				if (latency > 0)
+				{
+					std::this_thread::sleep_for(std::chrono::microseconds(latency));
+				}
+			}
+
+		private:
+			mock_server &m_server; // 所属的服务器
+			int m_socket; // 客户端套接字
+			unsigned int m_id; // 连接ID
+			unsigned char m_sequence; // 下一个数据包的序号
+			unsigned int m_next_statement; // 下一个预处理语句ID
+			std::map<unsigned int, statement> m_statements; // 预处理语句
+			std::string m_output; // 输出缓冲区
+			std::string m_row; // 编码一行的缓冲区, 重复使用
+			std::atomic<bool> m_finished; // 客户端是否已经断开
+			std::thread m_thread; // 处理命令的线程
+		};
+
+
+		//*********************************************************
+		// 函数名称 : mock_cell
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 构造 NULL 值
+		//*********************************************************
+		mock_cell::mock_cell(void)
+			: null(true)
+		{
+		}
+
+
+		//*********************************************************
+		// 函数名称 : mock_cell
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 构造文本值
+		// 函数参数 : std::string value 文本形式的值
+		//*********************************************************
+		mock_cell::mock_cell(std::string value)
+			: null(false)
+			, text(std::move(value))
+		{
+		}
+
+
+		//*********************************************************
+		// 函数名称 : mock_cell
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 构造文本值
+		// 函数参数 : const char * value 文本形式的值
+		//*********************************************************
+		mock_cell::mock_cell(const char *value)
+			: null(false)
+			, text(value)
+		{
+		}
+
+
+		//*********************************************************
+		// 函数名称 : mock_result
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 构造 OK 响应, 影响的行数为 0
+		//*********************************************************
+		mock_result::mock_result(void)
+			: generated_rows(0)
+			, affected_rows(0)
+			, insert_id(0)
+			, error_code(0)
+			, drop_connection(false)
+		{
+		}
+
+
+		//*********************************************************
+		// 函数名称 : ok
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 构造 OK 响应
+		// 函数参数 : unsigned long long affected_rows 影响的行数
+		// 函数参数 : unsigned long long insert_id 最后插入的自增ID
+		// 返 回 值 : mock_result 响应
+		//*********************************************************
+		mock_result mock_result::ok(unsigned long long affected_rows, unsigned long long insert_id)
+		{
+			mock_result result;
+			result.affected_rows = affected_rows;
+			result.insert_id = insert_id;
+			return result;
+		}
+
+
+		//*********************************************************
+		// 函数名称 : error
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 构造错误响应
+		// 函数参数 : unsigned int code 错误代号
+		// 函数参数 : std::string sqlstate SQLSTATE
+		// 函数参数 : std::string message 错误信息
+		// 返 回 值 : mock_result 响应
+		//*********************************************************
+		mock_result mock_result::error(unsigned int code, std::string sqlstate, std::string message)
+		{
+			mock_result result;
+			result.error_code = code;
+			result.sqlstate = std::move(sqlstate);
+			result.message = std::move(message);
+			return result;
+		}
+
+
+		//*********************************************************
+		// 函数名称 : rows
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 构造结果集响应, 所有列的类型为 MYSQL_TYPE_VAR_STRING
+		// 函数参数 : const std::vector<std::string> & names 列名
+		// 函数参数 : std::vector<std::vector<mock_cell>> data 所有行
+		// 返 回 值 : mock_result 响应
+		//*********************************************************
+		mock_result mock_result::rows(const std::vector<std::string> &names, std::vector<std::vector<mock_cell>> data)
+		{
+			mock_result result;
+			for (const auto &name : names)
+			{
+				result.columns.push_back({ name, MYSQL_TYPE_VAR_STRING });
+			}
+			result.data = std::move(data);
+			return result;
+		}
+
+
+		//*********************************************************
+		// 函数名称 : generated
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 构造由生成函数逐行产生的结果集响应, 不需要一次保存所有行
+		// 函数参数 : std::vector<mock_column> columns 列
+		// 函数参数 : unsigned long long count 行数
+		// 函数参数 : std::function<void(unsigned long long, std::vector<mock_cell>&)> generator 生成第 n 行
+		// 返 回 值 : mock_result 响应
+		//*********************************************************
+		mock_result mock_result::generated(std::vector<mock_column> columns, unsigned long long count,
+			std::function<void(unsigned long long, std::vector<mock_cell> &)> generator)
+		{
+			mock_result result;
+			result.columns = std::move(columns);
+			result.generated_rows = count;
+			result.generator = std::move(generator);
+			return result;
+		}
+
+
+		//*********************************************************
+		// 函数名称 : disconnect
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 构造断开连接的响应
+		// 返 回 值 : mock_result 响应
+		//*********************************************************
+		mock_result mock_result::disconnect(void)
+		{
+			mock_result result;
+			result.drop_connection = true;
+			return result;
+		}
+
+
+		//*********************************************************
+		// 函数名称 : mock_server
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 构造函数, 开始监听
+		// 函数参数 : mock_handler handler 处理SQL语句的函数
+		// 异    常 : 如果监听失败则抛出 std::runtime_error 异常
+		//*********************************************************
+		mock_server::mock_server(mock_handler handler)
+			: m_handler(std::move(handler))
+			, m_listener(::socket(AF_INET, SOCK_STREAM, 0))
+			, m_port(0)
+			, m_latency(0)
+			, m_bandwidth(0)
+			, m_queries(0)
+			, m_next_id(1)
+			, m_stop(false)
+		{
+			if (m_listener < 0)
+			{
+				throw std::runtime_error("mock_server: socket failed");
+			}
+
+			const int reuse = 1;
+			::setsockopt(m_listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+			sockaddr_in address;
+			std::memset(&address, 0, sizeof(address));
+			address.sin_family = AF_INET;
+			address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+			address.sin_port = 0;
+			socklen_t size = sizeof(address);
+			if (::bind(m_listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0
+				|| ::listen(m_listener, 128) != 0
+				|| ::getsockname(m_listener, reinterpret_cast<sockaddr *>(&address), &size) != 0)
+			{
+				::close(m_listener);
+				throw std::runtime_error("mock_server: listen failed");
+			}
+
+			m_port = ntohs(address.sin_port);
+			m_thread = std::thread([this]() { this->accept_loop(); });
+		}
+
+
+		//*********************************************************
+		// 函数名称 : ~mock_server
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 停止监听, 关闭所有客户端连接并等待线程结束
+		//*********************************************************
+		mock_server::~mock_server(void) noexcept
+		{
+			m_stop = true;
+			if (m_thread.joinable())
+			{
+				m_thread.join();
+			}
+			::close(m_listener);
+
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_sessions.clear();
+		}
+
+
+		//*********************************************************
+		// 函数名称 : port
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 获取监听的端口
+		// 返 回 值 : unsigned int 端口
+		//*********************************************************
+		unsigned int mock_server::port(void) const noexcept
+		{
+			return m_port;
+		}
+
+
+		//*********************************************************
+		// 函数名称 : set_latency
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 设置每个命令响应前的延迟, 模拟网络往返和服务器执行时间
+		// 函数参数 : std::chrono::microseconds latency 延迟
+		//*********************************************************
+		void mock_server::set_latency(std::chrono::microseconds latency) noexcept
+		{
+			m_latency = static_cast<long long>(latency.count());
+		}
+
+
+		//*********************************************************
+		// 函数名称 : set_bandwidth
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 设置每个连接发送数据的带宽
+		// 函数参数 : unsigned long long bytes_per_second 每秒字节数, 0 代表不限制
+		//*********************************************************
+		void mock_server::set_bandwidth(unsigned long long bytes_per_second) noexcept
+		{
+			m_bandwidth = bytes_per_second;
+		}
+
+
+		//*********************************************************
+		// 函数名称 : queries
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 获取处理过的SQL语句数量 (包括预处理语句的执行)
+		// 返 回 值 : unsigned long long 数量
+		//*********************************************************
+		unsigned long long mock_server::queries(void) const noexcept
+		{
+			return m_queries.load();
+		}
+
+
+		//*********************************************************
+		// 函数名称 : accept_loop
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 监听线程, 为每个客户端连接创建线程; 每 100 毫秒检查一次是否停止
+		//*********************************************************
+		void mock_server::accept_loop(void) noexcept
+		try
+		{
+			while (!m_stop)
+			{
+				pollfd listener = { m_listener, POLLIN, 0 };
+				if (::poll(&listener, 1, 100) <= 0)
+				{
+					continue;
+				}
+
+				const auto client = ::accept(m_listener, nullptr, nullptr);
+				if (client < 0)
+				{
+					continue;
+				}
+
+				const int nodelay = 1;
+				::setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_sessions.remove_if([](const std::shared_ptr<session> &s) { return s->finished(); });
+				m_sessions.push_back(std::make_shared<session>(*this, client, m_next_id++));
+			}
+		}
+		catch (const std::exception &)
+		{
+		}
+	}
+}
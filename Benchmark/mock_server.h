@@ -0,0 +1,264 @@
+﻿//*********************************************************
+// 文件名称 : mock_server.h
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 文件说明 : 在本机回环地址上模拟 MariaDB 服务器, 用于不需要真实数据库的性能测试;
+//            支持握手 (接受任意用户和密码)、COM_QUERY 文本结果集、COM_STMT_* 二进制结果集、
+//            多语句、错误包, 以及可配置的延迟和带宽; 只支持 POSIX 套接字
+//*********************************************************
+#ifndef __SQL_MARIADB_MOCK_SERVER_H__
+#define __SQL_MARIADB_MOCK_SERVER_H__
+
+#include <mysql/mysql.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sql
+{
+	namespace mariadb
+	{
+		// 模拟结果集中的一个值
+		struct mock_cell
+		{
+			//*********************************************************
+			// 函数名称 : mock_cell
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造 NULL 值
+			//*********************************************************
+			mock_cell(void);
+
+			//*********************************************************
+			// 函数名称 : mock_cell
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造文本值
+			// 函数参数 : std::string value 文本形式的值
+			//*********************************************************
+			mock_cell(std::string value);
+
+			//*********************************************************
+			// 函数名称 : mock_cell
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造文本值
+			// 函数参数 : const char * value 文本形式的值
+			//*********************************************************
+			mock_cell(const char *value);
+
+			bool null; // 是否 NULL
+			std::string text; // 文本形式的值
+		};
+
+		// 模拟结果集中的一列
+		struct mock_column
+		{
+			std::string name; // 列名
+			enum_field_types type; // 类型, 二进制结果集按该类型编码
+		};
+
+		// 模拟服务器对一条SQL语句的响应: 结果集, OK 或者错误
+		struct mock_result
+		{
+			//*********************************************************
+			// 函数名称 : mock_result
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造 OK 响应, 影响的行数为 0
+			//*********************************************************
+			mock_result(void);
+
+			//*********************************************************
+			// 函数名称 : ok
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造 OK 响应
+			// 函数参数 : unsigned long long affected_rows 影响的行数
+			// 函数参数 : unsigned long long insert_id 最后插入的自增ID
+			// 返 回 值 : mock_result 响应
+			//*********************************************************
+			static mock_result ok(unsigned long long affected_rows, unsigned long long insert_id = 0);
+
+			//*********************************************************
+			// 函数名称 : error
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造错误响应
+			// 函数参数 : unsigned int code 错误代号
+			// 函数参数 : std::string sqlstate SQLSTATE
+			// 函数参数 : std::string message 错误信息
+			// 返 回 值 : mock_result 响应
+			//*********************************************************
+			static mock_result error(unsigned int code, std::string sqlstate, std::string message);
+
+			//*********************************************************
+			// 函数名称 : rows
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造结果集响应, 所有列的类型为 MYSQL_TYPE_VAR_STRING
+			// 函数参数 : const std::vector<std::string> & names 列名
+			// 函数参数 : std::vector<std::vector<mock_cell>> data 所有行
+			// 返 回 值 : mock_result 响应
+			//*********************************************************
+			static mock_result rows(const std::vector<std::string> &names, std::vector<std::vector<mock_cell>> data);
+
+			//*********************************************************
+			// 函数名称 : generated
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造由生成函数逐行产生的结果集响应, 不需要一次保存所有行
+			// 函数参数 : std::vector<mock_column> columns 列
+			// 函数参数 : unsigned long long count 行数
+			// 函数参数 : std::function<void(unsigned long long, std::vector<mock_cell>&)> generator
+			//            生成第 n 行, 写入第二个参数 (已经调整为列数)
+			// 返 回 值 : mock_result 响应
+			//*********************************************************
+			static mock_result generated(std::vector<mock_column> columns, unsigned long long count,
+				std::function<void(unsigned long long, std::vector<mock_cell> &)> generator);
+
+			//*********************************************************
+			// 函数名称 : disconnect
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造断开连接的响应: 不发送任何数据, 直接关闭该客户端连接,
+			//            模拟服务器重启或者网络中断, 客户端会得到 CR_SERVER_LOST
+			// 返 回 值 : mock_result 响应
+			//*********************************************************
+			static mock_result disconnect(void);
+
+			std::vector<mock_column> columns; // 列, 为空时代表 OK 或者错误
+			std::vector<std::vector<mock_cell>> data; // 所有行, 没有 generator 时使用
+			unsigned long long generated_rows; // generator 产生的行数
+			std::function<void(unsigned long long, std::vector<mock_cell> &)> generator; // 逐行生成
+			unsigned long long affected_rows; // OK 响应的影响的行数
+			unsigned long long insert_id; // OK 响应的最后插入的自增ID
+			unsigned int error_code; // 错误代号, 0 代表不是错误
+			std::string sqlstate; // 错误的 SQLSTATE
+			std::string message; // 错误信息
+			bool drop_connection; // 是否断开连接而不响应
+		};
+
+		// 处理一条SQL语句; 预处理语句执行时参数已经替换到语句中 (字符串用单引号引用)
+		// 可能在多个线程中同时调用
+		typedef std::function<mock_result(const std::string &query)> mock_handler;
+
+		// 模拟 MariaDB 服务器类
+		// 在 127.0.0.1 的随机端口上监听, 每个客户端连接使用一个线程, 例子如下:
+		//     sql::mariadb::mock_server server([](const std::string &query)
+		//     {
+		//         return sql::mariadb::mock_result::rows({ "id" }, { { "1" }, { "2" } });
+		//     });
+		//     sql::mariadb::connection connector;
+		//     connector.open("user", "password", "test", server.port(), "127.0.0.1");
+		class mock_server
+		{
+		public:
+
+			//*********************************************************
+			// 函数名称 : mock_server
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数, 开始监听
+			// 函数参数 : mock_handler handler 处理SQL语句的函数
+			// 异    常 : 如果监听失败则抛出 std::runtime_error 异常
+			//*********************************************************
+			explicit mock_server(mock_handler handler);
+
+			//*********************************************************
+			// 函数名称 : ~mock_server
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 停止监听, 关闭所有客户端连接并等待线程结束
+			//*********************************************************
+			~mock_server(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : port
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取监听的端口
+			// 返 回 值 : unsigned int 端口
+			//*********************************************************
+			unsigned int port(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : set_latency
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置每个命令响应前的延迟, 模拟网络往返和服务器执行时间
+			// 函数参数 : std::chrono::microseconds latency 延迟
+			//*********************************************************
+			void set_latency(std::chrono::microseconds latency) noexcept;
+
+			//*********************************************************
+			// 函数名称 : set_bandwidth
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置每个连接发送数据的带宽
+			// 函数参数 : unsigned long long bytes_per_second 每秒字节数, 0 代表不限制
+			//*********************************************************
+			void set_bandwidth(unsigned long long bytes_per_second) noexcept;
+
+			//*********************************************************
+			// 函数名称 : queries
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取处理过的SQL语句数量 (包括预处理语句的执行)
+			// 返 回 值 : unsigned long long 数量
+			//*********************************************************
+			unsigned long long queries(void) const noexcept;
+
+		private:
+			class session; // 一个客户端连接
+
+			//*********************************************************
+			// 函数名称 : mock_server
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 函数参数 : const mock_server &
+			//*********************************************************
+			mock_server(const mock_server &) = delete;
+
+			//*********************************************************
+			// 函数名称 : operator=
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 函数参数 : const mock_server &
+			// 返 回 值 : mock_server &
+			//*********************************************************
+			mock_server & operator=(const mock_server &) = delete;
+
+			//*********************************************************
+			// 函数名称 : accept_loop
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 监听线程, 为每个客户端连接创建线程
+			//*********************************************************
+			void accept_loop(void) noexcept;
+
+		private:
+			mock_handler m_handler; // 处理SQL语句的函数
+			int m_listener; // 监听的套接字
+			unsigned int m_port; // 监听的端口
+			std::atomic<long long> m_latency; // 响应前的延迟 (微秒)
+			std::atomic<unsigned long long> m_bandwidth; // 每个连接的带宽 (字节/秒)
+			std::atomic<unsigned long long> m_queries; // 处理过的SQL语句数量
+			std::atomic<unsigned int> m_next_id; // 下一个连接ID
+			std::atomic<bool> m_stop; // 是否停止
+			std::mutex m_mutex; // 保护 m_sessions
+			std::list<std::shared_ptr<session>> m_sessions; // 所有客户端连接
+			std::thread m_thread; // 监听线程
+		};
+	}
+}
+
+#endif // __SQL_MARIADB_MOCK_SERVER_H__
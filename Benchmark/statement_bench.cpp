@@ -0,0 +1,320 @@
+﻿//*********************************************************
+// 文件名称 : statement_bench.cpp
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 文件说明 : 测量生成SQL语句和读取结果集的热点路径, 不需要数据库服务器, 只使用公开的接口:
+//            生成SQL语句使用没有连接的数据库句柄, 发送SQL语句在客户端立即失败;
+//            读取结果集通过本机的模拟服务器 (mock_server), 不依赖客户端库的内部结构;
+//            使用方法:
+//            statement_bench [最短测量时间 (毫秒)] [--json]
+//            --json 时每个测试输出一行 JSON, 供 bench_compare 读取;
+//            编译时定义 SQL_MARIADB_ALLOC_STATS 宏时同时输出每次的分配次数和字节数
+//*********************************************************
+
+#include "../LibMariaDbConnectivity/mariadb.h"
+#include "mock_server.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+	std::chrono::milliseconds min_time(200); // 每个测试最短的测量时间
+	volatile size_t sink = 0; // 保存测试结果, 防止编译器优化掉被测代码
+	bool json_output = false; // 是否以 JSON 格式输出
+
+
+	//*********************************************************
+	// 函数名称 : respond
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 模拟服务器的处理函数: "select row" 返回一行各种类型的值,
+	//            "select <n>" 返回 n 行 (int, varchar, double), 其他语句返回影响 0 行
+	// 函数参数 : const std::string & query SQL语句
+	// 返 回 值 : sql::mariadb::mock_result 响应
+	//*********************************************************
+	sql::mariadb::mock_result respond(const std::string &query)
+	{
+		if (query == "select row")
+		{
+			return sql::mariadb::mock_result::rows({ "i", "ll", "d", "b", "s", "blob", "c", "us" },
+			{
+				{ "123456", "1234567890123", "3.14159", "1", "abcdefghijklmnopqrstuvwxyz012345", std::string(256, 'x'), "x", "65535" }
+			});
+		}
+
+		if (query.compare(0, 7, "select ") != 0)
+		{
+			return sql::mariadb::mock_result::ok(0);
+		}
+
+		const auto count = std::strtoull(query.c_str() + 7, nullptr, 10);
+		std::vector<sql::mariadb::mock_column> columns =
+		{
+			{ "id", MYSQL_TYPE_LONG },
+			{ "name", MYSQL_TYPE_VAR_STRING },
+			{ "score", MYSQL_TYPE_DOUBLE }
+		};
+		return sql::mariadb::mock_result::generated(std::move(columns), count,
+			[](unsigned long long n, std::vector<sql::mariadb::mock_cell> &row)
+		{
+			row[0] = std::to_string(n);
+			row[1] = "customer_" + std::to_string(n * 7 % 1000);
+			row[2] = std::to_string((double)n * 0.25);
+		});
+	}
+
+
+	//*********************************************************
+	// 函数名称 : run
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 重复执行 function, 直到测量时间超过 min_time, 然后输出每次的耗时;
+	//            启用 SQL_MARIADB_ALLOC_STATS 时另外执行最多 1000 次, 输出每次的分配次数和字节数
+	// 函数参数 : const char * name 测试名称
+	// 函数参数 : Function function 被测代码, 返回值保存到 sink
+	//*********************************************************
+	template <typename Function>
+	void run(const char *name, Function function)
+	{
+		sink = sink + function(); // 预热
+
+		unsigned long long iterations = 1;
+		while (true)
+		{
+			const auto begin = std::chrono::steady_clock::now();
+			for (unsigned long long i = 0; i < iterations; ++i)
+			{
+				sink = sink + function();
+			}
+			const auto elapsed = std::chrono::steady_clock::now() - begin;
+
+			if (elapsed >= min_time || iterations >= (1ULL << 32))
+			{
+				const auto nanoseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+				const auto ns_per_op = nanoseconds / (double)iterations;
+				if (!sql::mariadb::alloc_scope::enabled())
+				{
+					if (json_output)
+					{
+						std::printf("{\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.2f}\n", name, iterations, ns_per_op);
+					}
+					else
+					{
+						std::printf("%-40s %14llu %12.1f\n", name, iterations, ns_per_op);
+					}
+					std::fflush(stdout);
+					return;
+				}
+
+				// 分配统计单独执行, 不影响计时
+				const auto samples = std::min(iterations, 1000ULL);
+				sql::mariadb::alloc_scope scope;
+				for (unsigned long long i = 0; i < samples; ++i)
+				{
+					sink = sink + function();
+				}
+				const auto allocs_per_op = (double)scope.allocations() / (double)samples;
+				const auto bytes_per_op = (double)scope.bytes() / (double)samples;
+
+				if (json_output)
+				{
+					std::printf("{\"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.2f, \"allocs_per_op\": %.2f, \"bytes_per_op\": %.1f}\n",
+						name, iterations, ns_per_op, allocs_per_op, bytes_per_op);
+				}
+				else
+				{
+					std::printf("%-40s %14llu %12.1f %12.2f %12.1f\n", name, iterations, ns_per_op, allocs_per_op, bytes_per_op);
+				}
+				std::fflush(stdout);
+				return;
+			}
+
+			iterations *= 2;
+		}
+	}
+
+
+	//*********************************************************
+	// 函数名称 : bench_building
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 测量生成SQL语句
+	// 函数参数 : const sql::mariadb::connection & connector 没有连接的数据库句柄
+	//*********************************************************
+	void bench_building(const sql::mariadb::connection &connector)
+	{
+		const std::string name(32, 'n');
+		const std::vector<char> blob(256, '\'');
+
+		// execute(void) 生成SQL语句后发送, 句柄没有连接, 发送在客户端立即失败
+		run("command::execute(void)", [&]()
+		{
+			sql::mariadb::command executer(connector, "insert into t values(?, ?, ?, ?)");
+			executer.add(0, 123456);
+			executer.add(1, name);
+			executer.add(2, 3.25);
+			executer.add(3, blob);
+			return (size_t)executer.execute();
+		});
+
+		// execute(text, tuple) 同样在生成SQL语句后立即失败, 主要测量 statement<Tuple>::generate
+		const sql::mariadb::command executer(connector);
+		const auto values = std::make_tuple(123456, name, 3.25, blob);
+		run("command::execute(text, tuple)", [&]()
+		{
+			return (size_t)executer.execute("insert into t values(?, ?, ?, ?)", values);
+		});
+
+		const std::string small(16, 'a');
+		const std::string medium(256, 'a');
+		std::string large(4096, 'a');
+		for (size_t i = 0; i < large.size(); i += 16)
+		{
+			large[i] = '\'';
+		}
+
+		run("escape_buffer_with_quote 16B", [&]()
+		{
+			return executer.escape_buffer_with_quote(small.data(), (unsigned long)small.size()).size();
+		});
+		run("escape_buffer_with_quote 256B", [&]()
+		{
+			return executer.escape_buffer_with_quote(medium.data(), (unsigned long)medium.size()).size();
+		});
+		run("escape_buffer_with_quote 4KB quoted", [&]()
+		{
+			return executer.escape_buffer_with_quote(large.data(), (unsigned long)large.size()).size();
+		});
+	}
+
+
+	//*********************************************************
+	// 函数名称 : bench_getters
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 测量 recordset::get_* 读取一个值, 结果集只在开始时从模拟服务器读取一次
+	// 函数参数 : const sql::mariadb::connection & connector 已经连接模拟服务器的数据库连接
+	//*********************************************************
+	void bench_getters(const sql::mariadb::connection &connector)
+	{
+		auto reader = sql::mariadb::command(connector).execute_reader("select row");
+		if (!reader.read())
+		{
+			std::fprintf(stderr, "mock server returned no row\n");
+			return;
+		}
+
+		run("recordset::get_char", [&]() { return (size_t)reader.get_char(6); });
+		run("recordset::get_uchar", [&]() { return (size_t)reader.get_uchar(6); });
+		run("recordset::get_wchar", [&]() { return (size_t)reader.get_wchar(4); });
+		run("recordset::get_bool", [&]() { return (size_t)reader.get_bool(3); });
+		run("recordset::get_short", [&]() { return (size_t)reader.get_short(7); });
+		run("recordset::get_ushort", [&]() { return (size_t)reader.get_ushort(7); });
+		run("recordset::get_int", [&]() { return (size_t)reader.get_int(0); });
+		run("recordset::get_uint", [&]() { return (size_t)reader.get_uint(0); });
+		run("recordset::get_long", [&]() { return (size_t)reader.get_long(0); });
+		run("recordset::get_ulong", [&]() { return (size_t)reader.get_ulong(0); });
+		run("recordset::get_longlong", [&]() { return (size_t)reader.get_longlong(1); });
+		run("recordset::get_ulonglong", [&]() { return (size_t)reader.get_ulonglong(1); });
+		run("recordset::get_float", [&]() { return (size_t)reader.get_float(2); });
+		run("recordset::get_double", [&]() { return (size_t)reader.get_double(2); });
+		run("recordset::get_raw", [&]() { return (size_t)*reader.get_raw(4); });
+		run("recordset::get_string 32B", [&]() { return reader.get_string(4).size(); });
+		run("recordset::get_string_ptr 32B", [&]() { return reader.get_string_ptr(4)->size(); });
+		run("recordset::get_wstring 32B", [&]() { return reader.get_wstring(4).size(); });
+		run("recordset::get_wstring_ptr 32B", [&]() { return reader.get_wstring_ptr(4)->size(); });
+		run("recordset::get_data 256B", [&]() { return reader.get_data(5).size(); });
+		run("recordset::get_data_ptr 256B", [&]() { return reader.get_data_ptr(5)->size(); });
+		run("recordset::get_udata 256B", [&]() { return reader.get_udata(5).size(); });
+		run("recordset::get_udata_ptr 256B", [&]() { return reader.get_udata_ptr(5)->size(); });
+	}
+
+
+	//*********************************************************
+	// 函数名称 : bench_decoding
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 测量把整个结果集转换成 std::vector 和 std::list; 模拟服务器没有延迟,
+	//            耗时主要是协议解码和 vector_from_recordset/list_from_recordset 的转换
+	// 函数参数 : const sql::mariadb::connection & connector 已经连接模拟服务器的数据库连接
+	//*********************************************************
+	void bench_decoding(const sql::mariadb::connection &connector)
+	{
+		typedef std::tuple<int, std::string, double> row;
+		const sql::mariadb::command executer(connector);
+
+		run("query_vector 1000 rows", [&]()
+		{
+			return executer.query_vector<row>("select 1000").size();
+		});
+		run("query_list 1000 rows", [&]()
+		{
+			return executer.query_list<row>("select 1000").size();
+		});
+	}
+}
+
+
+int main(int argc, char *argv[])
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--json") == 0)
+		{
+			json_output = true;
+		}
+		else
+		{
+			min_time = std::chrono::milliseconds(std::strtoul(argv[i], nullptr, 10));
+		}
+	}
+
+	try
+	{
+		// 不连接数据库, 只用于生成SQL语句和转义字符串
+		sql::mariadb::connection connector;
+		if (connector == nullptr)
+		{
+			std::fprintf(stderr, "mysql_init failed\n");
+			return 1;
+		}
+
+		// 读取结果集通过模拟服务器, 只使用公开的接口
+		sql::mariadb::mock_server server(respond);
+		sql::mariadb::connection reader;
+		if (!reader.open("bench", "bench", "bench", server.port(), "127.0.0.1"))
+		{
+			std::fprintf(stderr, "connect failed: %s\n", reader.error().c_str());
+			return 1;
+		}
+
+		if (!json_output)
+		{
+			if (sql::mariadb::alloc_scope::enabled())
+			{
+				std::printf("%-40s %14s %12s %12s %12s\n", "benchmark", "iterations", "ns/op", "allocs/op", "B/op");
+			}
+			else
+			{
+				std::printf("%-40s %14s %12s\n", "benchmark", "iterations", "ns/op");
+			}
+		}
+		bench_building(connector);
+		bench_getters(reader);
+		bench_decoding(reader);
+	}
+	catch (const std::exception &e)
+	{
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+
+	return 0;
+}
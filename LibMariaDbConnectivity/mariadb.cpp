@@ -11,1538 +11,9364 @@
 // 摘    要 : 用于访问 MySQL/MariaDB 的类库
 //*********************************************************
 #include "mariadb.h"
+#include <mysql/errmsg.h>
+#include <mysql/mysqld_error.h>
 #include <cassert>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <unordered_map>
+#include <random>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 
 // 如果条件是 false 则抛出异常
 #define if_false_throw(condition, message)\
 if (!condition)\
 {\
-	throw mariadb_exception(this->error() + "\r\nSQL: " + message, __FILE__, __LINE__);\
+	throw mariadb_exception(this->error() + "\r\nSQL: " + message, __FILE__, __LINE__, this->errorno(), mysql_sqlstate(m_ptr_mysql));\
+}
+
+// 如果条件是 false 则抛出异常, 执行超时则抛出 timeout_exception 异常
+#define if_false_throw_timeout(condition, message)\
+if (!condition)\
+{\
+	if (m_timed_out)\
+	{\
+		throw timeout_exception(std::string("timeout\r\nSQL: ") + message, __FILE__, __LINE__);\
+	}\
+	throw mariadb_exception(this->error() + "\r\nSQL: " + message, __FILE__, __LINE__, this->errorno(), mysql_sqlstate(m_ptr_mysql));\
 }
 
 
 //*********************************************************
-// 函数名称 : to_date_string
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/12
-// 函数说明 : 将日期转换成符合 MySQL/MariaDB 格式的字符串
-// 访问方式 : public
-// 函数参数 : unsigned int year 年份
-// 函数参数 : unsigned int month 月份
-// 函数参数 : unsigned int day 日期
-// 返 回 值 : std::string 符合 MySQL/MariaDB 格式的日期字符串
-// 异    常 : 如果尝试分配空间失败则抛出 std::bad_alloc 异常
+// 函数名称 : skip_comments
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 跳过SQL语句开头的空白和注释
+// 访问方式 : private
+// 函数参数 : const char * pointer SQL语句开始位置
+// 函数参数 : const char * end SQL语句结束位置
+// 返 回 值 : const char * 第一个不是空白和注释的字符的位置
 //*********************************************************
-std::string sql::mariadb::to_date_string(unsigned int year, unsigned int month, unsigned int day)
+static const char * skip_comments(const char *pointer, const char *end) noexcept
 {
-	const auto y = std::to_string(year);
-	const auto m = std::to_string(month);
-	const auto d = std::to_string(day);
-	return y + "-" + m + "-" + d;
+	while (pointer != end)
+	{
+		if (std::isspace((unsigned char)*pointer))
+		{
+			++pointer;
+		}
+		else if (end - pointer >= 2 && pointer[0] == '/' && pointer[1] == '*')
+		{
+			const char close[] = "*/";
+			pointer = std::search(pointer + 2, end, close, close + 2);
+			pointer = pointer == end ? end : pointer + 2;
+		}
+		else if (*pointer == '#' || (end - pointer >= 2 && pointer[0] == '-' && pointer[1] == '-'))
+		{
+			pointer = std::find(pointer, end, '\n');
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	return pointer;
 }
 
 
 //*********************************************************
-// 函数名称 : to_time_string
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/12
-// 函数说明 : 将时间转换成符合 MySQL/MariaDB 格式的字符串
-// 访问方式 : public
-// 函数参数 : unsigned int hour 时
-// 函数参数 : unsigned int minute 分
-// 函数参数 : unsigned int second 秒
-// 返 回 值 : std::string 符合 MySQL/MariaDB 格式的时间字符串
-// 异    常 : 如果尝试分配空间失败则抛出 std::bad_alloc 异常
+// 函数名称 : is_word_char
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 判断字符能否组成关键字或者标识符
+// 访问方式 : private
+// 函数参数 : char ch 字符
+// 返 回 值 : bool 字母、数字和下划线返回true; 反之返回false
 //*********************************************************
-std::string sql::mariadb::to_time_string(unsigned int hour, unsigned int minute, unsigned int second)
+static bool is_word_char(char ch) noexcept
 {
-	const auto h = std::to_string(hour);
-	const auto m = std::to_string(minute);
-	const auto s = std::to_string(second);
-	return h + "-" + m + "-" + s;
+	return std::isalnum((unsigned char)ch) || ch == '_';
 }
 
 
 //*********************************************************
-// 函数名称 : to_datetime_string
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/12
-// 函数说明 : 将日期时间转换成符合 MySQL/MariaDB 格式的字符串
-// 访问方式 : public
-// 函数参数 : unsigned int year 年
-// 函数参数 : unsigned int month 月
-// 函数参数 : unsigned int day 日
-// 函数参数 : unsigned int hour 时
-// 函数参数 : unsigned int minute 分
-// 函数参数 : unsigned int second 秒
-// 返 回 值 : std::string 符合 MySQL/MariaDB 格式的日期时间字符串
-// 异    常 : 如果尝试分配空间失败则抛出 std::bad_alloc 异常
+// 函数名称 : starts_with_keyword
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 判断字符串是否以关键字开头 (不区分大小写)
+// 访问方式 : private
+// 函数参数 : const char * pointer 字符串开始位置
+// 函数参数 : const char * end 字符串结束位置
+// 函数参数 : const char * keyword 大写的关键字
+// 返 回 值 : bool 如果以关键字开头返回true; 反之返回false
 //*********************************************************
-std::string sql::mariadb::to_datetime_string(unsigned int year, unsigned int month, unsigned int day, unsigned int hour, unsigned int minute, unsigned int second)
+static bool starts_with_keyword(const char *pointer, const char *end, const char *keyword) noexcept
 {
-	const auto d = to_date_string(year, month, day);
-	const auto t = to_time_string(hour, minute, second);
-	return d + " " + t;
+	const auto size = std::strlen(keyword);
+
+	return (size_t)(end - pointer) >= size
+		&& std::equal(keyword, keyword + size, pointer, [](char left, char right) { return left == std::toupper((unsigned char)right); })
+		&& (pointer + size == end || !is_word_char(pointer[size]));
 }
 
 
 //*********************************************************
-// 函数名称 : mariadb_exception
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/12
-// 函数说明 : 构造函数
-// 访问方式 : public
-// 函数参数 : const std::string & text 异常信息
-// 函数参数 : const std::string & file 异常所在文件
-// 函数参数 : int line 异常所在行
-// 异    常 : 如果异常信息长度 (length) 超过字符串
-//            最大长度(max_size) 则抛出 std::length_error 异常;
-//            如果尝试分配空间失败则抛出 std::bad_alloc 异常
+// 函数名称 : contains_keyword
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 判断字符串中是否有关键字 (不区分大小写, 不检查是否在字符串常量中)
+// 访问方式 : private
+// 函数参数 : const char * pointer 字符串开始位置
+// 函数参数 : const char * end 字符串结束位置
+// 函数参数 : const char * keyword 大写的关键字
+// 返 回 值 : bool 如果有关键字返回true; 反之返回false
 //*********************************************************
-sql::mariadb::mariadb_exception::mariadb_exception(const std::string & text, const std::string & file, int line)
-	: m_text(text + "\r\nin " + file + ", row: " + std::to_string(line))
+static bool contains_keyword(const char *pointer, const char *end, const char *keyword) noexcept
 {
+	for (auto current = pointer; current != end; ++current)
+	{
+		if ((current == pointer || !is_word_char(current[-1])) && starts_with_keyword(current, end, keyword))
+		{
+			return true;
+		}
+	}
+
+	return false;
 }
 
 
 //*********************************************************
-// 函数名称 : what
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/12
-// 函数说明 : 输出异常信息
-// 访问方式 : public
-// 返 回 值 : const char * 异常信息字符串
+// 函数名称 : is_plain_read
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 判断SQL语句是否为没有副作用的读语句: 只有一条SQL语句, 以 SELECT, SHOW, DESCRIBE,
+//            DESC, EXPLAIN 开头, 并且不加锁、不写入、不使用与会话相关的函数;
+//            这样的语句可以发送到从服务器, 也可以在重新连接后再执行一次
+// 访问方式 : private
+// 函数参数 : const char * pointer 跳过开头注释后的SQL语句开始位置
+// 函数参数 : const char * end SQL语句结束位置
+// 返 回 值 : bool 如果是没有副作用的读语句返回true; 反之返回false
 //*********************************************************
-const char * sql::mariadb::mariadb_exception::what() const noexcept
+static bool is_plain_read(const char *pointer, const char *end) noexcept
 {
-	return m_text.c_str();
+	// 多条SQL语句中可能有写语句
+	const auto last = std::find_if(std::reverse_iterator<const char *>(end), std::reverse_iterator<const char *>(pointer),
+		[](char ch) { return !std::isspace((unsigned char)ch) && ch != ';'; }).base();
+	if (std::find(pointer, last, ';') != last)
+	{
+		return false;
+	}
+
+	static const char *const reads[] = { "SELECT", "SHOW", "DESCRIBE", "DESC", "EXPLAIN" };
+
+	if (std::none_of(std::begin(reads), std::end(reads), [&](const char *keyword) { return starts_with_keyword(pointer, last, keyword); }))
+	{
+		return false;
+	}
+
+	// 加锁、写入或者结果与会话相关的语句
+	static const char *const writes[] =
+	{
+		"UPDATE", "SHARE", "INTO",
+		"LAST_INSERT_ID", "FOUND_ROWS", "ROW_COUNT",
+		"GET_LOCK", "RELEASE_LOCK", "IS_USED_LOCK", "IS_FREE_LOCK",
+		"NEXTVAL", "SETVAL", "LASTVAL"
+	};
+
+	return std::none_of(std::begin(writes), std::end(writes), [&](const char *keyword) { return contains_keyword(pointer, last, keyword); });
 }
 
 
 //*********************************************************
-// 函数名称 : connection
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 构造函数
-// 访问方式 : public
+// 函数名称 : server_fault
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 判断错误是否由服务器或者网络引起: 客户端库的网络错误和执行超时;
+//            语法错误等由SQL语句本身引起的错误在任何服务器上都一样
+// 访问方式 : private
+// 函数参数 : unsigned int error 错误代号
+// 返 回 值 : bool 如果由服务器或者网络引起返回true; 反之返回false
 //*********************************************************
-sql::mariadb::connection::connection(void) noexcept
-	: m_ptr_mysql(mysql_init(nullptr))
+static bool server_fault(unsigned int error) noexcept
 {
+	return (error >= CR_MIN_ERROR && error <= CR_MAX_ERROR && error != CR_COMMANDS_OUT_OF_SYNC)
+		|| error == ER_STATEMENT_TIMEOUT;
 }
 
 
 //*********************************************************
-// 函数名称 : connection
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 转移构造函数, 转移后原对象不应该使用
-// 访问方式 : public
-// 函数参数 : connection && connector 需要转移的对象
+// 函数名称 : backoff_delay
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 带随机抖动的指数退避, 第 attempt 次等待 [0, min(max_delay, base_delay * 2^attempt)] 毫秒
+// 访问方式 : private
+// 函数参数 : unsigned int base_delay 退避的基础等待时间 (毫秒)
+// 函数参数 : unsigned int max_delay 最长的等待时间 (毫秒)
+// 函数参数 : unsigned int attempt 第几次, 从0开始
+// 返 回 值 : unsigned int 等待时间 (毫秒)
 //*********************************************************
-sql::mariadb::connection::connection(connection && connector) noexcept
-	: m_ptr_mysql(connector.m_ptr_mysql)
+static unsigned int backoff_delay(unsigned int base_delay, unsigned int max_delay, unsigned int attempt) noexcept
 {
-	connector.m_ptr_mysql = nullptr;
+	// 每个线程使用自己的随机数引擎, 不需要加锁
+	static thread_local std::minstd_rand engine(std::random_device{}());
+
+	const auto shift = std::min(attempt, 20U);
+	const auto ceiling = std::min<unsigned long long>(max_delay, (unsigned long long)base_delay << shift);
+	return std::uniform_int_distribution<unsigned int>(0, (unsigned int)ceiling)(engine);
 }
 
 
 //*********************************************************
-// 函数名称 : ~connection
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 如果数据库连接没有关闭则在析构时自动关闭
-// 访问方式 : public
+// 函数名称 : copy_sqlstate
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 复制 SQLSTATE, 最多复制五个字符并以 '\0' 结尾
+// 访问方式 : private
+// 函数参数 : char (&target)[6] 保存 SQLSTATE 的数组
+// 函数参数 : const char * sqlstate SQLSTATE, nullptr 代表 HY000
 //*********************************************************
-sql::mariadb::connection::~connection(void) noexcept
+static void copy_sqlstate(char (&target)[6], const char *sqlstate) noexcept
 {
-	if (m_ptr_mysql != nullptr)
+	const auto source = sqlstate == nullptr ? "HY000" : sqlstate;
+
+	size_t length = 0;
+	while (length < sizeof(target) - 1 && source[length] != '\0')
 	{
-		mysql_close(m_ptr_mysql);
+		++length;
 	}
+
+	std::memcpy(target, source, length);
+	target[length] = '\0';
 }
 
 
 //*********************************************************
-// 函数名称 : operator!=
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 判断数据库连接器是否创建成功
-// 访问方式 : public
-// 函数参数 : std::nullptr_t null 与nullptr作比较
-// 返 回 值 : bool 如果创建成功则 对象 != nullptr;
-//            反之 对象 == nullptr
+// 函数名称 : is_mariadb
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 根据服务器版本字符串判断是否为 MariaDB 服务器
+// 访问方式 : private
+// 函数参数 : MYSQL * ptr_mysql 已经连接的数据库连接
+// 返 回 值 : bool 如果是 MariaDB 服务器返回true; 反之 (包括 MySQL 服务器) 返回false
 //*********************************************************
-bool sql::mariadb::connection::operator!=(std::nullptr_t null) const noexcept
+static bool is_mariadb(MYSQL *ptr_mysql) noexcept
 {
-	return m_ptr_mysql != null;
+	const auto version = mysql_get_server_info(ptr_mysql);
+	return version != nullptr && std::strstr(version, "MariaDB") != nullptr;
 }
 
 
-//*********************************************************
-// 函数名称 : operator==
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 判断数据库连接器是否创建成功
-// 访问方式 : public
-// 函数参数 : std::nullptr_t null  与nullptr作比较
-// 返 回 值 : bool 如果创建成功则 对象 != nullptr;
-//            反之 对象 == nullptr
-//*********************************************************
-bool sql::mariadb::connection::operator==(std::nullptr_t null) const noexcept
+namespace
 {
-	return m_ptr_mysql == null;
-}
+	// 取消SQL语句类
+	// 每个服务器 (地址、端口、socket 和用户相同) 使用一个后台线程和一个保持打开的连接发送 KILL QUERY,
+	// 连接断开后在下一次发送时重新连接; 一个服务器没有响应时不影响发送给其他服务器的 KILL QUERY
+	class query_killer
+	{
+	public:
 
+		//*********************************************************
+		// 函数名称 : instance
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 获取唯一的取消对象
+		// 访问方式 : public
+		// 返 回 值 : query_killer & 取消对象
+		//*********************************************************
+		static query_killer & instance(void) noexcept;
 
-//*********************************************************
-// 函数名称 : open
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 连接数据库
-// 访问方式 : public
-// 函数参数 : const char * user 用户名
-// 函数参数 : const char * password 密码
-// 函数参数 : const char * database 数据库名
-// 函数参数 : unsigned int port 服务器端口
-// 函数参数 : const char * host 服务器 IP 地址
-// 函数参数 : const char * unix_socket 指定需要使用的 socket 或者 命名管道
-// 函数参数 : unsigned long flags 链接选项
-// 返 回 值 : bool true 代表连接成功, false 代表连接失败
-//*********************************************************
-bool sql::mariadb::connection::open(const char * user, const char * password, const char * database, unsigned int port, const char * host, const char * unix_socket, unsigned long flags) const noexcept
-{
-	assert(host != nullptr);
-	assert(user != nullptr);
-	assert(password != nullptr);
+		//*********************************************************
+		// 函数名称 : ~query_killer
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 停止所有后台线程, 还没有发送的 KILL QUERY 不再发送
+		// 访问方式 : public
+		//*********************************************************
+		~query_killer(void) noexcept;
 
-	if (m_ptr_mysql == nullptr)
+		//*********************************************************
+		// 函数名称 : post
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 登记一次 KILL QUERY, 由该服务器的后台线程发送, 不等待发送完
+		// 访问方式 : public
+		// 函数参数 : const sql::mariadb::endpoint & point 服务器参数
+		// 函数参数 : unsigned long thread_id 需要取消的连接的线程ID
+		// 函数参数 : unsigned long long ticket 登记编号, 用于 cancel; 0 代表不会撤销
+		// 异    常 : 如果分配资源或者创建线程失败则抛出 std::exception 异常
+		//*********************************************************
+		void post(const sql::mariadb::endpoint &point, unsigned long thread_id, unsigned long long ticket);
+
+		//*********************************************************
+		// 函数名称 : cancel
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 撤销还没有发送的 KILL QUERY, 不等待; 如果正在发送则记下该连接,
+		//            由该连接执行下一条SQL语句前调用的 settle 等待发送完
+		// 访问方式 : public
+		// 函数参数 : unsigned long long ticket 登记编号
+		// 函数参数 : const void * handle 被取消的数据库连接
+		// 返 回 值 : bool 如果撤销成功 (KILL QUERY 不会发送) 返回true; 反之返回false
+		//*********************************************************
+		bool cancel(unsigned long long ticket, const void *handle) noexcept;
+
+		//*********************************************************
+		// 函数名称 : settle
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 等待发给该连接的 KILL QUERY 发送完, 避免它取消该连接的下一条SQL语句;
+		//            没有正在发送的 KILL QUERY 时不加锁, 立即返回
+		// 访问方式 : public
+		// 函数参数 : const void * handle 即将执行SQL语句的数据库连接
+		//*********************************************************
+		void settle(const void *handle) noexcept;
+
+	private:
+		typedef std::pair<unsigned long long, unsigned long> job_type; // 登记编号和线程ID
+
+		// 发送给同一服务器的 KILL QUERY
+		struct lane
+		{
+			//*********************************************************
+			// 函数名称 : lane
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数, 取消连接使用较短的超时时间
+			// 访问方式 : public
+			// 函数参数 : const sql::mariadb::endpoint & target 服务器参数
+			// 异    常 : 如果尝试分配空间失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			explicit lane(const sql::mariadb::endpoint &target);
+
+			sql::mariadb::endpoint point; // 服务器参数
+			std::unique_ptr<sql::mariadb::connection> killer; // 保持打开的取消连接, 只由后台线程使用
+			std::chrono::steady_clock::time_point retry_after; // 连接失败后在这个时间之前不再尝试连接
+			std::deque<job_type> pending; // 还没有发送的 KILL QUERY
+			unsigned long long sending; // 正在发送的登记编号, 0 代表没有
+			std::condition_variable changed; // 登记或者停止时通知后台线程
+			std::thread thread; // 后台线程
+		};
+
+		//*********************************************************
+		// 函数名称 : query_killer
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 构造函数, 第一次发送给某个服务器时才创建它的后台线程
+		// 访问方式 : private
+		//*********************************************************
+		query_killer(void) noexcept;
+
+		//*********************************************************
+		// 函数名称 : run
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 后台线程, 依次发送登记给一个服务器的 KILL QUERY
+		// 访问方式 : private
+		// 函数参数 : lane * target 服务器
+		//*********************************************************
+		void run(lane *target) noexcept;
+
+		//*********************************************************
+		// 函数名称 : connect
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 打开取消连接; 无法连接时 1 秒内不再尝试, 避免每次都等待连接超时
+		// 访问方式 : private
+		// 函数参数 : lane & target 服务器
+		// 返 回 值 : bool 如果连接成功返回true; 反之返回false
+		//*********************************************************
+		static bool connect(lane &target) noexcept;
+
+		//*********************************************************
+		// 函数名称 : send
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 通过取消连接发送 KILL QUERY; 连接断开时重新连接一次
+		// 访问方式 : private
+		// 函数参数 : lane & target 服务器
+		// 函数参数 : unsigned long thread_id 需要取消的连接的线程ID
+		//*********************************************************
+		static void send(lane &target, unsigned long thread_id) noexcept;
+
+	private:
+		std::list<std::unique_ptr<lane>> m_lanes; // 每个服务器一个
+		std::map<const void *, unsigned long long> m_fences; // 撤销时正在发送 KILL QUERY 的连接和登记编号
+		std::atomic<std::size_t> m_fence_count; // m_fences 的元素个数, settle 不加锁读取
+		bool m_stop; // 是否停止后台线程
+		std::mutex m_mutex; // 保护以上成员和 lane 中除 killer 和 retry_after 以外的成员
+		std::condition_variable m_sent; // KILL QUERY 发送完时通知 settle
+	};
+
+
+	// SQL语句超时监视类
+	// 所有设置了超时时间的 command 共用一个后台线程, 到期时把 KILL QUERY 交给 query_killer 发送,
+	// 后台线程本身不访问网络, 一个服务器没有响应时不影响其他到期时间
+	class deadline_watchdog
 	{
-		return false;
-	}
+	public:
+
+		//*********************************************************
+		// 函数名称 : instance
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 获取唯一的监视对象
+		// 访问方式 : public
+		// 返 回 值 : deadline_watchdog & 监视对象
+		//*********************************************************
+		static deadline_watchdog & instance(void) noexcept;
 
-	bool result = mysql_real_connect(m_ptr_mysql, host, user, password, database, port, unix_socket, flags) != nullptr;
-	mysql_set_character_set(m_ptr_mysql, "utf8");
+		//*********************************************************
+		// 函数名称 : ~deadline_watchdog
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 停止后台线程
+		// 访问方式 : public
+		//*********************************************************
+		~deadline_watchdog(void) noexcept;
 
-	return result;
+		//*********************************************************
+		// 函数名称 : arm
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 登记一条SQL语句, 到期时取消它
+		// 访问方式 : public
+		// 函数参数 : const sql::mariadb::endpoint * point 服务器参数
+		// 函数参数 : unsigned long thread_id 执行SQL语句的连接的线程ID
+		// 函数参数 : std::chrono::steady_clock::time_point deadline 到期时间
+		// 返 回 值 : unsigned long long 登记编号
+		// 异    常 : 如果分配资源或者创建线程失败则抛出 std::exception 异常
+		//*********************************************************
+		unsigned long long arm(const sql::mariadb::endpoint *point, unsigned long thread_id, std::chrono::steady_clock::time_point deadline);
+
+		//*********************************************************
+		// 函数名称 : disarm
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 取消登记, 不等待; 如果已经到期但是 KILL QUERY 还没有发送则撤销,
+		//            正在发送则由 query_killer::settle 在该连接执行下一条SQL语句前等待
+		// 访问方式 : public
+		// 函数参数 : unsigned long long ticket 登记编号
+		// 函数参数 : const void * handle 执行SQL语句的数据库连接
+		// 返 回 值 : bool 如果 KILL QUERY 不会发送返回true; 反之返回false
+		//*********************************************************
+		bool disarm(unsigned long long ticket, const void *handle) noexcept;
+
+	private:
+		typedef std::multimap<std::chrono::steady_clock::time_point, unsigned long long> queue_type;
+
+		// 登记的SQL语句
+		struct item
+		{
+			const sql::mariadb::endpoint *point; // 服务器参数
+			unsigned long thread_id; // 执行SQL语句的连接的线程ID
+			queue_type::iterator position; // 在 m_queue 中的位置
+		};
+
+		//*********************************************************
+		// 函数名称 : deadline_watchdog
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 构造函数, 第一次登记时才创建后台线程
+		// 访问方式 : private
+		//*********************************************************
+		deadline_watchdog(void) noexcept;
+
+		//*********************************************************
+		// 函数名称 : run
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 后台线程, 取消到期的SQL语句
+		// 访问方式 : private
+		//*********************************************************
+		void run(void) noexcept;
+
+	private:
+		queue_type m_queue; // 按到期时间排序的登记编号
+		std::map<unsigned long long, item> m_items; // 登记的SQL语句
+		unsigned long long m_next_ticket; // 下一个登记编号
+		bool m_stop; // 是否停止后台线程
+		std::mutex m_mutex; // 保护以上成员
+		std::condition_variable m_changed; // 登记或者停止时通知后台线程
+		std::thread m_thread; // 后台线程
+	};
 }
 
 
 //*********************************************************
-// 函数名称 : close
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 关闭数据库连接, 如果不关闭数据库连接, 则析构时自动关闭
+// 函数名称 : instance
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取唯一的取消对象
 // 访问方式 : public
+// 返 回 值 : query_killer & 取消对象
 //*********************************************************
-void sql::mariadb::connection::close(void) noexcept
+query_killer & query_killer::instance(void) noexcept
 {
-	if (m_ptr_mysql != nullptr)
-	{
-		mysql_close(m_ptr_mysql);
-		m_ptr_mysql = nullptr;
-	}
+	static query_killer killer;
+	return killer;
 }
 
 
 //*********************************************************
-// 函数名称 : error
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 获取数据库操作失败的错误信息
-// 访问方式 : public
-// 返 回 值 : std::string 错误信息
+// 函数名称 : query_killer
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数, 第一次发送给某个服务器时才创建它的后台线程
+// 访问方式 : private
 //*********************************************************
-std::string sql::mariadb::connection::error(void) const noexcept
-try
-{
-	return std::string(mysql_error(m_ptr_mysql));
-}
-catch (const std::exception &)
+query_killer::query_killer(void) noexcept
+	: m_fence_count(0)
+	, m_stop(false)
 {
-	return std::string();
 }
 
 
 //*********************************************************
-// 函数名称 : errorno
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 获取数据库操作失败的错误代号
+// 函数名称 : ~query_killer
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 停止所有后台线程, 还没有发送的 KILL QUERY 不再发送
 // 访问方式 : public
-// 返 回 值 : unsigned int 错误代号
 //*********************************************************
-unsigned int sql::mariadb::connection::errorno(void) const noexcept
+query_killer::~query_killer(void) noexcept
 {
-	return mysql_errno(m_ptr_mysql);
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+
+		for (const auto &target : m_lanes)
+		{
+			target->changed.notify_all();
+		}
+	}
+
+	for (const auto &target : m_lanes)
+	{
+		if (target->thread.joinable())
+		{
+			target->thread.join();
+		}
+	}
 }
 
 
 //*********************************************************
-// 函数名称 : recordset
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 转移构造函数, 转移后原对象不应该使用
-// 访问方式 : private
-// 函数参数 : recordset && reader 需要转移的对象
+// 函数名称 : lane
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数, 取消连接使用较短的超时时间
+// 访问方式 : public
+// 函数参数 : const sql::mariadb::endpoint & target 服务器参数
+// 异    常 : 如果尝试分配空间失败则抛出 std::bad_alloc 异常
 //*********************************************************
-sql::mariadb::recordset::recordset(recordset && reader) noexcept
-	: m_ptr_mysql(reader.m_ptr_mysql)
-	, m_ptr_res(reader.m_ptr_res)
-	, m_row(reader.m_row)
+query_killer::lane::lane(const sql::mariadb::endpoint &target)
+	: point(target)
+	, sending(0)
 {
-	reader.m_ptr_mysql = nullptr;
-	reader.m_ptr_res = nullptr;
-	reader.m_row = nullptr;
+	point.options().set_connect_timeout(2);
+	point.options().set_read_timeout(2);
+	point.options().set_write_timeout(2);
 }
 
 
 //*********************************************************
-// 函数名称 : ~recordset
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 如果结果集没有释放关闭则在析构时自动关闭
+// 函数名称 : post
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 登记一次 KILL QUERY, 由该服务器的后台线程发送, 不等待发送完
 // 访问方式 : public
+// 函数参数 : const sql::mariadb::endpoint & point 服务器参数
+// 函数参数 : unsigned long thread_id 需要取消的连接的线程ID
+// 函数参数 : unsigned long long ticket 登记编号, 用于 cancel; 0 代表不会撤销
+// 异    常 : 如果分配资源或者创建线程失败则抛出 std::exception 异常
 //*********************************************************
-sql::mariadb::recordset::~recordset(void) noexcept
+void query_killer::post(const sql::mariadb::endpoint &point, unsigned long thread_id, unsigned long long ticket)
 {
-	if (m_ptr_res != nullptr)
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const auto iterator = std::find_if(m_lanes.begin(), m_lanes.end(), [&point](const std::unique_ptr<lane> &target)
 	{
-		mysql_free_result(m_ptr_res);
+		return target->point.port() == point.port() && target->point.host() == point.host()
+			&& target->point.unix_socket() == point.unix_socket() && target->point.user() == point.user();
+	});
+
+	lane *target = nullptr;
+	if (iterator != m_lanes.end())
+	{
+		target = iterator->get();
+	}
+	else
+	{
+		m_lanes.emplace_back(new lane(point));
+		target = m_lanes.back().get();
+
+		try
+		{
+			target->thread = std::thread(&query_killer::run, this, target);
+		}
+		catch (...)
+		{
+			m_lanes.pop_back();
+			throw;
+		}
 	}
+
+	target->pending.emplace_back(ticket, thread_id);
+	target->changed.notify_one();
 }
 
 
 //*********************************************************
-// 函数名称 : operator!=
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 判断数据库连接器是否创建成功
+// 函数名称 : cancel
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 撤销还没有发送的 KILL QUERY, 不等待; 如果正在发送则记下该连接,
+//            由该连接执行下一条SQL语句前调用的 settle 等待发送完
 // 访问方式 : public
-// 函数参数 : std::nullptr_t null 与nullptr作比较
-// 返 回 值 : bool 如果创建成功则 对象 != nullptr;
-//            反之 对象 == nullptr
+// 函数参数 : unsigned long long ticket 登记编号
+// 函数参数 : const void * handle 被取消的数据库连接
+// 返 回 值 : bool 如果撤销成功 (KILL QUERY 不会发送) 返回true; 反之返回false
 //*********************************************************
-bool sql::mariadb::recordset::operator!=(std::nullptr_t null) const noexcept
+bool query_killer::cancel(unsigned long long ticket, const void *handle) noexcept
 {
-	return m_ptr_res != null;
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	for (const auto &target : m_lanes)
+	{
+		auto &pending = target->pending;
+		const auto iterator = std::find_if(pending.begin(), pending.end(), [ticket](const job_type &job) { return job.first == ticket; });
+
+		if (iterator != pending.end())
+		{
+			pending.erase(iterator);
+			return true;
+		}
+	}
+
+	const auto sending = [this, ticket]()
+	{
+		return std::any_of(m_lanes.begin(), m_lanes.end(), [ticket](const std::unique_ptr<lane> &target) { return target->sending == ticket; });
+	};
+
+	if (sending())
+	{
+		try
+		{
+			m_fences[handle] = ticket;
+			m_fence_count.store(m_fences.size(), std::memory_order_relaxed);
+		}
+		catch (const std::exception &)
+		{
+			// 无法记下该连接时只能在这里等待发送完
+			m_sent.wait(lock, [&sending]() { return !sending(); });
+		}
+	}
+
+	return false;
 }
 
 
 //*********************************************************
-// 函数名称 : operator==
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 判断数据库连接器是否创建成功
+// 函数名称 : settle
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 等待发给该连接的 KILL QUERY 发送完, 避免它取消该连接的下一条SQL语句;
+//            没有正在发送的 KILL QUERY 时不加锁, 立即返回
 // 访问方式 : public
-// 函数参数 : std::nullptr_t null  与nullptr作比较
-// 返 回 值 : bool 如果创建成功则 对象 != nullptr;
-//            反之 对象 == nullptr
+// 函数参数 : const void * handle 即将执行SQL语句的数据库连接
 //*********************************************************
-bool sql::mariadb::recordset::operator==(std::nullptr_t null) const noexcept
+void query_killer::settle(const void *handle) noexcept
 {
-	return m_ptr_res == null;
+	// 记下连接的 cancel 和 settle 在同一线程中调用, 不需要更强的内存顺序
+	if (m_fence_count.load(std::memory_order_relaxed) == 0)
+	{
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_sent.wait(lock, [this, handle]() { return m_fences.find(handle) == m_fences.end(); });
 }
 
 
 //*********************************************************
-// 函数名称 : close
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 释放结果集所占用的资源, 如果不手动释放资源, 则析构时自动释放
-// 访问方式 : public
+// 函数名称 : run
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 后台线程, 依次发送登记给一个服务器的 KILL QUERY
+// 访问方式 : private
+// 函数参数 : lane * target 服务器
 //*********************************************************
-void sql::mariadb::recordset::close(void) noexcept
+void query_killer::run(lane *target) noexcept
 {
-	if (m_ptr_res != nullptr)
+	mysql_thread_init();
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (!m_stop)
 	{
-		mysql_free_result(m_ptr_res);
-		m_ptr_res = nullptr;
-		m_ptr_mysql = nullptr;
+		if (target->pending.empty())
+		{
+			target->changed.wait(lock);
+			continue;
+		}
+
+		// 连接期间登记仍然留在 pending 中, cancel 可以直接撤销而不需要等待
+		if (target->killer == nullptr)
+		{
+			lock.unlock();
+			const auto connected = connect(*target);
+			lock.lock();
+
+			if (!connected)
+			{
+				target->pending.clear();
+			}
+
+			continue;
+		}
+
+		const auto job = target->pending.front();
+		target->pending.pop_front();
+		target->sending = job.first;
+
+		// 发送 KILL QUERY 时不持有锁, 其他服务器的后台线程和 cancel 不需要等待
+		lock.unlock();
+		send(*target, job.second);
+		lock.lock();
+
+		target->sending = 0;
+		for (auto iterator = m_fences.begin(); iterator != m_fences.end();)
+		{
+			iterator = iterator->second == job.first ? m_fences.erase(iterator) : std::next(iterator);
+		}
+
+		m_fence_count.store(m_fences.size(), std::memory_order_relaxed);
+		m_sent.notify_all();
 	}
+
+	lock.unlock();
+	target->killer.reset();
+	mysql_thread_end();
 }
 
 
 //*********************************************************
-// 函数名称 : error
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 获取数据库操作失败的错误信息
-// 访问方式 : public
-// 返 回 值 : std::string 错误信息
+// 函数名称 : connect
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 打开取消连接; 无法连接时 1 秒内不再尝试, 避免每次都等待连接超时
+// 访问方式 : private
+// 函数参数 : lane & target 服务器
+// 返 回 值 : bool 如果连接成功返回true; 反之返回false
 //*********************************************************
-std::string sql::mariadb::recordset::error(void) const noexcept
+bool query_killer::connect(lane &target) noexcept
 try
 {
-	return std::string(mysql_error(m_ptr_mysql));
+	const auto now = std::chrono::steady_clock::now();
+	if (now < target.retry_after)
+	{
+		return false;
+	}
+
+	std::unique_ptr<sql::mariadb::connection> killer(new sql::mariadb::connection);
+	if (*killer == nullptr || !killer->open(target.point))
+	{
+		target.retry_after = now + std::chrono::seconds(1);
+		return false;
+	}
+
+	target.killer = std::move(killer);
+	return true;
 }
 catch (const std::exception &)
 {
-	return std::string();
+	return false;
 }
 
 
 //*********************************************************
-// 函数名称 : errorno
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 获取数据库操作失败的错误代号
-// 访问方式 : public
-// 返 回 值 : unsigned int 错误代号
+// 函数名称 : send
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 通过取消连接发送 KILL QUERY; 连接断开时重新连接一次
+// 访问方式 : private
+// 函数参数 : lane & target 服务器
+// 函数参数 : unsigned long thread_id 需要取消的连接的线程ID
 //*********************************************************
-unsigned int sql::mariadb::recordset::errorno(void) const noexcept
+void query_killer::send(lane &target, unsigned long thread_id) noexcept
+try
+{
+	const auto text = "KILL QUERY " + std::to_string(thread_id);
+
+	for (int attempt = 0; attempt < 2; ++attempt)
+	{
+		if (target.killer == nullptr && !connect(target))
+		{
+			return;
+		}
+
+		sql::mariadb::command executer(*target.killer);
+		if (executer.execute(text))
+		{
+			return;
+		}
+
+		// 线程已经结束等服务器返回的错误不需要重新连接
+		const auto code = executer.errorno();
+		if (code < CR_MIN_ERROR || code > CR_MAX_ERROR)
+		{
+			return;
+		}
+
+		target.killer.reset();
+	}
+}
+catch (const std::exception &)
 {
-	return mysql_errno(m_ptr_mysql);
 }
 
 
 //*********************************************************
-// 函数名称 : row_count
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 获取数据的行数
+// 函数名称 : instance
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取唯一的监视对象
 // 访问方式 : public
-// 返 回 值 : unsigned long long 行数
+// 返 回 值 : deadline_watchdog & 监视对象
 //*********************************************************
-unsigned long long sql::mariadb::recordset::row_count(void) const noexcept
+deadline_watchdog & deadline_watchdog::instance(void) noexcept
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	return mysql_num_rows(m_ptr_res);
+	static deadline_watchdog watchdog;
+	return watchdog;
 }
 
 
 //*********************************************************
-// 函数名称 : field_count
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 获取数据的列数(字段数量)
-// 访问方式 : public
-// 返 回 值 : unsigned long 列数(字段数量)
+// 函数名称 : deadline_watchdog
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数, 第一次登记时才创建后台线程
+// 访问方式 : private
 //*********************************************************
-unsigned long sql::mariadb::recordset::field_count(void) const noexcept
+deadline_watchdog::deadline_watchdog(void) noexcept
+	: m_next_ticket(1)
+	, m_stop(false)
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	return mysql_num_fields(m_ptr_res);
+	// 先创建取消对象, 使它在监视对象之后析构
+	query_killer::instance();
 }
 
 
 //*********************************************************
-// 函数名称 : data_size
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 获取单条数据的长度
+// 函数名称 : ~deadline_watchdog
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 停止后台线程
 // 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置; 如果超出数据的列数则可能出现数组越界的问题
-// 返 回 值 : unsigned long 单条数据的字节数
 //*********************************************************
-unsigned long sql::mariadb::recordset::data_size(unsigned long n) const noexcept
+deadline_watchdog::~deadline_watchdog(void) noexcept
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return mysql_fetch_lengths(m_ptr_res)[n];
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+
+	m_changed.notify_all();
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
 }
 
 
 //*********************************************************
-// 函数名称 : read
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 读取下一条数据
+// 函数名称 : arm
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 登记一条SQL语句, 到期时取消它
 // 访问方式 : public
-// 返 回 值 : bool 成功返回true, 失败返回false
+// 函数参数 : const sql::mariadb::endpoint * point 服务器参数
+// 函数参数 : unsigned long thread_id 执行SQL语句的连接的线程ID
+// 函数参数 : std::chrono::steady_clock::time_point deadline 到期时间
+// 返 回 值 : unsigned long long 登记编号
+// 异    常 : 如果分配资源或者创建线程失败则抛出 std::exception 异常
 //*********************************************************
-bool sql::mariadb::recordset::read(void) noexcept
+unsigned long long deadline_watchdog::arm(const sql::mariadb::endpoint *point, unsigned long thread_id, std::chrono::steady_clock::time_point deadline)
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	m_row = mysql_fetch_row(m_ptr_res);
-	return m_row != nullptr;
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (!m_thread.joinable())
+	{
+		m_thread = std::thread(&deadline_watchdog::run, this);
+	}
+
+	const auto ticket = m_next_ticket++;
+	const auto position = m_queue.emplace(deadline, ticket);
+
+	try
+	{
+		m_items.emplace(ticket, item{ point, thread_id, position });
+	}
+	catch (...)
+	{
+		m_queue.erase(position);
+		throw;
+	}
+
+	// 只有新的到期时间最早时才需要唤醒后台线程
+	if (position == m_queue.begin())
+	{
+		m_changed.notify_one();
+	}
+
+	return ticket;
 }
 
 
 //*********************************************************
-// 函数名称 : get_char
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 获取数据, 并将数据强制转换成 char 类型
+// 函数名称 : disarm
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 取消登记, 不等待; 如果已经到期但是 KILL QUERY 还没有发送则撤销,
+//            正在发送则由 query_killer::settle 在该连接执行下一条SQL语句前等待
 // 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置
-// 返 回 值 : char 数据
+// 函数参数 : unsigned long long ticket 登记编号
+// 函数参数 : const void * handle 执行SQL语句的数据库连接
+// 返 回 值 : bool 如果 KILL QUERY 不会发送返回true; 反之返回false
 //*********************************************************
-char sql::mariadb::recordset::get_char(unsigned long n) const
+bool deadline_watchdog::disarm(unsigned long long ticket, const void *handle) noexcept
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(m_row != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return m_row[n][0];
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		const auto iterator = m_items.find(ticket);
+
+		if (iterator != m_items.end())
+		{
+			m_queue.erase(iterator->second.position);
+			m_items.erase(iterator);
+			return true;
+		}
+	}
+
+	// 已经到期的登记在 run 中持有锁时交给了 query_killer
+	return query_killer::instance().cancel(ticket, handle);
 }
 
 
 //*********************************************************
-// 函数名称 : get_udata
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 获取数据, 并将数据用 std::vector<unsigned char> 对象保存
-// 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置
-// 返 回 值 : std::vector<unsigned char> 数据
-// 异    常 : 如果 std::vector 创建失败时抛出异常
+// 函数名称 : run
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 后台线程, 取消到期的SQL语句
+// 访问方式 : private
 //*********************************************************
-std::vector<unsigned char> sql::mariadb::recordset::get_udata(unsigned long n) const
+void deadline_watchdog::run(void) noexcept
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(m_row != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return std::vector<unsigned char>(m_row[n], m_row[n] + this->data_size(n));
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (!m_stop)
+	{
+		if (m_queue.empty())
+		{
+			m_changed.wait(lock);
+			continue;
+		}
+
+		const auto first = m_queue.begin();
+		if (std::chrono::steady_clock::now() < first->first)
+		{
+			m_changed.wait_until(lock, first->first);
+			continue;
+		}
+
+		const auto ticket = first->second;
+		const auto iterator = m_items.find(ticket);
+		const auto point = iterator->second.point;
+		const auto thread_id = iterator->second.thread_id;
+		m_items.erase(iterator);
+		m_queue.erase(first);
+
+		// 只登记不发送, 不会因为某个服务器没有响应而推迟其他到期时间
+		try
+		{
+			query_killer::instance().post(*point, thread_id, ticket);
+		}
+		catch (const std::exception &)
+		{
+		}
+	}
 }
 
 
 //*********************************************************
-// 函数名称 : get_udata_ptr
+// 函数名称 : to_date_string
 // 作    者 : Gooeen
-// 完成日期 : 2016/05/09
-// 函数说明 : 获取数据, 并将数据用 std::vector<unsigned char> 对象保存
+// 完成日期 : 2015/09/12
+// 函数说明 : 将日期转换成符合 MySQL/MariaDB 格式的字符串
 // 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置
-// 返 回 值 : std::shared_ptr<std::vector<unsigned char>> 数据
-// 异    常 : 如果 std::vector 创建失败时抛出异常
+// 函数参数 : unsigned int year 年份
+// 函数参数 : unsigned int month 月份
+// 函数参数 : unsigned int day 日期
+// 返 回 值 : std::string 符合 MySQL/MariaDB 格式的日期字符串
+// 异    常 : 如果尝试分配空间失败则抛出 std::bad_alloc 异常
 //*********************************************************
-std::shared_ptr<std::vector<unsigned char>> sql::mariadb::recordset::get_udata_ptr(unsigned long n) const
+std::string sql::mariadb::to_date_string(unsigned int year, unsigned int month, unsigned int day)
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(m_row != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return std::make_shared<std::vector<unsigned char>>(m_row[n], m_row[n] + this->data_size(n));
+	const auto y = std::to_string(year);
+	const auto m = std::to_string(month);
+	const auto d = std::to_string(day);
+	return y + "-" + m + "-" + d;
 }
 
 
 //*********************************************************
-// 函数名称 : get_data
+// 函数名称 : to_time_string
 // 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 获取数据, 并将数据用 std::vector<char> 对象保存
+// 完成日期 : 2015/09/12
+// 函数说明 : 将时间转换成符合 MySQL/MariaDB 格式的字符串
 // 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置
-// 返 回 值 : std::vector<char> 数据
-// 异    常 : 如果 std::vector 创建失败时抛出异常
+// 函数参数 : unsigned int hour 时
+// 函数参数 : unsigned int minute 分
+// 函数参数 : unsigned int second 秒
+// 返 回 值 : std::string 符合 MySQL/MariaDB 格式的时间字符串
+// 异    常 : 如果尝试分配空间失败则抛出 std::bad_alloc 异常
 //*********************************************************
-std::vector<char> sql::mariadb::recordset::get_data(unsigned long n) const
+std::string sql::mariadb::to_time_string(unsigned int hour, unsigned int minute, unsigned int second)
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(m_row != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return std::vector<char>(m_row[n], m_row[n] + this->data_size(n));
+	const auto h = std::to_string(hour);
+	const auto m = std::to_string(minute);
+	const auto s = std::to_string(second);
+	return h + "-" + m + "-" + s;
 }
 
 
 //*********************************************************
-// 函数名称 : get_data_ptr
+// 函数名称 : to_datetime_string
 // 作    者 : Gooeen
-// 完成日期 : 2016/05/09
-// 函数说明 : 获取数据, 并将数据用 std::vector<char> 对象保存
+// 完成日期 : 2015/09/12
+// 函数说明 : 将日期时间转换成符合 MySQL/MariaDB 格式的字符串
 // 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置
-// 返 回 值 : std::shared_ptr<std::vector<char>> 数据
-// 异    常 : 如果 std::vector 创建失败时抛出异常
+// 函数参数 : unsigned int year 年
+// 函数参数 : unsigned int month 月
+// 函数参数 : unsigned int day 日
+// 函数参数 : unsigned int hour 时
+// 函数参数 : unsigned int minute 分
+// 函数参数 : unsigned int second 秒
+// 返 回 值 : std::string 符合 MySQL/MariaDB 格式的日期时间字符串
+// 异    常 : 如果尝试分配空间失败则抛出 std::bad_alloc 异常
 //*********************************************************
-std::shared_ptr<std::vector<char>> sql::mariadb::recordset::get_data_ptr(unsigned long n) const
+std::string sql::mariadb::to_datetime_string(unsigned int year, unsigned int month, unsigned int day, unsigned int hour, unsigned int minute, unsigned int second)
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(m_row != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return std::make_shared<std::vector<char>>(m_row[n], m_row[n] + this->data_size(n));
+	const auto d = to_date_string(year, month, day);
+	const auto t = to_time_string(hour, minute, second);
+	return d + " " + t;
 }
 
 
 //*********************************************************
-// 函数名称 : get_double
+// 函数名称 : mariadb_exception
 // 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 获取数据, 并将数据转换成 double 类型
+// 完成日期 : 2015/09/12
+// 函数说明 : 构造函数
 // 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置
-// 返 回 值 : double 数据
+// 函数参数 : const std::string & text 异常信息
+// 函数参数 : const std::string & file 异常所在文件
+// 函数参数 : int line 异常所在行
+// 异    常 : 如果异常信息长度 (length) 超过字符串
+//            最大长度(max_size) 则抛出 std::length_error 异常;
+//            如果尝试分配空间失败则抛出 std::bad_alloc 异常
 //*********************************************************
-double sql::mariadb::recordset::get_double(unsigned long n) const
+sql::mariadb::mariadb_exception::mariadb_exception(const std::string & text, const std::string & file, int line)
+	: mariadb_exception(text, file, line, 0, "HY000")
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(m_row != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return std::atof(m_row[n]);
 }
 
 
 //*********************************************************
-// 函数名称 : get_float
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 获取数据, 并将数据转换成 float 类型
+// 函数名称 : mariadb_exception
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数
 // 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置
-// 返 回 值 : float 数据
+// 函数参数 : const std::string & text 异常信息
+// 函数参数 : const std::string & file 异常所在文件
+// 函数参数 : int line 异常所在行
+// 函数参数 : unsigned int code 服务器或者客户端库的错误代号
+// 函数参数 : const char * sqlstate 五个字符的 SQLSTATE
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
 //*********************************************************
-float sql::mariadb::recordset::get_float(unsigned long n) const
+sql::mariadb::mariadb_exception::mariadb_exception(const std::string & text, const std::string & file, int line, unsigned int code, const char * sqlstate)
+	: m_text(text + "\r\nin " + file + ", row: " + std::to_string(line))
+	, m_code(code)
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(m_row != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return (float)std::atof(m_row[n]);
+	copy_sqlstate(m_sqlstate, sqlstate);
 }
 
 
 //*********************************************************
-// 函数名称 : get_int
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 获取数据, 并将数据转换成 int 类型
+// 函数名称 : code
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取错误代号, 例如 1213 (ER_LOCK_DEADLOCK)
 // 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置
-// 返 回 值 : int 数据
+// 返 回 值 : unsigned int 错误代号; 不是数据库操作失败时为 0
 //*********************************************************
-int sql::mariadb::recordset::get_int(unsigned long n) const
+unsigned int sql::mariadb::mariadb_exception::code(void) const noexcept
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(m_row != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return std::atoi(m_row[n]);
+	return m_code;
 }
 
 
 //*********************************************************
-// 函数名称 : get_long
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 获取数据, 并将数据转换成 long 类型
+// 函数名称 : sqlstate
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取 SQLSTATE, 例如 40001 (序列化失败)
 // 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置
-// 返 回 值 : long 数据
+// 返 回 值 : const char * SQLSTATE; 不是数据库操作失败时为 HY000
 //*********************************************************
-long sql::mariadb::recordset::get_long(unsigned long n) const
+const char * sql::mariadb::mariadb_exception::sqlstate(void) const noexcept
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(m_row != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return std::atol(m_row[n]);
+	return m_sqlstate;
 }
 
 
 //*********************************************************
-// 函数名称 : get_longlong
+// 函数名称 : what
 // 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 获取数据, 并将数据转换成 long long 类型
+// 完成日期 : 2015/09/12
+// 函数说明 : 输出异常信息
 // 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置
-// 返 回 值 : long long 数据
+// 返 回 值 : const char * 异常信息字符串
 //*********************************************************
-long long sql::mariadb::recordset::get_longlong(unsigned long n) const
+const char * sql::mariadb::mariadb_exception::what() const noexcept
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(m_row != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return std::atoll(m_row[n]);
+	return m_text.c_str();
 }
 
 
 //*********************************************************
-// 函数名称 : get_short
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 获取数据, 并将数据转换成 short 类型
+// 函数名称 : timeout_exception
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数, 错误代号为 ER_STATEMENT_TIMEOUT, SQLSTATE 为 70100
 // 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置
-// 返 回 值 : short 数据
+// 函数参数 : const std::string & text 异常信息
+// 函数参数 : const std::string & file 异常所在文件
+// 函数参数 : int line 异常所在行
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
 //*********************************************************
-short sql::mariadb::recordset::get_short(unsigned long n) const
+sql::mariadb::timeout_exception::timeout_exception(const std::string & text, const std::string & file, int line)
+	: mariadb_exception(text, file, line, ER_STATEMENT_TIMEOUT, "70100")
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(m_row != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return (short)std::atoi(m_row[n]);
 }
 
 
 //*********************************************************
-// 函数名称 : get_string
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 获取数据
+// 函数名称 : error_info
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数, 没有错误
 // 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置
-// 返 回 值 : std::string 数据
-// 异    常 : 如果数据长度 (length) 超过字符串最大长度(max_size)
-//            则抛出 std::length_error 异常;
-//            如果尝试分配空间失败则抛出 std::bad_alloc 异常
 //*********************************************************
-std::string sql::mariadb::recordset::get_string(unsigned long n) const
+sql::mariadb::error_info::error_info(void) noexcept
+	: error_info(0, "00000", "")
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(m_row != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return std::string(m_row[n]);
 }
 
 
 //*********************************************************
-// 函数名称 : get_string_ptr
-// 作    者 : Gooeen
-// 完成日期 : 2016/05/09
-// 函数说明 : 获取数据
+// 函数名称 : error_info
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数
 // 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置
-// 返 回 值 : std::shared_ptr<std::string> 数据
-// 异    常 : 如果数据长度 (length) 超过字符串最大长度(max_size)
-//            则抛出 std::length_error 异常;
-//            如果分配资源失败则抛出 std::bad_alloc 异常
+// 函数参数 : unsigned int code 错误代号
+// 函数参数 : const char * sqlstate 五个字符的 SQLSTATE
+// 函数参数 : const char * text 错误信息, 如果分配空间失败则为空字符串
 //*********************************************************
-std::shared_ptr<std::string> sql::mariadb::recordset::get_string_ptr(unsigned long n) const
+sql::mariadb::error_info::error_info(unsigned int code, const char * sqlstate, const char * text) noexcept
+	: m_code(code)
+	, m_ptr_text(share_text(text))
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(m_row != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return std::make_shared<std::string>(m_row[n]);
+	copy_sqlstate(m_sqlstate, sqlstate);
 }
 
 
 //*********************************************************
-// 函数名称 : get_uchar
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 获取数据, 并将数据强制转换成 unsigned char 类型
+// 函数名称 : error_info
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数, 从异常中获取错误信息
 // 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置
-// 返 回 值 : unsigned char 数据
+// 函数参数 : const std::exception & exception 异常, mariadb_exception 异常带有错误代号
 //*********************************************************
-unsigned char sql::mariadb::recordset::get_uchar(unsigned long n) const
+sql::mariadb::error_info::error_info(const std::exception & exception) noexcept
+	: error_info(0, "HY000", exception.what())
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(m_row != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return (unsigned char)m_row[n][0];
+	const auto error = dynamic_cast<const mariadb_exception *>(&exception);
+
+	if (error != nullptr)
+	{
+		m_code = error->code();
+		copy_sqlstate(m_sqlstate, error->sqlstate());
+	}
 }
 
 
 //*********************************************************
-// 函数名称 : get_uint
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/13
-// 函数说明 : 获取数据, 并将数据转换成 unsigned int 类型
+// 函数名称 : no_data
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取 "没有数据" 的错误信息, SQLSTATE 为 02000
 // 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置
-// 返 回 值 : unsigned int 数据
-// 异    常 : 如果强制转换失败, 则抛出 std::invalid_argument 异常;
-//            如果数据值大于 unsigned int 的取值范围, 则抛出 std::out_of_range 异常
+// 返 回 值 : error_info 错误信息
 //*********************************************************
-unsigned int sql::mariadb::recordset::get_uint(unsigned long n) const
+sql::mariadb::error_info sql::mariadb::error_info::no_data(void) noexcept
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(m_row != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return (unsigned int)std::stoul(m_row[n]);
+	// 没有数据很常见, 所有对象共享同一个错误信息
+	static const auto text = share_text("no data");
+
+	error_info error(0, "02000", nullptr);
+	error.m_ptr_text = text;
+	return error;
 }
 
 
 //*********************************************************
-// 函数名称 : get_ulong
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/15
-// 函数说明 : 获取数据, 并将数据转换成 unsigned long 类型
+// 函数名称 : code
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取错误代号
 // 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置
-// 返 回 值 : unsigned long 数据
-// 异    常 : 如果强制转换失败, 则抛出 std::invalid_argument 异常;
-//            如果数据值大于 unsigned long 的取值范围, 则抛出 std::out_of_range 异常
+// 返 回 值 : unsigned int 错误代号; 没有数据时为 0
 //*********************************************************
-unsigned long sql::mariadb::recordset::get_ulong(unsigned long n) const
+unsigned int sql::mariadb::error_info::code(void) const noexcept
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(m_row != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return std::stoul(m_row[n]);
+	return m_code;
 }
 
 
 //*********************************************************
-// 函数名称 : get_ulonglong
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/15
-// 函数说明 : 获取数据, 并将数据转换成 unsigned long long 类型
+// 函数名称 : sqlstate
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取 SQLSTATE
 // 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置
-// 返 回 值 : unsigned long long 数据
-// 异    常 : 如果强制转换失败, 则抛出 std::invalid_argument 异常;
-//            如果数据值大于 unsigned long long 的取值范围, 则抛出 std::out_of_range 异常
+// 返 回 值 : const char * SQLSTATE
 //*********************************************************
-unsigned long long sql::mariadb::recordset::get_ulonglong(unsigned long n) const
+const char * sql::mariadb::error_info::sqlstate(void) const noexcept
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(m_row != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return std::stoull(m_row[n]);
+	return m_sqlstate;
 }
 
 
 //*********************************************************
-// 函数名称 : get_ushort
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/15
-// 函数说明 : 获取数据, 并将数据转换成 unsigned short 类型
+// 函数名称 : text
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取客户端库的错误信息
 // 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置
-// 返 回 值 : unsigned short 数据
+// 返 回 值 : const char * 错误信息
 //*********************************************************
-unsigned short sql::mariadb::recordset::get_ushort(unsigned long n) const
+const char * sql::mariadb::error_info::text(void) const noexcept
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(m_row != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return (unsigned short)std::atoi(m_row[n]);
+	return m_ptr_text == nullptr ? "" : m_ptr_text->c_str();
 }
 
 
 //*********************************************************
-// 函数名称 : get_wchar
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/15
-// 函数说明 : 获取数据, 并将数据强制转换成 wchar_t 类型
+// 函数名称 : not_found
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 判断是否因为没有数据而失败
 // 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置
-// 返 回 值 : wchar_t 数据
+// 返 回 值 : bool 如果没有数据返回true; 反之返回false
 //*********************************************************
-wchar_t sql::mariadb::recordset::get_wchar(unsigned long n) const
+bool sql::mariadb::error_info::not_found(void) const noexcept
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(m_row != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return *((wchar_t *)m_row[n]);
+	return std::strcmp(m_sqlstate, "02000") == 0;
 }
 
 
 //*********************************************************
-// 函数名称 : get_wstring
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/15
-// 函数说明 : 获取数据, 并将数据强制转换成 std::wstring 类型
+// 函数名称 : duplicate_key
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 判断是否因为主键或者唯一索引重复而失败 (ER_DUP_ENTRY)
 // 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置
-// 返 回 值 : std::wstring 数据
+// 返 回 值 : bool 如果重复返回true; 反之返回false
 //*********************************************************
-std::wstring sql::mariadb::recordset::get_wstring(unsigned long n) const
+bool sql::mariadb::error_info::duplicate_key(void) const noexcept
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(m_row != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return std::wstring((wchar_t *)m_row[n], mysql_fetch_lengths(m_ptr_res)[n] / 2);
+	return m_code == ER_DUP_ENTRY;
 }
 
 
 //*********************************************************
-// 函数名称 : get_wstring_ptr
-// 作    者 : Gooeen
-// 完成日期 : 2015/05/09
-// 函数说明 : 获取数据, 并将数据强制转换成 std::wstring 类型
+// 函数名称 : message
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 生成完整的错误信息
 // 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置
-// 返 回 值 : std::shared_ptr<std::wstring> 数据
+// 返 回 值 : std::string 错误信息, 格式为 "[错误代号] (SQLSTATE) 错误信息"
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
 //*********************************************************
-std::shared_ptr<std::wstring> sql::mariadb::recordset::get_wstring_ptr(unsigned long n) const
+std::string sql::mariadb::error_info::message(void) const
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(m_row != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return std::make_shared<std::wstring>((wchar_t *)m_row[n], mysql_fetch_lengths(m_ptr_res)[n] / 2);
+	return "[" + std::to_string(m_code) + "] (" + m_sqlstate + ") " + this->text();
 }
 
 
 //*********************************************************
-// 函数名称 : get_raw
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/15
-// 函数说明 : 不进行转换, 直接获取从数据库返回的数据
+// 函数名称 : share_text
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 复制错误信息, 供多个 error_info 共享
+// 访问方式 : private
+// 函数参数 : const char * text 错误信息
+// 返 回 值 : std::shared_ptr<const std::string> 错误信息; 空字符串或者分配空间失败时为 nullptr
+//*********************************************************
+std::shared_ptr<const std::string> sql::mariadb::error_info::share_text(const char * text) noexcept
+try
+{
+	if (text == nullptr || *text == '\0')
+	{
+		return nullptr;
+	}
+
+	return std::make_shared<const std::string>(text);
+}
+catch (const std::exception &)
+{
+	return nullptr;
+}
+
+
+//*********************************************************
+// 函数名称 : connection_options
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数, 默认字符集为 utf8, 其他选项使用客户端库的默认值
 // 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置
-// 返 回 值 : const char * 数据
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
 //*********************************************************
-const char * sql::mariadb::recordset::get_raw(unsigned long n) const
+sql::mariadb::connection_options::connection_options(void)
+	: m_charset("utf8")
+	, m_compress(false)
+	, m_connect_timeout(0)
+	, m_read_timeout(0)
+	, m_write_timeout(0)
+	, m_net_buffer_length(0)
+	, m_max_allowed_packet(0)
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(m_row != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return m_row[n];
 }
 
 
 //*********************************************************
-// 函数名称 : get_bool
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/15
-// 函数说明 : 获取数据, 并将数据强制转换成 bool 类型
+// 函数名称 : latency_histogram
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数, 所有桶为空
 // 访问方式 : public
-// 函数参数 : unsigned long n 数据的列位置
-// 返 回 值 : bool 数据
 //*********************************************************
-bool sql::mariadb::recordset::get_bool(unsigned long n) const
+sql::mariadb::latency_histogram::latency_histogram(void) noexcept
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(m_ptr_res != nullptr);
-	assert(m_row != nullptr);
-	assert(n < mysql_num_fields(m_ptr_res));
-	return (*m_row[n]) - '0' != 0;
+	std::fill(m_counts, m_counts + bucket_count, 0ULL);
 }
 
 
 //*********************************************************
-// 函数名称 : recordset
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/15
-// 函数说明 : 由 command 类对象创建 recordset 类对象
-// 访问方式 : private
-// 函数参数 : MYSQL * pointer 数据库句柄
+// 函数名称 : record
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 记录一个延迟
+// 访问方式 : public
+// 函数参数 : unsigned long long microseconds 延迟 (微秒)
 //*********************************************************
-sql::mariadb::recordset::recordset(MYSQL * pointer) noexcept
-	: m_ptr_mysql(pointer)
-	, m_ptr_res(mysql_store_result(pointer))
-	, m_row(nullptr)
+void sql::mariadb::latency_histogram::record(unsigned long long microseconds) noexcept
 {
+	++m_counts[index(microseconds)];
 }
 
 
 //*********************************************************
-// 函数名称 : command
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/15
-// 函数说明 : 转移构造函数, 转移后原对象不应该使用
+// 函数名称 : merge
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 合并另一个直方图
 // 访问方式 : public
-// 函数参数 : command && executor 需要转移的对象
+// 函数参数 : const latency_histogram & other 另一个直方图
 //*********************************************************
-sql::mariadb::command::command(command && executor) noexcept
-	: m_ptr_mysql(executor.m_ptr_mysql)
-	, m_text(std::move(executor.m_text))
-	, m_strings(std::move(executor.m_strings))
-	, m_datas(std::move(executor.m_datas))
-	, m_udatas(std::move(executor.m_udatas))
-	, m_parameters(std::move(executor.m_parameters))
+void sql::mariadb::latency_histogram::merge(const latency_histogram & other) noexcept
 {
-	executor.m_ptr_mysql = nullptr;
+	for (size_t n = 0; n < bucket_count; ++n)
+	{
+		m_counts[n] += other.m_counts[n];
+	}
 }
 
 
 //*********************************************************
-// 函数名称 : command
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/15
-// 函数说明 : 构造函数
+// 函数名称 : count
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取记录的个数
 // 访问方式 : public
-// 函数参数 : const connection & connector 数据库连接类
+// 返 回 值 : unsigned long long 个数
 //*********************************************************
-sql::mariadb::command::command(const connection & connector) noexcept
-	: m_ptr_mysql(connector.m_ptr_mysql)
+unsigned long long sql::mariadb::latency_histogram::count(void) const noexcept
 {
+	unsigned long long total = 0;
+	for (size_t n = 0; n < bucket_count; ++n)
+	{
+		total += m_counts[n];
+	}
+
+	return total;
 }
 
 
 //*********************************************************
-// 函数名称 : command
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/15
-// 函数说明 : 构造函数
+// 函数名称 : percentile
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取分位数, 例如 percentile(0.99) 为 p99
 // 访问方式 : public
-// 函数参数 : const connection & connector 数据库连接类
-// 函数参数 : const std::string & text SQL语句
-// 异    常 : 如果尝试分配空间失败则抛出 std::bad_alloc 异常
+// 函数参数 : double p 分位, 范围为 [0, 1]
+// 返 回 值 : unsigned long long 分位数所在桶的上限 (微秒); 没有记录时返回 0
+//*********************************************************
+unsigned long long sql::mariadb::latency_histogram::percentile(double p) const noexcept
+{
+	const auto total = this->count();
+	if (total == 0)
+	{
+		return 0;
+	}
+
+	p = std::min(std::max(p, 0.0), 1.0);
+	const auto rank = std::max(1ULL, (unsigned long long)std::ceil(p * (double)total));
+
+	unsigned long long seen = 0;
+	for (size_t n = 0; n < bucket_count; ++n)
+	{
+		seen += m_counts[n];
+		if (seen >= rank)
+		{
+			return upper_bound(n);
+		}
+	}
+
+	return upper_bound(bucket_count - 1);
+}
+
+
+//*********************************************************
+// 函数名称 : index
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取延迟所在的桶
+// 访问方式 : public
+// 函数参数 : unsigned long long microseconds 延迟 (微秒)
+// 返 回 值 : size_t 桶的位置
+//*********************************************************
+size_t sql::mariadb::latency_histogram::index(unsigned long long microseconds) noexcept
+{
+	if (microseconds < 16)
+	{
+		return (size_t)microseconds;
+	}
+
+	if ((microseconds >> 36) != 0)
+	{
+		return bucket_count - 1;
+	}
+
+	// 最高位在第 msb 位, 其后4位决定在该区间中的哪个桶
+	unsigned int msb = 4;
+	while ((microseconds >> (msb + 1)) != 0)
+	{
+		++msb;
+	}
+
+	return 16 + (msb - 4) * 16 + (size_t)((microseconds >> (msb - 4)) & 15);
+}
+
+
+//*********************************************************
+// 函数名称 : upper_bound
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取桶的上限
+// 访问方式 : public
+// 函数参数 : size_t n 桶的位置
+// 返 回 值 : unsigned long long 桶中最大的延迟 (微秒)
+//*********************************************************
+unsigned long long sql::mariadb::latency_histogram::upper_bound(size_t n) noexcept
+{
+	if (n < 16)
+	{
+		return n;
+	}
+
+	const auto shift = (unsigned int)((n - 16) / 16);
+	const auto lower = (unsigned long long)(16 + (n - 16) % 16) << shift;
+	return lower + (1ULL << shift) - 1;
+}
+
+
+// 一个线程中一个指纹的统计数据, 只有所属线程写入, 其他线程只读取
+struct sql::mariadb::query_stats::slot
+{
+	slot(void) noexcept;
+
+	std::atomic<unsigned long long> calls; // 执行次数
+	std::atomic<unsigned long long> errors; // 失败次数
+	std::atomic<unsigned long long> rows; // 结果集行数或者影响的行数
+	std::atomic<unsigned long long> bytes; // 发送的SQL语句字节数
+	std::atomic<unsigned long long> buckets[latency_histogram::bucket_count]; // 延迟直方图
+};
+
+
+// 一个线程的统计数据; 线程结束时合并到已结束线程的统计数据中
+struct sql::mariadb::query_stats::thread_store
+{
+	typedef std::unordered_map<std::string, std::unique_ptr<slot>> slot_map;
+
+	thread_store(void);
+	~thread_store(void);
+	static thread_store & local(void);
+	static std::mutex & registry_mutex(void) noexcept;
+	static std::vector<thread_store *> & registry(void);
+	static slot_map & retired(void);
+
+	std::mutex mutex; // 查找、插入和遍历 slots 时加锁, 更新计数器不加锁
+	slot_map slots; // 每个指纹的统计数据
+	slot *ptr_last; // 最后一次记录的统计数据
+	MYSQL *ptr_handle; // 最后一次记录的数据库句柄
+	std::string scratch; // 计算指纹的缓冲区, 重复使用以避免分配内存
+};
+
+
+namespace
+{
+	// 是否启用 query_stats
+	std::atomic<bool> query_stats_enabled(false);
+
+	// 已安装的 phase_tracer
+	std::atomic<sql::mariadb::phase_tracer *> installed_phase_tracer(nullptr);
+
+#ifdef SQL_MARIADB_ALLOC_STATS
+	thread_local unsigned int alloc_depth = 0; // 当前线程嵌套的 alloc_scope 层数
+	thread_local unsigned long long alloc_count = 0; // 当前线程在 alloc_scope 中的分配次数
+	thread_local unsigned long long alloc_bytes = 0; // 当前线程在 alloc_scope 中分配的字节数
+#endif
+
+
+	//*********************************************************
+	// 函数名称 : bump
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 增加只有一个线程写入的计数器, 不需要读-改-写原子操作
+	// 访问方式 : private
+	// 函数参数 : std::atomic<unsigned long long> & counter 计数器
+	// 函数参数 : unsigned long long value 增加的值
+	//*********************************************************
+	inline void bump(std::atomic<unsigned long long> & counter, unsigned long long value) noexcept
+	{
+		counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+
+
+	//*********************************************************
+	// 函数名称 : is_word
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 判断字符是否可以组成标识符
+	// 访问方式 : private
+	// 函数参数 : char ch 字符
+	// 返 回 值 : bool 如果是字母、数字、下划线、$ 或者非 ASCII 字符返回true; 反之返回false
+	//*********************************************************
+	inline bool is_word(char ch) noexcept
+	{
+		return std::isalnum((unsigned char)ch) != 0 || ch == '_' || ch == '$' || (ch & 0x80) != 0;
+	}
+
+
+	//*********************************************************
+	// 函数名称 : append_json_string
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 把字符串转换成带双引号的 JSON 字符串, 添加到 output 的结尾
+	// 访问方式 : private
+	// 函数参数 : std::string & output 输出
+	// 函数参数 : const std::string & text 字符串
+	// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+	//*********************************************************
+	void append_json_string(std::string & output, const std::string & text)
+	{
+		output.push_back('"');
+		for (const auto ch : text)
+		{
+			switch (ch)
+			{
+			case '"': output += "\\\""; break;
+			case '\\': output += "\\\\"; break;
+			case '\n': output += "\\n"; break;
+			case '\r': output += "\\r"; break;
+			case '\t': output += "\\t"; break;
+			default:
+				if ((unsigned char)ch < 0x20)
+				{
+					char escaped[8];
+					std::snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned int)(unsigned char)ch);
+					output += escaped;
+				}
+				else
+				{
+					output.push_back(ch);
+				}
+			}
+		}
+		output.push_back('"');
+	}
+
+
+	//*********************************************************
+	// 函数名称 : store_result
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 调用 mysql_store_result 并记录 store 阶段的耗时
+	// 访问方式 : private
+	// 函数参数 : MYSQL * pointer 数据库句柄
+	// 返 回 值 : MYSQL_RES * 结果集, 没有结果集或者失败时返回 nullptr
+	//*********************************************************
+	MYSQL_RES * store_result(MYSQL * pointer) noexcept
+	{
+		sql::mariadb::phase_timer timer(sql::mariadb::query_phase::store);
+		return mysql_store_result(pointer);
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : slot
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数, 所有计数器为 0
+// 访问方式 : private
+//*********************************************************
+sql::mariadb::query_stats::slot::slot(void) noexcept
+	: calls(0)
+	, errors(0)
+	, rows(0)
+	, bytes(0)
+{
+	for (auto &bucket : buckets)
+	{
+		bucket.store(0, std::memory_order_relaxed);
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : thread_store
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数, 登记到所有线程的统计数据中
+// 访问方式 : private
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+sql::mariadb::query_stats::thread_store::thread_store(void)
+	: ptr_last(nullptr)
+	, ptr_handle(nullptr)
+{
+	std::lock_guard<std::mutex> lock(registry_mutex());
+	registry().push_back(this);
+}
+
+
+//*********************************************************
+// 函数名称 : ~thread_store
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 线程结束时取消登记, 把统计数据合并到已结束线程的统计数据中
+// 访问方式 : private
+//*********************************************************
+sql::mariadb::query_stats::thread_store::~thread_store(void)
+{
+	std::lock_guard<std::mutex> lock(registry_mutex());
+	auto &stores = registry();
+	stores.erase(std::remove(stores.begin(), stores.end(), this), stores.end());
+
+	try
+	{
+		auto &target = retired();
+		for (auto &item : slots)
+		{
+			auto &merged = target[item.first];
+			if (!merged)
+			{
+				merged = std::move(item.second);
+				continue;
+			}
+
+			const auto &source = *item.second;
+			bump(merged->calls, source.calls.load(std::memory_order_relaxed));
+			bump(merged->errors, source.errors.load(std::memory_order_relaxed));
+			bump(merged->rows, source.rows.load(std::memory_order_relaxed));
+			bump(merged->bytes, source.bytes.load(std::memory_order_relaxed));
+			for (size_t n = 0; n < latency_histogram::bucket_count; ++n)
+			{
+				bump(merged->buckets[n], source.buckets[n].load(std::memory_order_relaxed));
+			}
+		}
+	}
+	catch (const std::exception &)
+	{
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : local
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取当前线程的统计数据
+// 访问方式 : private
+// 返 回 值 : thread_store & 当前线程的统计数据
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+sql::mariadb::query_stats::thread_store & sql::mariadb::query_stats::thread_store::local(void)
+{
+	static thread_local thread_store store;
+	return store;
+}
+
+
+//*********************************************************
+// 函数名称 : registry_mutex
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取保护 registry 和 retired 的互斥量
+// 访问方式 : private
+// 返 回 值 : std::mutex & 互斥量
+//*********************************************************
+std::mutex & sql::mariadb::query_stats::thread_store::registry_mutex(void) noexcept
+{
+	static std::mutex mutex;
+	return mutex;
+}
+
+
+//*********************************************************
+// 函数名称 : registry
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取所有正在运行的线程的统计数据
+// 访问方式 : private
+// 返 回 值 : std::vector<thread_store *> & 所有线程的统计数据
+//*********************************************************
+std::vector<sql::mariadb::query_stats::thread_store *> & sql::mariadb::query_stats::thread_store::registry(void)
+{
+	static std::vector<thread_store *> stores;
+	return stores;
+}
+
+
+//*********************************************************
+// 函数名称 : retired
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取已经结束的线程的统计数据
+// 访问方式 : private
+// 返 回 值 : slot_map & 已经结束的线程合并后的统计数据
+//*********************************************************
+sql::mariadb::query_stats::thread_store::slot_map & sql::mariadb::query_stats::thread_store::retired(void)
+{
+	static slot_map slots;
+	return slots;
+}
+
+
+//*********************************************************
+// 函数名称 : set_enabled
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 启用或者停止统计
+// 访问方式 : public
+// 函数参数 : bool enable 是否启用
+//*********************************************************
+void sql::mariadb::query_stats::set_enabled(bool enable) noexcept
+{
+	query_stats_enabled.store(enable, std::memory_order_relaxed);
+}
+
+
+//*********************************************************
+// 函数名称 : enabled
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 判断是否启用了统计
+// 访问方式 : public
+// 返 回 值 : bool 如果启用返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::query_stats::enabled(void) noexcept
+{
+	return query_stats_enabled.load(std::memory_order_relaxed);
+}
+
+
+//*********************************************************
+// 函数名称 : fingerprint
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 计算SQL语句的指纹: 去掉注释, 合并空白, 关键字和标识符转成小写,
+//            字符串和数字常量替换成 ?, IN (?, ?, ?) 这样的列表合并成 (?+)
+// 访问方式 : public
+// 函数参数 : const char * text SQL语句
+// 函数参数 : unsigned long length SQL语句字符串长度
+// 返 回 值 : std::string 指纹
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+std::string sql::mariadb::query_stats::fingerprint(const char * text, unsigned long length)
+{
+	std::string output;
+	fingerprint(text, length, output);
+	return output;
+}
+
+
+//*********************************************************
+// 函数名称 : fingerprint
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 计算SQL语句的指纹, 写入 output, 重复使用 output 的内存
+// 访问方式 : private
+// 函数参数 : const char * text SQL语句
+// 函数参数 : unsigned long length SQL语句字符串长度
+// 函数参数 : std::string & output 指纹
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+void sql::mariadb::query_stats::fingerprint(const char * text, unsigned long length, std::string & output)
+{
+	output.clear();
+	output.reserve(length);
+
+	const auto end = text + length;
+	auto space = false;
+	auto ptr = text;
+	while (ptr != end)
+	{
+		const auto ch = *ptr;
+
+		// 空白和注释都当作一个空格
+		if (std::isspace((unsigned char)ch) != 0)
+		{
+			space = true;
+			++ptr;
+			continue;
+		}
+
+		if (ch == '#' || (ch == '-' && end - ptr >= 2 && ptr[1] == '-'
+			&& (end - ptr == 2 || std::isspace((unsigned char)ptr[2]) != 0)))
+		{
+			ptr = std::find(ptr, end, '\n');
+			space = true;
+			continue;
+		}
+
+		if (ch == '/' && end - ptr >= 2 && ptr[1] == '*')
+		{
+			const char close[] = { '*', '/' };
+			ptr = std::search(ptr + 2, end, close, close + 2);
+			ptr = ptr == end ? end : ptr + 2;
+			space = true;
+			continue;
+		}
+
+		if (space && !output.empty())
+		{
+			output.push_back(' ');
+		}
+		space = false;
+
+		// 反引号中的标识符原样保留
+		if (ch == '`')
+		{
+			const auto start = ptr++;
+			while (ptr != end)
+			{
+				if (*ptr == '`' && end - ptr >= 2 && ptr[1] == '`')
+				{
+					ptr += 2;
+				}
+				else if (*ptr++ == '`')
+				{
+					break;
+				}
+			}
+			output.append(start, ptr);
+			continue;
+		}
+
+		auto literal = false;
+		const auto after_word = !output.empty() && is_word(output.back());
+
+		// 字符串常量, 包括 x'..' 和 b'..'
+		auto quote = ch;
+		if (!after_word && (ch == 'x' || ch == 'X' || ch == 'b' || ch == 'B') && end - ptr >= 2 && ptr[1] == '\'')
+		{
+			quote = *++ptr;
+		}
+
+		if (quote == '\'' || quote == '"')
+		{
+			++ptr;
+			while (ptr != end)
+			{
+				if (*ptr == '\\' && end - ptr >= 2)
+				{
+					ptr += 2;
+				}
+				else if (*ptr == quote && end - ptr >= 2 && ptr[1] == quote)
+				{
+					ptr += 2;
+				}
+				else if (*ptr++ == quote)
+				{
+					break;
+				}
+			}
+			literal = true;
+		}
+		else if (!after_word && (std::isdigit((unsigned char)ch) != 0
+			|| (ch == '.' && end - ptr >= 2 && std::isdigit((unsigned char)ptr[1]) != 0)))
+		{
+			// 数字常量, 包括 1.5e-3 和 0x1F
+			++ptr;
+			while (ptr != end && (is_word(*ptr) || *ptr == '.'
+				|| ((*ptr == '+' || *ptr == '-') && (ptr[-1] == 'e' || ptr[-1] == 'E'))))
+			{
+				++ptr;
+			}
+			literal = true;
+		}
+
+		if (!literal)
+		{
+			output.push_back((char)std::tolower((unsigned char)ch));
+			++ptr;
+			continue;
+		}
+
+		// 常量列表合并: "?, ?" 和 "?+, ?" 都变成 "?+"
+		auto size = output.size();
+		while (size != 0 && output[size - 1] == ' ')
+		{
+			--size;
+		}
+
+		if (size != 0 && output[size - 1] == ',')
+		{
+			--size;
+			while (size != 0 && output[size - 1] == ' ')
+			{
+				--size;
+			}
+
+			if (size != 0 && output[size - 1] == '+' && size >= 2 && output[size - 2] == '?')
+			{
+				output.resize(size);
+				continue;
+			}
+
+			if (size != 0 && output[size - 1] == '?')
+			{
+				output.resize(size);
+				output.push_back('+');
+				continue;
+			}
+		}
+
+		output.push_back('?');
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : snapshot
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 合并所有线程 (包括已经结束的线程) 的统计数据
+// 访问方式 : public
+// 返 回 值 : std::vector<entry> 每个指纹的统计数据, 按执行次数从多到少排序
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+std::vector<sql::mariadb::query_stats::entry> sql::mariadb::query_stats::snapshot(void)
+{
+	std::map<std::string, entry> merged;
+	const auto add = [&merged](const thread_store::slot_map &slots)
+	{
+		for (const auto &item : slots)
+		{
+			auto position = merged.find(item.first);
+			if (position == merged.end())
+			{
+				position = merged.insert(std::make_pair(item.first, entry())).first;
+				position->second.fingerprint = item.first;
+				position->second.calls = 0;
+				position->second.errors = 0;
+				position->second.rows = 0;
+				position->second.bytes = 0;
+			}
+
+			auto &target = position->second;
+			const auto &source = *item.second;
+			target.calls += source.calls.load(std::memory_order_relaxed);
+			target.errors += source.errors.load(std::memory_order_relaxed);
+			target.rows += source.rows.load(std::memory_order_relaxed);
+			target.bytes += source.bytes.load(std::memory_order_relaxed);
+			for (size_t n = 0; n < latency_histogram::bucket_count; ++n)
+			{
+				target.latency.m_counts[n] += source.buckets[n].load(std::memory_order_relaxed);
+			}
+		}
+	};
+
+	{
+		std::lock_guard<std::mutex> lock(thread_store::registry_mutex());
+		for (const auto store : thread_store::registry())
+		{
+			std::lock_guard<std::mutex> store_lock(store->mutex);
+			add(store->slots);
+		}
+		add(thread_store::retired());
+	}
+
+	std::vector<entry> entries;
+	entries.reserve(merged.size());
+	for (auto &item : merged)
+	{
+		entries.push_back(std::move(item.second));
+	}
+
+	std::stable_sort(entries.begin(), entries.end(), [](const entry &left, const entry &right)
+	{
+		return left.calls > right.calls;
+	});
+	return entries;
+}
+
+
+//*********************************************************
+// 函数名称 : reset
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 清空所有统计数据
+// 访问方式 : public
+//*********************************************************
+void sql::mariadb::query_stats::reset(void) noexcept
+{
+	const auto clear = [](const thread_store::slot_map &slots)
+	{
+		for (const auto &item : slots)
+		{
+			auto &target = *item.second;
+			target.calls.store(0, std::memory_order_relaxed);
+			target.errors.store(0, std::memory_order_relaxed);
+			target.rows.store(0, std::memory_order_relaxed);
+			target.bytes.store(0, std::memory_order_relaxed);
+			for (auto &bucket : target.buckets)
+			{
+				bucket.store(0, std::memory_order_relaxed);
+			}
+		}
+	};
+
+	// 只清零计数器, 不删除 slot, 因为所属线程可能正在使用
+	std::lock_guard<std::mutex> lock(thread_store::registry_mutex());
+	for (const auto store : thread_store::registry())
+	{
+		std::lock_guard<std::mutex> store_lock(store->mutex);
+		clear(store->slots);
+	}
+	thread_store::retired().clear();
+}
+
+
+//*********************************************************
+// 函数名称 : record
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 记录一次执行SQL语句
+// 访问方式 : private
+// 函数参数 : MYSQL * pointer 执行SQL语句的数据库句柄
+// 函数参数 : const char * text SQL语句
+// 函数参数 : unsigned long length SQL语句字符串长度
+// 函数参数 : std::chrono::nanoseconds elapsed 延迟
+// 函数参数 : bool failed 是否失败
+//*********************************************************
+void sql::mariadb::query_stats::record(MYSQL * pointer, const char * text, unsigned long length,
+	std::chrono::nanoseconds elapsed, bool failed) noexcept try
+{
+	auto &store = thread_store::local();
+	fingerprint(text, length, store.scratch);
+
+	// 查找和插入都持有本线程的锁, 插入引起的重新散列不会与 snapshot/reset 的遍历同时进行;
+	// 只有 snapshot/reset 会竞争这个锁, 平时加锁不会阻塞
+	slot *ptr_target = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(store.mutex);
+		auto position = store.slots.find(store.scratch);
+		if (position == store.slots.end())
+		{
+			std::unique_ptr<slot> created(new slot);
+			position = store.slots.insert(std::make_pair(store.scratch, std::move(created))).first;
+		}
+
+		ptr_target = position->second.get();
+	}
+
+	// slot 不会被删除, 更新计数器不需要持有锁
+	auto &target = *ptr_target;
+	bump(target.calls, 1);
+	bump(target.bytes, length);
+	if (failed)
+	{
+		bump(target.errors, 1);
+	}
+
+	const auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+	bump(target.buckets[latency_histogram::index(microseconds < 0 ? 0ULL : (unsigned long long)microseconds)], 1);
+
+	store.ptr_last = &target;
+	store.ptr_handle = pointer;
+}
+catch (const std::exception &)
+{
+}
+
+
+//*********************************************************
+// 函数名称 : add_rows
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 把结果集的行数记录到该线程在 pointer 上最后执行的SQL语句
+// 访问方式 : private
+// 函数参数 : MYSQL * pointer 数据库句柄
+// 函数参数 : unsigned long long rows 结果集行数
+//*********************************************************
+void sql::mariadb::query_stats::add_rows(MYSQL * pointer, unsigned long long rows) noexcept try
+{
+	auto &store = thread_store::local();
+	if (store.ptr_last != nullptr && store.ptr_handle == pointer)
+	{
+		bump(store.ptr_last->rows, rows);
+	}
+}
+catch (const std::exception &)
+{
+}
+
+
+//*********************************************************
+// 函数名称 : ~phase_tracer
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 析构函数
+// 访问方式 : public
+//*********************************************************
+sql::mariadb::phase_tracer::~phase_tracer(void)
+{
+}
+
+
+//*********************************************************
+// 函数名称 : install
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 安装跟踪对象, 替换之前安装的对象; 跟踪对象由调用者管理,
+//            必须比所有正在执行的SQL语句活得久
+// 访问方式 : public
+// 函数参数 : phase_tracer * tracer 跟踪对象, nullptr 代表停止跟踪
+//*********************************************************
+void sql::mariadb::phase_tracer::install(phase_tracer * tracer) noexcept
+{
+	installed_phase_tracer.store(tracer, std::memory_order_release);
+}
+
+
+//*********************************************************
+// 函数名称 : installed
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取已安装的跟踪对象
+// 访问方式 : public
+// 返 回 值 : phase_tracer * 跟踪对象, 没有安装时返回 nullptr
+//*********************************************************
+sql::mariadb::phase_tracer * sql::mariadb::phase_tracer::installed(void) noexcept
+{
+	return installed_phase_tracer.load(std::memory_order_acquire);
+}
+
+
+//*********************************************************
+// 函数名称 : phase_timer
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数, 已安装 phase_tracer 时开始计时
+// 访问方式 : public
+// 函数参数 : query_phase phase 阶段
+//*********************************************************
+sql::mariadb::phase_timer::phase_timer(query_phase phase) noexcept
+	: m_ptr_tracer(phase_tracer::installed())
+	, m_phase(phase)
+{
+	if (m_ptr_tracer != nullptr)
+	{
+		m_start = std::chrono::steady_clock::now();
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : ~phase_timer
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 析构函数, 还没有报告时报告耗时
+// 访问方式 : public
+//*********************************************************
+sql::mariadb::phase_timer::~phase_timer(void)
+{
+	this->stop();
+}
+
+
+//*********************************************************
+// 函数名称 : stop
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 停止计时并报告耗时, 只报告一次
+// 访问方式 : public
+//*********************************************************
+void sql::mariadb::phase_timer::stop(void) noexcept
+{
+	if (m_ptr_tracer != nullptr)
+	{
+		m_ptr_tracer->on_phase(m_phase, std::chrono::steady_clock::now() - m_start);
+		m_ptr_tracer = nullptr;
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : alloc_scope
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数, 开始统计当前线程的分配; 可以嵌套
+// 访问方式 : public
+//*********************************************************
+sql::mariadb::alloc_scope::alloc_scope(void) noexcept
+#ifdef SQL_MARIADB_ALLOC_STATS
+	: m_allocations(alloc_count)
+	, m_bytes(alloc_bytes)
+{
+	++alloc_depth;
+}
+#else
+	: m_allocations(0)
+	, m_bytes(0)
+{
+}
+#endif
+
+
+//*********************************************************
+// 函数名称 : ~alloc_scope
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 析构函数, 最外层的范围结束后不再统计
+// 访问方式 : public
+//*********************************************************
+sql::mariadb::alloc_scope::~alloc_scope(void) noexcept
+{
+#ifdef SQL_MARIADB_ALLOC_STATS
+	--alloc_depth;
+#endif
+}
+
+
+//*********************************************************
+// 函数名称 : allocations
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取构造以来当前线程的分配次数
+// 访问方式 : public
+// 返 回 值 : unsigned long long 分配次数
+//*********************************************************
+unsigned long long sql::mariadb::alloc_scope::allocations(void) const noexcept
+{
+#ifdef SQL_MARIADB_ALLOC_STATS
+	return alloc_count - m_allocations;
+#else
+	return 0;
+#endif
+}
+
+
+//*********************************************************
+// 函数名称 : bytes
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取构造以来当前线程分配时请求的字节数
+// 访问方式 : public
+// 返 回 值 : unsigned long long 字节数
+//*********************************************************
+unsigned long long sql::mariadb::alloc_scope::bytes(void) const noexcept
+{
+#ifdef SQL_MARIADB_ALLOC_STATS
+	return alloc_bytes - m_bytes;
+#else
+	return 0;
+#endif
+}
+
+
+//*********************************************************
+// 函数名称 : enabled
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 判断编译时是否启用了分配统计 (SQL_MARIADB_ALLOC_STATS)
+// 访问方式 : public
+// 返 回 值 : bool true 代表启用
+//*********************************************************
+bool sql::mariadb::alloc_scope::enabled(void) noexcept
+{
+#ifdef SQL_MARIADB_ALLOC_STATS
+	return true;
+#else
+	return false;
+#endif
+}
+
+
+//*********************************************************
+// 函数名称 : record
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 记录一次分配, 由程序自己替换的 operator new 调用; 只在当前线程有 alloc_scope 时计数
+// 访问方式 : public
+// 函数参数 : std::size_t size 请求的字节数
+//*********************************************************
+void sql::mariadb::alloc_scope::record(std::size_t size) noexcept
+{
+#ifdef SQL_MARIADB_ALLOC_STATS
+	if (alloc_depth != 0)
+	{
+		++alloc_count;
+		alloc_bytes += size;
+	}
+#else
+	(void)size;
+#endif
+}
+
+
+
+
+//*********************************************************
+// 函数名称 : ~statement_observer
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 析构函数
+// 访问方式 : public
+//*********************************************************
+sql::mariadb::statement_observer::~statement_observer(void)
+{
+}
+
+
+//*********************************************************
+// 函数名称 : set_charset
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置字符集 (MYSQL_SET_CHARSET_NAME), 在连接握手时设置
+// 访问方式 : public
+// 函数参数 : std::string charset 字符集名称, 如 utf8mb4
+//*********************************************************
+void sql::mariadb::connection_options::set_charset(std::string charset) noexcept
+{
+	m_charset = std::move(charset);
+}
+
+
+//*********************************************************
+// 函数名称 : add_init_command
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 添加连接成功后服务器执行的SQL语句 (MYSQL_INIT_COMMAND)
+// 访问方式 : public
+// 函数参数 : std::string text SQL语句
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+void sql::mariadb::connection_options::add_init_command(std::string text)
+{
+	m_init_commands.push_back(std::move(text));
+}
+
+
+//*********************************************************
+// 函数名称 : set_session_variable
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置会话变量, 所有会话变量合并成一条 SET 语句在连接成功后执行
+// 访问方式 : public
+// 函数参数 : std::string name 变量名
+// 函数参数 : std::string value 变量值, 会直接写入SQL语句, 字符串需要加上单引号
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+void sql::mariadb::connection_options::set_session_variable(std::string name, std::string value)
+{
+	if (!m_session_variables.empty())
+	{
+		m_session_variables += ", ";
+	}
+	m_session_variables += "@@session." + name + " = " + value;
+}
+
+
+//*********************************************************
+// 函数名称 : set_compress
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置是否启用协议压缩 (MYSQL_OPT_COMPRESS)
+// 访问方式 : public
+// 函数参数 : bool enable true 代表启用, false 代表不启用
+//*********************************************************
+void sql::mariadb::connection_options::set_compress(bool enable) noexcept
+{
+	m_compress = enable;
+}
+
+
+//*********************************************************
+// 函数名称 : set_connect_timeout
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置连接超时时间 (MYSQL_OPT_CONNECT_TIMEOUT)
+// 访问方式 : public
+// 函数参数 : unsigned int seconds 秒数, 0 代表使用默认值
+//*********************************************************
+void sql::mariadb::connection_options::set_connect_timeout(unsigned int seconds) noexcept
+{
+	m_connect_timeout = seconds;
+}
+
+
+//*********************************************************
+// 函数名称 : set_read_timeout
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置读取数据超时时间 (MYSQL_OPT_READ_TIMEOUT)
+// 访问方式 : public
+// 函数参数 : unsigned int seconds 秒数, 0 代表使用默认值
+//*********************************************************
+void sql::mariadb::connection_options::set_read_timeout(unsigned int seconds) noexcept
+{
+	m_read_timeout = seconds;
+}
+
+
+//*********************************************************
+// 函数名称 : set_write_timeout
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置发送数据超时时间 (MYSQL_OPT_WRITE_TIMEOUT)
+// 访问方式 : public
+// 函数参数 : unsigned int seconds 秒数, 0 代表使用默认值
+//*********************************************************
+void sql::mariadb::connection_options::set_write_timeout(unsigned int seconds) noexcept
+{
+	m_write_timeout = seconds;
+}
+
+
+//*********************************************************
+// 函数名称 : set_net_buffer_length
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置客户端网络缓冲区的初始大小 (MYSQL_OPT_NET_BUFFER_LENGTH)
+// 访问方式 : public
+// 函数参数 : unsigned long bytes 字节数, 0 代表使用默认值
+//*********************************************************
+void sql::mariadb::connection_options::set_net_buffer_length(unsigned long bytes) noexcept
+{
+	m_net_buffer_length = bytes;
+}
+
+
+//*********************************************************
+// 函数名称 : set_max_allowed_packet
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置客户端允许的最大数据包 (MYSQL_OPT_MAX_ALLOWED_PACKET)
+// 访问方式 : public
+// 函数参数 : unsigned long bytes 字节数, 0 代表使用默认值
+//*********************************************************
+void sql::mariadb::connection_options::set_max_allowed_packet(unsigned long bytes) noexcept
+{
+	m_max_allowed_packet = bytes;
+}
+
+
+//*********************************************************
+// 函数名称 : compression_pays_off
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 估算协议压缩能否缩短结果集的传输时间
+// 访问方式 : public
+// 函数参数 : unsigned long long bytes 结果集的数据量 (字节)
+// 函数参数 : double bandwidth 链路带宽 (字节/秒)
+// 函数参数 : double ratio 压缩比 (压缩后网络字节数 / 不压缩网络字节数)
+// 函数参数 : double codec_speed zlib 压缩和解压的综合速度 (字节/秒)
+// 函数参数 : double fixed_cost 每个结果集与数据量无关的压缩开销 (秒)
+// 返 回 值 : bool 启用压缩能缩短传输时间返回 true; 反之返回 false
+//*********************************************************
+bool sql::mariadb::connection_options::compression_pays_off(unsigned long long bytes, double bandwidth, double ratio, double codec_speed, double fixed_cost) noexcept
+{
+	// 客户端库不压缩小于 MIN_COMPRESS_LENGTH (50 字节) 的数据包
+	const unsigned long long min_compress_length = 50;
+
+	if (bytes < min_compress_length || bandwidth <= 0.0 || codec_speed <= 0.0 || ratio >= 1.0)
+	{
+		return false;
+	}
+
+	const auto size = static_cast<double>(bytes);
+	const auto plain = size / bandwidth;
+	const auto compressed = size * ratio / bandwidth + size / codec_speed + std::max(fixed_cost, 0.0);
+
+	return compressed < plain;
+}
+
+
+//*********************************************************
+// 函数名称 : apply
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 将选项设置到还没有连接的数据库句柄
+// 访问方式 : private
+// 函数参数 : MYSQL * pointer 数据库句柄
+// 返 回 值 : bool 如果设置成功返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::connection_options::apply(MYSQL * pointer) const noexcept
+try
+{
+	assert(pointer != nullptr);
+
+	bool result = true;
+
+	if (!m_charset.empty())
+	{
+		result = result && mysql_options(pointer, MYSQL_SET_CHARSET_NAME, m_charset.c_str()) == 0;
+	}
+
+	for (const auto &text : m_init_commands)
+	{
+		result = result && mysql_options(pointer, MYSQL_INIT_COMMAND, text.c_str()) == 0;
+	}
+
+	if (!m_session_variables.empty())
+	{
+		const auto text = "SET " + m_session_variables;
+		result = result && mysql_options(pointer, MYSQL_INIT_COMMAND, text.c_str()) == 0;
+	}
+
+	if (m_compress)
+	{
+		result = result && mysql_options(pointer, MYSQL_OPT_COMPRESS, nullptr) == 0;
+	}
+
+	if (m_connect_timeout != 0)
+	{
+		result = result && mysql_options(pointer, MYSQL_OPT_CONNECT_TIMEOUT, &m_connect_timeout) == 0;
+	}
+
+	if (m_read_timeout != 0)
+	{
+		result = result && mysql_options(pointer, MYSQL_OPT_READ_TIMEOUT, &m_read_timeout) == 0;
+	}
+
+	if (m_write_timeout != 0)
+	{
+		result = result && mysql_options(pointer, MYSQL_OPT_WRITE_TIMEOUT, &m_write_timeout) == 0;
+	}
+
+	if (m_net_buffer_length != 0)
+	{
+		result = result && mysql_options(pointer, MYSQL_OPT_NET_BUFFER_LENGTH, &m_net_buffer_length) == 0;
+	}
+
+	if (m_max_allowed_packet != 0)
+	{
+		result = result && mysql_options(pointer, MYSQL_OPT_MAX_ALLOWED_PACKET, &m_max_allowed_packet) == 0;
+	}
+
+	return result;
+}
+catch (const std::exception &)
+{
+	return false;
+}
+
+
+//*********************************************************
+// 函数名称 : restore
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 在已经连接的数据库句柄上重新执行连接成功后执行的SQL语句和设置会话变量,
+//            用于 mysql_reset_connection 之后
+// 访问方式 : private
+// 函数参数 : MYSQL * pointer 数据库句柄
+// 返 回 值 : bool 如果执行成功返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::connection_options::restore(MYSQL * pointer) const noexcept
+try
+{
+	assert(pointer != nullptr);
+
+	// 执行一条SQL语句并丢弃可能返回的结果集
+	const auto run = [pointer](const std::string &text)
+	{
+		if (mysql_real_query(pointer, text.c_str(), (unsigned long)text.size()) != 0)
+		{
+			return false;
+		}
+
+		const auto result = mysql_store_result(pointer);
+		if (result != nullptr)
+		{
+			mysql_free_result(result);
+		}
+
+		return mysql_errno(pointer) == 0;
+	};
+
+	for (const auto &text : m_init_commands)
+	{
+		if (!run(text))
+		{
+			return false;
+		}
+	}
+
+	return m_session_variables.empty() || run("SET " + m_session_variables);
+}
+catch (const std::exception &)
+{
+	return false;
+}
+
+
+//*********************************************************
+// 函数名称 : endpoint
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数
+// 访问方式 : public
+// 函数参数 : std::string user 用户名
+// 函数参数 : std::string password 密码
+// 函数参数 : std::string database 数据库名, 空字符串代表不指定
+// 函数参数 : unsigned int port 服务器端口
+// 函数参数 : std::string host 服务器 IP 地址
+// 函数参数 : std::string unix_socket 指定需要使用的 socket 或者 命名管道, 空字符串代表不指定
+// 函数参数 : unsigned long flags 链接选项
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+sql::mariadb::endpoint::endpoint(std::string user, std::string password, std::string database, unsigned int port, std::string host, std::string unix_socket, unsigned long flags)
+	: m_user(std::move(user))
+	, m_password(std::move(password))
+	, m_database(std::move(database))
+	, m_port(port)
+	, m_host(std::move(host))
+	, m_unix_socket(std::move(unix_socket))
+	, m_flags(flags)
+{
+}
+
+
+//*********************************************************
+// 函数名称 : options
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取连接选项, 可以在连接前修改
+// 访问方式 : public
+// 返 回 值 : connection_options & 连接选项
+//*********************************************************
+sql::mariadb::connection_options & sql::mariadb::endpoint::options(void) noexcept
+{
+	return m_options;
+}
+
+
+//*********************************************************
+// 函数名称 : options
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取连接选项
+// 访问方式 : public
+// 返 回 值 : const connection_options & 连接选项
+//*********************************************************
+const sql::mariadb::connection_options & sql::mariadb::endpoint::options(void) const noexcept
+{
+	return m_options;
+}
+
+
+//*********************************************************
+// 函数名称 : host
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取服务器 IP 地址
+// 访问方式 : public
+// 返 回 值 : const std::string & 服务器 IP 地址
+//*********************************************************
+const std::string & sql::mariadb::endpoint::host(void) const noexcept
+{
+	return m_host;
+}
+
+
+//*********************************************************
+// 函数名称 : port
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取服务器端口
+// 访问方式 : public
+// 返 回 值 : unsigned int 服务器端口
+//*********************************************************
+unsigned int sql::mariadb::endpoint::port(void) const noexcept
+{
+	return m_port;
+}
+
+
+//*********************************************************
+// 函数名称 : user
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取用户名
+// 访问方式 : public
+// 返 回 值 : const std::string & 用户名
+//*********************************************************
+const std::string & sql::mariadb::endpoint::user(void) const noexcept
+{
+	return m_user;
+}
+
+
+//*********************************************************
+// 函数名称 : unix_socket
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取 socket 或者 命名管道
+// 访问方式 : public
+// 返 回 值 : const std::string & socket 或者 命名管道
+//*********************************************************
+const std::string & sql::mariadb::endpoint::unix_socket(void) const noexcept
+{
+	return m_unix_socket;
+}
+
+
+//*********************************************************
+// 函数名称 : reconnect_policy
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数
+// 访问方式 : public
+// 函数参数 : unsigned int max_attempts 最多尝试重新连接多少次, 0 代表不重新连接
+// 函数参数 : unsigned int base_delay 退避的基础等待时间 (毫秒)
+// 函数参数 : unsigned int max_delay 最长的等待时间 (毫秒)
+//*********************************************************
+sql::mariadb::reconnect_policy::reconnect_policy(unsigned int max_attempts, unsigned int base_delay, unsigned int max_delay) noexcept
+	: m_max_attempts(max_attempts)
+	, m_base_delay(base_delay)
+	, m_max_delay(max_delay)
+{
+}
+
+
+//*********************************************************
+// 函数名称 : max_attempts
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取最多尝试重新连接的次数
+// 访问方式 : public
+// 返 回 值 : unsigned int 次数
+//*********************************************************
+unsigned int sql::mariadb::reconnect_policy::max_attempts(void) const noexcept
+{
+	return m_max_attempts;
+}
+
+
+//*********************************************************
+// 函数名称 : delay
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取第 attempt 次重新连接前需要等待的时间 (带随机抖动)
+// 访问方式 : public
+// 函数参数 : unsigned int attempt 第几次重新连接, 从0开始
+// 返 回 值 : unsigned int 等待时间 (毫秒)
+//*********************************************************
+unsigned int sql::mariadb::reconnect_policy::delay(unsigned int attempt) const noexcept
+{
+	return backoff_delay(m_base_delay, m_max_delay, attempt);
+}
+
+
+//*********************************************************
+// 函数名称 : retry_policy
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数
+// 访问方式 : public
+// 函数参数 : unsigned int max_attempts 最多执行多少次, 包括第一次
+// 函数参数 : unsigned int base_delay 退避的基础等待时间 (毫秒)
+// 函数参数 : unsigned int max_delay 最长的等待时间 (毫秒)
+//*********************************************************
+sql::mariadb::retry_policy::retry_policy(unsigned int max_attempts, unsigned int base_delay, unsigned int max_delay) noexcept
+	: m_max_attempts(std::max(max_attempts, 1U))
+	, m_base_delay(base_delay)
+	, m_max_delay(max_delay)
+{
+}
+
+
+//*********************************************************
+// 函数名称 : max_attempts
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取最多执行的次数
+// 访问方式 : public
+// 返 回 值 : unsigned int 次数
+//*********************************************************
+unsigned int sql::mariadb::retry_policy::max_attempts(void) const noexcept
+{
+	return m_max_attempts;
+}
+
+
+//*********************************************************
+// 函数名称 : delay
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取第 attempt 次重试前需要等待的时间 (带随机抖动)
+// 访问方式 : public
+// 函数参数 : unsigned int attempt 第几次重试, 从0开始
+// 返 回 值 : unsigned int 等待时间 (毫秒)
+//*********************************************************
+unsigned int sql::mariadb::retry_policy::delay(unsigned int attempt) const noexcept
+{
+	return backoff_delay(m_base_delay, m_max_delay, attempt);
+}
+
+
+//*********************************************************
+// 函数名称 : retryable
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 判断错误是否可以通过重新执行事务解决
+// 访问方式 : public
+// 函数参数 : const mariadb_exception & exception 事务中抛出的异常
+// 返 回 值 : bool 如果可以重试返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::retry_policy::retryable(const mariadb_exception & exception) noexcept
+{
+	return exception.code() == ER_LOCK_DEADLOCK
+		|| exception.code() == ER_LOCK_WAIT_TIMEOUT
+		|| std::strcmp(exception.sqlstate(), "40001") == 0;
+}
+
+
+//*********************************************************
+// 函数名称 : session_state
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数
+// 访问方式 : private
+// 函数参数 : const reconnect_policy & policy 重新连接的策略
+//*********************************************************
+sql::mariadb::session_state::session_state(const reconnect_policy & policy) noexcept
+	: m_policy(policy)
+	, m_generation(0)
+{
+}
+
+
+//*********************************************************
+// 函数名称 : reconnect
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 按照策略重新连接 (使用原来的数据库句柄) 并恢复会话变量
+// 访问方式 : private
+// 函数参数 : MYSQL * pointer 数据库句柄
+// 返 回 值 : bool 如果重新连接成功返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::session_state::reconnect(MYSQL * pointer) noexcept
+try
+{
+	assert(pointer != nullptr);
+
+	for (unsigned int attempt = 0; attempt < m_policy.max_attempts(); ++attempt)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(m_policy.delay(attempt)));
+
+		// 只在这里允许客户端库重新连接, 避免客户端库自动重新发送不能重复执行的SQL语句;
+		// 重新连接时客户端库会重新设置字符集并执行 MYSQL_INIT_COMMAND
+		bool enable = true;
+		mysql_options(pointer, MYSQL_OPT_RECONNECT, &enable);
+		const auto alive = mysql_ping(pointer) == 0;
+		enable = false;
+		mysql_options(pointer, MYSQL_OPT_RECONNECT, &enable);
+
+		if (!alive)
+		{
+			continue;
+		}
+
+		// 旧的预处理语句句柄已经失效
+		++m_generation;
+
+		if (m_variables.empty())
+		{
+			return true;
+		}
+
+		std::string text = "SET ";
+		for (const auto &variable : m_variables)
+		{
+			if (text.size() > 4)
+			{
+				text += ", ";
+			}
+			text += "@@session." + variable.first + " = " + variable.second;
+		}
+
+		return mysql_real_query(pointer, text.c_str(), (unsigned long)text.size()) == 0;
+	}
+
+	return false;
+}
+catch (const std::exception &)
+{
+	return false;
+}
+
+
+//*********************************************************
+// 函数名称 : retryable
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 判断失败的SQL语句能否在重新连接后再执行一次
+// 访问方式 : private
+// 函数参数 : unsigned int code 错误代号
+// 函数参数 : bool in_transaction 执行前是否在事务中
+// 函数参数 : const char * text SQL语句
+// 函数参数 : unsigned long length SQL语句字符串长度
+// 返 回 值 : bool 如果可以再执行一次返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::session_state::retryable(unsigned int code, bool in_transaction, const char * text, unsigned long length) noexcept
+{
+	return (code == CR_SERVER_GONE_ERROR || code == CR_SERVER_LOST) && !in_transaction && idempotent(text, length);
+}
+
+
+//*********************************************************
+// 函数名称 : idempotent
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 判断SQL语句能否重复执行
+// 访问方式 : private
+// 函数参数 : const char * text SQL语句
+// 函数参数 : unsigned long length SQL语句字符串长度
+// 返 回 值 : bool 如果可以重复执行返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::session_state::idempotent(const char * text, unsigned long length) noexcept
+{
+	const auto end = text + length;
+	return is_plain_read(skip_comments(text, end), end);
+}
+
+
+//*********************************************************
+// 函数名称 : connection
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 构造函数
+// 访问方式 : public
+//*********************************************************
+sql::mariadb::connection::connection(void) noexcept
+	: m_ptr_mysql(mysql_init(nullptr))
+	, m_ptr_observer(nullptr)
+{
+}
+
+
+//*********************************************************
+// 函数名称 : connection
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 转移构造函数, 转移后原对象不应该使用
+// 访问方式 : public
+// 函数参数 : connection && connector 需要转移的对象
+//*********************************************************
+sql::mariadb::connection::connection(connection && connector) noexcept
+	: m_ptr_mysql(connector.m_ptr_mysql)
+	, m_session(std::move(connector.m_session))
+	, m_ptr_observer(connector.m_ptr_observer)
+{
+	connector.m_ptr_mysql = nullptr;
+}
+
+
+//*********************************************************
+// 函数名称 : ~connection
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 如果数据库连接没有关闭则在析构时自动关闭
+// 访问方式 : public
+//*********************************************************
+sql::mariadb::connection::~connection(void) noexcept
+{
+	if (m_ptr_mysql != nullptr)
+	{
+		mysql_close(m_ptr_mysql);
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : operator!=
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 判断数据库连接器是否创建成功
+// 访问方式 : public
+// 函数参数 : std::nullptr_t null 与nullptr作比较
+// 返 回 值 : bool 如果创建成功则 对象 != nullptr;
+//            反之 对象 == nullptr
+//*********************************************************
+bool sql::mariadb::connection::operator!=(std::nullptr_t null) const noexcept
+{
+	return m_ptr_mysql != null;
+}
+
+
+//*********************************************************
+// 函数名称 : operator==
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 判断数据库连接器是否创建成功
+// 访问方式 : public
+// 函数参数 : std::nullptr_t null  与nullptr作比较
+// 返 回 值 : bool 如果创建成功则 对象 != nullptr;
+//            反之 对象 == nullptr
+//*********************************************************
+bool sql::mariadb::connection::operator==(std::nullptr_t null) const noexcept
+{
+	return m_ptr_mysql == null;
+}
+
+
+//*********************************************************
+// 函数名称 : open
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 连接数据库
+// 访问方式 : public
+// 函数参数 : const char * user 用户名
+// 函数参数 : const char * password 密码
+// 函数参数 : const char * database 数据库名
+// 函数参数 : unsigned int port 服务器端口
+// 函数参数 : const char * host 服务器 IP 地址
+// 函数参数 : const char * unix_socket 指定需要使用的 socket 或者 命名管道
+// 函数参数 : unsigned long flags 链接选项
+// 返 回 值 : bool true 代表连接成功, false 代表连接失败
+//*********************************************************
+bool sql::mariadb::connection::open(const char * user, const char * password, const char * database, unsigned int port, const char * host, const char * unix_socket, unsigned long flags) const noexcept
+{
+	assert(host != nullptr);
+	assert(user != nullptr);
+	assert(password != nullptr);
+
+	if (m_ptr_mysql == nullptr)
+	{
+		return false;
+	}
+
+	// 在连接握手时设置字符集, 不需要连接后再执行 SET NAMES
+	if (mysql_options(m_ptr_mysql, MYSQL_SET_CHARSET_NAME, "utf8") != 0)
+	{
+		return false;
+	}
+
+	return mysql_real_connect(m_ptr_mysql, host, user, password, database, port, unix_socket, flags) != nullptr;
+}
+
+
+//*********************************************************
+// 函数名称 : open
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 使用连接选项连接数据库, 连接前设置所有选项
+// 访问方式 : public
+// 函数参数 : const connection_options & options 连接选项
+// 函数参数 : const char * user 用户名
+// 函数参数 : const char * password 密码
+// 函数参数 : const char * database 数据库名
+// 函数参数 : unsigned int port 服务器端口
+// 函数参数 : const char * host 服务器 IP 地址
+// 函数参数 : const char * unix_socket 指定需要使用的 socket 或者 命名管道
+// 函数参数 : unsigned long flags 链接选项
+// 返 回 值 : bool true 代表连接成功, false 代表连接失败
+//*********************************************************
+bool sql::mariadb::connection::open(const connection_options & options, const char * user, const char * password, const char * database, unsigned int port, const char * host, const char * unix_socket, unsigned long flags) const noexcept
+{
+	assert(host != nullptr);
+	assert(user != nullptr);
+	assert(password != nullptr);
+
+	if (m_ptr_mysql == nullptr || !options.apply(m_ptr_mysql))
+	{
+		return false;
+	}
+
+	return mysql_real_connect(m_ptr_mysql, host, user, password, database, port, unix_socket, flags) != nullptr;
+}
+
+
+//*********************************************************
+// 函数名称 : close
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 关闭数据库连接, 如果不关闭数据库连接, 则析构时自动关闭
+// 访问方式 : public
+//*********************************************************
+void sql::mariadb::connection::close(void) noexcept
+{
+	if (m_ptr_mysql != nullptr)
+	{
+		mysql_close(m_ptr_mysql);
+		m_ptr_mysql = nullptr;
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : error
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 获取数据库操作失败的错误信息
+// 访问方式 : public
+// 返 回 值 : std::string 错误信息
+//*********************************************************
+std::string sql::mariadb::connection::error(void) const noexcept
+try
+{
+	return std::string(mysql_error(m_ptr_mysql));
+}
+catch (const std::exception &)
+{
+	return std::string();
+}
+
+
+//*********************************************************
+// 函数名称 : errorno
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 获取数据库操作失败的错误代号
+// 访问方式 : public
+// 返 回 值 : unsigned int 错误代号
+//*********************************************************
+unsigned int sql::mariadb::connection::errorno(void) const noexcept
+{
+	return mysql_errno(m_ptr_mysql);
+}
+
+
+//*********************************************************
+// 函数名称 : sqlstate
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取数据库操作失败的 SQLSTATE
+// 访问方式 : public
+// 返 回 值 : std::string 五个字符的 SQLSTATE, 成功时为 00000
+//*********************************************************
+std::string sql::mariadb::connection::sqlstate(void) const noexcept
+try
+{
+	return std::string(mysql_sqlstate(m_ptr_mysql));
+}
+catch (const std::exception &)
+{
+	return std::string();
+}
+
+
+//*********************************************************
+// 函数名称 : set_multi_statements
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 允许或者禁止一次执行多条用分号分隔的SQL语句
+// 访问方式 : public
+// 函数参数 : bool enable true 代表允许, false 代表禁止
+// 返 回 值 : bool 如果设置成功返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::connection::set_multi_statements(bool enable) const noexcept
+{
+	assert(m_ptr_mysql != nullptr);
+	const auto option = enable ? MYSQL_OPTION_MULTI_STATEMENTS_ON : MYSQL_OPTION_MULTI_STATEMENTS_OFF;
+	return mysql_set_server_option(m_ptr_mysql, option) == 0;
+}
+
+
+//*********************************************************
+// 函数名称 : open
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 使用服务器参数连接数据库
+// 访问方式 : public
+// 函数参数 : const endpoint & point 服务器参数
+// 返 回 值 : bool true 代表连接成功, false 代表连接失败
+//*********************************************************
+bool sql::mariadb::connection::open(const endpoint & point) const noexcept
+{
+	const auto database = point.m_database.empty() ? nullptr : point.m_database.c_str();
+	const auto unix_socket = point.m_unix_socket.empty() ? nullptr : point.m_unix_socket.c_str();
+	return this->open(point.m_options, point.m_user.c_str(), point.m_password.c_str(), database, point.m_port, point.m_host.c_str(), unix_socket, point.m_flags);
+}
+
+
+//*********************************************************
+// 函数名称 : open_many
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 使用多个线程同时打开多个数据库连接, 并用 ping 检查连接是否可用
+// 访问方式 : public
+// 函数参数 : const endpoint & point 服务器参数
+// 函数参数 : size_t count 需要打开的连接数
+// 函数参数 : size_t threads 最多使用多少个线程
+// 返 回 值 : std::vector<connection> 已经连接成功的数据库连接
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+//            如果无法创建线程则抛出 std::system_error 异常
+//*********************************************************
+std::vector<sql::mariadb::connection> sql::mariadb::connection::open_many(const endpoint & point, size_t count, size_t threads)
+{
+	if (count == 0)
+	{
+		return std::vector<connection>();
+	}
+
+	// 在当前线程中调用 mysql_init, 避免多个线程同时初始化客户端库
+	std::vector<connection> connectors(count);
+	std::vector<char> opened(count, 0);
+	std::atomic<size_t> next(0);
+
+	auto worker = [&]()
+	{
+		mysql_thread_init();
+
+		for (auto i = next++; i < count; i = next++)
+		{
+			opened[i] = connectors[i] != nullptr && connectors[i].open(point) && connectors[i].ping();
+		}
+
+		mysql_thread_end();
+	};
+
+	const auto n = std::max<size_t>(1, std::min(threads, count)); // 线程数
+	std::vector<std::thread> workers;
+	workers.reserve(n);
+
+	try
+	{
+		while (workers.size() < n)
+		{
+			workers.emplace_back(worker);
+		}
+	}
+	catch (...)
+	{
+		// 已经创建的线程会完成所有连接
+		if (workers.empty())
+		{
+			throw;
+		}
+	}
+
+	for (auto &work : workers)
+	{
+		work.join();
+	}
+
+	std::vector<connection> result;
+	result.reserve(count);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (opened[i] != 0)
+		{
+			result.push_back(std::move(connectors[i]));
+		}
+	}
+
+	return result;
+}
+
+
+//*********************************************************
+// 函数名称 : ping
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 检查数据库连接是否可用
+// 访问方式 : public
+// 返 回 值 : bool 如果连接可用返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::connection::ping(void) const noexcept
+{
+	assert(m_ptr_mysql != nullptr);
+	return mysql_ping(m_ptr_mysql) == 0;
+}
+
+
+//*********************************************************
+// 函数名称 : reset
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 清除会话状态, 连接池在放回连接前调用; full 为 true 并且客户端库支持时
+//            使用 mysql_reset_connection 回滚事务并清除会话变量、用户变量、临时表和预处理语句,
+//            然后重新执行 point 中连接成功后执行的SQL语句; 否则只回滚还没有结束的事务
+// 访问方式 : private
+// 函数参数 : const endpoint & point 打开该连接时使用的服务器参数
+// 函数参数 : bool full 是否清除所有会话状态
+// 返 回 值 : bool 如果清除成功返回true; 反之返回false, 连接不应该再使用
+//*********************************************************
+bool sql::mariadb::connection::reset(const endpoint & point, bool full) const noexcept
+{
+	assert(m_ptr_mysql != nullptr);
+
+#if defined(MARIADB_PACKAGE_VERSION) || MYSQL_VERSION_ID >= 50703
+	if (full)
+	{
+		// 服务器保留连接时的字符集, 但是不会重新执行 MYSQL_INIT_COMMAND
+		if (mysql_reset_connection(m_ptr_mysql) == 0)
+		{
+			// 会话变量已经清除, 重新连接时不再恢复; 旧的预处理语句句柄已经失效
+			if (m_session != nullptr)
+			{
+				m_session->m_variables.clear();
+				++m_session->m_generation;
+			}
+
+			return point.m_options.restore(m_ptr_mysql);
+		}
+
+		// 旧版本的服务器不支持 COM_RESET_CONNECTION 时连接仍然可用, 只回滚事务
+		if (mysql_errno(m_ptr_mysql) != ER_UNKNOWN_COM_ERROR)
+		{
+			return false;
+		}
+	}
+#else
+	// 客户端库不支持 mysql_reset_connection
+	(void)point;
+	(void)full;
+#endif
+
+	return (m_ptr_mysql->server_status & SERVER_STATUS_IN_TRANS) == 0 || mysql_rollback(m_ptr_mysql) == 0;
+}
+
+
+//*********************************************************
+// 函数名称 : set_reconnect
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 启用自动重新连接
+// 访问方式 : public
+// 函数参数 : const reconnect_policy & policy 重新连接的策略
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+void sql::mariadb::connection::set_reconnect(const reconnect_policy & policy)
+{
+	if (m_session == nullptr)
+	{
+		m_session.reset(new session_state(policy));
+	}
+	else
+	{
+		m_session->m_policy = policy;
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : set_session_variable
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置会话变量, 启用自动重新连接时会在重新连接后恢复
+// 访问方式 : public
+// 函数参数 : const std::string & name 变量名
+// 函数参数 : const std::string & value 变量值, 会直接写入SQL语句, 字符串需要加上单引号
+// 返 回 值 : bool 如果设置成功返回true; 反之返回false
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+bool sql::mariadb::connection::set_session_variable(const std::string & name, const std::string & value) const
+{
+	assert(m_ptr_mysql != nullptr);
+
+	const auto text = "SET @@session." + name + " = " + value;
+
+	if (!command(*this).execute(text))
+	{
+		return false;
+	}
+
+	if (m_session != nullptr)
+	{
+		m_session->m_variables[name] = value;
+	}
+
+	return true;
+}
+
+
+//*********************************************************
+// 函数名称 : in_transaction
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 根据服务器最后一次返回的状态判断是否在事务中
+// 访问方式 : public
+// 返 回 值 : bool 如果在事务中返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::connection::in_transaction(void) const noexcept
+{
+	assert(m_ptr_mysql != nullptr);
+	return (m_ptr_mysql->server_status & SERVER_STATUS_IN_TRANS) != 0;
+}
+
+
+//*********************************************************
+// 函数名称 : autocommit
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 根据服务器最后一次返回的状态判断是否自动提交
+// 访问方式 : public
+// 返 回 值 : bool 如果自动提交返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::connection::autocommit(void) const noexcept
+{
+	assert(m_ptr_mysql != nullptr);
+	return (m_ptr_mysql->server_status & SERVER_STATUS_AUTOCOMMIT) != 0;
+}
+
+
+//*********************************************************
+// 函数名称 : thread_id
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取服务器上该连接的线程ID, 可以用于 KILL QUERY
+// 访问方式 : public
+// 返 回 值 : unsigned long 线程ID
+//*********************************************************
+unsigned long sql::mariadb::connection::thread_id(void) const noexcept
+{
+	assert(m_ptr_mysql != nullptr);
+	return mysql_thread_id(m_ptr_mysql);
+}
+
+
+//*********************************************************
+// 函数名称 : set_observer
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置观察者, 之后由该连接创建的 command 默认使用该观察者
+// 访问方式 : public
+// 函数参数 : statement_observer * observer 观察者, nullptr 代表不观察;
+//            观察者由调用者管理, 必须比使用它的 command 活得久
+//*********************************************************
+void sql::mariadb::connection::set_observer(statement_observer * observer) noexcept
+{
+	m_ptr_observer = observer;
+}
+
+
+//*********************************************************
+// 函数名称 : observer
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取观察者
+// 访问方式 : public
+// 返 回 值 : statement_observer * 观察者, 没有设置时返回 nullptr
+//*********************************************************
+sql::mariadb::statement_observer * sql::mariadb::connection::observer(void) const noexcept
+{
+	return m_ptr_observer;
+}
+
+
+//*********************************************************
+// 函数名称 : recordset
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 转移构造函数, 转移后原对象不应该使用
+// 访问方式 : private
+// 函数参数 : recordset && reader 需要转移的对象
+//*********************************************************
+sql::mariadb::recordset::recordset(recordset && reader) noexcept
+	: m_ptr_mysql(reader.m_ptr_mysql)
+	, m_ptr_res(reader.m_ptr_res)
+	, m_row(reader.m_row)
+	, m_more_results(reader.m_more_results)
+{
+	reader.m_ptr_mysql = nullptr;
+	reader.m_ptr_res = nullptr;
+	reader.m_row = nullptr;
+	reader.m_more_results = false;
+}
+
+
+//*********************************************************
+// 函数名称 : ~recordset
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 如果结果集没有释放关闭则在析构时自动关闭
+// 访问方式 : public
+//*********************************************************
+sql::mariadb::recordset::~recordset(void) noexcept
+{
+	if (m_ptr_res != nullptr)
+	{
+		mysql_free_result(m_ptr_res);
+	}
+
+	this->discard_results();
+}
+
+
+//*********************************************************
+// 函数名称 : operator!=
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 判断数据库连接器是否创建成功
+// 访问方式 : public
+// 函数参数 : std::nullptr_t null 与nullptr作比较
+// 返 回 值 : bool 如果创建成功则 对象 != nullptr;
+//            反之 对象 == nullptr
+//*********************************************************
+bool sql::mariadb::recordset::operator!=(std::nullptr_t null) const noexcept
+{
+	return m_ptr_res != null;
+}
+
+
+//*********************************************************
+// 函数名称 : operator==
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 判断数据库连接器是否创建成功
+// 访问方式 : public
+// 函数参数 : std::nullptr_t null  与nullptr作比较
+// 返 回 值 : bool 如果创建成功则 对象 != nullptr;
+//            反之 对象 == nullptr
+//*********************************************************
+bool sql::mariadb::recordset::operator==(std::nullptr_t null) const noexcept
+{
+	return m_ptr_res == null;
+}
+
+
+//*********************************************************
+// 函数名称 : close
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 释放结果集所占用的资源, 如果不手动释放资源, 则析构时自动释放
+// 访问方式 : public
+//*********************************************************
+void sql::mariadb::recordset::close(void) noexcept
+{
+	if (m_ptr_res != nullptr)
+	{
+		mysql_free_result(m_ptr_res);
+		m_ptr_res = nullptr;
+	}
+
+	this->discard_results();
+	m_ptr_mysql = nullptr;
+}
+
+
+//*********************************************************
+// 函数名称 : error
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 获取数据库操作失败的错误信息
+// 访问方式 : public
+// 返 回 值 : std::string 错误信息
+//*********************************************************
+std::string sql::mariadb::recordset::error(void) const noexcept
+try
+{
+	return std::string(mysql_error(m_ptr_mysql));
+}
+catch (const std::exception &)
+{
+	return std::string();
+}
+
+
+//*********************************************************
+// 函数名称 : errorno
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 获取数据库操作失败的错误代号
+// 访问方式 : public
+// 返 回 值 : unsigned int 错误代号
+//*********************************************************
+unsigned int sql::mariadb::recordset::errorno(void) const noexcept
+{
+	return mysql_errno(m_ptr_mysql);
+}
+
+
+//*********************************************************
+// 函数名称 : row_count
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 获取数据的行数
+// 访问方式 : public
+// 返 回 值 : unsigned long long 行数
+//*********************************************************
+unsigned long long sql::mariadb::recordset::row_count(void) const noexcept
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	return mysql_num_rows(m_ptr_res);
+}
+
+
+//*********************************************************
+// 函数名称 : field_count
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 获取数据的列数(字段数量)
+// 访问方式 : public
+// 返 回 值 : unsigned long 列数(字段数量)
+//*********************************************************
+unsigned long sql::mariadb::recordset::field_count(void) const noexcept
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	return mysql_num_fields(m_ptr_res);
+}
+
+
+//*********************************************************
+// 函数名称 : data_size
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 获取单条数据的长度
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置; 如果超出数据的列数则可能出现数组越界的问题
+// 返 回 值 : unsigned long 单条数据的字节数
+//*********************************************************
+unsigned long sql::mariadb::recordset::data_size(unsigned long n) const noexcept
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return mysql_fetch_lengths(m_ptr_res)[n];
+}
+
+
+//*********************************************************
+// 函数名称 : field_index
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 根据列名获取列位置
+// 访问方式 : public
+// 函数参数 : const char * name 列名
+// 返 回 值 : unsigned long 列位置; 如果没有该列则返回 field_count()
+//*********************************************************
+unsigned long sql::mariadb::recordset::field_index(const char * name) const noexcept
+{
+	assert(m_ptr_res != nullptr);
+	assert(name != nullptr);
+
+	const auto count = mysql_num_fields(m_ptr_res);
+	const auto fields = mysql_fetch_fields(m_ptr_res);
+
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		if (std::strcmp(fields[i].name, name) == 0)
+		{
+			return i;
+		}
+	}
+
+	return count;
+}
+
+
+//*********************************************************
+// 函数名称 : is_null
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 判断当前行的数据是否为 NULL
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : bool 如果是 NULL 返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::recordset::is_null(unsigned long n) const noexcept
+{
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return m_row[n] == nullptr;
+}
+
+
+//*********************************************************
+// 函数名称 : read
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 读取下一条数据
+// 访问方式 : public
+// 返 回 值 : bool 成功返回true, 失败返回false
+//*********************************************************
+bool sql::mariadb::recordset::read(void) noexcept
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	m_row = mysql_fetch_row(m_ptr_res);
+	return m_row != nullptr;
+}
+
+
+//*********************************************************
+// 函数名称 : next_result
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 释放当前结果集并切换到下一条SQL语句的结果集
+// 访问方式 : public
+// 返 回 值 : bool 如果切换成功返回true; 如果没有下一个结果集或者
+//            下一条SQL语句执行失败则返回false, 失败时 errorno 不为 0
+//*********************************************************
+bool sql::mariadb::recordset::next_result(void) noexcept
+{
+	assert(m_ptr_mysql != nullptr);
+
+	if (m_ptr_res != nullptr)
+	{
+		mysql_free_result(m_ptr_res);
+		m_ptr_res = nullptr;
+	}
+	m_row = nullptr;
+
+	// mysql_next_result 返回 0 代表成功, -1 代表没有结果集, 大于 0 代表失败
+	if (!m_more_results || mysql_next_result(m_ptr_mysql) != 0)
+	{
+		m_more_results = false;
+		return false;
+	}
+
+	m_ptr_res = store_result(m_ptr_mysql);
+	m_more_results = mysql_more_results(m_ptr_mysql) != 0;
+	return true;
+}
+
+
+//*********************************************************
+// 函数名称 : affected_rows
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取当前结果集所对应的SQL语句所影响的行数
+// 访问方式 : public
+// 返 回 值 : unsigned long long 影响的行数
+//*********************************************************
+unsigned long long sql::mariadb::recordset::affected_rows(void) const noexcept
+{
+	assert(m_ptr_mysql != nullptr);
+	return mysql_affected_rows(m_ptr_mysql);
+}
+
+
+//*********************************************************
+// 函数名称 : get_char
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 获取数据, 并将数据强制转换成 char 类型
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : char 数据
+//*********************************************************
+char sql::mariadb::recordset::get_char(unsigned long n) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return m_row[n][0];
+}
+
+
+//*********************************************************
+// 函数名称 : get_udata
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 获取数据, 并将数据用 std::vector<unsigned char> 对象保存
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : std::vector<unsigned char> 数据
+// 异    常 : 如果 std::vector 创建失败时抛出异常
+//*********************************************************
+std::vector<unsigned char> sql::mariadb::recordset::get_udata(unsigned long n) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return std::vector<unsigned char>(m_row[n], m_row[n] + this->data_size(n));
+}
+
+
+//*********************************************************
+// 函数名称 : get_udata_ptr
+// 作    者 : Gooeen
+// 完成日期 : 2016/05/09
+// 函数说明 : 获取数据, 并将数据用 std::vector<unsigned char> 对象保存
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : std::shared_ptr<std::vector<unsigned char>> 数据
+// 异    常 : 如果 std::vector 创建失败时抛出异常
+//*********************************************************
+std::shared_ptr<std::vector<unsigned char>> sql::mariadb::recordset::get_udata_ptr(unsigned long n) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return std::make_shared<std::vector<unsigned char>>(m_row[n], m_row[n] + this->data_size(n));
+}
+
+
+//*********************************************************
+// 函数名称 : get_data
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 获取数据, 并将数据用 std::vector<char> 对象保存
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : std::vector<char> 数据
+// 异    常 : 如果 std::vector 创建失败时抛出异常
+//*********************************************************
+std::vector<char> sql::mariadb::recordset::get_data(unsigned long n) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return std::vector<char>(m_row[n], m_row[n] + this->data_size(n));
+}
+
+
+//*********************************************************
+// 函数名称 : get_data_ptr
+// 作    者 : Gooeen
+// 完成日期 : 2016/05/09
+// 函数说明 : 获取数据, 并将数据用 std::vector<char> 对象保存
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : std::shared_ptr<std::vector<char>> 数据
+// 异    常 : 如果 std::vector 创建失败时抛出异常
+//*********************************************************
+std::shared_ptr<std::vector<char>> sql::mariadb::recordset::get_data_ptr(unsigned long n) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return std::make_shared<std::vector<char>>(m_row[n], m_row[n] + this->data_size(n));
+}
+
+
+//*********************************************************
+// 函数名称 : get_double
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 获取数据, 并将数据转换成 double 类型
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : double 数据
+//*********************************************************
+double sql::mariadb::recordset::get_double(unsigned long n) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return std::atof(m_row[n]);
+}
+
+
+//*********************************************************
+// 函数名称 : get_float
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 获取数据, 并将数据转换成 float 类型
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : float 数据
+//*********************************************************
+float sql::mariadb::recordset::get_float(unsigned long n) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return (float)std::atof(m_row[n]);
+}
+
+
+//*********************************************************
+// 函数名称 : get_int
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 获取数据, 并将数据转换成 int 类型
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : int 数据
+//*********************************************************
+int sql::mariadb::recordset::get_int(unsigned long n) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return std::atoi(m_row[n]);
+}
+
+
+//*********************************************************
+// 函数名称 : get_long
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 获取数据, 并将数据转换成 long 类型
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : long 数据
+//*********************************************************
+long sql::mariadb::recordset::get_long(unsigned long n) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return std::atol(m_row[n]);
+}
+
+
+//*********************************************************
+// 函数名称 : get_longlong
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 获取数据, 并将数据转换成 long long 类型
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : long long 数据
+//*********************************************************
+long long sql::mariadb::recordset::get_longlong(unsigned long n) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return std::atoll(m_row[n]);
+}
+
+
+//*********************************************************
+// 函数名称 : get_short
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 获取数据, 并将数据转换成 short 类型
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : short 数据
+//*********************************************************
+short sql::mariadb::recordset::get_short(unsigned long n) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return (short)std::atoi(m_row[n]);
+}
+
+
+//*********************************************************
+// 函数名称 : get_string
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 获取数据
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : std::string 数据
+// 异    常 : 如果数据长度 (length) 超过字符串最大长度(max_size)
+//            则抛出 std::length_error 异常;
+//            如果尝试分配空间失败则抛出 std::bad_alloc 异常
+//*********************************************************
+std::string sql::mariadb::recordset::get_string(unsigned long n) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return std::string(m_row[n]);
+}
+
+
+//*********************************************************
+// 函数名称 : get_string_ptr
+// 作    者 : Gooeen
+// 完成日期 : 2016/05/09
+// 函数说明 : 获取数据
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : std::shared_ptr<std::string> 数据
+// 异    常 : 如果数据长度 (length) 超过字符串最大长度(max_size)
+//            则抛出 std::length_error 异常;
+//            如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+std::shared_ptr<std::string> sql::mariadb::recordset::get_string_ptr(unsigned long n) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return std::make_shared<std::string>(m_row[n]);
+}
+
+
+//*********************************************************
+// 函数名称 : get_uchar
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 获取数据, 并将数据强制转换成 unsigned char 类型
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : unsigned char 数据
+//*********************************************************
+unsigned char sql::mariadb::recordset::get_uchar(unsigned long n) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return (unsigned char)m_row[n][0];
+}
+
+
+//*********************************************************
+// 函数名称 : get_uint
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/13
+// 函数说明 : 获取数据, 并将数据转换成 unsigned int 类型
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : unsigned int 数据
+// 异    常 : 如果强制转换失败, 则抛出 std::invalid_argument 异常;
+//            如果数据值大于 unsigned int 的取值范围, 则抛出 std::out_of_range 异常
+//*********************************************************
+unsigned int sql::mariadb::recordset::get_uint(unsigned long n) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return (unsigned int)std::stoul(m_row[n]);
+}
+
+
+//*********************************************************
+// 函数名称 : get_ulong
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/15
+// 函数说明 : 获取数据, 并将数据转换成 unsigned long 类型
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : unsigned long 数据
+// 异    常 : 如果强制转换失败, 则抛出 std::invalid_argument 异常;
+//            如果数据值大于 unsigned long 的取值范围, 则抛出 std::out_of_range 异常
+//*********************************************************
+unsigned long sql::mariadb::recordset::get_ulong(unsigned long n) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return std::stoul(m_row[n]);
+}
+
+
+//*********************************************************
+// 函数名称 : get_ulonglong
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/15
+// 函数说明 : 获取数据, 并将数据转换成 unsigned long long 类型
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : unsigned long long 数据
+// 异    常 : 如果强制转换失败, 则抛出 std::invalid_argument 异常;
+//            如果数据值大于 unsigned long long 的取值范围, 则抛出 std::out_of_range 异常
+//*********************************************************
+unsigned long long sql::mariadb::recordset::get_ulonglong(unsigned long n) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return std::stoull(m_row[n]);
+}
+
+
+//*********************************************************
+// 函数名称 : get_ushort
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/15
+// 函数说明 : 获取数据, 并将数据转换成 unsigned short 类型
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : unsigned short 数据
+//*********************************************************
+unsigned short sql::mariadb::recordset::get_ushort(unsigned long n) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return (unsigned short)std::atoi(m_row[n]);
+}
+
+
+//*********************************************************
+// 函数名称 : get_wchar
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/15
+// 函数说明 : 获取数据, 并将数据强制转换成 wchar_t 类型
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : wchar_t 数据
+//*********************************************************
+wchar_t sql::mariadb::recordset::get_wchar(unsigned long n) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return *((wchar_t *)m_row[n]);
+}
+
+
+//*********************************************************
+// 函数名称 : get_wstring
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/15
+// 函数说明 : 获取数据, 并将数据强制转换成 std::wstring 类型
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : std::wstring 数据
+//*********************************************************
+std::wstring sql::mariadb::recordset::get_wstring(unsigned long n) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return std::wstring((wchar_t *)m_row[n], mysql_fetch_lengths(m_ptr_res)[n] / 2);
+}
+
+
+//*********************************************************
+// 函数名称 : get_wstring_ptr
+// 作    者 : Gooeen
+// 完成日期 : 2015/05/09
+// 函数说明 : 获取数据, 并将数据强制转换成 std::wstring 类型
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : std::shared_ptr<std::wstring> 数据
+//*********************************************************
+std::shared_ptr<std::wstring> sql::mariadb::recordset::get_wstring_ptr(unsigned long n) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return std::make_shared<std::wstring>((wchar_t *)m_row[n], mysql_fetch_lengths(m_ptr_res)[n] / 2);
+}
+
+
+//*********************************************************
+// 函数名称 : get_raw
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/15
+// 函数说明 : 不进行转换, 直接获取从数据库返回的数据
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : const char * 数据
+//*********************************************************
+const char * sql::mariadb::recordset::get_raw(unsigned long n) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return m_row[n];
+}
+
+
+//*********************************************************
+// 函数名称 : get_bool
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/15
+// 函数说明 : 获取数据, 并将数据强制转换成 bool 类型
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : bool 数据
+//*********************************************************
+bool sql::mariadb::recordset::get_bool(unsigned long n) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(m_ptr_res != nullptr);
+	assert(m_row != nullptr);
+	assert(n < mysql_num_fields(m_ptr_res));
+	return (*m_row[n]) - '0' != 0;
+}
+
+
+//*********************************************************
+// 函数名称 : recordset
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/15
+// 函数说明 : 由 command 类对象创建 recordset 类对象
+// 访问方式 : private
+// 函数参数 : MYSQL * pointer 数据库句柄
+//*********************************************************
+sql::mariadb::recordset::recordset(MYSQL * pointer) noexcept
+	: m_ptr_mysql(pointer)
+	, m_ptr_res(store_result(pointer))
+	, m_row(nullptr)
+	, m_more_results(mysql_more_results(pointer) != 0)
+{
+	if (m_ptr_res != nullptr && query_stats::enabled())
+	{
+		query_stats::add_rows(pointer, mysql_num_rows(m_ptr_res));
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : discard_results
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 丢弃还没有读取的结果集, 使数据库连接可以继续执行SQL语句
+// 访问方式 : private
+//*********************************************************
+void sql::mariadb::recordset::discard_results(void) noexcept
+{
+	while (m_more_results && mysql_next_result(m_ptr_mysql) == 0)
+	{
+		const auto result = mysql_store_result(m_ptr_mysql);
+		if (result != nullptr)
+		{
+			mysql_free_result(result);
+		}
+		m_more_results = mysql_more_results(m_ptr_mysql) != 0;
+	}
+	m_more_results = false;
+}
+
+
+//*********************************************************
+// 函数名称 : command
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/15
+// 函数说明 : 转移构造函数, 转移后原对象不应该使用
+// 访问方式 : public
+// 函数参数 : command && executor 需要转移的对象
+//*********************************************************
+sql::mariadb::command::command(command && executor) noexcept
+	: m_ptr_mysql(executor.m_ptr_mysql)
+	, m_ptr_session(executor.m_ptr_session)
+	, m_idempotent(executor.m_idempotent)
+	, m_timeout(executor.m_timeout)
+	, m_ptr_endpoint(executor.m_ptr_endpoint)
+	, m_timed_out(executor.m_timed_out)
+	, m_ptr_observer(executor.m_ptr_observer)
+	, m_parameter_count(executor.m_parameter_count)
+	, m_observing(executor.m_observing)
+	, m_observe_start(executor.m_observe_start)
+	, m_event(std::move(executor.m_event))
+	, m_text(std::move(executor.m_text))
+	, m_strings(std::move(executor.m_strings))
+	, m_datas(std::move(executor.m_datas))
+	, m_udatas(std::move(executor.m_udatas))
+	, m_parameters(std::move(executor.m_parameters))
+{
+	executor.m_ptr_mysql = nullptr;
+	executor.m_observing = false;
+}
+
+
+//*********************************************************
+// 函数名称 : ~command
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 析构函数, 结束还没有结束的观察
+// 访问方式 : public
+//*********************************************************
+sql::mariadb::command::~command(void) noexcept
+{
+	if (m_observing)
+	{
+		this->end_observe(0, 0);
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : command
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/15
+// 函数说明 : 构造函数
+// 访问方式 : public
+// 函数参数 : const connection & connector 数据库连接类
+//*********************************************************
+sql::mariadb::command::command(const connection & connector) noexcept
+	: m_ptr_mysql(connector.m_ptr_mysql)
+	, m_ptr_session(connector.m_session.get())
+	, m_idempotent(false)
+	, m_timeout(0)
+	, m_ptr_endpoint(nullptr)
+	, m_timed_out(false)
+	, m_ptr_observer(connector.m_ptr_observer)
+	, m_parameter_count(0)
+	, m_observing(false)
+	, m_event()
+{
+}
+
+
+//*********************************************************
+// 函数名称 : command
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/15
+// 函数说明 : 构造函数
+// 访问方式 : public
+// 函数参数 : const connection & connector 数据库连接类
+// 函数参数 : const std::string & text SQL语句
+// 异    常 : 如果尝试分配空间失败则抛出 std::bad_alloc 异常
+//*********************************************************
+sql::mariadb::command::command(const connection & connector, const std::string & text)
+	: command(connector, std::string(text))
+{
+}
+
+
+//*********************************************************
+// 函数名称 : command
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/15
+// 函数说明 : 构造函数
+// 访问方式 : public
+// 函数参数 : const connection & connector 数据库连接类
+// 函数参数 : std::string && text SQL语句
+//*********************************************************
+sql::mariadb::command::command(const connection & connector, std::string && text) noexcept
+	: m_ptr_mysql(connector.m_ptr_mysql)
+	, m_ptr_session(connector.m_session.get())
+	, m_idempotent(false)
+	, m_timeout(0)
+	, m_ptr_endpoint(nullptr)
+	, m_timed_out(false)
+	, m_ptr_observer(connector.m_ptr_observer)
+	, m_parameter_count(0)
+	, m_observing(false)
+	, m_event()
+	, m_text(std::move(text))
+{
+}
+
+
+//*********************************************************
+// 函数名称 : error
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/15
+// 函数说明 : 获取数据库操作失败的错误信息
+// 访问方式 : public 
+// 函数参数 : void
+// 返 回 值 : std::string 错误信息
+//*********************************************************
+std::string sql::mariadb::command::error(void) const noexcept
+try
+{
+	return std::string(mysql_error(m_ptr_mysql));
+}
+catch (const std::exception &)
+{
+	return std::string();
+}
+
+
+//*********************************************************
+// 函数名称 : errorno
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/15
+// 函数说明 : 获取数据库操作失败的错误代号
+// 访问方式 : public
+// 返 回 值 : unsigned int 错误代号
+//*********************************************************
+unsigned int sql::mariadb::command::errorno(void) const noexcept
+{
+	return mysql_errno(m_ptr_mysql);
+}
+
+
+//*********************************************************
+// 函数名称 : prepare
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/15
+// 函数说明 : 预存SQL语句; 可使用以下例子防注入
+//            executer.prepare("select * from table where id = ?");
+//            executer.add(12);
+// 访问方式 : public
+// 函数参数 : std::string && text
+// 返 回 值 : void
+//*********************************************************
+void sql::mariadb::command::prepare(std::string && text) noexcept
+{
+	m_text = std::move(text);
+}
+
+
+//*********************************************************
+// 函数名称 : prepare
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/15
+// 函数说明 : 预存SQL语句; 可使用以下例子防注入
+// 访问方式 : public
+// 函数参数 : const std::string & text SQL语句
+// 返 回 值 : void
+// 异    常 : 如果尝试分配空间失败则抛出 std::bad_alloc 异常
+//*********************************************************
+void sql::mariadb::command::prepare(const std::string & text)
+{
+	m_text = text;
+}
+
+
+//*********************************************************
+// 函数名称 : add
+// 作    者 : Gooeen
+// 完成日期 : 2016/05/12
+// 函数说明 : 添加数据, 执行SQL语句时将本次添加的数据用单引
+//            号引起后代替SQL语句中第 pos 个问号; 例子如下:
+//            executer.prepare("insert into table1 values(?, ?)");
+//            executer.add(0, 12);
+//            executer.add(1, std::make_shared<std::string>("data"));
+//            在执行SQL语句时将产生 SQL语句:
+//            insert into table1 values(12, 'data')
+// 访问方式 : public
+// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
+// 函数参数 : std::shared_ptr<std::string> &&text 数据, 此数据在SQL语句中将以单引号引用
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+void sql::mariadb::command::add(unsigned int pos, std::shared_ptr<std::string> &&text)
+{
+	// 保存字符串
+	m_strings.push_back(std::move(text));
+
+	// 保存数据的信息
+	const auto p = m_strings.back()->c_str();
+	const auto size = (unsigned long)m_strings.back()->size();
+	const auto pair = std::make_pair(p, size);
+	m_parameters[pos] = std::make_pair(false, pair);
+}
+
+
+//*********************************************************
+// 函数名称 : add
+// 作    者 : Gooeen
+// 完成日期 : 2016/05/12
+// 函数说明 : 添加数据, 执行SQL语句时将本次添加的数据用单引
+//            号引起后代替SQL语句中第 pos 个问号; 例子如下:
+//            executer.prepare("insert into table1 values(?, ?)");
+//            executer.add(0, 12);
+//            executer.add(1, std::make_shared<std::string>("data"));
+//            在执行SQL语句时将产生 SQL语句:
+//            insert into table1 values(12, 'data')
+// 访问方式 : public
+// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
+// 函数参数 : const std::shared_ptr<std::string> &text 数据, 此数据在SQL语句中将以单引号引用
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+void sql::mariadb::command::add(unsigned int pos, const std::shared_ptr<std::string> &text)
+{
+	// 保存字符串
+	m_strings.push_back(text);
+
+	// 保存数据的信息
+	const auto p = m_strings.back()->c_str();
+	const auto size = (unsigned long)m_strings.back()->size();
+	const auto pair = std::make_pair(p, size);
+	m_parameters[pos] = std::make_pair(false, pair);
+}
+
+
+//*********************************************************
+// 函数名称 : add
+// 作    者 : Gooeen
+// 完成日期 : 2016/05/17
+// 函数说明 : 添加数据, 执行SQL语句时将本次添加的数据用单引
+//            号引起后代替SQL语句中第 pos 个问号; 例子如下:
+//            executer.prepare("insert into table1 values(?, ?)");
+//            executer.add(0, 12);
+//            executer.add(1, "data");
+//            在执行SQL语句时将产生 SQL语句:
+//            insert into table1 values(12, 'data')
+// 访问方式 : public
+// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
+// 函数参数 : std::string text 数据, 此数据在SQL语句中将以单引号引用
+// 返 回 值 : void
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+void sql::mariadb::command::add(unsigned int pos, std::string text)
+{
+	this->add(pos, std::make_shared<std::string>(std::move(text)));
+}
+
+
+//*********************************************************
+// 函数名称 : add
+// 作    者 : Gooeen
+// 完成日期 : 2016/05/17
+// 函数说明 : 添加数据, 执行SQL语句时将本次添加的数据用单引
+//            号引起后代替SQL语句中第 pos 个问号; 例子如下:
+//            executer.prepare("insert into table1 values(?, ?)");
+//            executer.add(0, 12);
+//            executer.add(1, std::vector<char>({'H', 'e', 'l', 'l', 'o'}));
+//            在执行SQL语句时将产生 SQL语句:
+//            insert into table1 values(12, 'Hello')
+// 访问方式 : public
+// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
+// 函数参数 : std::vector<char> data 数据, 此数据在SQL语句中将以单引号引用
+// 返 回 值 : void
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+void sql::mariadb::command::add(unsigned int pos, std::vector<char> data)
+{
+	// 保存数据
+	m_datas.push_back(std::make_shared<std::vector<char>>(std::move(data)));
+
+	// 保存数据的信息
+	const auto p = m_datas.back()->data();
+	const auto size = (unsigned long)m_datas.back()->size();
+	const auto pair = std::make_pair(p, size);
+	m_parameters[pos] = std::make_pair(false, pair);
+}
+
+
+//*********************************************************
+// 函数名称 : add
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/16
+// 函数说明 : 添加数据, 执行SQL语句时将本次添加的数据用单引
+//            号引起后代替SQL语句中第 pos 个问号; 例子如下:
+//            executer.prepare("insert into table1 values(?, ?)");
+//            executer.add(0, 12);
+//            executer.add(1, std::vector<unsigned char>({'H', 'e', 'l', 'l', 'o'}));
+//            在执行SQL语句时将产生 SQL语句:
+//            insert into table1 values(12, 'data')
+// 访问方式 : public
+// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
+// 函数参数 : std::vector<unsigned char> data 数据, 此数据在SQL语句中将以单引号引用
+// 返 回 值 : void
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+void sql::mariadb::command::add(unsigned int pos, std::vector<unsigned char> data)
+{
+	// 保存数据
+	m_udatas.push_back(std::make_shared<std::vector<unsigned char>>(std::move(data)));
+
+	// 保存数据的信息
+	const auto p = (char *)m_udatas.back()->data();
+	const auto size = (unsigned long)m_udatas.back()->size();
+	const auto pair = std::make_pair(p, size);
+	m_parameters[pos] = std::make_pair(false, pair);
+}
+
+
+//*********************************************************
+// 函数名称 : escape
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/16
+// 函数说明 : 转换数据并保存到 to 参数所指向的缓冲区
+// 访问方式 : public
+// 函数参数 : char * to 保存转换后的字符串的缓冲区, 缓冲区大小应该比 (size * 2 + 1) 大
+// 函数参数 : const char * from 需要转换的字符串
+// 函数参数 : unsigned long size from 的长度
+// 返 回 值 : unsigned long 转换的字节数
+//*********************************************************
+unsigned long sql::mariadb::command::escape(char * to, const char * from, unsigned long size) const noexcept
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(to != nullptr);
+	assert(from != nullptr);
+	return mysql_real_escape_string(m_ptr_mysql, to, from, size);
+}
+
+
+//*********************************************************
+// 函数名称 : escape
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/16
+// 函数说明 : 转换数据并保存到字符串对象中
+// 访问方式 : public
+// 函数参数 : const char * data 需要转换的数据
+// 函数参数 : unsigned long size 需要转换的数据的长度
+// 返 回 值 : std::string 转换后的字符串
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+//            如果执行失败则抛出 std::exception 异常
+//*********************************************************
+std::string sql::mariadb::command::escape(const char * data, unsigned long size) const
+{
+	auto buffer = this->escape_buffer(data, size);
+	return std::string(buffer.begin(), buffer.end());
+}
+
+
+//*********************************************************
+// 函数名称 : escape_with_quote
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/16
+// 函数说明 : 转换数据并以单引号引用保存到字符串对象中
+// 访问方式 : public
+// 函数参数 : const char * data 需要转换的数据
+// 函数参数 : unsigned long size 需要转换的数据的长度
+// 返 回 值 : std::string 转换后的字符串
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+//            如果执行失败则抛出 std::exception 异常
+//*********************************************************
+std::string sql::mariadb::command::escape_with_quote(const char * data, unsigned long size) const
+{
+	auto buffer = this->escape_buffer_with_quote(data, size);
+	return std::string(buffer.begin(), buffer.end());
+}
+
+
+//*********************************************************
+// 函数名称 : escape_buffer
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/16
+// 函数说明 : 转换数据并保存到 std::vector<char> 类型的缓冲区中
+// 访问方式 : public
+// 函数参数 : const char * data 需要转换的数据
+// 函数参数 : unsigned long size 需要转换的数据的长度
+// 返 回 值 : std::vector<char> 保存转换后的数据的缓冲区
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+//            如果执行失败则抛出 std::exception 异常
+//*********************************************************
+std::vector<char> sql::mariadb::command::escape_buffer(const char * data, unsigned long size) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(data != nullptr);
+
+	std::vector<char> buffer(size * 2 + 1);
+	auto n = mysql_real_escape_string(m_ptr_mysql, buffer.data(), data, size);
+	buffer.resize(n);
+
+	return buffer;
+}
+
+
+//*********************************************************
+// 函数名称 : escape_buffer_with_quote
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/16
+// 函数说明 : 转换数据并并以单引号引用保存到 std::vector<char> 类型的缓冲区中
+// 访问方式 : public
+// 函数参数 : const char * data 需要转换的数据
+// 函数参数 : unsigned long size 需要转换的数据的长度
+// 返 回 值 : std::vector<char> 保存转换后的数据的缓冲区
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+//            如果执行失败则抛出 std::exception 异常
+//*********************************************************
+std::vector<char> sql::mariadb::command::escape_buffer_with_quote(const char * data, unsigned long size) const
+{
+	assert(m_ptr_mysql != nullptr);
+	assert(data != nullptr);
+
+	std::vector<char> buffer(size * 2 + 1 + 2);
+	auto n = mysql_real_escape_string(m_ptr_mysql, buffer.data() + 1, data, size);
+	buffer.resize(n + 2);
+	buffer.front() = '\'';
+	buffer.back() = '\'';
+	return buffer;
+}
+
+
+//*********************************************************
+// 函数名称 : execute
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/16
+// 函数说明 : 执行SQL语句, 如果返回结果集则读取后丢弃
+// 访问方式 : public
+// 函数参数 : const char * text SQL语句
+// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::command::execute(const char * text) const noexcept
+{
+	assert(m_ptr_mysql != nullptr);
+	return this->complete_query(text, (unsigned long)std::strlen(text));
+}
+
+
+//*********************************************************
+// 函数名称 : execute
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/16
+// 函数说明 : 执行SQL语句, 如果返回结果集则读取后丢弃
+// 访问方式 : public
+// 函数参数 : const char * text SQL语句
+// 函数参数 : unsigned long length SQL语句字符串长度
+// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::command::execute(const char * text, unsigned long length) const noexcept
+{
+	assert(m_ptr_mysql != nullptr);
+	return this->complete_query(text, length);
+}
+
+
+//*********************************************************
+// 函数名称 : execute
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/16
+// 函数说明 : 执行SQL语句, 如果返回结果集则读取后丢弃
+// 访问方式 : public
+// 函数参数 : const std::string & text SQL语句
+// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::command::execute(const std::string & text) const noexcept
+{
+	assert(m_ptr_mysql != nullptr);
+	return this->complete_query(text.c_str(), (unsigned long)text.size());
+}
+
+
+//*********************************************************
+// 函数名称 : execute
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/16
+// 函数说明 : 执行SQL语句, 如果返回结果集则读取后丢弃
+// 访问方式 : public
+// 函数参数 : const std::vector<char> & data SQL语句
+// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::command::execute(const std::vector<char>& data) const noexcept
+{
+	assert(m_ptr_mysql != nullptr);
+	return this->complete_query(data.data(), (unsigned long)data.size());
+}
+
+
+//*********************************************************
+// 函数名称 : execute
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/16
+// 函数说明 : 执行SQL语句, 如果返回结果集则读取后丢弃
+// 访问方式 : public
+// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+//            如果生成SQL语句失败则抛出 std::exception 异常
+//*********************************************************
+bool sql::mariadb::command::execute(void) const
+{
+	assert(m_ptr_mysql != nullptr);
+
+	const auto statement = this->make_statement();
+	return this->complete_query(statement.data(), (unsigned long)statement.size());
+}
+
+
+//*********************************************************
+// 函数名称 : make_statement
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 用添加的数据代替SQL语句中的问号, 生成需要执行的SQL语句
+// 访问方式 : private
+// 返 回 值 : std::vector<char> 生成的SQL语句
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+//            如果生成SQL语句失败则抛出 std::exception 异常
+//*********************************************************
+std::vector<char> sql::mariadb::command::make_statement(void) const
+{
+	assert(!m_text.empty());
+
+	unsigned long size = 0; // 保存数据的总字节数, 用于开辟缓冲区
+
+	// 遍历数据, 求出数据的总字节数
+	for (const auto &parameter : m_parameters)
+	{
+		const auto isnum = parameter.second.first; // 数据是否一个数
+		const auto count = parameter.second.second.second; // 数据大小
+
+		// 如果不是一个数, 则额外加上两个单引号的长度
+		size += isnum ? count : count + 2;
+	}
+
+	// 用于保存生成的SQL语句
+	std::vector<char> statement;
+	statement.reserve(m_text.size() + (size * 2 + m_parameters.size()));
+
+	// 保存原SQL语句中遍历到 '?' 的个数
+	unsigned int mark_count = 0;
+
+	// 生成SQL语句
+	for (auto ch : m_text)
+	{
+		// 如果字符不是问号, 则直接添加该字符到新语句的结尾
+		if (ch != '?')
+		{
+			statement.push_back(ch);
+		}
+		else // 如果字符是问号
+		{
+			const auto &parameter = m_parameters.at(mark_count); // 数据
+			const auto isnum = parameter.first; // 数据是否一个数
+			const auto start = parameter.second.first; // 数据开始位置
+			const auto length = parameter.second.second; // 数据大小
+
+			// 如果参数是一个数, 则直接复制数据
+			if (isnum)
+			{
+				const auto count = statement.size(); // 保存此时容器大小
+				statement.resize(count + length); // 扩充容量
+				const auto pointer = statement.data() + count; // 复制的开始位置
+				memcpy(pointer, start, length); // 复制数据
+			}
+			else // 如果参数是字符串或者数据, 则转换数据并添加单引号
+			{
+				statement.push_back('\''); // 添加单引号
+
+				const auto count = statement.size(); // 保存此时容器大小
+				statement.resize(count + (length * 2 + 1)); // 扩充容量
+				const auto pointer = statement.data() + count; // 复制的开始位置
+				statement.resize(count + this->escape(pointer, start, length));
+
+				statement.push_back('\''); // 添加单引号
+			}
+
+			++mark_count; // 增加一个问号的个数
+		}
+	}
+
+	m_parameter_count = mark_count;
+	return statement;
+}
+
+
+//*********************************************************
+// 函数名称 : execute_reader
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/16
+// 函数说明 : 执行SQL语句
+// 访问方式 : public
+// 函数参数 : const char * text SQL语句
+// 返 回 值 : sql::mariadb::recordset 结果集
+// 异    常 : 如果执行SQL失败则抛出 mariadb_exception 异常
+//*********************************************************
+sql::mariadb::recordset sql::mariadb::command::execute_reader(const char * text) const
+{
+	if_false_throw_timeout(this->real_query(text, (unsigned long)std::strlen(text)), text);
+	return this->open_reader();
+}
+
+
+//*********************************************************
+// 函数名称 : execute_reader
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/16
+// 函数说明 : 执行SQL语句
+// 访问方式 : public
+// 函数参数 : const char * text SQL语句
+// 函数参数 : unsigned long length text的字节数
+// 返 回 值 : sql::mariadb::recordset 结果集
+// 异    常 : 如果执行SQL失败则抛出 mariadb_exception 异常
+//*********************************************************
+sql::mariadb::recordset sql::mariadb::command::execute_reader(const char * text, unsigned long length) const
+{
+	if_false_throw_timeout(this->real_query(text, length), std::string(text, length));
+	return this->open_reader();
+}
+
+
+//*********************************************************
+// 函数名称 : execute_reader
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/16
+// 函数说明 : 执行SQL语句
+// 访问方式 : public
+// 函数参数 : const std::string & text SQL语句
+// 返 回 值 : sql::mariadb::recordset 结果集
+// 异    常 : 如果执行SQL失败则抛出 mariadb_exception 异常
+//*********************************************************
+sql::mariadb::recordset sql::mariadb::command::execute_reader(const std::string & text) const
+{
+	if_false_throw_timeout(this->real_query(text.c_str(), (unsigned long)text.size()), text);
+	return this->open_reader();
+}
+
+
+//*********************************************************
+// 函数名称 : execute_reader
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/16
+// 函数说明 : 执行SQL语句
+// 访问方式 : public
+// 函数参数 : const std::vector<char> & data SQL语句
+// 返 回 值 : sql::mariadb::recordset 结果集
+// 异    常 : 如果执行SQL失败则抛出 mariadb_exception 异常
+//*********************************************************
+sql::mariadb::recordset sql::mariadb::command::execute_reader(const std::vector<char>& data) const
+{
+	if_false_throw_timeout(this->real_query(data.data(), (unsigned long)data.size()), std::string(data.begin(), data.end()));
+	return this->open_reader();
+}
+
+
+//*********************************************************
+// 函数名称 : execute_reader
+// 作    者 : Gooeen
+// 完成日期 : 2015/09/16
+// 函数说明 : 执行SQL语句
+// 访问方式 : public
+// 返 回 值 : sql::mariadb::recordset 结果集
+// 异    常 : 如果执行SQL失败则抛出 mariadb_exception 异常
+//            如果分配资源失败则抛出 std::bad_alloc 异常;
+//            如果生成SQL语句失败则抛出 std::exception 异常
+//*********************************************************
+sql::mariadb::recordset sql::mariadb::command::execute_reader(void) const
+{
+	const auto statement = this->make_statement();
+	if_false_throw_timeout(this->real_query(statement.data(), (unsigned long)statement.size()), m_text);
+	return this->open_reader();
+}
+
+
+//*********************************************************
+// 函数名称 : execute_batch
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 将多条SQL语句用分号连接后一次发送到服务器执行
+// 访问方式 : public
+// 函数参数 : const std::vector<std::string> & texts SQL语句, 结尾不需要分号
+// 返 回 值 : sql::mariadb::recordset 第一条SQL语句的结果集
+// 异    常 : 如果第一条SQL语句执行失败则抛出 mariadb_exception 异常;
+//            如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+sql::mariadb::recordset sql::mariadb::command::execute_batch(const std::vector<std::string> &texts) const
+{
+	assert(!texts.empty());
+
+	// 计算连接后的长度, SQL语句之间加一个分号
+	size_t size = texts.size() - 1;
+	for (const auto &text : texts)
+	{
+		size += text.size();
+	}
+
+	std::string batch;
+	batch.reserve(size);
+	for (const auto &text : texts)
+	{
+		if (!batch.empty())
+		{
+			batch += ';';
+		}
+		batch += text;
+	}
+
+	return this->execute_reader(batch);
+}
+
+
+//*********************************************************
+// 函数名称 : try_execute
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 执行SQL语句, 不抛出异常
+// 访问方式 : public
+// 函数参数 : const std::string & text SQL语句
+// 返 回 值 : result<unsigned long long> 成功时为影响的行数; 失败时为错误信息
+//*********************************************************
+sql::mariadb::result<unsigned long long> sql::mariadb::command::try_execute(const std::string & text) const noexcept
+{
+	assert(m_ptr_mysql != nullptr);
+
+	if (!this->real_query(text.c_str(), (unsigned long)text.size()))
+	{
+		return this->last_error();
+	}
+
+	// 丢弃可能返回的结果集, 使连接可以继续执行SQL语句
+	unsigned long long rows = mysql_affected_rows(m_ptr_mysql);
+	if (mysql_field_count(m_ptr_mysql) != 0)
+	{
+		const auto reader = this->open_reader();
+		rows = reader == nullptr ? 0 : mysql_num_rows(reader.m_ptr_res);
+	}
+
+	return rows;
+}
+
+
+//*********************************************************
+// 函数名称 : try_execute_reader
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 执行SQL语句并获取结果集, 不抛出异常
+// 访问方式 : public
+// 函数参数 : const std::string & text SQL语句
+// 返 回 值 : result<recordset> 成功时为结果集; 失败时为错误信息
+//*********************************************************
+sql::mariadb::result<sql::mariadb::recordset> sql::mariadb::command::try_execute_reader(const std::string & text) const noexcept
+{
+	assert(m_ptr_mysql != nullptr);
+
+	if (!this->real_query(text.c_str(), (unsigned long)text.size()))
+	{
+		return this->last_error();
+	}
+
+	return this->open_reader();
+}
+
+
+//*********************************************************
+// 函数名称 : set_idempotent
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 声明本对象执行的所有SQL语句都可以重复执行
+// 访问方式 : public
+// 函数参数 : bool enable true 代表可以重复执行, false 代表根据SQL语句判断
+//*********************************************************
+void sql::mariadb::command::set_idempotent(bool enable) noexcept
+{
+	m_idempotent = enable;
+}
+
+
+//*********************************************************
+// 函数名称 : set_timeout
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置每次执行SQL语句的超时时间
+// 访问方式 : public
+// 函数参数 : unsigned int milliseconds 超时时间 (毫秒), 0 代表不限制
+// 函数参数 : const endpoint * point 该连接的服务器参数, 执行SQL语句期间必须有效
+//*********************************************************
+void sql::mariadb::command::set_timeout(unsigned int milliseconds, const endpoint * point) noexcept
+{
+	m_timeout = milliseconds;
+	m_ptr_endpoint = point;
+}
+
+
+//*********************************************************
+// 函数名称 : timed_out
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 判断最后一次执行SQL语句是否超时
+// 访问方式 : public
+// 返 回 值 : bool 如果超时返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::command::timed_out(void) const noexcept
+{
+	return m_timed_out;
+}
+
+
+//*********************************************************
+// 函数名称 : set_observer
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置观察者, 替换从 connection 继承的观察者
+// 访问方式 : public
+// 函数参数 : statement_observer * observer 观察者, nullptr 代表不观察
+//*********************************************************
+void sql::mariadb::command::set_observer(statement_observer * observer) noexcept
+{
+	m_ptr_observer = observer;
+}
+
+
+//*********************************************************
+// 函数名称 : real_query
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 执行SQL语句, 记录 network 阶段的耗时, 启用了 query_stats 时记录延迟,
+//            设置了观察者时通知观察者
+// 访问方式 : private
+// 函数参数 : const char * text SQL语句
+// 函数参数 : unsigned long length SQL语句字符串长度
+// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::command::real_query(const char * text, unsigned long length) const noexcept
+{
+#ifndef SQL_MARIADB_NO_OBSERVER
+	if (m_ptr_observer != nullptr)
+	{
+		this->begin_observe(text, length);
+	}
+#endif
+	m_parameter_count = 0;
+
+	phase_timer timer(query_phase::network);
+	const auto measure = query_stats::enabled();
+	const auto start = measure ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+	const auto success = this->send_query(text, length);
+	timer.stop();
+
+	// 没有结果集的语句在这里记录影响的行数, 有结果集的语句在读取结果集时记录行数
+	const auto finished = !success || mysql_field_count(m_ptr_mysql) == 0;
+	if (measure)
+	{
+		query_stats::record(m_ptr_mysql, text, length, std::chrono::steady_clock::now() - start, !success);
+		if (success && finished)
+		{
+			query_stats::add_rows(m_ptr_mysql, mysql_affected_rows(m_ptr_mysql));
+		}
+	}
+
+#ifndef SQL_MARIADB_NO_OBSERVER
+	if (m_observing && finished)
+	{
+		this->end_observe(success ? 0 : (m_timed_out ? ER_STATEMENT_TIMEOUT : mysql_errno(m_ptr_mysql)),
+			success ? mysql_affected_rows(m_ptr_mysql) : 0);
+	}
+#endif
+
+	return success;
+}
+
+
+//*********************************************************
+// 函数名称 : complete_query
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 执行SQL语句, 如果返回结果集则读取后丢弃, 在本次调用中结束对该语句的观察,
+//            连接可以继续执行SQL语句
+// 访问方式 : private
+// 函数参数 : const char * text SQL语句
+// 函数参数 : unsigned long length SQL语句字符串长度
+// 返 回 值 : bool 如果SQL语句执行成功并且读取结果集成功返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::command::complete_query(const char * text, unsigned long length) const noexcept
+{
+	if (!this->real_query(text, length))
+	{
+		return false;
+	}
+
+	if (mysql_field_count(m_ptr_mysql) == 0)
+	{
+		return true;
+	}
+
+	// 结果集在 reader 析构时释放, 之后的结果集也一起丢弃
+	const auto reader = this->open_reader();
+	return reader != nullptr;
+}
+
+
+//*********************************************************
+// 函数名称 : send_query
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 执行SQL语句; 启用自动重新连接时, 如果连接断开并且SQL语句
+//            可以重复执行, 则重新连接后再执行一次
+// 访问方式 : private
+// 函数参数 : const char * text SQL语句
+// 函数参数 : unsigned long length SQL语句字符串长度
+// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::command::send_query(const char * text, unsigned long length) const noexcept
+{
+	assert(m_ptr_mysql != nullptr);
+	m_timed_out = false;
+
+	// 上一条SQL语句超时后发送的 KILL QUERY 不能取消这一条
+	query_killer::instance().settle(m_ptr_mysql);
+
+	// 设置了超时时间时不重新执行, 避免超过超时时间
+	if (m_timeout != 0)
+	{
+		return this->timed_query(text, length);
+	}
+
+	// 执行失败后服务器状态不会更新, 因此在执行前读取
+	const auto in_transaction = (m_ptr_mysql->server_status & SERVER_STATUS_IN_TRANS) != 0;
+
+	if (mysql_real_query(m_ptr_mysql, text, length) == 0)
+	{
+		return true;
+	}
+
+	if (m_ptr_session == nullptr)
+	{
+		return false;
+	}
+
+	const auto code = mysql_errno(m_ptr_mysql);
+	const auto retry = m_idempotent
+		? (code == CR_SERVER_GONE_ERROR || code == CR_SERVER_LOST) && !in_transaction
+		: session_state::retryable(code, in_transaction, text, length);
+
+	return retry && m_ptr_session->reconnect(m_ptr_mysql) && mysql_real_query(m_ptr_mysql, text, length) == 0;
+}
+
+
+//*********************************************************
+// 函数名称 : timed_query
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 在超时时间内执行SQL语句; 超时后取消该语句, 丢弃还没有读取的结果集
+//            使数据库连接可以继续使用, 并设置 m_timed_out
+// 访问方式 : private
+// 函数参数 : const char * text SQL语句
+// 函数参数 : unsigned long length SQL语句字符串长度
+// 返 回 值 : bool 如果SQL语句在超时时间内执行成功返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::command::timed_query(const char * text, unsigned long length) const noexcept
+{
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_timeout);
+
+	// 服务器端限制执行时间 (秒), SET STATEMENT 只有 MariaDB 支持, 并且只能用于单条的增删改查语句;
+	// 其他服务器只由客户端发送 KILL QUERY 取消
+	std::string hinted;
+	const auto begin = skip_comments(text, text + length);
+	const auto end = text + length;
+
+	if (is_mariadb(m_ptr_mysql) && (starts_with_keyword(begin, end, "SELECT") || starts_with_keyword(begin, end, "INSERT")
+		|| starts_with_keyword(begin, end, "UPDATE") || starts_with_keyword(begin, end, "DELETE")
+		|| starts_with_keyword(begin, end, "REPLACE")))
+	{
+		try
+		{
+			const auto seconds = std::to_string(m_timeout / 1000) + '.' + std::to_string(1000 + m_timeout % 1000).substr(1);
+			hinted = "SET STATEMENT max_statement_time=" + seconds + " FOR ";
+			hinted.append(text, length);
+			text = hinted.data();
+			length = (unsigned long)hinted.size();
+		}
+		catch (const std::exception &)
+		{
+		}
+	}
+
+	// 客户端在到期时发送 KILL QUERY, 在服务器无法及时检查 max_statement_time 时 (例如等待锁) 也能取消
+	unsigned long long ticket = 0;
+	if (m_ptr_endpoint != nullptr)
+	{
+		try
+		{
+			ticket = deadline_watchdog::instance().arm(m_ptr_endpoint, mysql_thread_id(m_ptr_mysql), deadline);
+		}
+		catch (const std::exception &)
+		{
+		}
+	}
+
+	auto success = mysql_real_query(m_ptr_mysql, text, length) == 0;
+	const auto killed = ticket != 0 && !deadline_watchdog::instance().disarm(ticket, m_ptr_mysql);
+	const auto code = success ? 0 : mysql_errno(m_ptr_mysql);
+
+	m_timed_out = killed || code == ER_STATEMENT_TIMEOUT
+		|| (code == ER_QUERY_INTERRUPTED && std::chrono::steady_clock::now() >= deadline);
+
+	if (m_timed_out && success)
+	{
+		// KILL QUERY 到达时SQL语句已经执行完, 逐行跳过结果集而不是全部读入内存,
+		// 等 KILL QUERY 发送完后再执行一条空语句消耗可能残留的取消标记
+		do
+		{
+			const auto result = mysql_use_result(m_ptr_mysql);
+			if (result != nullptr)
+			{
+				mysql_free_result(result);
+			}
+		} while (mysql_next_result(m_ptr_mysql) == 0);
+
+		query_killer::instance().settle(m_ptr_mysql);
+		mysql_real_query(m_ptr_mysql, "DO 0", 4);
+		success = false;
+	}
+
+	return success;
+}
+
+
+//*********************************************************
+// 函数名称 : last_error
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取最后一次执行SQL语句的错误信息
+// 访问方式 : private
+// 返 回 值 : error_info 错误信息
+//*********************************************************
+sql::mariadb::error_info sql::mariadb::command::last_error(void) const noexcept
+{
+	if (m_timed_out)
+	{
+		return error_info(ER_STATEMENT_TIMEOUT, "70100", "timeout");
+	}
+
+	return error_info(mysql_errno(m_ptr_mysql), mysql_sqlstate(m_ptr_mysql), mysql_error(m_ptr_mysql));
+}
+
+
+//*********************************************************
+// 函数名称 : open_reader
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取SQL语句的结果集, 并结束对该语句的观察
+// 访问方式 : private
+// 返 回 值 : recordset 结果集
+//*********************************************************
+sql::mariadb::recordset sql::mariadb::command::open_reader(void) const noexcept
+{
+	recordset reader(m_ptr_mysql);
+
+#ifndef SQL_MARIADB_NO_OBSERVER
+	if (m_observing)
+	{
+		this->end_observe(reader == nullptr ? mysql_errno(m_ptr_mysql) : 0,
+			reader == nullptr ? 0 : mysql_num_rows(reader.m_ptr_res));
+	}
+#endif
+
+	return reader;
+}
+
+
+//*********************************************************
+// 函数名称 : begin_observe
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 结束上一条还没有结束的观察, 然后通知观察者开始执行SQL语句
+// 访问方式 : private
+// 函数参数 : const char * text SQL语句
+// 函数参数 : unsigned long length SQL语句字符串长度
+//*********************************************************
+void sql::mariadb::command::begin_observe(const char * text, unsigned long length) const noexcept
+{
+	if (m_observing)
+	{
+		this->end_observe(0, 0);
+	}
+
+	try
+	{
+		query_stats::fingerprint(text, length, m_event.fingerprint);
+		m_event.text.assign(text, length);
+	}
+	catch (const std::exception &)
+	{
+		m_event.fingerprint.clear();
+		m_event.text.clear();
+	}
+
+	m_event.parameters = m_parameter_count;
+	m_event.duration = std::chrono::nanoseconds::zero();
+	m_event.rows = 0;
+	m_event.bytes = length;
+	m_event.error = 0;
+	m_event.context = nullptr;
+
+	m_ptr_observer->on_begin(m_event);
+	m_observing = true;
+	m_observe_start = std::chrono::steady_clock::now();
+}
+
+
+//*********************************************************
+// 函数名称 : end_observe
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 通知观察者SQL语句已经结束
+// 访问方式 : private
+// 函数参数 : unsigned int error 错误代号, 0 代表成功
+// 函数参数 : unsigned long long rows 结果集行数或者影响的行数
+//*********************************************************
+void sql::mariadb::command::end_observe(unsigned int error, unsigned long long rows) const noexcept
+{
+	m_observing = false;
+	m_event.duration = std::chrono::steady_clock::now() - m_observe_start;
+	m_event.rows = rows;
+	m_event.error = error;
+	m_ptr_observer->on_end(m_event);
+}
+
+
+// stream_reader 返回负数时的错误代号, 类外定义供按引用使用
+constexpr unsigned int sql::mariadb::prepared_statement::stream_read_error;
+
+
+//*********************************************************
+// 函数名称 : prepared_statement
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 转移构造函数, 转移后原对象不应该使用
+// 访问方式 : public
+// 函数参数 : prepared_statement && statement 需要转移的对象
+//*********************************************************
+sql::mariadb::prepared_statement::prepared_statement(prepared_statement && statement) noexcept
+	: m_ptr_mysql(statement.m_ptr_mysql)
+	, m_ptr_stmt(statement.m_ptr_stmt)
+	, m_ptr_session(statement.m_ptr_session)
+	, m_generation(statement.m_generation)
+	, m_text(std::move(statement.m_text))
+	, m_chunk_size(statement.m_chunk_size)
+	, m_parameters(std::move(statement.m_parameters))
+	, m_results(std::move(statement.m_results))
+	, m_columns(std::move(statement.m_columns))
+	, m_stream_error(std::move(statement.m_stream_error))
+{
+	statement.m_ptr_mysql = nullptr;
+	statement.m_ptr_stmt = nullptr;
+}
+
+
+//*********************************************************
+// 函数名称 : prepared_statement
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数
+// 访问方式 : public
+// 函数参数 : const connection & connector 数据库连接类
+//*********************************************************
+sql::mariadb::prepared_statement::prepared_statement(const connection & connector) noexcept
+	: m_ptr_mysql(connector.m_ptr_mysql)
+	, m_ptr_stmt(connector.m_ptr_mysql == nullptr ? nullptr : mysql_stmt_init(connector.m_ptr_mysql))
+	, m_ptr_session(connector.m_session.get())
+	, m_generation(connector.m_session == nullptr ? 0 : connector.m_session->m_generation)
+	, m_chunk_size(64 * 1024)
+{
+}
+
+
+//*********************************************************
+// 函数名称 : ~prepared_statement
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 如果预处理语句没有关闭则在析构时自动关闭
+// 访问方式 : public
+//*********************************************************
+sql::mariadb::prepared_statement::~prepared_statement(void) noexcept
+{
+	if (m_ptr_stmt != nullptr)
+	{
+		mysql_stmt_close(m_ptr_stmt);
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : operator!=
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 判断预处理语句是否创建成功
+// 访问方式 : public
+// 函数参数 : std::nullptr_t null 与nullptr作比较
+// 返 回 值 : bool 如果创建成功则 对象 != nullptr;
+//            反之 对象 == nullptr
+//*********************************************************
+bool sql::mariadb::prepared_statement::operator!=(std::nullptr_t null) const noexcept
+{
+	return m_ptr_stmt != null;
+}
+
+
+//*********************************************************
+// 函数名称 : operator==
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 判断预处理语句是否创建成功
+// 访问方式 : public
+// 函数参数 : std::nullptr_t null 与nullptr作比较
+// 返 回 值 : bool 如果创建成功则 对象 != nullptr;
+//            反之 对象 == nullptr
+//*********************************************************
+bool sql::mariadb::prepared_statement::operator==(std::nullptr_t null) const noexcept
+{
+	return m_ptr_stmt == null;
+}
+
+
+//*********************************************************
+// 函数名称 : close
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 关闭预处理语句, 如果不手动关闭, 则析构时自动关闭
+// 访问方式 : public
+//*********************************************************
+void sql::mariadb::prepared_statement::close(void) noexcept
+{
+	if (m_ptr_stmt != nullptr)
+	{
+		mysql_stmt_close(m_ptr_stmt);
+		m_ptr_stmt = nullptr;
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : error
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取数据库操作失败的错误信息
+// 访问方式 : public
+// 返 回 值 : std::string 错误信息
+//*********************************************************
+std::string sql::mariadb::prepared_statement::error(void) const noexcept
+try
+{
+	if (m_stream_error.code() != 0)
+	{
+		return std::string(m_stream_error.text());
+	}
+	if (m_ptr_stmt == nullptr)
+	{
+		return std::string(mysql_error(m_ptr_mysql));
+	}
+	return std::string(mysql_stmt_error(m_ptr_stmt));
+}
+catch (const std::exception &)
+{
+	return std::string();
+}
+
+
+//*********************************************************
+// 函数名称 : errorno
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取数据库操作失败的错误代号
+// 访问方式 : public
+// 返 回 值 : unsigned int 错误代号
+//*********************************************************
+unsigned int sql::mariadb::prepared_statement::errorno(void) const noexcept
+{
+	if (m_stream_error.code() != 0)
+	{
+		return m_stream_error.code();
+	}
+	if (m_ptr_stmt == nullptr)
+	{
+		return mysql_errno(m_ptr_mysql);
+	}
+	return mysql_stmt_errno(m_ptr_stmt);
+}
+
+
+//*********************************************************
+// 函数名称 : last_error
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取数据库操作失败的错误信息, 包括错误代号和 SQLSTATE;
+//            分块发送数据失败时为发送失败时的错误, 而不是丢弃数据后的状态
+// 访问方式 : public
+// 返 回 值 : error_info 错误信息
+//*********************************************************
+sql::mariadb::error_info sql::mariadb::prepared_statement::last_error(void) const noexcept
+{
+	if (m_stream_error.code() != 0)
+	{
+		return m_stream_error;
+	}
+	if (m_ptr_stmt == nullptr)
+	{
+		return error_info(mysql_errno(m_ptr_mysql), mysql_sqlstate(m_ptr_mysql), mysql_error(m_ptr_mysql));
+	}
+	return error_info(mysql_stmt_errno(m_ptr_stmt), mysql_stmt_sqlstate(m_ptr_stmt), mysql_stmt_error(m_ptr_stmt));
+}
+
+
+//*********************************************************
+// 函数名称 : prepare
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 将SQL语句发送到服务器进行预处理, 并清除之前添加的数据
+// 访问方式 : public
+// 函数参数 : const std::string & text SQL语句
+// 返 回 值 : bool 如果预处理成功返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::prepared_statement::prepare(const std::string & text) noexcept
+try
+{
+	assert(m_ptr_stmt != nullptr);
+	m_parameters.clear();
+	m_results.clear();
+	m_text.clear();
+	m_stream_error = error_info();
+
+	if (!this->refresh())
+	{
+		return false;
+	}
+
+	m_text = text;
+	return mysql_stmt_prepare(m_ptr_stmt, text.c_str(), (unsigned long)text.size()) == 0;
+}
+catch (const std::exception &)
+{
+	return false;
+}
+
+
+//*********************************************************
+// 函数名称 : param_count
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取预处理语句中问号的数量
+// 访问方式 : public
+// 返 回 值 : unsigned long 问号的数量
+//*********************************************************
+unsigned long sql::mariadb::prepared_statement::param_count(void) const noexcept
+{
+	assert(m_ptr_stmt != nullptr);
+	return mysql_stmt_param_count(m_ptr_stmt);
+}
+
+
+//*********************************************************
+// 函数名称 : set_chunk_size
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置 add_stream 添加的数据每次发送的字节数
+// 访问方式 : public
+// 函数参数 : unsigned long size 每次发送的字节数, 必须大于 0
+//*********************************************************
+void sql::mariadb::prepared_statement::set_chunk_size(unsigned long size) noexcept
+{
+	assert(size > 0);
+	m_chunk_size = size;
+}
+
+
+//*********************************************************
+// 函数名称 : add
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 添加数据, 执行SQL语句时本次添加的数据代替第 pos 个问号
+// 访问方式 : public
+// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
+// 函数参数 : std::string text 数据
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+void sql::mariadb::prepared_statement::add(unsigned int pos, std::string text)
+{
+	this->add(pos, std::vector<char>(text.begin(), text.end()));
+}
+
+
+//*********************************************************
+// 函数名称 : add
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 添加数据, 执行SQL语句时本次添加的数据代替第 pos 个问号
+// 访问方式 : public
+// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
+// 函数参数 : std::vector<char> data 数据
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+void sql::mariadb::prepared_statement::add(unsigned int pos, std::vector<char> data)
+{
+	m_parameters[pos] = std::make_pair(std::move(data), stream_reader());
+}
+
+
+//*********************************************************
+// 函数名称 : add_stream
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 添加分块读取的数据, 执行SQL语句时调用 reader 读取数据,
+//            并通过 mysql_stmt_send_long_data 分块发送到服务器
+// 访问方式 : public
+// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
+// 函数参数 : stream_reader reader 分块读取数据的函数
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+void sql::mariadb::prepared_statement::add_stream(unsigned int pos, stream_reader reader)
+{
+	assert(reader);
+	m_parameters[pos] = std::make_pair(std::vector<char>(), std::move(reader));
+}
+
+
+//*********************************************************
+// 函数名称 : add_stream
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 添加从文件描述符读取的数据, 执行SQL语句时从 fd 当前位置
+//            读取到文件结尾, 并分块发送到服务器; 不会关闭 fd
+// 访问方式 : public
+// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
+// 函数参数 : int fd 文件描述符
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+void sql::mariadb::prepared_statement::add_stream(unsigned int pos, int fd)
+{
+	this->add_stream(pos, [fd](char *buffer, unsigned long size) -> long
+	{
+#ifdef _WIN32
+		return (long)_read(fd, buffer, (unsigned int)size);
+#else
+		return (long)::read(fd, buffer, size);
+#endif
+	});
+}
+
+
+//*********************************************************
+// 函数名称 : execute
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 执行预处理语句, 执行前先分块发送 add_stream 添加的数据
+// 访问方式 : public
+// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+//            如果有问号没有添加数据则抛出 std::out_of_range 异常;
+//            如果 reader 抛出异常则继续抛出该异常
+//*********************************************************
+bool sql::mariadb::prepared_statement::execute(void)
+{
+	assert(m_ptr_stmt != nullptr);
+	m_stream_error = error_info();
+
+	// 执行失败后服务器状态不会更新, 因此在执行前读取
+	const auto in_transaction = (m_ptr_mysql->server_status & SERVER_STATUS_IN_TRANS) != 0;
+
+	if (!this->refresh())
+	{
+		return false;
+	}
+
+	if (this->execute_once())
+	{
+		return true;
+	}
+
+	if (m_ptr_session == nullptr
+		|| !session_state::retryable(this->errorno(), in_transaction, m_text.c_str(), (unsigned long)m_text.size()))
+	{
+		return false;
+	}
+
+	// 分块读取的数据已经读取过, 不能再发送一次
+	for (const auto &parameter : m_parameters)
+	{
+		if (parameter.second.second)
+		{
+			return false;
+		}
+	}
+
+	return m_ptr_session->reconnect(m_ptr_mysql) && this->refresh() && this->execute_once();
+}
+
+
+//*********************************************************
+// 函数名称 : execute_once
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 绑定数据、分块发送数据并执行预处理语句
+// 访问方式 : private
+// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+//            如果有问号没有添加数据则抛出 std::out_of_range 异常;
+//            如果 reader 抛出异常则继续抛出该异常
+//*********************************************************
+bool sql::mariadb::prepared_statement::execute_once(void)
+{
+	assert(m_ptr_stmt != nullptr);
+
+	const auto count = (unsigned int)mysql_stmt_param_count(m_ptr_stmt); // 问号的数量
+	std::vector<MYSQL_BIND> binds(count); // 绑定的数据
+	std::vector<unsigned long> lengths(count); // 绑定的数据的长度
+	std::memset(binds.data(), 0, binds.size() * sizeof(MYSQL_BIND));
+
+	// 绑定数据; 分块发送的数据只需要绑定类型
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		const auto &parameter = m_parameters.at(i);
+		binds[i].buffer_type = MYSQL_TYPE_BLOB;
+		if (!parameter.second)
+		{
+			lengths[i] = (unsigned long)parameter.first.size();
+			binds[i].buffer = (void *)parameter.first.data();
+			binds[i].buffer_length = lengths[i];
+			binds[i].length = &lengths[i];
+		}
+	}
+
+	if (count != 0 && mysql_stmt_bind_param(m_ptr_stmt, binds.data()) != 0)
+	{
+		return false;
+	}
+
+	// 分块发送数据, 所有数据共用一个缓冲区
+	std::vector<char> buffer;
+	for (const auto &parameter : m_parameters)
+	{
+		if (parameter.first < count && parameter.second.second)
+		{
+			if (buffer.empty())
+			{
+				buffer.resize(m_chunk_size);
+			}
+
+			if (!this->send_stream(parameter.first, parameter.second.second, buffer))
+			{
+				// 丢弃已经发送到服务器的数据
+				mysql_stmt_reset(m_ptr_stmt);
+				return false;
+			}
+		}
+	}
+
+	// 上一条SQL语句超时后发送的 KILL QUERY 不能取消这一条
+	query_killer::instance().settle(m_ptr_mysql);
+
+	if (mysql_stmt_execute(m_ptr_stmt) != 0)
+	{
+		return false;
+	}
+
+	// 如果有结果集则绑定结果集, 用于分块读取数据
+	return mysql_stmt_field_count(m_ptr_stmt) == 0 || this->bind_result();
+}
+
+
+//*********************************************************
+// 函数名称 : affected_rows
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取上一次执行SQL语句所影响的行数
+// 访问方式 : public
+// 返 回 值 : unsigned long long 影响的行数
+//*********************************************************
+unsigned long long sql::mariadb::prepared_statement::affected_rows(void) const noexcept
+{
+	assert(m_ptr_stmt != nullptr);
+	return mysql_stmt_affected_rows(m_ptr_stmt);
+}
+
+
+//*********************************************************
+// 函数名称 : field_count
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取结果集的列数(字段数量)
+// 访问方式 : public
+// 返 回 值 : unsigned long 列数(字段数量), 没有结果集则返回 0
+//*********************************************************
+unsigned long sql::mariadb::prepared_statement::field_count(void) const noexcept
+{
+	assert(m_ptr_stmt != nullptr);
+	return mysql_stmt_field_count(m_ptr_stmt);
+}
+
+
+//*********************************************************
+// 函数名称 : read
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 从服务器读取下一条数据; 数据不会整行复制到客户端的缓冲区,
+//            需要使用 read_column 分块读取各列的数据
+// 访问方式 : public
+// 返 回 值 : bool 成功返回true, 没有数据或者失败返回false
+//*********************************************************
+bool sql::mariadb::prepared_statement::read(void) noexcept
+{
+	assert(m_ptr_stmt != nullptr);
+
+	if (m_results.empty())
+	{
+		return false;
+	}
+
+	// 绑定的缓冲区大小为 0, 所以有数据的列都会返回 MYSQL_DATA_TRUNCATED
+	const auto result = mysql_stmt_fetch(m_ptr_stmt);
+	return result == 0 || result == MYSQL_DATA_TRUNCATED;
+}
+
+
+//*********************************************************
+// 函数名称 : free_result
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 丢弃还没有读取的数据
+// 访问方式 : public
+//*********************************************************
+void sql::mariadb::prepared_statement::free_result(void) noexcept
+{
+	if (m_ptr_stmt != nullptr)
+	{
+		mysql_stmt_free_result(m_ptr_stmt);
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : is_null
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 判断当前行的数据是否为 NULL
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : bool 如果数据为 NULL 返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::prepared_statement::is_null(unsigned long n) const noexcept
+{
+	assert(n < m_columns.size());
+	return m_columns[n].second != 0;
+}
+
+
+//*********************************************************
+// 函数名称 : data_size
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取当前行单条数据的长度
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : unsigned long 单条数据的字节数
+//*********************************************************
+unsigned long sql::mariadb::prepared_statement::data_size(unsigned long n) const noexcept
+{
+	assert(n < m_columns.size());
+	return m_columns[n].first;
+}
+
+
+//*********************************************************
+// 函数名称 : read_column
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 通过 mysql_stmt_fetch_column 读取当前行单条数据从 offset
+//            开始的一部分, 保存到 buffer 中
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 函数参数 : char * buffer 保存数据的缓冲区
+// 函数参数 : unsigned long size 缓冲区的大小
+// 函数参数 : unsigned long offset 数据的开始位置
+// 返 回 值 : unsigned long 读取到的字节数; 如果 offset 已经到达数据结尾或者读取失败则返回 0
+//*********************************************************
+unsigned long sql::mariadb::prepared_statement::read_column(unsigned long n, char * buffer, unsigned long size, unsigned long offset) const noexcept
+{
+	assert(m_ptr_stmt != nullptr);
+	assert(buffer != nullptr);
+	assert(n < m_columns.size());
+
+	const auto length = m_columns[n].first; // 数据的总长度
+	if (offset >= length || m_columns[n].second != 0)
+	{
+		return 0;
+	}
+
+	unsigned long total = 0; // mysql_stmt_fetch_column 返回的数据总长度
+	MYSQL_BIND bind;
+	std::memset(&bind, 0, sizeof(bind));
+	bind.buffer_type = MYSQL_TYPE_BLOB;
+	bind.buffer = buffer;
+	bind.buffer_length = size;
+	bind.length = &total;
+
+	if (mysql_stmt_fetch_column(m_ptr_stmt, &bind, (unsigned int)n, offset) != 0)
+	{
+		return 0;
+	}
+
+	return std::min(size, length - offset);
+}
+
+
+//*********************************************************
+// 函数名称 : read_column
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 分块读取当前行单条数据, 每读取一块数据就调用一次 writer
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 函数参数 : const stream_writer & writer 分块接收数据的函数
+// 返 回 值 : bool 如果读取完所有数据返回true; 如果读取失败或者 writer 返回 false 则返回false
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+//            如果 writer 抛出异常则继续抛出该异常
+//*********************************************************
+bool sql::mariadb::prepared_statement::read_column(unsigned long n, const stream_writer & writer) const
+{
+	assert(n < m_columns.size());
+
+	const auto length = m_columns[n].first; // 数据的总长度
+	std::vector<char> buffer(std::min(m_chunk_size, length));
+
+	for (unsigned long offset = 0; offset < length;)
+	{
+		const auto count = this->read_column(n, buffer.data(), (unsigned long)buffer.size(), offset);
+		if (count == 0 || !writer(buffer.data(), count))
+		{
+			return false;
+		}
+		offset += count;
+	}
+
+	return true;
+}
+
+
+//*********************************************************
+// 函数名称 : get_data
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取当前行单条数据, 并将数据用 std::vector<char> 对象保存
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : std::vector<char> 数据
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+std::vector<char> sql::mariadb::prepared_statement::get_data(unsigned long n) const
+{
+	assert(n < m_columns.size());
+
+	std::vector<char> data(m_columns[n].first);
+	if (!data.empty())
+	{
+		data.resize(this->read_column(n, data.data(), (unsigned long)data.size(), 0));
+	}
+	return data;
+}
+
+
+//*********************************************************
+// 函数名称 : get_string
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取当前行单条数据, 并将数据用 std::string 对象保存
+// 访问方式 : public
+// 函数参数 : unsigned long n 数据的列位置
+// 返 回 值 : std::string 数据
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+std::string sql::mariadb::prepared_statement::get_string(unsigned long n) const
+{
+	const auto data = this->get_data(n);
+	return std::string(data.begin(), data.end());
+}
+
+
+//*********************************************************
+// 函数名称 : send_stream
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 从 reader 分块读取数据并发送到服务器; 失败时把错误信息保存到 m_stream_error,
+//            因为之后丢弃数据的 mysql_stmt_reset 会清除预处理语句中的错误信息
+// 访问方式 : private
+// 函数参数 : unsigned int pos 问号的位置
+// 函数参数 : const stream_reader & reader 分块读取数据的函数
+// 函数参数 : std::vector<char> & buffer 分块缓冲区
+// 返 回 值 : bool 如果发送成功返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::prepared_statement::send_stream(unsigned int pos, const stream_reader & reader, std::vector<char>& buffer)
+{
+	try
+	{
+		for (;;)
+		{
+			const auto n = reader(buffer.data(), (unsigned long)buffer.size());
+			if (n == 0)
+			{
+				return true;
+			}
+
+			if (n < 0)
+			{
+				m_stream_error = error_info(stream_read_error, "HY000", "stream reader failed");
+				return false;
+			}
+
+			if (mysql_stmt_send_long_data(m_ptr_stmt, pos, buffer.data(), (unsigned long)n) != 0)
+			{
+				m_stream_error = error_info(mysql_stmt_errno(m_ptr_stmt), mysql_stmt_sqlstate(m_ptr_stmt), mysql_stmt_error(m_ptr_stmt));
+				return false;
+			}
+		}
+	}
+	catch (...)
+	{
+		// 丢弃已经发送到服务器的数据后继续抛出异常
+		mysql_stmt_reset(m_ptr_stmt);
+		throw;
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : bind_result
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 绑定结果集, 不分配数据缓冲区, 只接收各列的长度和是否为 NULL
+// 访问方式 : private
+// 返 回 值 : bool 如果绑定成功返回true; 反之返回false
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+bool sql::mariadb::prepared_statement::bind_result(void)
+{
+	const auto count = mysql_stmt_field_count(m_ptr_stmt); // 结果集的列数
+
+	m_results.assign(count, MYSQL_BIND());
+	m_columns.assign(count, std::make_pair(0UL, bind_flag()));
+	std::memset(m_results.data(), 0, m_results.size() * sizeof(MYSQL_BIND));
+
+	// 缓冲区大小为 0, 读取数据时只保存长度, 数据由 read_column 分块读取
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		m_results[i].buffer_type = MYSQL_TYPE_BLOB;
+		m_results[i].length = &m_columns[i].first;
+		m_results[i].is_null = &m_columns[i].second;
+	}
+
+	if (mysql_stmt_bind_result(m_ptr_stmt, m_results.data()) != 0)
+	{
+		m_results.clear();
+		return false;
+	}
+
+	return true;
+}
+
+
+//*********************************************************
+// 函数名称 : refresh
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 如果连接已经自动重新连接过, 则重新创建预处理语句句柄并重新预处理
+// 访问方式 : private
+// 返 回 值 : bool 如果预处理语句可用返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::prepared_statement::refresh(void) noexcept
+{
+	if (m_ptr_stmt == nullptr || m_ptr_session == nullptr || m_generation == m_ptr_session->m_generation)
+	{
+		return m_ptr_stmt != nullptr;
+	}
+
+	// 旧的句柄属于已经断开的连接, 只能关闭
+	mysql_stmt_close(m_ptr_stmt);
+	m_results.clear();
+	m_ptr_stmt = mysql_stmt_init(m_ptr_mysql);
+	m_generation = m_ptr_session->m_generation;
+
+	return m_ptr_stmt != nullptr
+		&& (m_text.empty() || mysql_stmt_prepare(m_ptr_stmt, m_text.c_str(), (unsigned long)m_text.size()) == 0);
+}
+
+
+//*********************************************************
+// 函数名称 : pipeline
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 转移构造函数, 转移后原对象不应该使用
+// 访问方式 : public
+// 函数参数 : pipeline && executer 需要转移的对象
+//*********************************************************
+sql::mariadb::pipeline::pipeline(pipeline && executer) noexcept
+	: m_ptr_mysql(executer.m_ptr_mysql)
+	, m_window(executer.m_window)
+	, m_items(std::move(executer.m_items))
+{
+	executer.m_ptr_mysql = nullptr;
+}
+
+
+//*********************************************************
+// 函数名称 : pipeline
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数
+// 访问方式 : public
+// 函数参数 : const connection & connector 数据库连接类
+//*********************************************************
+sql::mariadb::pipeline::pipeline(const connection & connector) noexcept
+	: m_ptr_mysql(connector.m_ptr_mysql)
+	, m_window(16)
+{
+}
+
+
+//*********************************************************
+// 函数名称 : size
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取还没有执行的SQL语句的数量
+// 访问方式 : public
+// 返 回 值 : size_t SQL语句的数量
+//*********************************************************
+size_t sql::mariadb::pipeline::size(void) const noexcept
+{
+	return m_items.size();
+}
+
+
+//*********************************************************
+// 函数名称 : set_window
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置最多有多少条已经发送但还没有读取结果的SQL语句
+// 访问方式 : public
+// 函数参数 : size_t count SQL语句的数量, 必须大于 0
+//*********************************************************
+void sql::mariadb::pipeline::set_window(size_t count) noexcept
+{
+	assert(count > 0);
+	m_window = count;
+}
+
+
+//*********************************************************
+// 函数名称 : add
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 添加SQL语句, 执行 run 时按添加的顺序执行
+// 访问方式 : public
+// 函数参数 : std::string text SQL语句
+// 函数参数 : result_handler on_result SQL语句执行成功后处理结果集的函数
+// 函数参数 : error_handler on_error SQL语句执行失败后处理错误的函数
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+void sql::mariadb::pipeline::add(std::string text, result_handler on_result, error_handler on_error)
+{
+	item statement;
+	statement.text = std::move(text);
+	statement.on_result = std::move(on_result);
+	statement.on_error = std::move(on_error);
+	m_items.push_back(std::move(statement));
+}
+
+
+//*********************************************************
+// 函数名称 : add_execute
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 添加SQL语句, 执行 run 后可以从返回值获取影响的行数
+// 访问方式 : public
+// 函数参数 : std::string text SQL语句
+// 返 回 值 : std::future<unsigned long long> 影响的行数;
+//            如果执行失败则 get 时抛出 mariadb_exception 异常
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+std::future<unsigned long long> sql::mariadb::pipeline::add_execute(std::string text)
+{
+	const auto promise = std::make_shared<std::promise<unsigned long long>>();
+	const auto message = text;
+
+	this->add(std::move(text), [promise](recordset &reader)
+	{
+		promise->set_value(reader.affected_rows());
+	}, [promise, message](unsigned int, const std::string &error)
+	{
+		promise->set_exception(std::make_exception_ptr(mariadb_exception(error + "\r\nSQL: " + message, __FILE__, __LINE__)));
+	});
+
+	return promise->get_future();
+}
+
+
+//*********************************************************
+// 函数名称 : run
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 连续发送添加的SQL语句, 然后按顺序读取结果并调用处理函数
+// 访问方式 : public
+// 返 回 值 : size_t 执行成功的SQL语句的数量
+// 异    常 : 如果处理函数抛出异常则继续抛出该异常
+//*********************************************************
+size_t sql::mariadb::pipeline::run(void)
+{
+	assert(m_ptr_mysql != nullptr);
+
+	std::vector<item> items; // 本次执行的SQL语句
+	items.swap(m_items);
+
+	std::exception_ptr exception; // 处理函数抛出的第一个异常
+	size_t succeeded = 0; // 执行成功的SQL语句的数量
+	size_t sent = 0; // 已经发送的SQL语句的数量
+	bool broken = false; // 发送失败后连接不能继续使用
+
+	for (size_t received = 0; received < items.size(); ++received)
+	{
+		// 在窗口范围内连续发送SQL语句
+		while (!broken && sent < items.size() && sent - received < m_window)
+		{
+			broken = !this->send(items[sent].text);
+			if (!broken)
+			{
+				++sent;
+			}
+		}
+
+		auto &statement = items[received];
+		const auto ok = received < sent && this->receive(statement.text);
+
+		try
+		{
+			if (ok)
+			{
+				++succeeded;
+				recordset reader(m_ptr_mysql);
+				if (statement.on_result)
+				{
+					statement.on_result(reader);
+				}
+			}
+			else if (statement.on_error)
+			{
+				statement.on_error(mysql_errno(m_ptr_mysql), std::string(mysql_error(m_ptr_mysql)));
+			}
+		}
+		catch (...)
+		{
+			if (!exception)
+			{
+				exception = std::current_exception();
+			}
+		}
+	}
+
+	if (exception)
+	{
+		std::rethrow_exception(exception);
+	}
+
+	return succeeded;
+}
+
+
+//*********************************************************
+// 函数名称 : send
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 发送SQL语句, 不等待服务器返回结果
+// 访问方式 : private
+// 函数参数 : const std::string & text SQL语句
+// 返 回 值 : bool 如果发送成功返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::pipeline::send(const std::string & text) const noexcept
+{
+	// 上一条SQL语句超时后发送的 KILL QUERY 不能取消这一条
+	query_killer::instance().settle(m_ptr_mysql);
+
+#ifdef MARIADB_PACKAGE_VERSION
+	return mysql_send_query(m_ptr_mysql, text.c_str(), (unsigned long)text.size()) == 0;
+#else
+	// 其他客户端库不能只发送SQL语句, 在 receive 中逐条执行
+	(void)text;
+	return true;
+#endif
+}
+
+
+//*********************************************************
+// 函数名称 : receive
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 读取已经发送的SQL语句的执行结果
+// 访问方式 : private
+// 函数参数 : const std::string & text SQL语句
+// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::pipeline::receive(const std::string & text) const noexcept
+{
+#ifdef MARIADB_PACKAGE_VERSION
+	(void)text;
+	return mysql_read_query_result(m_ptr_mysql) == 0;
+#else
+	return mysql_real_query(m_ptr_mysql, text.c_str(), (unsigned long)text.size()) == 0;
+#endif
+}
+
+
+//*********************************************************
+// 函数名称 : pooled_connection
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 转移构造函数, 转移后原对象不应该使用
+// 访问方式 : public
+// 函数参数 : pooled_connection && connector 需要转移的对象
+//*********************************************************
+sql::mariadb::pooled_connection::pooled_connection(pooled_connection && connector) noexcept
+	: m_ptr_pool(connector.m_ptr_pool)
+	, m_connection(std::move(connector.m_connection))
+	, m_reuse(connector.m_reuse)
+{
+	connector.m_ptr_pool = nullptr;
+}
+
+
+//*********************************************************
+// 函数名称 : pooled_connection
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数
+// 访问方式 : private
+// 函数参数 : connection_pool * pool 连接池
+// 函数参数 : std::unique_ptr<connection> && connector 数据库连接
+//*********************************************************
+sql::mariadb::pooled_connection::pooled_connection(connection_pool * pool, std::unique_ptr<connection>&& connector) noexcept
+	: m_ptr_pool(pool)
+	, m_connection(std::move(connector))
+	, m_reuse(true)
+{
+}
+
+
+//*********************************************************
+// 函数名称 : ~pooled_connection
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 将数据库连接归还给连接池
+// 访问方式 : public
+//*********************************************************
+sql::mariadb::pooled_connection::~pooled_connection(void) noexcept
+{
+	if (m_ptr_pool != nullptr)
+	{
+		const auto reuse = m_reuse && (m_connection == nullptr || m_ptr_pool->reset(*m_connection));
+		m_ptr_pool->release(std::move(m_connection), reuse);
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : operator!=
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 判断是否持有数据库连接
+// 访问方式 : public
+// 函数参数 : std::nullptr_t null 与nullptr作比较
+// 返 回 值 : bool 如果持有数据库连接则 对象 != nullptr;
+//            反之 对象 == nullptr
+//*********************************************************
+bool sql::mariadb::pooled_connection::operator!=(std::nullptr_t null) const noexcept
+{
+	return m_connection != null;
+}
+
+
+//*********************************************************
+// 函数名称 : operator==
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 判断是否持有数据库连接
+// 访问方式 : public
+// 函数参数 : std::nullptr_t null 与nullptr作比较
+// 返 回 值 : bool 如果持有数据库连接则 对象 != nullptr;
+//            反之 对象 == nullptr
+//*********************************************************
+bool sql::mariadb::pooled_connection::operator==(std::nullptr_t null) const noexcept
+{
+	return m_connection == null;
+}
+
+
+//*********************************************************
+// 函数名称 : get
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取数据库连接
+// 访问方式 : public
+// 返 回 值 : const connection & 数据库连接
+//*********************************************************
+const sql::mariadb::connection & sql::mariadb::pooled_connection::get(void) const noexcept
+{
+	assert(m_connection != nullptr);
+	return *m_connection;
+}
+
+
+//*********************************************************
+// 函数名称 : operator const connection &
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 转换成数据库连接
+// 访问方式 : public
+// 返 回 值 : const connection & 数据库连接
+//*********************************************************
+sql::mariadb::pooled_connection::operator const connection &(void) const noexcept
+{
+	return this->get();
+}
+
+
+//*********************************************************
+// 函数名称 : discard
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 标记数据库连接已经不可用, 归还时关闭而不是放回连接池
+// 访问方式 : public
+//*********************************************************
+void sql::mariadb::pooled_connection::discard(void) noexcept
+{
+	m_reuse = false;
+}
+
+
+//*********************************************************
+// 函数名称 : connection_pool
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数, 不会马上打开连接, 需要时再打开或者使用 warm_up 预先打开
+// 访问方式 : public
+// 函数参数 : endpoint point 服务器参数
+// 函数参数 : size_t capacity 最多打开多少个连接
+//*********************************************************
+sql::mariadb::connection_pool::connection_pool(endpoint point, size_t capacity) noexcept
+	: m_endpoint(std::move(point))
+	, m_capacity(capacity)
+	, m_size(0)
+	, m_acquire_timeout(0)
+	, m_validation_interval(30000)
+	, m_reset_on_release(true)
+{
+	assert(capacity > 0);
+}
+
+
+//*********************************************************
+// 函数名称 : warm_up
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 使用多个线程同时打开连接并放入连接池, 连接总数不超过 capacity
+// 访问方式 : public
+// 函数参数 : size_t count 需要打开的连接数
+// 函数参数 : size_t threads 最多使用多少个线程
+// 返 回 值 : size_t 成功打开的连接数
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+//            如果无法创建线程则抛出 std::system_error 异常
+//*********************************************************
+size_t sql::mariadb::connection_pool::warm_up(size_t count, size_t threads)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	const auto reserved = std::min(count, m_capacity - m_size);
+	m_size += reserved;
+	lock.unlock();
+
+	size_t added = 0;
+
+	try
+	{
+		auto connectors = connection::open_many(m_endpoint, reserved, threads);
+
+		for (auto &connector : connectors)
+		{
+			std::unique_ptr<connection> pointer(new connection(std::move(connector)));
+			this->release(std::move(pointer), true);
+			++added;
+		}
+	}
+	catch (...)
+	{
+		lock.lock();
+		m_size -= reserved - added;
+		lock.unlock();
+		m_available.notify_all();
+		throw;
+	}
+
+	lock.lock();
+	m_size -= reserved - added;
+	lock.unlock();
+	m_available.notify_all();
+
+	return added;
+}
+
+
+//*********************************************************
+// 函数名称 : acquire
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 借出一个数据库连接; 空闲太久的连接先 ping
+// 访问方式 : public
+// 返 回 值 : pooled_connection 数据库连接, 析构时自动归还
+// 异    常 : 如果等待超时则抛出 timeout_exception 异常;
+//            如果连接数据库失败则抛出 mariadb_exception 异常;
+//            如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+sql::mariadb::pooled_connection sql::mariadb::connection_pool::acquire(void)
+{
+	phase_timer timer(query_phase::pool_wait);
+	const auto ready = [this]() { return !m_idle.empty() || m_size < m_capacity; };
+	std::unique_lock<std::mutex> lock(m_mutex);
+	const auto deadline = std::chrono::steady_clock::now() + m_acquire_timeout;
+
+	for (;;)
+	{
+		if (m_acquire_timeout.count() == 0)
+		{
+			m_available.wait(lock, ready);
+		}
+		else if (!m_available.wait_until(lock, deadline, ready))
+		{
+			throw timeout_exception("connection pool acquire timeout\r\nHOST: " + m_endpoint.host(), __FILE__, __LINE__);
+		}
+
+		if (m_idle.empty())
+		{
+			break;
+		}
+
+		auto connector = std::move(m_idle.back().first);
+		const auto since = m_idle.back().second;
+		const auto interval = m_validation_interval;
+		m_idle.pop_back();
+
+		if (interval.count() == 0 || std::chrono::steady_clock::now() - since < interval)
+		{
+			return pooled_connection(this, std::move(connector));
+		}
+
+		// 在锁外 ping, 不可用的连接关闭后重新选择
+		lock.unlock();
+
+		if (connector->ping())
+		{
+			return pooled_connection(this, std::move(connector));
+		}
+
+		this->release(std::move(connector), false);
+		lock.lock();
+	}
+
+	timer.stop();
+
+	// 在锁外打开新的连接, 不阻塞其他线程借出和归还
+	++m_size;
+	lock.unlock();
+
+	std::unique_ptr<connection> connector;
+
+	try
+	{
+		connector.reset(new connection);
+	}
+	catch (...)
+	{
+		this->release(nullptr, false);
+		throw;
+	}
+
+	if (*connector == nullptr || !connector->open(m_endpoint))
+	{
+		const auto text = *connector == nullptr ? std::string("mysql_init failed") : connector->error();
+		const auto code = *connector == nullptr ? (unsigned int)CR_OUT_OF_MEMORY : connector->errorno();
+		const auto state = *connector == nullptr ? std::string("HY000") : connector->sqlstate();
+		this->release(std::move(connector), false);
+		throw mariadb_exception(text + "\r\nHOST: " + m_endpoint.host(), __FILE__, __LINE__, code, state.c_str());
+	}
+
+	return pooled_connection(this, std::move(connector));
+}
+
+
+//*********************************************************
+// 函数名称 : size
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取已经打开的连接数, 包括借出的连接
+// 访问方式 : public
+// 返 回 值 : size_t 连接数
+//*********************************************************
+size_t sql::mariadb::connection_pool::size(void) const noexcept
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_size;
+}
+
+
+//*********************************************************
+// 函数名称 : idle
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取空闲的连接数
+// 访问方式 : public
+// 返 回 值 : size_t 连接数
+//*********************************************************
+size_t sql::mariadb::connection_pool::idle(void) const noexcept
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_idle.size();
+}
+
+
+//*********************************************************
+// 函数名称 : capacity
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取最多可以打开的连接数
+// 访问方式 : public
+// 返 回 值 : size_t 连接数
+//*********************************************************
+size_t sql::mariadb::connection_pool::capacity(void) const noexcept
+{
+	return m_capacity;
+}
+
+
+//*********************************************************
+// 函数名称 : get_endpoint
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取服务器参数
+// 访问方式 : public
+// 返 回 值 : const endpoint & 服务器参数
+//*********************************************************
+const sql::mariadb::endpoint & sql::mariadb::connection_pool::get_endpoint(void) const noexcept
+{
+	return m_endpoint;
+}
+
+
+//*********************************************************
+// 函数名称 : set_acquire_timeout
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置 acquire 等待其他线程归还连接的最长时间
+// 访问方式 : public
+// 函数参数 : unsigned int milliseconds 等待时间 (毫秒), 0 代表一直等待
+//*********************************************************
+void sql::mariadb::connection_pool::set_acquire_timeout(unsigned int milliseconds) noexcept
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_acquire_timeout = std::chrono::milliseconds(milliseconds);
+}
+
+
+//*********************************************************
+// 函数名称 : set_validation_interval
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置空闲多久的连接在借出前需要 ping 检查是否可用
+// 访问方式 : public
+// 函数参数 : unsigned int milliseconds 空闲时间 (毫秒), 0 代表不检查
+//*********************************************************
+void sql::mariadb::connection_pool::set_validation_interval(unsigned int milliseconds) noexcept
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_validation_interval = std::chrono::milliseconds(milliseconds);
+}
+
+
+//*********************************************************
+// 函数名称 : set_reset_on_release
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置归还时是否使用 mysql_reset_connection 清除所有会话状态
+// 访问方式 : public
+// 函数参数 : bool enable true 代表清除所有会话状态, false 代表只回滚还没有结束的事务
+//*********************************************************
+void sql::mariadb::connection_pool::set_reset_on_release(bool enable) noexcept
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_reset_on_release = enable;
+}
+
+
+//*********************************************************
+// 函数名称 : reset
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 放回连接池前清除会话状态, 下一个借用者不会看到上一个借用者的事务和会话变量
+// 访问方式 : private
+// 函数参数 : const connection & connector 数据库连接
+// 返 回 值 : bool 如果清除成功返回true; 反之返回false, 连接需要关闭
+//*********************************************************
+bool sql::mariadb::connection_pool::reset(const connection & connector) const noexcept
+{
+	bool full = true;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		full = m_reset_on_release;
+	}
+
+	// 在锁外访问网络
+	return connector != nullptr && connector.reset(m_endpoint, full);
+}
+
+
+//*********************************************************
+// 函数名称 : release
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 归还数据库连接
+// 访问方式 : private
+// 函数参数 : std::unique_ptr<connection> && connector 数据库连接, 可以是 nullptr
+// 函数参数 : bool reuse 是否放回连接池, false 代表关闭连接
+//*********************************************************
+void sql::mariadb::connection_pool::release(std::unique_ptr<connection> && connector, bool reuse) noexcept
+{
+	std::unique_ptr<connection> closing;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		try
+		{
+			if (reuse && connector != nullptr)
+			{
+				m_idle.emplace_back(std::move(connector), std::chrono::steady_clock::now());
+			}
+		}
+		catch (const std::exception &)
+		{
+			// 无法放回连接池时关闭连接
+		}
+
+		if (connector != nullptr || !reuse)
+		{
+			closing = std::move(connector);
+			--m_size;
+		}
+	}
+
+	// 在锁外关闭连接, mysql_close 需要发送 COM_QUIT
+	closing.reset();
+	m_available.notify_one();
+}
+
+
+//*********************************************************
+// 函数名称 : balancer
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数
+// 访问方式 : public
+// 函数参数 : const std::vector<connection_pool *> & pools 连接池
+// 函数参数 : double decay EWMA 中新样本的权重, 范围为 (0, 1]
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+sql::mariadb::balancer::balancer(const std::vector<connection_pool *> & pools, double decay)
+	: m_decay(decay)
+	, m_factor(3.0)
+	, m_cooldown(10000)
+	, m_min_samples(20)
+	, m_max_failures(5)
+{
+	assert(decay > 0.0 && decay <= 1.0);
+	m_pools.reserve(pools.size());
+
+	for (const auto pool : pools)
+	{
+		assert(pool != nullptr);
+		m_pools.push_back(statistics{ pool, 0.0, 0, 0, 0, std::chrono::steady_clock::time_point() });
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : set_ejection
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置移除异常连接池的条件
+// 访问方式 : public
+// 函数参数 : double factor 延迟倍数
+// 函数参数 : unsigned int cooldown 移除的时间 (毫秒)
+// 函数参数 : unsigned int min_samples 最少样本数
+// 函数参数 : unsigned int max_failures 连续失败次数
+//*********************************************************
+void sql::mariadb::balancer::set_ejection(double factor, unsigned int cooldown, unsigned int min_samples, unsigned int max_failures) noexcept
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_factor = factor;
+	m_cooldown = std::chrono::milliseconds(cooldown);
+	m_min_samples = min_samples;
+	m_max_failures = max_failures;
+}
+
+
+//*********************************************************
+// 函数名称 : select
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 从所有没有被移除的连接池中选择一个
+// 访问方式 : public
+// 返 回 值 : connection_pool * 连接池; 如果没有连接池则返回 nullptr
+//*********************************************************
+sql::mariadb::connection_pool * sql::mariadb::balancer::select(void) noexcept
+try
+{
+	std::vector<connection_pool *> candidates;
+	candidates.reserve(m_pools.size());
+
+	for (const auto &state : m_pools)
+	{
+		candidates.push_back(state.pool);
+	}
+
+	return this->select(candidates);
+}
+catch (const std::exception &)
+{
+	return nullptr;
+}
+
+
+//*********************************************************
+// 函数名称 : select
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 从 candidates 中没有被移除的连接池中选择一个
+// 访问方式 : public
+// 函数参数 : const std::vector<connection_pool *> & candidates 可以选择的连接池
+// 返 回 值 : connection_pool * 连接池; 如果 candidates 为空则返回 nullptr
+//*********************************************************
+sql::mariadb::connection_pool * sql::mariadb::balancer::select(const std::vector<connection_pool *> & candidates) noexcept
+{
+	static thread_local std::minstd_rand engine(std::random_device{}());
+
+	const auto now = std::chrono::steady_clock::now();
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	statistics *chosen[2] = { nullptr, nullptr };
+
+	// 用蓄水池抽样随机选出两个连接池, 不需要分配内存; 如果都被移除了则不考虑是否被移除
+	for (int pass = 0; pass < 2 && chosen[0] == nullptr; ++pass)
+	{
+		size_t seen = 0;
+
+		for (const auto pool : candidates)
+		{
+			const auto state = this->find(pool);
+
+			if (state == nullptr || (pass == 0 && state->ejected_until > now))
+			{
+				continue;
+			}
+
+			const auto slot = seen < 2 ? seen : std::uniform_int_distribution<size_t>(0, seen)(engine);
+			if (slot < 2)
+			{
+				chosen[slot] = state;
+			}
+
+			++seen;
+		}
+	}
+
+	if (chosen[0] == nullptr)
+	{
+		return nullptr;
+	}
+
+	if (chosen[1] == nullptr)
+	{
+		return chosen[0]->pool;
+	}
+
+	const auto score = [](const statistics &state) { return state.latency * (state.in_flight + 1); };
+	return score(*chosen[1]) < score(*chosen[0]) ? chosen[1]->pool : chosen[0]->pool;
+}
+
+
+//*********************************************************
+// 函数名称 : acquire
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 选择连接池并借出一个数据库连接, 归还前记录在该连接上执行的每条SQL语句的延迟
+// 访问方式 : public
+// 返 回 值 : balanced_connection 数据库连接, 析构时自动归还
+// 异    常 : 如果没有连接池或者连接数据库失败则抛出 mariadb_exception 异常;
+//            如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+sql::mariadb::balanced_connection sql::mariadb::balancer::acquire(void)
+{
+	const auto pool = this->select();
+
+	if (pool == nullptr)
+	{
+		throw mariadb_exception("no connection pool available", __FILE__, __LINE__);
+	}
+
+	std::unique_ptr<probe> observer(new probe);
+
+	try
+	{
+		return balanced_connection(this, pool, pool->acquire(), std::move(observer));
+	}
+	catch (const mariadb_exception &)
+	{
+		this->fail(pool);
+		throw;
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : begin
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 记录连接池开始执行一个请求
+// 访问方式 : public
+// 函数参数 : connection_pool * pool 连接池
+//*********************************************************
+void sql::mariadb::balancer::begin(connection_pool * pool) noexcept
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const auto state = this->find(pool);
+
+	if (state != nullptr)
+	{
+		++state->in_flight;
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : end
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 记录连接池完成一个请求, 更新延迟并检查是否需要移除
+// 访问方式 : public
+// 函数参数 : connection_pool * pool 连接池
+// 函数参数 : std::chrono::nanoseconds elapsed 请求的执行时间
+// 函数参数 : bool failed 请求是否失败, 失败的请求不更新延迟
+//*********************************************************
+void sql::mariadb::balancer::end(connection_pool * pool, std::chrono::nanoseconds elapsed, bool failed) noexcept
+{
+	const auto now = std::chrono::steady_clock::now();
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const auto state = this->find(pool);
+
+	if (state == nullptr)
+	{
+		return;
+	}
+
+	if (state->in_flight > 0)
+	{
+		--state->in_flight;
+	}
+
+	if (failed)
+	{
+		++state->failures;
+	}
+	else
+	{
+		const auto sample = (double)elapsed.count();
+		state->latency = state->samples == 0 ? sample : state->latency + m_decay * (sample - state->latency);
+		state->failures = 0;
+		++state->samples;
+	}
+
+	this->eject(*state, now);
+}
+
+
+//*********************************************************
+// 函数名称 : latency
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取连接池的平均延迟 (EWMA)
+// 访问方式 : public
+// 函数参数 : connection_pool * pool 连接池
+// 返 回 值 : double 平均延迟 (纳秒); 如果没有样本则返回 0
+//*********************************************************
+double sql::mariadb::balancer::latency(connection_pool * pool) const noexcept
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const auto state = const_cast<balancer *>(this)->find(pool);
+	return state == nullptr ? 0.0 : state->latency;
+}
+
+
+//*********************************************************
+// 函数名称 : ejected
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 判断连接池是否被暂时移除
+// 访问方式 : public
+// 函数参数 : connection_pool * pool 连接池
+// 返 回 值 : bool 如果被移除返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::balancer::ejected(connection_pool * pool) const noexcept
+{
+	const auto now = std::chrono::steady_clock::now();
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const auto state = const_cast<balancer *>(this)->find(pool);
+	return state != nullptr && state->ejected_until > now;
+}
+
+
+//*********************************************************
+// 函数名称 : find
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 查找连接池的统计数据, 调用前需要加锁
+// 访问方式 : private
+// 函数参数 : connection_pool * pool 连接池
+// 返 回 值 : statistics * 统计数据; 如果不是本对象的连接池则返回 nullptr
+//*********************************************************
+sql::mariadb::balancer::statistics * sql::mariadb::balancer::find(connection_pool * pool) noexcept
+{
+	for (auto &state : m_pools)
+	{
+		if (state.pool == pool)
+		{
+			return &state;
+		}
+	}
+
+	return nullptr;
+}
+
+
+//*********************************************************
+// 函数名称 : eject
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 检查连接池是否需要移除, 调用前需要加锁
+// 访问方式 : private
+// 函数参数 : statistics & state 连接池的统计数据
+// 函数参数 : std::chrono::steady_clock::time_point now 当前时间
+//*********************************************************
+void sql::mariadb::balancer::eject(statistics & state, std::chrono::steady_clock::time_point now) noexcept
+{
+	if (state.ejected_until > now)
+	{
+		return;
+	}
+
+	// 其他没有被移除的连接池的延迟中位数, 连接池的数量很少, 直接在栈上排序
+	double latencies[64];
+	size_t count = 0;
+	size_t active = 0;
+
+	for (const auto &other : m_pools)
+	{
+		if (&other == &state || other.ejected_until > now)
+		{
+			continue;
+		}
+
+		++active;
+
+		if (other.samples > 0 && count < sizeof(latencies) / sizeof(latencies[0]))
+		{
+			latencies[count++] = other.latency;
+		}
+	}
+
+	// 至少保留一个连接池
+	if (active == 0)
+	{
+		return;
+	}
+
+	double median = 0.0;
+	if (count > 0)
+	{
+		std::nth_element(latencies, latencies + count / 2, latencies + count);
+		median = latencies[count / 2];
+	}
+
+	const auto failing = state.failures >= m_max_failures;
+	const auto slow = count > 0 && state.samples >= m_min_samples && state.latency > m_factor * median;
+
+	if (!failing && !slow)
+	{
+		return;
+	}
+
+	// 重新使用时以其他连接池的延迟作为初始值, 并重新积累样本
+	state.ejected_until = now + m_cooldown;
+	state.failures = 0;
+	state.samples = 0;
+
+	if (count > 0)
+	{
+		state.latency = median;
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : fail
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 记录连接池的一次失败 (例如无法连接), 不改变正在执行的请求数
+// 访问方式 : private
+// 函数参数 : connection_pool * pool 连接池
+//*********************************************************
+void sql::mariadb::balancer::fail(connection_pool * pool) noexcept
+{
+	const auto now = std::chrono::steady_clock::now();
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const auto state = this->find(pool);
+
+	if (state != nullptr)
+	{
+		++state->failures;
+		this->eject(*state, now);
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : probe
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数, 没有注册到任何数据库连接
+// 访问方式 : public
+//*********************************************************
+sql::mariadb::balancer::probe::probe(void) noexcept
+	: m_ptr_balancer(nullptr)
+	, m_ptr_pool(nullptr)
+	, m_ptr_connection(nullptr)
+	, m_ptr_next(nullptr)
+	, m_ptr_running(nullptr)
+{
+}
+
+
+//*********************************************************
+// 函数名称 : ~probe
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 取消注册
+// 访问方式 : public
+//*********************************************************
+sql::mariadb::balancer::probe::~probe(void) noexcept
+{
+	this->detach();
+}
+
+
+//*********************************************************
+// 函数名称 : attach
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 取消之前的注册, 然后注册到数据库连接上
+// 访问方式 : public
+// 函数参数 : balancer * balance 负载均衡对象
+// 函数参数 : connection_pool * pool 数据库连接所属的连接池
+// 函数参数 : const connection & connector 数据库连接
+//*********************************************************
+void sql::mariadb::balancer::probe::attach(balancer * balance, connection_pool * pool, const connection & connector) noexcept
+{
+	if (m_ptr_connection == &connector && m_ptr_pool == pool && m_ptr_balancer == balance)
+	{
+		return;
+	}
+
+	this->detach();
+
+	// 借出的连接只能以 const 引用访问, 观察者是连接的附加设置, 不改变连接本身
+	m_ptr_connection = const_cast<connection *>(&connector);
+	m_ptr_next = m_ptr_connection->observer();
+	m_ptr_balancer = balance;
+	m_ptr_pool = pool;
+	m_ptr_connection->set_observer(this);
+}
+
+
+//*********************************************************
+// 函数名称 : detach
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 恢复数据库连接原来的观察者; 还没有结束的SQL语句按已经执行的时间记录
+// 访问方式 : public
+//*********************************************************
+void sql::mariadb::balancer::probe::detach(void) noexcept
+{
+	if (m_ptr_running != nullptr)
+	{
+		m_ptr_balancer->end(m_ptr_running, std::chrono::steady_clock::now() - m_start, false);
+		m_ptr_running = nullptr;
+	}
+
+	if (m_ptr_connection != nullptr)
+	{
+		m_ptr_connection->set_observer(m_ptr_next);
+	}
+
+	m_ptr_connection = nullptr;
+	m_ptr_pool = nullptr;
+}
+
+
+//*********************************************************
+// 函数名称 : on_begin
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 记录连接池开始执行一条SQL语句
+// 访问方式 : public
+// 函数参数 : statement_event & event 事件
+//*********************************************************
+void sql::mariadb::balancer::probe::on_begin(statement_event & event) noexcept
+{
+	// 注册前创建的 command 仍然可能在取消注册后使用本对象, 这时只转发
+	if (m_ptr_pool != nullptr && m_ptr_running == nullptr)
+	{
+		m_ptr_balancer->begin(m_ptr_pool);
+		m_ptr_running = m_ptr_pool;
+		m_start = std::chrono::steady_clock::now();
+	}
+
+	if (m_ptr_next != nullptr)
+	{
+		m_ptr_next->on_begin(event);
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : on_end
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 记录SQL语句的耗时; 网络错误和超时记录为失败
+// 访问方式 : public
+// 函数参数 : const statement_event & event 事件
+//*********************************************************
+void sql::mariadb::balancer::probe::on_end(const statement_event & event) noexcept
+{
+	if (m_ptr_running != nullptr)
+	{
+		m_ptr_balancer->end(m_ptr_running, event.duration, server_fault(event.error));
+		m_ptr_running = nullptr;
+	}
+
+	if (m_ptr_next != nullptr)
+	{
+		m_ptr_next->on_end(event);
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : balanced_connection
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 转移构造函数, 转移后原对象不应该使用
+// 访问方式 : public
+// 函数参数 : balanced_connection && connector 需要转移的对象
+//*********************************************************
+sql::mariadb::balanced_connection::balanced_connection(balanced_connection && connector) noexcept
+	: m_ptr_balancer(connector.m_ptr_balancer)
+	, m_ptr_pool(connector.m_ptr_pool)
+	, m_connection(std::move(connector.m_connection))
+	, m_ptr_probe(std::move(connector.m_ptr_probe))
+	, m_failed(connector.m_failed)
+{
+	connector.m_ptr_balancer = nullptr;
+}
+
+
+//*********************************************************
+// 函数名称 : balanced_connection
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数
+// 访问方式 : private
+// 函数参数 : balancer * balance 负载均衡对象
+// 函数参数 : connection_pool * pool 连接池
+// 函数参数 : pooled_connection && connector 数据库连接
+// 函数参数 : std::unique_ptr<balancer::probe> && observer 注册到数据库连接上的观察者
+//*********************************************************
+sql::mariadb::balanced_connection::balanced_connection(balancer * balance, connection_pool * pool, pooled_connection && connector,
+	std::unique_ptr<balancer::probe> && observer) noexcept
+	: m_ptr_balancer(balance)
+	, m_ptr_pool(pool)
+	, m_connection(std::move(connector))
+	, m_ptr_probe(std::move(observer))
+	, m_failed(false)
+{
+	m_ptr_probe->attach(balance, pool, m_connection.get());
+}
+
+
+//*********************************************************
+// 函数名称 : ~balanced_connection
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 停止记录延迟并将数据库连接归还给连接池
+// 访问方式 : public
+//*********************************************************
+sql::mariadb::balanced_connection::~balanced_connection(void) noexcept
+{
+	if (m_ptr_balancer == nullptr)
+	{
+		return;
+	}
+
+	m_ptr_probe->detach();
+
+	if (m_failed)
+	{
+		m_ptr_balancer->fail(m_ptr_pool);
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : get
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取数据库连接
+// 访问方式 : public
+// 返 回 值 : const connection & 数据库连接
+//*********************************************************
+const sql::mariadb::connection & sql::mariadb::balanced_connection::get(void) const noexcept
+{
+	return m_connection.get();
+}
+
+
+//*********************************************************
+// 函数名称 : operator const connection &
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 转换成数据库连接
+// 访问方式 : public
+// 返 回 值 : const connection & 数据库连接
+//*********************************************************
+sql::mariadb::balanced_connection::operator const connection &(void) const noexcept
+{
+	return m_connection.get();
+}
+
+
+//*********************************************************
+// 函数名称 : discard
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 标记请求失败, 归还时关闭连接并记录一次失败
+// 访问方式 : public
+//*********************************************************
+void sql::mariadb::balanced_connection::discard(void) noexcept
+{
+	m_failed = true;
+	m_connection.discard();
+}
+
+
+//*********************************************************
+// 函数名称 : router
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数, 有从服务器时启动检查复制延迟的后台线程
+// 访问方式 : public
+// 函数参数 : connection_pool & primary 主服务器连接池
+// 函数参数 : const std::vector<connection_pool *> & replicas 从服务器连接池
+// 函数参数 : unsigned int max_lag 允许的最大复制延迟 (秒)
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+//            如果创建线程失败则抛出 std::system_error 异常
+//*********************************************************
+sql::mariadb::router::router(connection_pool & primary, const std::vector<connection_pool *> & replicas, unsigned int max_lag)
+	: m_primary(primary)
+	, m_max_lag(max_lag)
+	, m_check_interval(1000)
+	, m_gtid_wait_timeout(50)
+	, m_next(0)
+	, m_ptr_balancer(nullptr)
+	, m_stop(false)
+{
+	m_replicas.reserve(replicas.size());
+
+	for (const auto pool : replicas)
+	{
+		assert(pool != nullptr);
+
+		// 检查用的连接使用较短的超时时间, 从服务器没有响应时不会长时间推迟其他从服务器的检查
+		std::unique_ptr<endpoint> point(new endpoint(pool->get_endpoint()));
+		point->options().set_connect_timeout(2);
+		point->options().set_read_timeout(2);
+		point->options().set_write_timeout(2);
+
+		// 第一次检查完成前认为从服务器可用
+		m_replicas.push_back(replica{ pool, 0, std::move(point), nullptr });
+	}
+
+	if (!m_replicas.empty())
+	{
+		m_thread = std::thread(&router::run, this);
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : ~router
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 结束检查复制延迟的后台线程
+// 访问方式 : public
+//*********************************************************
+sql::mariadb::router::~router(void) noexcept
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+
+	m_changed.notify_all();
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : set_lag_check_interval
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置检查从服务器复制延迟的间隔
+// 访问方式 : public
+// 函数参数 : unsigned int milliseconds 毫秒数
+//*********************************************************
+void sql::mariadb::router::set_lag_check_interval(unsigned int milliseconds) noexcept
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_check_interval = std::chrono::milliseconds(milliseconds);
+	}
+
+	m_changed.notify_all();
+}
+
+
+//*********************************************************
+// 函数名称 : set_gtid_wait_timeout
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置从服务器等待读写一致性令牌的最长时间
+// 访问方式 : public
+// 函数参数 : unsigned int milliseconds 毫秒数
+//*********************************************************
+void sql::mariadb::router::set_gtid_wait_timeout(unsigned int milliseconds) noexcept
+{
+	m_gtid_wait_timeout = milliseconds;
+}
+
+
+//*********************************************************
+// 函数名称 : set_balancer
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置负载均衡对象
+// 访问方式 : public
+// 函数参数 : balancer * balance 负载均衡对象, nullptr 代表轮流选择
+//*********************************************************
+void sql::mariadb::router::set_balancer(balancer * balance) noexcept
+{
+	m_ptr_balancer = balance;
+}
+
+
+//*********************************************************
+// 函数名称 : primary
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取主服务器连接池
+// 访问方式 : public
+// 返 回 值 : connection_pool & 主服务器连接池
+//*********************************************************
+sql::mariadb::connection_pool & sql::mariadb::router::primary(void) noexcept
+{
+	return m_primary;
+}
+
+
+//*********************************************************
+// 函数名称 : select_replica
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 选择一个复制延迟没有超过上限的从服务器连接池
+// 访问方式 : public
+// 返 回 值 : connection_pool * 从服务器连接池; 如果没有可用的从服务器则返回 nullptr
+//*********************************************************
+sql::mariadb::connection_pool * sql::mariadb::router::select_replica(void) noexcept
+{
+	const auto count = m_replicas.size();
+
+	if (m_ptr_balancer != nullptr)
+	{
+		try
+		{
+			std::vector<connection_pool *> candidates;
+			candidates.reserve(count);
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (this->healthy(i))
+				{
+					candidates.push_back(m_replicas[i].pool);
+				}
+			}
+
+			return m_ptr_balancer->select(candidates);
+		}
+		catch (const std::exception &)
+		{
+			return nullptr;
+		}
+	}
+
+	const auto start = m_next++;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		const auto index = (start + i) % count;
+
+		if (this->healthy(index))
+		{
+			return m_replicas[index].pool;
+		}
+	}
+
+	return nullptr;
+}
+
+
+//*********************************************************
+// 函数名称 : is_read
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 判断SQL语句能否发送到从服务器
+// 访问方式 : public
+// 函数参数 : const char * text SQL语句
+// 函数参数 : unsigned long length SQL语句字符串长度
+// 返 回 值 : bool 如果可以发送到从服务器返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::router::is_read(const char * text, unsigned long length) noexcept
+{
+	const auto end = text + length;
+	const auto pointer = skip_comments(text, end);
+
+	// 开头的注释中指定的路由
+	const char primary_hint[] = "route:primary";
+	const char replica_hint[] = "route:replica";
+
+	if (std::search(text, pointer, primary_hint, primary_hint + sizeof(primary_hint) - 1) != pointer)
+	{
+		return false;
+	}
+
+	if (std::search(text, pointer, replica_hint, replica_hint + sizeof(replica_hint) - 1) != pointer)
+	{
+		return true;
+	}
+
+	// 加锁、写入或者结果与会话相关的语句只能在主服务器上执行
+	return is_plain_read(pointer, end);
+}
+
+
+//*********************************************************
+// 函数名称 : healthy
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 判断从服务器最后一次检查的复制延迟是否没有超过上限
+// 访问方式 : private
+// 函数参数 : size_t index 从服务器的位置
+// 返 回 值 : bool 如果可以使用返回true; 反之返回false
+//*********************************************************
+bool sql::mariadb::router::healthy(size_t index) noexcept
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const auto lag = m_replicas[index].lag;
+	return lag >= 0 && lag <= m_max_lag;
+}
+
+
+//*********************************************************
+// 函数名称 : run
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 后台线程, 每隔 m_check_interval 检查一次所有从服务器的复制延迟
+// 访问方式 : private
+//*********************************************************
+void sql::mariadb::router::run(void) noexcept
+{
+	mysql_thread_init();
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (!m_stop)
+	{
+		for (auto &state : m_replicas)
+		{
+			// 检查时不持有锁, 选择从服务器的线程继续使用上一次的结果
+			lock.unlock();
+			const auto lag = check_lag(state.prober, *state.point);
+			lock.lock();
+
+			state.lag = lag;
+			if (m_stop)
+			{
+				break;
+			}
+		}
+
+		if (!m_stop)
+		{
+			m_changed.wait_for(lock, m_check_interval);
+		}
+	}
+
+	lock.unlock();
+
+	for (auto &state : m_replicas)
+	{
+		state.prober.reset();
+	}
+
+	mysql_thread_end();
+}
+
+
+//*********************************************************
+// 函数名称 : check_lag
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 在检查用的连接上使用 SHOW SLAVE STATUS 获取从服务器的复制延迟;
+//            连接没有打开或者已经断开时重新连接
+// 访问方式 : private
+// 函数参数 : std::unique_ptr<connection> & prober 检查用的连接, 失败时被关闭
+// 函数参数 : const endpoint & point 从服务器参数
+// 返 回 值 : long long 复制延迟 (秒); 如果无法连接或者复制已经停止则返回 -1;
+//            如果服务器不是从服务器则返回 0
+//*********************************************************
+long long sql::mariadb::router::check_lag(std::unique_ptr<connection> & prober, const endpoint & point) noexcept
+try
+{
+	if (prober == nullptr)
+	{
+		std::unique_ptr<connection> connector(new connection);
+		if (*connector == nullptr || !connector->open(point))
+		{
+			return -1;
+		}
+		prober = std::move(connector);
+	}
+
+	try
+	{
+		auto reader = command(*prober).execute_reader("SHOW SLAVE STATUS");
+
+		if (!reader.read())
+		{
+			return 0;
+		}
+
+		// 复制已经停止时 Seconds_Behind_Master 为 NULL
+		const auto index = reader.field_index("Seconds_Behind_Master");
+		if (index == reader.field_count() || reader.is_null(index))
+		{
+			return -1;
+		}
+
+		return reader.get_longlong(index);
+	}
+	catch (const std::exception &)
+	{
+		prober.reset();
+		return -1;
+	}
+}
+catch (const std::exception &)
+{
+	return -1;
+}
+
+
+//*********************************************************
+// 函数名称 : routed_session
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数
+// 访问方式 : public
+// 函数参数 : router & route 路由对象
+//*********************************************************
+sql::mariadb::routed_session::routed_session(router & route) noexcept
+	: m_router(route)
+	, m_replica_pool(nullptr)
+	, m_written(false)
+	, m_pinned(false)
+	, m_synced(false)
+{
+}
+
+
+//*********************************************************
+// 函数名称 : ~routed_session
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 归还数据库连接
+// 访问方式 : public
+//*********************************************************
+sql::mariadb::routed_session::~routed_session(void) noexcept
+{
+	// 先恢复连接原来的观察者再归还连接
+	m_probe.detach();
+}
+
+
+//*********************************************************
+// 函数名称 : route
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 根据SQL语句选择数据库连接, 会话结束前借出的连接会被重复使用
+// 访问方式 : public
+// 函数参数 : const std::string & text SQL语句
+// 返 回 值 : const connection & 用于执行该SQL语句的数据库连接
+// 异    常 : 如果无法连接主服务器则抛出 mariadb_exception 异常;
+//            如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+const sql::mariadb::connection & sql::mariadb::routed_session::route(const std::string & text)
+{
+	// 选择连接和等待令牌时执行的SQL语句不记录为读语句的延迟
+	m_probe.detach();
+
+	// 事务中 (包括关闭了自动提交) 的语句必须在同一个连接上执行
+	if (m_primary != nullptr && (m_primary->get().in_transaction() || !m_primary->get().autocommit()))
+	{
+		return m_primary->get();
+	}
+
+	if (!router::is_read(text.c_str(), (unsigned long)text.size()))
+	{
+		m_written = true;
+		return this->primary();
+	}
+
+	const auto connector = this->replica();
+	if (connector == nullptr)
+	{
+		return this->primary();
+	}
+
+	if (m_router.m_ptr_balancer != nullptr)
+	{
+		m_probe.attach(m_router.m_ptr_balancer, m_replica_pool, *connector);
+	}
+
+	return *connector;
+}
+
+
+//*********************************************************
+// 函数名称 : primary
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取主服务器的数据库连接
+// 访问方式 : public
+// 返 回 值 : const connection & 主服务器的数据库连接
+// 异    常 : 如果无法连接主服务器则抛出 mariadb_exception 异常;
+//            如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+const sql::mariadb::connection & sql::mariadb::routed_session::primary(void)
+{
+	if (m_primary == nullptr)
+	{
+		m_primary.reset(new pooled_connection(m_router.primary().acquire()));
+	}
+
+	return m_primary->get();
+}
+
+
+//*********************************************************
+// 函数名称 : token
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取读写一致性令牌 (最后一次写入的 GTID)
+// 访问方式 : public
+// 返 回 值 : std::string 令牌; 如果没有写入过或者获取失败则返回空字符串
+//*********************************************************
+std::string sql::mariadb::routed_session::token(void) noexcept
+try
+{
+	if (m_written && m_primary != nullptr)
+	{
+		// 写入后只需要获取一次, 之后的读语句都使用同一个令牌
+		auto reader = command(m_primary->get()).execute_reader("SELECT @@last_gtid");
+		reader.read();
+		m_token = reader.is_null(0) ? std::string() : std::string(reader.get_raw(0), reader.data_size(0));
+		m_written = false;
+		m_synced = false;
+
+		// 写入后没有 GTID 时无法保证从服务器能读到写入的数据
+		m_pinned = m_pinned || m_token.empty();
+	}
+
+	return m_token;
+}
+catch (const std::exception &)
+{
+	return std::string();
+}
+
+
+//*********************************************************
+// 函数名称 : set_token
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置读写一致性令牌
+// 访问方式 : public
+// 函数参数 : std::string token 其他会话的 token 返回的令牌
+//*********************************************************
+void sql::mariadb::routed_session::set_token(std::string token) noexcept
+{
+	m_token = std::move(token);
+	m_synced = false;
+}
+
+
+//*********************************************************
+// 函数名称 : replica
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 选择从服务器的数据库连接并等待读写一致性令牌
+// 访问方式 : private
+// 返 回 值 : const connection * 从服务器的数据库连接; 如果没有可用的从服务器,
+//            等待令牌超时, 或者写入后无法获取令牌则返回 nullptr
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+//*********************************************************
+const sql::mariadb::connection * sql::mariadb::routed_session::replica(void)
+{
+	// 写入后无法获取令牌时不能保证从服务器能读到写入的数据
+	const auto gtid = this->token();
+	if (m_written || m_pinned)
+	{
+		return nullptr;
+	}
+
+	const auto pool = m_router.select_replica();
+	if (pool == nullptr)
+	{
+		return nullptr;
+	}
+
+	if (m_replica == nullptr || m_replica_pool != pool)
+	{
+		m_replica.reset();
+		m_replica_pool = nullptr;
+		m_synced = false;
+
+		try
+		{
+			m_replica.reset(new pooled_connection(pool->acquire()));
+			m_replica_pool = pool;
+		}
+		catch (const mariadb_exception &)
+		{
+			return nullptr;
+		}
+	}
+
+	if (gtid.empty() || m_synced)
+	{
+		return &m_replica->get();
+	}
+
+	// 令牌只能包含 GTID 使用的字符, 防止 set_token 传入的令牌改变SQL语句
+	if (gtid.find_first_not_of("0123456789-, ") != std::string::npos)
+	{
+		return nullptr;
+	}
+
+	// MASTER_GTID_WAIT 返回 0 代表已经复制到该位置, -1 代表超时
+	const auto text = "SELECT MASTER_GTID_WAIT('" + gtid + "', " + std::to_string(m_router.m_gtid_wait_timeout / 1000.0) + ")";
+
+	try
+	{
+		auto reader = command(m_replica->get()).execute_reader(text);
+		m_synced = reader.read() && !reader.is_null(0) && reader.get_int(0) == 0;
+	}
+	catch (const mariadb_exception &)
+	{
+		m_replica->discard();
+		m_replica.reset();
+		m_replica_pool = nullptr;
+		return nullptr;
+	}
+
+	return m_synced ? &m_replica->get() : nullptr;
+}
+
+
+//*********************************************************
+// 函数名称 : hedging_policy
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数
+// 访问方式 : public
+// 函数参数 : double percentile 使用最近延迟的哪个分位数作为对冲的等待时间, 范围为 (0, 1)
+// 函数参数 : unsigned int min_delay 最短的等待时间 (毫秒)
+// 函数参数 : unsigned int max_delay 最长的等待时间 (毫秒), 样本不足时使用
+// 函数参数 : double budget 对冲次数最多占读取次数的比例
+//*********************************************************
+sql::mariadb::hedging_policy::hedging_policy(double percentile, unsigned int min_delay, unsigned int max_delay, double budget) noexcept
+	: m_percentile(percentile)
+	, m_min_delay(min_delay)
+	, m_max_delay(std::max(min_delay, max_delay))
+	, m_budget(budget)
+{
+	assert(percentile > 0.0 && percentile < 1.0);
+}
+
+
+//*********************************************************
+// 函数名称 : percentile
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取作为等待时间的延迟分位数
+// 访问方式 : public
+// 返 回 值 : double 分位数
+//*********************************************************
+double sql::mariadb::hedging_policy::percentile(void) const noexcept
+{
+	return m_percentile;
+}
+
+
+//*********************************************************
+// 函数名称 : min_delay
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取最短的等待时间
+// 访问方式 : public
+// 返 回 值 : std::chrono::milliseconds 等待时间
+//*********************************************************
+std::chrono::milliseconds sql::mariadb::hedging_policy::min_delay(void) const noexcept
+{
+	return std::chrono::milliseconds(m_min_delay);
+}
+
+
+//*********************************************************
+// 函数名称 : max_delay
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取最长的等待时间
+// 访问方式 : public
+// 返 回 值 : std::chrono::milliseconds 等待时间
+//*********************************************************
+std::chrono::milliseconds sql::mariadb::hedging_policy::max_delay(void) const noexcept
+{
+	return std::chrono::milliseconds(m_max_delay);
+}
+
+
+//*********************************************************
+// 函数名称 : budget
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取对冲次数最多占读取次数的比例
+// 访问方式 : public
+// 返 回 值 : double 比例
+//*********************************************************
+double sql::mariadb::hedging_policy::budget(void) const noexcept
+{
+	return m_budget;
+}
+
+
+// 一次对冲读取的共享状态, 由调用线程和执行读取的线程共同持有
+struct sql::mariadb::hedged_reader::race
+{
+	work task; // 执行SQL语句并保存结果
+	connection_pool *pools[2]; // 每次读取使用的连接池
+	unsigned long thread_ids[2]; // 正在执行的读取的连接线程ID, 0 代表没有在执行
+	std::exception_ptr errors[2]; // 每次读取的异常
+	size_t launched; // 已经开始的读取次数
+	size_t finished; // 已经结束的读取次数
+	size_t winner; // 先成功的是第几次, 2 代表还没有
+	std::mutex mutex; // 保护以上成员
+	std::condition_variable done; // 读取结束时通知调用线程
+	bool scheduled; // 是否还在 m_deadlines 中, 由 hedged_reader::m_mutex 保护
+};
+
+
+//*********************************************************
+// 函数名称 : hedged_reader
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数
+// 访问方式 : public
+// 函数参数 : router & route 路由对象, 从中选择从服务器
+// 函数参数 : const hedging_policy & policy 对冲读取的策略
+//*********************************************************
+sql::mariadb::hedged_reader::hedged_reader(router & route, const hedging_policy & policy) noexcept
+	: m_router(route)
+	, m_policy(policy)
+	, m_next_sample(0)
+	, m_delay(policy.max_delay())
+	, m_reads(0)
+	, m_hedges(0)
+	, m_outstanding(0)
+	, m_stop(false)
+{
+}
+
+
+//*********************************************************
+// 函数名称 : ~hedged_reader
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 停止定时线程, 等待所有输掉的读取结束
+// 访问方式 : public
+//*********************************************************
+sql::mariadb::hedged_reader::~hedged_reader(void) noexcept
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_stop = true;
+	m_wakeup.notify_all();
+	lock.unlock();
+
+	if (m_timer.joinable())
+	{
+		m_timer.join();
+	}
+
+	lock.lock();
+	m_finished.wait(lock, [this]() { return m_outstanding == 0; });
+}
+
+
+//*********************************************************
+// 函数名称 : delay
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取当前的对冲等待时间
+// 访问方式 : public
+// 返 回 值 : std::chrono::microseconds 等待时间
+//*********************************************************
+std::chrono::microseconds sql::mariadb::hedged_reader::delay(void) const noexcept
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_delay;
+}
+
+
+//*********************************************************
+// 函数名称 : reads
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取发送到从服务器的读取次数
+// 访问方式 : public
+// 返 回 值 : unsigned long long 次数
+//*********************************************************
+unsigned long long sql::mariadb::hedged_reader::reads(void) const noexcept
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_reads;
+}
+
+
+//*********************************************************
+// 函数名称 : hedges
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取对冲的次数
+// 访问方式 : public
+// 返 回 值 : unsigned long long 次数
+//*********************************************************
+unsigned long long sql::mariadb::hedged_reader::hedges(void) const noexcept
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_hedges;
+}
+
+
+//*********************************************************
+// 函数名称 : run
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 在调用线程上执行 task, 等待时间到期时由定时线程在第二个从服务器上
+//            再执行一次; 第一次失败时在调用线程上立即对冲
+// 访问方式 : private
+// 函数参数 : const std::string & text SQL语句
+// 函数参数 : const work & task 在数据库连接上执行SQL语句并保存第 index 次的结果
+// 返 回 值 : size_t 先成功的是第几次 (0 或者 1)
+// 异    常 : 如果所有读取都失败则抛出第一次读取的异常
+//*********************************************************
+size_t sql::mariadb::hedged_reader::run(const std::string & text, const work & task)
+{
+	const auto first = router::is_read(text.data(), static_cast<unsigned long>(text.size())) ? m_router.select_replica() : nullptr;
+
+	// 写语句或者没有可用的从服务器时直接在主服务器上执行
+	if (first == nullptr)
+	{
+		task(m_router.primary().acquire(), 0);
+		return 0;
+	}
+
+	const auto state = std::make_shared<race>();
+	state->task = task;
+	state->pools[0] = first;
+	state->pools[1] = nullptr;
+	state->thread_ids[0] = 0;
+	state->thread_ids[1] = 0;
+	state->launched = 1;
+	state->finished = 0;
+	state->winner = 2;
+	state->scheduled = false;
+
+	std::multimap<std::chrono::steady_clock::time_point, std::weak_ptr<race>>::iterator entry;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		++m_reads;
+
+		try
+		{
+			if (!m_timer.joinable())
+			{
+				m_timer = std::thread(&hedged_reader::schedule, this);
+			}
+
+			entry = m_deadlines.emplace(std::chrono::steady_clock::now() + m_delay, state);
+			state->scheduled = true;
+
+			// 定时线程只需要在最早的到期时间改变时唤醒
+			if (entry == m_deadlines.begin())
+			{
+				m_wakeup.notify_one();
+			}
+		}
+		catch (const std::exception &)
+		{
+			// 无法创建定时线程时只在第一次失败后对冲
+		}
+	}
+
+	this->attempt(state, 0);
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (state->scheduled)
+		{
+			m_deadlines.erase(entry);
+			state->scheduled = false;
+		}
+	}
+
+	std::unique_lock<std::mutex> lock(state->mutex);
+
+	if (state->winner == 2 && state->launched == 1)
+	{
+		lock.unlock();
+
+		if (this->claim(state))
+		{
+			this->attempt(state, 1);
+		}
+
+		lock.lock();
+	}
+
+	state->done.wait(lock, [&state]() { return state->winner != 2 || state->finished == state->launched; });
+
+	if (state->winner != 2)
+	{
+		return state->winner;
+	}
+
+	std::rethrow_exception(state->errors[0] != nullptr ? state->errors[0] : state->errors[1]);
+}
+
+
+//*********************************************************
+// 函数名称 : claim
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 如果还没有结果、还没有对冲并且没有超过对冲预算, 则占用第二次读取
+// 访问方式 : private
+// 函数参数 : const std::shared_ptr<race> & state 共享状态
+// 返 回 值 : bool 如果占用成功返回true, 调用者负责执行第二次读取; 反之返回false
+//*********************************************************
+bool sql::mariadb::hedged_reader::claim(const std::shared_ptr<race> & state) noexcept
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_hedges >= m_policy.budget() * m_reads)
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> guard(state->mutex);
+
+	if (state->winner != 2 || state->launched != 1)
+	{
+		return false;
+	}
+
+	state->launched = 2;
+	++m_hedges;
+	return true;
+}
+
+
+//*********************************************************
+// 函数名称 : schedule
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 定时线程, 等待时间到期时为还没有结果的读取创建对冲线程
+// 访问方式 : private
+//*********************************************************
+void sql::mariadb::hedged_reader::schedule(void) noexcept
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (!m_stop)
+	{
+		if (m_deadlines.empty())
+		{
+			m_wakeup.wait(lock);
+			continue;
+		}
+
+		const auto deadline = m_deadlines.begin()->first;
+		if (std::chrono::steady_clock::now() < deadline)
+		{
+			m_wakeup.wait_until(lock, deadline);
+			continue;
+		}
+
+		const auto state = m_deadlines.begin()->second.lock();
+		m_deadlines.erase(m_deadlines.begin());
+
+		if (state == nullptr)
+		{
+			continue;
+		}
+
+		state->scheduled = false;
+		lock.unlock();
+
+		if (this->claim(state))
+		{
+			lock.lock();
+			++m_outstanding;
+			lock.unlock();
+
+			try
+			{
+				// 输掉的读取在调用线程返回后继续运行, 析构函数会等待它结束
+				std::thread(&hedged_reader::hedge, this, state).detach();
+			}
+			catch (const std::exception &)
+			{
+				// 无法创建线程时放弃对冲, 调用线程只等待第一次读取
+				{
+					std::lock_guard<std::mutex> guard(state->mutex);
+					state->launched = 1;
+					state->done.notify_all();
+				}
+
+				lock.lock();
+				--m_outstanding;
+				--m_hedges;
+				lock.unlock();
+			}
+		}
+
+		lock.lock();
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : hedge
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 对冲线程, 执行第二次读取
+// 访问方式 : private
+// 函数参数 : std::shared_ptr<race> state 共享状态
+//*********************************************************
+void sql::mariadb::hedged_reader::hedge(std::shared_ptr<race> state) noexcept
+{
+	mysql_thread_init();
+	this->attempt(state, 1);
+	mysql_thread_end();
+
+	// 通知必须在持有锁时进行, 否则析构函数可能在通知前销毁条件变量
+	std::lock_guard<std::mutex> lock(m_mutex);
+	--m_outstanding;
+	m_finished.notify_all();
+}
+
+
+//*********************************************************
+// 函数名称 : attempt
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 在当前线程中执行第 index 次读取; 第二次读取选择另一个从服务器
+// 访问方式 : private
+// 函数参数 : const std::shared_ptr<race> & state 共享状态
+// 函数参数 : size_t index 第几次读取
+//*********************************************************
+void sql::mariadb::hedged_reader::attempt(const std::shared_ptr<race> & state, size_t index) noexcept
+{
+	const auto start = std::chrono::steady_clock::now();
+	std::exception_ptr error;
+	auto won = false;
+
+	try
+	{
+		if (index == 1)
+		{
+			// pools[0] 在开始读取前已经设置, 之后不会改变
+			connection_pool *second = nullptr;
+			for (int i = 0; i < 4 && (second == nullptr || second == state->pools[0]); ++i)
+			{
+				second = m_router.select_replica();
+			}
+
+			if (second == nullptr || second == state->pools[0])
+			{
+				throw mariadb_exception("no other replica available", __FILE__, __LINE__);
+			}
+
+			std::lock_guard<std::mutex> lock(state->mutex);
+			state->pools[1] = second;
+		}
+
+		auto connector = state->pools[index]->acquire();
+		auto started = false;
+
+		{
+			std::lock_guard<std::mutex> lock(state->mutex);
+			if (state->winner == 2)
+			{
+				state->thread_ids[index] = connector.get().thread_id();
+				started = true;
+			}
+		}
+
+		if (started)
+		{
+			try
+			{
+				state->task(connector, index);
+			}
+			catch (...)
+			{
+				error = std::current_exception();
+			}
+
+			std::lock_guard<std::mutex> lock(state->mutex);
+			state->thread_ids[index] = 0;
+
+			if (state->winner != 2)
+			{
+				// 输掉的连接可能已经或者将要收到 KILL QUERY, 不能再使用
+				connector.discard();
+			}
+			else if (error == nullptr)
+			{
+				state->winner = index;
+				won = true;
+			}
+		}
+	}
+	catch (...)
+	{
+		error = std::current_exception();
+	}
+
+	if (won)
+	{
+		this->record(std::chrono::steady_clock::now() - start);
+	}
+
+	connection_pool *loser = nullptr;
+	unsigned long thread_id = 0;
+	{
+		std::lock_guard<std::mutex> lock(state->mutex);
+		state->errors[index] = error;
+		++state->finished;
+
+		if (won && state->pools[1 - index] != nullptr)
+		{
+			loser = state->pools[1 - index];
+			thread_id = state->thread_ids[1 - index];
+		}
+
+		state->done.notify_all();
+	}
+
+	// 由后台线程发送 KILL QUERY, 先成功的一次不需要等待
+	if (thread_id != 0)
+	{
+		try
+		{
+			query_killer::instance().post(loser->get_endpoint(), thread_id, 0);
+		}
+		catch (const std::exception &)
+		{
+		}
+	}
+}
+
+
+//*********************************************************
+// 函数名称 : record
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 记录成功的读取的延迟, 并定期重新计算对冲等待时间
+// 访问方式 : private
+// 函数参数 : std::chrono::nanoseconds elapsed 延迟
+//*********************************************************
+void sql::mariadb::hedged_reader::record(std::chrono::nanoseconds elapsed) noexcept
+try
+{
+	static const size_t capacity = 1024; // 保存的样本数
+	static const size_t period = 64; // 每多少个样本重新计算一次等待时间
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	const auto sample = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+
+	if (m_samples.size() < capacity)
+	{
+		m_samples.push_back(static_cast<double>(sample));
+	}
+	else
+	{
+		m_samples[m_next_sample] = static_cast<double>(sample);
+	}
+
+	m_next_sample = (m_next_sample + 1) % capacity;
+
+	if (m_next_sample % period != 0)
+	{
+		return;
+	}
+
+	auto sorted = m_samples;
+	const auto nth = sorted.begin() + static_cast<std::ptrdiff_t>(m_policy.percentile() * (sorted.size() - 1));
+	std::nth_element(sorted.begin(), nth, sorted.end());
+
+	const std::chrono::microseconds lower = m_policy.min_delay();
+	const std::chrono::microseconds upper = m_policy.max_delay();
+	m_delay = std::min(upper, std::max(lower, std::chrono::microseconds(static_cast<long long>(*nth))));
+}
+catch (const std::exception &)
+{
+}
+
+
+//*********************************************************
+// 函数名称 : transaction
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数, 开始事务
+// 访问方式 : public
+// 函数参数 : const connection & connector 数据库连接, 不能已经在事务中
+// 异    常 : 如果开始事务失败则抛出 mariadb_exception 异常
 //*********************************************************
-sql::mariadb::command::command(const connection & connector, const std::string & text)
-	: command(connector, std::string(text))
+sql::mariadb::transaction::transaction(const connection & connector)
+	: m_ptr_connection(&connector)
+	, m_active(false)
 {
+	assert(!connector.in_transaction());
+	this->control("START TRANSACTION");
+	m_active = true;
 }
 
 
 //*********************************************************
-// 函数名称 : command
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/15
-// 函数说明 : 构造函数
+// 函数名称 : transaction
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 转移构造函数, 转移后原对象不应该使用
 // 访问方式 : public
-// 函数参数 : const connection & connector 数据库连接类
-// 函数参数 : std::string && text SQL语句
+// 函数参数 : transaction && scope 需要转移的对象
 //*********************************************************
-sql::mariadb::command::command(const connection & connector, std::string && text) noexcept
-	: m_ptr_mysql(connector.m_ptr_mysql)
-	, m_text(std::move(text))
+sql::mariadb::transaction::transaction(transaction && scope) noexcept
+	: m_ptr_connection(scope.m_ptr_connection)
+	, m_active(scope.m_active)
 {
+	scope.m_active = false;
 }
 
 
 //*********************************************************
-// 函数名称 : error
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/15
-// 函数说明 : 获取数据库操作失败的错误信息
-// 访问方式 : public 
-// 函数参数 : void
-// 返 回 值 : std::string 错误信息
+// 函数名称 : ~transaction
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 如果事务没有提交或者回滚则在析构时自动回滚
+// 访问方式 : public
 //*********************************************************
-std::string sql::mariadb::command::error(void) const noexcept
-try
-{
-	return std::string(mysql_error(m_ptr_mysql));
-}
-catch (const std::exception &)
+sql::mariadb::transaction::~transaction(void) noexcept
 {
-	return std::string();
+	this->rollback();
 }
 
 
 //*********************************************************
-// 函数名称 : errorno
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/15
-// 函数说明 : 获取数据库操作失败的错误代号
+// 函数名称 : commit
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 提交事务
 // 访问方式 : public
-// 返 回 值 : unsigned int 错误代号
+// 异    常 : 如果提交失败则抛出 mariadb_exception 异常, 事务已经结束
 //*********************************************************
-unsigned int sql::mariadb::command::errorno(void) const noexcept
+void sql::mariadb::transaction::commit(void)
 {
-	return mysql_errno(m_ptr_mysql);
+	assert(m_active);
+
+	// 提交失败时服务器已经回滚, 不需要再回滚
+	m_active = false;
+	this->control("COMMIT");
 }
 
 
 //*********************************************************
-// 函数名称 : prepare
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/15
-// 函数说明 : 预存SQL语句; 可使用以下例子防注入
-//            executer.prepare("select * from table where id = ?");
-//            executer.add(12);
+// 函数名称 : rollback
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 回滚事务
 // 访问方式 : public
-// 函数参数 : std::string && text
-// 返 回 值 : void
+// 返 回 值 : bool 如果回滚成功返回true; 反之返回false
 //*********************************************************
-void sql::mariadb::command::prepare(std::string && text) noexcept
+bool sql::mariadb::transaction::rollback(void) noexcept
 {
-	m_text = std::move(text);
+	if (!m_active)
+	{
+		return false;
+	}
+
+	m_active = false;
+	return command(*m_ptr_connection).execute("ROLLBACK");
 }
 
 
 //*********************************************************
-// 函数名称 : prepare
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/15
-// 函数说明 : 预存SQL语句; 可使用以下例子防注入
+// 函数名称 : active
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 判断事务是否还没有提交或者回滚
 // 访问方式 : public
-// 函数参数 : const std::string & text SQL语句
-// 返 回 值 : void
-// 异    常 : 如果尝试分配空间失败则抛出 std::bad_alloc 异常
+// 返 回 值 : bool 如果还没有结束返回true; 反之返回false
 //*********************************************************
-void sql::mariadb::command::prepare(const std::string & text)
+bool sql::mariadb::transaction::active(void) const noexcept
 {
-	m_text = text;
+	return m_active;
 }
 
 
 //*********************************************************
-// 函数名称 : add
-// 作    者 : Gooeen
-// 完成日期 : 2016/05/12
-// 函数说明 : 添加数据, 执行SQL语句时将本次添加的数据用单引
-//            号引起后代替SQL语句中第 pos 个问号; 例子如下:
-//            executer.prepare("insert into table1 values(?, ?)");
-//            executer.add(0, 12);
-//            executer.add(1, std::make_shared<std::string>("data"));
-//            在执行SQL语句时将产生 SQL语句:
-//            insert into table1 values(12, 'data')
-// 访问方式 : public
-// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
-// 函数参数 : std::shared_ptr<std::string> &&text 数据, 此数据在SQL语句中将以单引号引用
-// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+// 函数名称 : control
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 执行事务控制语句
+// 访问方式 : private
+// 函数参数 : const char * text SQL语句
+// 异    常 : 如果执行失败则抛出 mariadb_exception 异常
 //*********************************************************
-void sql::mariadb::command::add(unsigned int pos, std::shared_ptr<std::string> &&text)
+void sql::mariadb::transaction::control(const char * text) const
 {
-	// 保存字符串
-	m_strings.push_back(std::move(text));
+	const auto &connector = *m_ptr_connection;
 
-	// 保存数据的信息
-	const auto p = m_strings.back()->c_str();
-	const auto size = (unsigned long)m_strings.back()->size();
-	const auto pair = std::make_pair(p, size);
-	m_parameters[pos] = std::make_pair(false, pair);
+	if (!command(connector).execute(text))
+	{
+		throw mariadb_exception(connector.error() + "\r\nSQL: " + text, __FILE__, __LINE__,
+			connector.errorno(), connector.sqlstate().c_str());
+	}
 }
 
 
 //*********************************************************
-// 函数名称 : add
-// 作    者 : Gooeen
-// 完成日期 : 2016/05/12
-// 函数说明 : 添加数据, 执行SQL语句时将本次添加的数据用单引
-//            号引起后代替SQL语句中第 pos 个问号; 例子如下:
-//            executer.prepare("insert into table1 values(?, ?)");
-//            executer.add(0, 12);
-//            executer.add(1, std::make_shared<std::string>("data"));
-//            在执行SQL语句时将产生 SQL语句:
-//            insert into table1 values(12, 'data')
+// 函数名称 : group_commit
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数, 创建后台线程
 // 访问方式 : public
-// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
-// 函数参数 : const std::shared_ptr<std::string> &text 数据, 此数据在SQL语句中将以单引号引用
-// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
-//*********************************************************
-void sql::mariadb::command::add(unsigned int pos, const std::shared_ptr<std::string> &text)
+// 函数参数 : connection_pool & pool 连接池, 后台线程每次提交借出一个连接
+// 函数参数 : unsigned int interval 第一个单元最多等待多少毫秒后提交
+// 函数参数 : size_t max_batch 一次最多提交多少个单元
+// 异    常 : 如果创建线程失败则抛出 std::system_error 异常
+//*********************************************************
+sql::mariadb::group_commit::group_commit(connection_pool & pool, unsigned int interval, size_t max_batch)
+	: m_pool(pool)
+	, m_interval(interval)
+	, m_max_batch(std::max<size_t>(max_batch, 1))
+	, m_stop(false)
+	, m_thread(&group_commit::run, this)
 {
-	// 保存字符串
-	m_strings.push_back(text);
-
-	// 保存数据的信息
-	const auto p = m_strings.back()->c_str();
-	const auto size = (unsigned long)m_strings.back()->size();
-	const auto pair = std::make_pair(p, size);
-	m_parameters[pos] = std::make_pair(false, pair);
 }
 
 
 //*********************************************************
-// 函数名称 : add
-// 作    者 : Gooeen
-// 完成日期 : 2016/05/17
-// 函数说明 : 添加数据, 执行SQL语句时将本次添加的数据用单引
-//            号引起后代替SQL语句中第 pos 个问号; 例子如下:
-//            executer.prepare("insert into table1 values(?, ?)");
-//            executer.add(0, 12);
-//            executer.add(1, "data");
-//            在执行SQL语句时将产生 SQL语句:
-//            insert into table1 values(12, 'data')
+// 函数名称 : ~group_commit
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 提交剩余的单元并结束后台线程
 // 访问方式 : public
-// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
-// 函数参数 : std::string text 数据, 此数据在SQL语句中将以单引号引用
-// 返 回 值 : void
-// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
 //*********************************************************
-void sql::mariadb::command::add(unsigned int pos, std::string text)
+sql::mariadb::group_commit::~group_commit(void) noexcept
 {
-	this->add(pos, std::make_shared<std::string>(std::move(text)));
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+
+	m_changed.notify_all();
+	m_thread.join();
 }
 
 
 //*********************************************************
-// 函数名称 : add
-// 作    者 : Gooeen
-// 完成日期 : 2016/05/17
-// 函数说明 : 添加数据, 执行SQL语句时将本次添加的数据用单引
-//            号引起后代替SQL语句中第 pos 个问号; 例子如下:
-//            executer.prepare("insert into table1 values(?, ?)");
-//            executer.add(0, 12);
-//            executer.add(1, std::vector<char>({'H', 'e', 'l', 'l', 'o'}));
-//            在执行SQL语句时将产生 SQL语句:
-//            insert into table1 values(12, 'Hello')
+// 函数名称 : submit
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 提交一个写入单元
 // 访问方式 : public
-// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
-// 函数参数 : std::vector<char> data 数据, 此数据在SQL语句中将以单引号引用
-// 返 回 值 : void
+// 函数参数 : unit work 写入单元, 在后台线程中执行
+// 返 回 值 : std::future<void> 事务提交后就绪; 单元或者提交失败时 get 抛出异常
 // 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
 //*********************************************************
-void sql::mariadb::command::add(unsigned int pos, std::vector<char> data)
+std::future<void> sql::mariadb::group_commit::submit(unit work)
 {
-	// 保存数据
-	m_datas.push_back(std::make_shared<std::vector<char>>(std::move(data)));
+	entry item{ std::move(work), std::promise<void>() };
+	auto result = item.done.get_future();
 
-	// 保存数据的信息
-	const auto p = m_datas.back()->data();
-	const auto size = (unsigned long)m_datas.back()->size();
-	const auto pair = std::make_pair(p, size);
-	m_parameters[pos] = std::make_pair(false, pair);
+	std::lock_guard<std::mutex> lock(m_mutex);
+	assert(!m_stop);
+	m_queue.push_back(std::move(item));
+
+	// 第一个单元开始计时, 单元足够多时立即提交
+	if (m_queue.size() == 1 || m_queue.size() >= m_max_batch)
+	{
+		m_changed.notify_one();
+	}
+
+	return result;
 }
 
 
 //*********************************************************
-// 函数名称 : add
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/16
-// 函数说明 : 添加数据, 执行SQL语句时将本次添加的数据用单引
-//            号引起后代替SQL语句中第 pos 个问号; 例子如下:
-//            executer.prepare("insert into table1 values(?, ?)");
-//            executer.add(0, 12);
-//            executer.add(1, std::vector<unsigned char>({'H', 'e', 'l', 'l', 'o'}));
-//            在执行SQL语句时将产生 SQL语句:
-//            insert into table1 values(12, 'data')
-// 访问方式 : public
-// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
-// 函数参数 : std::vector<unsigned char> data 数据, 此数据在SQL语句中将以单引号引用
-// 返 回 值 : void
-// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+// 函数名称 : run
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 后台线程, 收集写入单元并提交
+// 访问方式 : private
 //*********************************************************
-void sql::mariadb::command::add(unsigned int pos, std::vector<unsigned char> data)
+void sql::mariadb::group_commit::run(void) noexcept
 {
-	// 保存数据
-	m_udatas.push_back(std::make_shared<std::vector<unsigned char>>(std::move(data)));
+	mysql_thread_init();
 
-	// 保存数据的信息
-	const auto p = (char *)m_udatas.back()->data();
-	const auto size = (unsigned long)m_udatas.back()->size();
-	const auto pair = std::make_pair(p, size);
-	m_parameters[pos] = std::make_pair(false, pair);
+	std::vector<entry> batch;
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (true)
+	{
+		m_changed.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+
+		if (m_queue.empty())
+		{
+			break;
+		}
+
+		// 等待更多单元, 提交期间到达的单元留给下一次
+		const auto deadline = std::chrono::steady_clock::now() + m_interval;
+		m_changed.wait_until(lock, deadline, [this]() { return m_stop || m_queue.size() >= m_max_batch; });
+
+		const auto count = std::min(m_queue.size(), m_max_batch);
+		batch.assign(std::make_move_iterator(m_queue.begin()), std::make_move_iterator(m_queue.begin() + count));
+		m_queue.erase(m_queue.begin(), m_queue.begin() + count);
+
+		lock.unlock();
+		this->flush(batch);
+		batch.clear();
+		lock.lock();
+	}
+
+	lock.unlock();
+	mysql_thread_end();
 }
 
 
 //*********************************************************
-// 函数名称 : escape
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/16
-// 函数说明 : 转换数据并保存到 to 参数所指向的缓冲区
-// 访问方式 : public
-// 函数参数 : char * to 保存转换后的字符串的缓冲区, 缓冲区大小应该比 (size * 2 + 1) 大
-// 函数参数 : const char * from 需要转换的字符串
-// 函数参数 : unsigned long size from 的长度
-// 返 回 值 : unsigned long 转换的字节数
+// 函数名称 : flush
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 在一个事务中执行所有写入单元并提交, 然后通知每个单元的结果
+// 访问方式 : private
+// 函数参数 : std::vector<entry> & batch 写入单元
 //*********************************************************
-unsigned long sql::mariadb::command::escape(char * to, const char * from, unsigned long size) const noexcept
+void sql::mariadb::group_commit::flush(std::vector<entry> & batch) noexcept
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(to != nullptr);
-	assert(from != nullptr);
-	return mysql_real_escape_string(m_ptr_mysql, to, from, size);
+	std::vector<std::exception_ptr> errors;
+	std::exception_ptr failure; // 使整个事务失败的异常
+
+	try
+	{
+		errors.resize(batch.size());
+
+		auto connector = m_pool.acquire();
+		const connection &target = connector;
+		transaction scope(target);
+
+		for (size_t i = 0; i < batch.size(); ++i)
+		{
+			if (!command(target).execute("SAVEPOINT group_commit_unit"))
+			{
+				throw mariadb_exception(target.error() + "\r\nSQL: SAVEPOINT", __FILE__, __LINE__, target.errorno(), target.sqlstate().c_str());
+			}
+
+			try
+			{
+				batch[i].work(target);
+
+				// 释放失败时按单元失败处理, 下面回滚到保存点; 保存点也不存在时整个事务失败
+				if (!command(target).execute("RELEASE SAVEPOINT group_commit_unit"))
+				{
+					throw mariadb_exception(target.error() + "\r\nSQL: RELEASE SAVEPOINT", __FILE__, __LINE__, target.errorno(), target.sqlstate().c_str());
+				}
+			}
+			catch (...)
+			{
+				errors[i] = std::current_exception();
+
+				// 死锁等错误会使服务器回滚整个事务, 保存点也不存在了, 其他单元只能一起失败
+				if (!command(target).execute("ROLLBACK TO SAVEPOINT group_commit_unit"))
+				{
+					throw;
+				}
+			}
+		}
+
+		scope.commit();
+	}
+	catch (...)
+	{
+		failure = std::current_exception();
+	}
+
+	for (size_t i = 0; i < batch.size(); ++i)
+	{
+		const auto error = i < errors.size() && errors[i] != nullptr ? errors[i] : failure;
+
+		try
+		{
+			if (error == nullptr)
+			{
+				batch[i].done.set_value();
+			}
+			else
+			{
+				batch[i].done.set_exception(error);
+			}
+		}
+		catch (const std::exception &)
+		{
+		}
+	}
 }
 
 
 //*********************************************************
-// 函数名称 : escape
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/16
-// 函数说明 : 转换数据并保存到字符串对象中
+// 函数名称 : slow_query_log
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 构造函数, 启动写日志的后台线程
 // 访问方式 : public
-// 函数参数 : const char * data 需要转换的数据
-// 函数参数 : unsigned long size 需要转换的数据的长度
-// 返 回 值 : std::string 转换后的字符串
+// 函数参数 : std::string path 日志文件路径, 轮转后的文件为 path.1, path.2, ...
+// 函数参数 : std::chrono::microseconds threshold 耗时不小于该值的SQL语句写入日志
 // 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
-//            如果执行失败则抛出 std::exception 异常
-//*********************************************************
-std::string sql::mariadb::command::escape(const char * data, unsigned long size) const
+//            如果创建线程失败则抛出 std::system_error 异常
+//*********************************************************
+sql::mariadb::slow_query_log::slow_query_log(std::string path, std::chrono::microseconds threshold)
+	: m_path(std::move(path))
+	, m_threshold(threshold)
+	, m_file_size(0)
+	, m_dropped(0)
+	, m_settings{ false, nullptr, 0, 64ULL * 1024 * 1024, 5 }
+	, m_capacity(10000)
+	, m_writing(0)
+	, m_stop(false)
+	, m_thread(&slow_query_log::run, this)
 {
-	auto buffer = this->escape_buffer(data, size);
-	return std::string(buffer.begin(), buffer.end());
 }
 
 
 //*********************************************************
-// 函数名称 : escape_with_quote
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/16
-// 函数说明 : 转换数据并以单引号引用保存到字符串对象中
+// 函数名称 : ~slow_query_log
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 写完队列中的记录后结束后台线程
+// 访问方式 : public
+//*********************************************************
+sql::mariadb::slow_query_log::~slow_query_log(void) noexcept
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+
+	m_changed.notify_all();
+	m_thread.join();
+}
+
+
+//*********************************************************
+// 函数名称 : set_redact
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置是否隐藏SQL语句中的数据; 隐藏时不写入完整的SQL语句,
+//            只写入指纹, 执行计划中的条件也可能包含数据, 需要时请同时关闭 EXPLAIN
 // 访问方式 : public
-// 函数参数 : const char * data 需要转换的数据
-// 函数参数 : unsigned long size 需要转换的数据的长度
-// 返 回 值 : std::string 转换后的字符串
-// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
-//            如果执行失败则抛出 std::exception 异常
+// 函数参数 : bool enable 是否隐藏
 //*********************************************************
-std::string sql::mariadb::command::escape_with_quote(const char * data, unsigned long size) const
+void sql::mariadb::slow_query_log::set_redact(bool enable) noexcept
 {
-	auto buffer = this->escape_buffer_with_quote(data, size);
-	return std::string(buffer.begin(), buffer.end());
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_settings.redact = enable;
 }
 
 
 //*********************************************************
-// 函数名称 : escape_buffer
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/16
-// 函数说明 : 转换数据并保存到 std::vector<char> 类型的缓冲区中
+// 函数名称 : set_explain
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置抽样执行 EXPLAIN FORMAT=JSON; 只对 SELECT/UPDATE/DELETE 语句执行,
+//            EXPLAIN 不会执行语句本身; 在后台线程中使用另一个连接, 不阻塞调用线程
 // 访问方式 : public
-// 函数参数 : const char * data 需要转换的数据
-// 函数参数 : unsigned long size 需要转换的数据的长度
-// 返 回 值 : std::vector<char> 保存转换后的数据的缓冲区
-// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
-//            如果执行失败则抛出 std::exception 异常
+// 函数参数 : const endpoint & point 执行 EXPLAIN 的服务器参数
+// 函数参数 : double rate 抽样比例, 范围为 [0, 1], 0 代表不执行
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
 //*********************************************************
-std::vector<char> sql::mariadb::command::escape_buffer(const char * data, unsigned long size) const
+void sql::mariadb::slow_query_log::set_explain(const endpoint & point, double rate)
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(data != nullptr);
-
-	std::vector<char> buffer(size * 2 + 1);
-	auto n = mysql_real_escape_string(m_ptr_mysql, buffer.data(), data, size);
-	buffer.resize(n);
+	// 后台线程可能正在使用原来的服务器参数, 所以替换指针而不是修改它;
+	// 后台线程发现服务器参数改变后关闭原来的连接
+	std::shared_ptr<const endpoint> target = std::make_shared<endpoint>(point);
 
-	return buffer;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_settings.ptr_endpoint.swap(target);
+	m_settings.explain_rate = std::min(std::max(rate, 0.0), 1.0);
 }
 
 
 //*********************************************************
-// 函数名称 : escape_buffer_with_quote
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/16
-// 函数说明 : 转换数据并并以单引号引用保存到 std::vector<char> 类型的缓冲区中
+// 函数名称 : set_rotation
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置日志文件轮转
 // 访问方式 : public
-// 函数参数 : const char * data 需要转换的数据
-// 函数参数 : unsigned long size 需要转换的数据的长度
-// 返 回 值 : std::vector<char> 保存转换后的数据的缓冲区
-// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
-//            如果执行失败则抛出 std::exception 异常
+// 函数参数 : unsigned long long max_bytes 文件超过该大小后轮转, 0 代表不轮转
+// 函数参数 : unsigned int max_files 最多保留多少个轮转后的文件
 //*********************************************************
-std::vector<char> sql::mariadb::command::escape_buffer_with_quote(const char * data, unsigned long size) const
+void sql::mariadb::slow_query_log::set_rotation(unsigned long long max_bytes, unsigned int max_files) noexcept
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(data != nullptr);
-
-	std::vector<char> buffer(size * 2 + 1 + 2);
-	auto n = mysql_real_escape_string(m_ptr_mysql, buffer.data() + 1, data, size);
-	buffer.resize(n + 2);
-	buffer.front() = '\'';
-	buffer.back() = '\'';
-	return buffer;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_settings.max_bytes = max_bytes;
+	m_settings.max_files = max_files;
 }
 
 
 //*********************************************************
-// 函数名称 : execute
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/16
-// 函数说明 : 执行SQL语句
+// 函数名称 : set_capacity
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 设置队列中最多等待写入的记录数, 队列满时丢弃新的记录
 // 访问方式 : public
-// 函数参数 : const char * text SQL语句
-// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+// 函数参数 : size_t capacity 最多等待写入的记录数
 //*********************************************************
-bool sql::mariadb::command::execute(const char * text) const noexcept
+void sql::mariadb::slow_query_log::set_capacity(size_t capacity) noexcept
 {
-	assert(m_ptr_mysql != nullptr);
-	return mysql_query(m_ptr_mysql, text) == 0;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_capacity = capacity;
 }
 
 
 //*********************************************************
-// 函数名称 : execute
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/16
-// 函数说明 : 执行SQL语句
+// 函数名称 : flush
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 等待队列中的记录全部写入文件
 // 访问方式 : public
-// 函数参数 : const char * text SQL语句
-// 函数参数 : unsigned long length SQL语句字符串长度
-// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
 //*********************************************************
-bool sql::mariadb::command::execute(const char * text, unsigned long length) const noexcept
+void sql::mariadb::slow_query_log::flush(void)
 {
-	assert(m_ptr_mysql != nullptr);
-	return mysql_real_query(m_ptr_mysql, text, length) == 0;
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_drained.wait(lock, [this]() { return m_queue.empty() && m_writing == 0; });
 }
 
 
 //*********************************************************
-// 函数名称 : execute
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/16
-// 函数说明 : 执行SQL语句
+// 函数名称 : dropped
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 获取因为队列满而丢弃的记录数
 // 访问方式 : public
-// 函数参数 : const std::string & text SQL语句
-// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+// 返 回 值 : unsigned long long 丢弃的记录数
 //*********************************************************
-bool sql::mariadb::command::execute(const std::string & text) const noexcept
+unsigned long long sql::mariadb::slow_query_log::dropped(void) const noexcept
 {
-	assert(m_ptr_mysql != nullptr);
-	return mysql_real_query(m_ptr_mysql, text.c_str(), (unsigned long)text.size()) == 0;
+	return m_dropped.load(std::memory_order_relaxed);
 }
 
 
 //*********************************************************
-// 函数名称 : execute
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/16
-// 函数说明 : 执行SQL语句
+// 函数名称 : on_begin
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 开始执行SQL语句前调用, 不做任何事
 // 访问方式 : public
-// 函数参数 : const std::vector<char> & data SQL语句
-// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+// 函数参数 : statement_event & event 事件
 //*********************************************************
-bool sql::mariadb::command::execute(const std::vector<char>& data) const noexcept
+void sql::mariadb::slow_query_log::on_begin(statement_event &) noexcept
 {
-	assert(m_ptr_mysql != nullptr);
-	return mysql_real_query(m_ptr_mysql, data.data(), (unsigned long)data.size()) == 0;
 }
 
 
 //*********************************************************
-// 函数名称 : execute
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/16
-// 函数说明 : 执行SQL语句
+// 函数名称 : on_end
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : SQL语句结束后调用, 耗时超过阈值时放入队列
 // 访问方式 : public
-// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
-// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
-//            如果生成SQL语句失败则抛出 std::exception 异常
+// 函数参数 : const statement_event & event 事件
 //*********************************************************
-bool sql::mariadb::command::execute(void) const
+void sql::mariadb::slow_query_log::on_end(const statement_event & event) noexcept
 {
-	assert(m_ptr_mysql != nullptr);
-	assert(!m_text.empty());
-
-	unsigned long size = 0; // 保存数据的总字节数, 用于开辟缓冲区
+	if (event.duration < m_threshold)
+	{
+		return;
+	}
 
-	// 遍历数据, 求出数据的总字节数
-	for (const auto &parameter : m_parameters)
+	try
 	{
-		const auto isnum = parameter.second.first; // 数据是否一个数
-		const auto count = parameter.second.second.second; // 数据大小
+		entry record{ std::chrono::system_clock::now(), event };
 
-		// 如果不是一个数, 则额外加上两个单引号的长度
-		size += isnum ? count : count + 2;
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_queue.size() >= m_capacity)
+		{
+			m_dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		m_queue.push_back(std::move(record));
+		m_changed.notify_one();
 	}
+	catch (const std::exception &)
+	{
+		m_dropped.fetch_add(1, std::memory_order_relaxed);
+	}
+}
 
-	// 用于保存生成的SQL语句
-	std::vector<char> statement;
-	statement.reserve(m_text.size() + (size * 2 + m_parameters.size()));
 
-	// 保存原SQL语句中遍历到 '?' 的个数
-	unsigned int mark_count = 0;
+//*********************************************************
+// 函数名称 : run
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 后台线程, 取出队列中的记录写入文件
+// 访问方式 : private
+//*********************************************************
+void sql::mariadb::slow_query_log::run(void) noexcept
+{
+	mysql_thread_init();
 
-	// 生成SQL语句
-	for (auto ch : m_text)
+	std::vector<entry> batch;
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (true)
 	{
-		// 如果字符不是问号, 则直接添加该字符到新语句的结尾
-		if (ch != '?')
+		m_changed.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+
+		if (m_queue.empty())
 		{
-			statement.push_back(ch);
+			break;
 		}
-		else // 如果字符是问号
-		{
-			const auto &parameter = m_parameters.at(mark_count); // 数据
-			const auto isnum = parameter.first; // 数据是否一个数
-			const auto start = parameter.second.first; // 数据开始位置
-			const auto length = parameter.second.second; // 数据大小
 
-			// 如果参数是一个数, 则直接复制数据
-			if (isnum)
+		batch.swap(m_queue);
+		m_writing = batch.size();
+		const auto config = m_settings;
+		lock.unlock();
+
+		for (const auto &record : batch)
+		{
+			try
 			{
-				const auto count = statement.size(); // 保存此时容器大小
-				statement.resize(count + length); // 扩充容量
-				const auto pointer = statement.data() + count; // 复制的开始位置
-				memcpy(pointer, start, length); // 复制数据
+				this->write(record, config);
 			}
-			else // 如果参数是字符串或者数据, 则转换数据并添加单引号
+			catch (const std::exception &)
 			{
-				statement.push_back('\''); // 添加单引号
-
-				const auto count = statement.size(); // 保存此时容器大小
-				statement.resize(count + (length * 2 + 1)); // 扩充容量
-				const auto pointer = statement.data() + count; // 复制的开始位置
-				statement.resize(count + this->escape(pointer, start, length));
-
-				statement.push_back('\''); // 添加单引号
 			}
+		}
 
-			++mark_count; // 增加一个问号的个数
+		if (m_ptr_file != nullptr)
+		{
+			m_ptr_file->flush();
+		}
+		batch.clear();
+
+		lock.lock();
+		m_writing = 0;
+		if (m_queue.empty())
+		{
+			m_drained.notify_all();
 		}
 	}
 
-	// 执行SQL语句并返回是否执行成功
-	return mysql_real_query(m_ptr_mysql, statement.data(), (unsigned long)statement.size()) == 0;
+	lock.unlock();
+	m_ptr_file.reset();
+	m_ptr_explainer.reset();
+	m_ptr_explained.reset();
+	mysql_thread_end();
 }
 
 
 //*********************************************************
-// 函数名称 : execute_reader
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/16
-// 函数说明 : 执行SQL语句
-// 访问方式 : public
-// 函数参数 : const char * text SQL语句
-// 返 回 值 : sql::mariadb::recordset 结果集
-// 异    常 : 如果执行SQL失败则抛出 mariadb_exception 异常
+// 函数名称 : write
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 把一条记录格式化成 JSON 并写入文件, 需要时执行 EXPLAIN 和轮转
+// 访问方式 : private
+// 函数参数 : const entry & record 记录
+// 函数参数 : const settings & config 日志设置
+// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
 //*********************************************************
-sql::mariadb::recordset sql::mariadb::command::execute_reader(const char * text) const
+void sql::mariadb::slow_query_log::write(const entry & record, const settings & config)
 {
-	if_false_throw(this->execute(text), text);
-	return recordset(m_ptr_mysql);
-}
+	// 后台线程使用自己的随机数引擎, 不需要加锁
+	static thread_local std::minstd_rand engine(std::random_device{}());
+
+	const auto &event = record.event;
+	std::string plan;
+	const auto &text = event.fingerprint;
+	const auto explainable = text.compare(0, 7, "select ") == 0
+		|| text.compare(0, 7, "update ") == 0 || text.compare(0, 7, "delete ") == 0;
+	if (config.ptr_endpoint != nullptr && explainable && config.explain_rate > 0
+		&& std::generate_canonical<double, 32>(engine) < config.explain_rate)
+	{
+		plan = this->explain(event.text, config.ptr_endpoint);
+	}
 
+	const auto seconds = std::chrono::system_clock::to_time_t(record.time);
+	const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(record.time.time_since_epoch()).count() % 1000;
+	std::tm utc;
+#ifdef _WIN32
+	gmtime_s(&utc, &seconds);
+#else
+	gmtime_r(&seconds, &utc);
+#endif
+	// 按 7 个 int 各 11 个字符计算最长的输出, 不会被截断
+	char time[7 * 11 + 8];
+	std::snprintf(time, sizeof(time), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ", utc.tm_year + 1900, utc.tm_mon + 1,
+		utc.tm_mday, utc.tm_hour, utc.tm_min, utc.tm_sec, (int)milliseconds);
+
+	std::string line;
+	line.reserve(event.fingerprint.size() + event.text.size() + plan.size() + 192);
+	line += "{\"time\":\"";
+	line += time;
+	line += "\",\"duration_us\":";
+	line += std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(event.duration).count());
+	line += ",\"fingerprint\":";
+	append_json_string(line, event.fingerprint);
+	if (!config.redact)
+	{
+		line += ",\"text\":";
+		append_json_string(line, event.text);
+	}
+	line += ",\"parameters\":" + std::to_string(event.parameters);
+	line += ",\"rows\":" + std::to_string(event.rows);
+	line += ",\"bytes\":" + std::to_string(event.bytes);
+	line += ",\"error\":" + std::to_string(event.error);
+	if (!plan.empty())
+	{
+		line += ",\"explain\":";
+		line += plan;
+	}
+	line += "}\n";
 
-//*********************************************************
-// 函数名称 : execute_reader
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/16
-// 函数说明 : 执行SQL语句
-// 访问方式 : public
-// 函数参数 : const char * text SQL语句
-// 函数参数 : unsigned long length text的字节数
-// 返 回 值 : sql::mariadb::recordset 结果集
-// 异    常 : 如果执行SQL失败则抛出 mariadb_exception 异常
-//*********************************************************
-sql::mariadb::recordset sql::mariadb::command::execute_reader(const char * text, unsigned long length) const
-{
-	if_false_throw(this->execute(text, length), std::string(text, length));
-	return recordset(m_ptr_mysql);
+	if (m_ptr_file == nullptr)
+	{
+		std::ifstream existing(m_path, std::ios::binary | std::ios::ate);
+		m_file_size = existing ? (unsigned long long)existing.tellg() : 0;
+		m_ptr_file.reset(new std::ofstream(m_path, std::ios::binary | std::ios::app));
+	}
+
+	m_ptr_file->write(line.data(), (std::streamsize)line.size());
+	m_file_size += line.size();
+
+	if (config.max_bytes != 0 && m_file_size >= config.max_bytes)
+	{
+		this->rotate(config.max_files);
+	}
 }
 
 
 //*********************************************************
-// 函数名称 : execute_reader
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/16
-// 函数说明 : 执行SQL语句
-// 访问方式 : public
+// 函数名称 : explain
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 在另一个连接上执行 EXPLAIN FORMAT=JSON; 服务器参数改变时先关闭原来的连接
+// 访问方式 : private
 // 函数参数 : const std::string & text SQL语句
-// 返 回 值 : sql::mariadb::recordset 结果集
-// 异    常 : 如果执行SQL失败则抛出 mariadb_exception 异常
+// 函数参数 : const std::shared_ptr<const endpoint> & point 执行 EXPLAIN 的服务器参数
+// 返 回 值 : std::string 执行计划 (JSON); 失败时返回空字符串
 //*********************************************************
-sql::mariadb::recordset sql::mariadb::command::execute_reader(const std::string & text) const
+std::string sql::mariadb::slow_query_log::explain(const std::string & text, const std::shared_ptr<const endpoint> & point) noexcept
+try
+{
+	if (m_ptr_explained != point)
+	{
+		m_ptr_explainer.reset();
+		m_ptr_explained = point;
+	}
+
+	if (m_ptr_explainer == nullptr)
+	{
+		std::unique_ptr<connection> connector(new connection);
+		if (*connector == nullptr || !connector->open(*point))
+		{
+			return std::string();
+		}
+		m_ptr_explainer = std::move(connector);
+	}
+
+	auto reader = command(*m_ptr_explainer).try_execute_reader("EXPLAIN FORMAT=JSON " + text);
+	if (!reader || reader.value() == nullptr || !reader.value().read())
+	{
+		// 连接断开时下一次重新连接
+		if (!m_ptr_explainer->ping())
+		{
+			m_ptr_explainer.reset();
+		}
+		return std::string();
+	}
+
+	const auto plan = reader.value().get_raw(0);
+	return plan == nullptr ? std::string() : std::string(plan);
+}
+catch (const std::exception &)
 {
-	if_false_throw(this->execute(text), text);
-	return recordset(m_ptr_mysql);
+	return std::string();
 }
 
 
 //*********************************************************
-// 函数名称 : execute_reader
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/16
-// 函数说明 : 执行SQL语句
-// 访问方式 : public
-// 函数参数 : const std::vector<char> & data SQL语句
-// 返 回 值 : sql::mariadb::recordset 结果集
-// 异    常 : 如果执行SQL失败则抛出 mariadb_exception 异常
+// 函数名称 : rotate
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 关闭日志文件, 把 path.n 改名为 path.n+1, path 改名为 path.1, 然后打开新文件
+// 访问方式 : private
+// 函数参数 : unsigned int max_files 最多保留多少个轮转后的文件
 //*********************************************************
-sql::mariadb::recordset sql::mariadb::command::execute_reader(const std::vector<char>& data) const
+void sql::mariadb::slow_query_log::rotate(unsigned int max_files) noexcept
+try
+{
+	m_ptr_file.reset();
+
+	if (max_files == 0)
+	{
+		std::remove(m_path.c_str());
+	}
+	else
+	{
+		std::remove((m_path + '.' + std::to_string(max_files)).c_str());
+		for (auto n = max_files - 1; n != 0; --n)
+		{
+			std::rename((m_path + '.' + std::to_string(n)).c_str(), (m_path + '.' + std::to_string(n + 1)).c_str());
+		}
+		std::rename(m_path.c_str(), (m_path + ".1").c_str());
+	}
+
+	m_ptr_file.reset(new std::ofstream(m_path, std::ios::binary | std::ios::trunc));
+	m_file_size = 0;
+}
+catch (const std::exception &)
 {
-	if_false_throw(this->execute(data), std::string(data.begin(), data.end()));
-	return recordset(m_ptr_mysql);
 }
 
 
 //*********************************************************
-// 函数名称 : execute_reader
-// 作    者 : Gooeen
-// 完成日期 : 2015/09/16
-// 函数说明 : 执行SQL语句
+// 函数名称 : run_in_transaction
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 函数说明 : 在事务中执行 unit 并提交; unit 或者提交抛出可以重试的 mariadb_exception 异常时
+//            回滚并等待一段时间后重新执行整个 unit
 // 访问方式 : public
-// 返 回 值 : sql::mariadb::recordset 结果集
-// 异    常 : 如果执行SQL失败则抛出 mariadb_exception 异常
-//            如果分配资源失败则抛出 std::bad_alloc 异常;
-//            如果生成SQL语句失败则抛出 std::exception 异常
+// 函数参数 : const connection & connector 数据库连接, 调用前不能在事务中
+// 函数参数 : const std::function<void(const connection&)> & unit 事务中执行的操作, 失败时需要抛出异常
+// 函数参数 : const retry_policy & policy 重试的策略
+// 异    常 : 如果不能重试或者重试次数用完则抛出最后一次的异常; unit 抛出的其他异常回滚后直接抛出
 //*********************************************************
-sql::mariadb::recordset sql::mariadb::command::execute_reader(void) const
+void sql::mariadb::run_in_transaction(const connection & connector,
+	const std::function<void(const connection &)> & unit, const retry_policy & policy)
 {
-	if_false_throw(this->execute(), m_text);
-	return recordset(m_ptr_mysql);
+	for (unsigned int attempt = 0; ; ++attempt)
+	{
+		// 抛出异常时 scope 在进入 catch 之前回滚; 死锁时服务器已经回滚了整个事务,
+		// 其他错误只回滚了出错的语句
+		try
+		{
+			transaction scope(connector);
+			unit(connector);
+			scope.commit();
+			return;
+		}
+		catch (const mariadb_exception &exception)
+		{
+			if (!retry_policy::retryable(exception) || attempt + 1 >= policy.max_attempts())
+			{
+				throw;
+			}
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(policy.delay(attempt)));
+	}
 }
 
 
@@ -20,14 +20,23 @@
 #include <list>
 #include <tuple>
 #include <memory>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
 #include <algorithm>
+#include <functional>
+#include <type_traits>
 #include <cstring>
+#include <iosfwd>
 
 // 如果指针是空则抛出异常
 #define if_null_throw(pointer, message)\
 if (pointer == nullptr)\
 {\
-	throw mariadb_exception(this->error() + "\r\nSQL: " + message, __FILE__, __LINE__);\
+	throw mariadb_exception(this->error() + "\r\nSQL: " + message, __FILE__, __LINE__, this->errorno(), mysql_sqlstate(m_ptr_mysql));\
 }
 
 // 尝试读取数据, 如果没有数据则抛出异常
@@ -43,9 +52,36 @@ namespace sql
 	// MySQL/MariaDB 操作
 	namespace mariadb
 	{
+		class error_info; // 数据库操作的错误信息
+		template <typename T> class result; // 数据库操作的结果类
+		class latency_histogram; // 延迟直方图
+		class query_stats; // SQL语句统计类
+		class phase_tracer; // 执行SQL语句各阶段耗时的跟踪接口
+		class phase_timer; // 阶段计时类
+		class alloc_scope; // 堆内存分配计数范围
+		struct statement_event; // 执行SQL语句的事件
+		class statement_observer; // 执行SQL语句的观察者接口
+		class connection_options; // 数据库连接选项类
+		class endpoint; // 数据库服务器类
+		class reconnect_policy; // 自动重新连接的策略
+		class retry_policy; // 事务重试的策略
+		class session_state; // 数据库连接的会话状态
 		class connection; // 数据库连接类
 		class command; // 数据库执行类
 		class recordset; // 数据库结果集类
+		class prepared_statement; // 数据库预处理语句类
+		class pipeline; // 数据库流水线类
+		class pooled_connection; // 从连接池借出的数据库连接
+		class connection_pool; // 数据库连接池类
+		class balancer; // 从服务器连接池负载均衡类
+		class balanced_connection; // 从负载均衡对象借出的数据库连接
+		class router; // 读写分离路由类
+		class routed_session; // 路由会话类
+		class hedging_policy; // 对冲读取的策略
+		class hedged_reader; // 对冲读取类
+		class transaction; // 数据库事务类
+		class group_commit; // 合并提交类
+		class slow_query_log; // 客户端慢查询日志类
 
 		//*********************************************************
 		// 函数名称 : to_date_string
@@ -112,6 +148,41 @@ namespace sql
 			//*********************************************************
 			mariadb_exception(const std::string &text, const std::string &file, int line);
 
+			//*********************************************************
+			// 函数名称 : mariadb_exception
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数
+			// 访问方式 : public
+			// 函数参数 : const std::string & text 异常信息
+			// 函数参数 : const std::string & file 异常所在文件
+			// 函数参数 : int line 异常所在行
+			// 函数参数 : unsigned int code 服务器或者客户端库的错误代号
+			// 函数参数 : const char * sqlstate 五个字符的 SQLSTATE
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			mariadb_exception(const std::string &text, const std::string &file, int line, unsigned int code, const char *sqlstate);
+
+			//*********************************************************
+			// 函数名称 : code
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取错误代号, 例如 1213 (ER_LOCK_DEADLOCK)
+			// 访问方式 : public
+			// 返 回 值 : unsigned int 错误代号; 不是数据库操作失败时为 0
+			//*********************************************************
+			unsigned int code(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : sqlstate
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取 SQLSTATE, 例如 40001 (序列化失败)
+			// 访问方式 : public
+			// 返 回 值 : const char * SQLSTATE; 不是数据库操作失败时为 HY000
+			//*********************************************************
+			const char * sqlstate(void) const noexcept;
+
 			//*********************************************************
 			// 函数名称 : what
 			// 作    者 : Gooeen
@@ -124,2009 +195,6213 @@ namespace sql
 
 		private:
 			std::string m_text; // 异常信息
+			unsigned int m_code; // 错误代号
+			char m_sqlstate[6]; // SQLSTATE
 		};
 
-		// 数据库连接类
-		// 一个数据库连接只能用于一个线程
-		class connection
+		// SQL语句执行超时异常
+		class timeout_exception : public mariadb_exception
 		{
 		public:
 
 			//*********************************************************
-			// 函数名称 : connection
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 构造函数
+			// 函数名称 : timeout_exception
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数, 错误代号为 ER_STATEMENT_TIMEOUT, SQLSTATE 为 70100
 			// 访问方式 : public
+			// 函数参数 : const std::string & text 异常信息
+			// 函数参数 : const std::string & file 异常所在文件
+			// 函数参数 : int line 异常所在行
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
 			//*********************************************************
-			connection(void) noexcept;
+			timeout_exception(const std::string &text, const std::string &file, int line);
+		};
+
+		// 数据库操作的错误信息
+		// 错误代号和 SQLSTATE 保存在对象内; 错误信息只在失败时分配一次, 复制时共享,
+		// 所以 result<T> 中的错误信息很小; 需要时才用 message 生成完整的错误信息
+		class error_info
+		{
+		public:
 
 			//*********************************************************
-			// 函数名称 : connection
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 转移构造函数, 转移后原对象不应该使用
+			// 函数名称 : error_info
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数, 没有错误
 			// 访问方式 : public
-			// 函数参数 : connection && connector 需要转移的对象
 			//*********************************************************
-			connection(connection &&connector) noexcept;
+			error_info(void) noexcept;
 
 			//*********************************************************
-			// 函数名称 : ~connection
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 如果数据库连接没有关闭则在析构时自动关闭
+			// 函数名称 : error_info
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数
 			// 访问方式 : public
+			// 函数参数 : unsigned int code 错误代号
+			// 函数参数 : const char * sqlstate 五个字符的 SQLSTATE
+			// 函数参数 : const char * text 错误信息, 如果分配空间失败则为空字符串
 			//*********************************************************
-			~connection(void) noexcept;
+			error_info(unsigned int code, const char *sqlstate, const char *text) noexcept;
 
 			//*********************************************************
-			// 函数名称 : operator!=
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 判断数据库连接器是否创建成功
+			// 函数名称 : error_info
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数, 从异常中获取错误信息
 			// 访问方式 : public
-			// 函数参数 : std::nullptr_t null 与nullptr作比较
-			// 返 回 值 : bool 如果创建成功则 对象 != nullptr;
-			//            反之 对象 == nullptr
+			// 函数参数 : const std::exception & exception 异常, mariadb_exception 异常带有错误代号
 			//*********************************************************
-			bool operator!=(std::nullptr_t null) const noexcept;
+			explicit error_info(const std::exception &exception) noexcept;
 
 			//*********************************************************
-			// 函数名称 : operator==
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 判断数据库连接器是否创建成功
+			// 函数名称 : no_data
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取 "没有数据" 的错误信息, SQLSTATE 为 02000
 			// 访问方式 : public
-			// 函数参数 : std::nullptr_t null  与nullptr作比较
-			// 返 回 值 : bool 如果创建成功则 对象 != nullptr;
-			//            反之 对象 == nullptr
+			// 返 回 值 : error_info 错误信息
 			//*********************************************************
-			bool operator==(std::nullptr_t null) const noexcept;
+			static error_info no_data(void) noexcept;
 
 			//*********************************************************
-			// 函数名称 : open
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 连接数据库
+			// 函数名称 : code
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取错误代号
 			// 访问方式 : public
-			// 函数参数 : const char * user 用户名
-			// 函数参数 : const char * password 密码
-			// 函数参数 : const char * database 数据库名
-			// 函数参数 : unsigned int port 服务器端口
-			// 函数参数 : const char * host 服务器 IP 地址
-			// 函数参数 : const char * unix_socket 指定需要使用的 socket 或者 命名管道
-			// 函数参数 : unsigned long flags 链接选项
-			// 返 回 值 : bool true 代表连接成功, false 代表连接失败
+			// 返 回 值 : unsigned int 错误代号; 没有数据时为 0
 			//*********************************************************
-			bool open(const char *user, const char *password,
-				const char *database, unsigned int port = 3306,
-				const char *host = "127.0.0.1",
-				const char *unix_socket = nullptr,
-				unsigned long flags = 0) const noexcept;
+			unsigned int code(void) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : close
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 关闭数据库连接, 如果不手动关闭数据库连接, 则析构时自动关闭
+			// 函数名称 : sqlstate
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取 SQLSTATE
 			// 访问方式 : public
+			// 返 回 值 : const char * SQLSTATE
 			//*********************************************************
-			void close(void) noexcept;
+			const char * sqlstate(void) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : error
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 获取数据库操作失败的错误信息
+			// 函数名称 : text
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取客户端库的错误信息
 			// 访问方式 : public
-			// 返 回 值 : std::string 错误信息
+			// 返 回 值 : const char * 错误信息
 			//*********************************************************
-			std::string error(void) const noexcept;
+			const char * text(void) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : errorno
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 获取数据库操作失败的错误代号
+			// 函数名称 : not_found
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 判断是否因为没有数据而失败
 			// 访问方式 : public
-			// 返 回 值 : unsigned int 错误代号
+			// 返 回 值 : bool 如果没有数据返回true; 反之返回false
 			//*********************************************************
-			unsigned int errorno(void) const noexcept;
+			bool not_found(void) const noexcept;
 
-		private:
+			//*********************************************************
+			// 函数名称 : duplicate_key
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 判断是否因为主键或者唯一索引重复而失败 (ER_DUP_ENTRY)
+			// 访问方式 : public
+			// 返 回 值 : bool 如果重复返回true; 反之返回false
+			//*********************************************************
+			bool duplicate_key(void) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : connection
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 禁止复制
-			// 访问方式 : private
-			// 函数参数 : const connection &
+			// 函数名称 : message
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 生成完整的错误信息
+			// 访问方式 : public
+			// 返 回 值 : std::string 错误信息, 格式为 "[错误代号] (SQLSTATE) 错误信息"
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
 			//*********************************************************
-			connection(const connection &) = delete;
+			std::string message(void) const;
+
+		private:
 
 			//*********************************************************
-			// 函数名称 : operator=
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 禁止复制
+			// 函数名称 : share_text
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 复制错误信息, 供多个 error_info 共享
 			// 访问方式 : private
-			// 函数参数 : const connection &
-			// 返 回 值 : connection &
+			// 函数参数 : const char * text 错误信息
+			// 返 回 值 : std::shared_ptr<const std::string> 错误信息; 空字符串或者分配空间失败时为 nullptr
 			//*********************************************************
-			connection & operator=(const connection &) = delete;
+			static std::shared_ptr<const std::string> share_text(const char *text) noexcept;
 
 		private:
-			friend command;
-			friend recordset;
-			MYSQL *m_ptr_mysql; // MariaDB 数据库句柄
+			unsigned int m_code; // 错误代号
+			char m_sqlstate[6]; // SQLSTATE
+			std::shared_ptr<const std::string> m_ptr_text; // 错误信息, 没有时为 nullptr
 		};
 
-		// 数据库结果集类
-		class recordset
+		// 数据库操作的结果类
+		// 成功时保存数据, 失败时保存错误信息, 用于不抛出异常的 try_ 系列函数
+		template <typename T>
+		class result
 		{
 		public:
 
 			//*********************************************************
-			// 函数名称 : recordset
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 转移构造函数, 转移后原对象不应该使用
-			// 访问方式 : private
-			// 函数参数 : recordset && reader 需要转移的对象
+			// 函数名称 : result
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数, 操作成功
+			// 访问方式 : public
+			// 函数参数 : T && value 数据
 			//*********************************************************
-			recordset(recordset &&reader) noexcept;
+			result(T &&value) noexcept(std::is_nothrow_move_constructible<T>::value)
+				: m_ok(true)
+			{
+				new (&m_storage) T(std::move(value));
+			}
 
 			//*********************************************************
-			// 函数名称 : ~recordset
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 如果结果集没有释放关闭则在析构时自动关闭
+			// 函数名称 : result
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数, 操作成功
 			// 访问方式 : public
+			// 函数参数 : const T & value 数据
 			//*********************************************************
-			~recordset(void) noexcept;
+			result(const T &value) noexcept(std::is_nothrow_copy_constructible<T>::value)
+				: m_ok(true)
+			{
+				new (&m_storage) T(value);
+			}
 
 			//*********************************************************
-			// 函数名称 : operator!=
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 判断数据库连接器是否创建成功
+			// 函数名称 : result
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数, 操作失败
 			// 访问方式 : public
-			// 函数参数 : std::nullptr_t null 与nullptr作比较
-			// 返 回 值 : bool 如果创建成功则 对象 != nullptr;
-			//            反之 对象 == nullptr
+			// 函数参数 : const error_info & error 错误信息
 			//*********************************************************
-			bool operator!=(std::nullptr_t null) const noexcept;
+			result(const error_info &error) noexcept
+				: m_ok(false)
+				, m_error(error)
+			{
+			}
 
 			//*********************************************************
-			// 函数名称 : operator==
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 判断数据库连接器是否创建成功
+			// 函数名称 : result
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 转移构造函数, 转移后原对象不应该使用
 			// 访问方式 : public
-			// 函数参数 : std::nullptr_t null  与nullptr作比较
-			// 返 回 值 : bool 如果创建成功则 对象 != nullptr;
-			//            反之 对象 == nullptr
+			// 函数参数 : result && other 需要转移的对象
 			//*********************************************************
-			bool operator==(std::nullptr_t null) const noexcept;
+			result(result &&other) noexcept(std::is_nothrow_move_constructible<T>::value)
+				: m_ok(other.m_ok)
+				, m_error(other.m_error)
+			{
+				if (m_ok)
+				{
+					new (&m_storage) T(std::move(other.value()));
+				}
+			}
 
 			//*********************************************************
-			// 函数名称 : close
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 释放结果集所占用的资源, 如果不手动释放资源, 则析构时自动释放
+			// 函数名称 : ~result
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 析构函数, 成功时析构数据
 			// 访问方式 : public
 			//*********************************************************
-			void close(void) noexcept;
+			~result(void) noexcept
+			{
+				if (m_ok)
+				{
+					this->value().~T();
+				}
+			}
 
 			//*********************************************************
-			// 函数名称 : error
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 获取数据库操作失败的错误信息
+			// 函数名称 : operator bool
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 判断操作是否成功
 			// 访问方式 : public
-			// 返 回 值 : std::string 错误信息
+			// 返 回 值 : bool 如果成功返回true; 反之返回false
 			//*********************************************************
-			std::string error(void) const noexcept;
+			explicit operator bool(void) const noexcept
+			{
+				return m_ok;
+			}
 
 			//*********************************************************
-			// 函数名称 : errorno
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 获取数据库操作失败的错误代号
+			// 函数名称 : value
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取数据, 只能在操作成功时调用
 			// 访问方式 : public
-			// 返 回 值 : unsigned int 错误代号
+			// 返 回 值 : T & 数据
 			//*********************************************************
-			unsigned int errorno(void) const noexcept;
+			T & value(void) noexcept
+			{
+				return *reinterpret_cast<T *>(&m_storage);
+			}
 
 			//*********************************************************
-			// 函数名称 : row_count
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 获取数据的行数
+			// 函数名称 : value
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取数据, 只能在操作成功时调用
 			// 访问方式 : public
-			// 返 回 值 : unsigned long long 行数
+			// 返 回 值 : const T & 数据
 			//*********************************************************
-			unsigned long long row_count(void) const noexcept;
+			const T & value(void) const noexcept
+			{
+				return *reinterpret_cast<const T *>(&m_storage);
+			}
 
 			//*********************************************************
-			// 函数名称 : field_count
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 获取数据的列数(字段数量)
+			// 函数名称 : error
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取错误信息, 操作成功时错误代号为 0
 			// 访问方式 : public
-			// 返 回 值 : unsigned long 列数(字段数量)
+			// 返 回 值 : const error_info & 错误信息
 			//*********************************************************
-			unsigned long field_count(void) const noexcept;
+			const error_info & error(void) const noexcept
+			{
+				return m_error;
+			}
+
+		private:
 
 			//*********************************************************
-			// 函数名称 : data_size
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 获取单条数据的长度
-			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置; 如果超出数据的列数则可能出现数组越界的问题
-			// 返 回 值 : unsigned long 单条数据的字节数
+			// 函数名称 : result
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const result &
 			//*********************************************************
-			unsigned long data_size(unsigned long n) const noexcept;
+			result(const result &) = delete;
 
 			//*********************************************************
-			// 函数名称 : read
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 读取下一条数据
-			// 访问方式 : public
-			// 返 回 值 : bool 成功返回true, 失败返回false
+			// 函数名称 : operator=
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const result &
+			// 返 回 值 : result &
 			//*********************************************************
-			bool read(void) noexcept;
+			result & operator=(const result &) = delete;
+
+		private:
+			bool m_ok; // 操作是否成功
+			error_info m_error; // 错误信息
+			typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type m_storage; // 数据
+		};
+
+		// 延迟直方图 (微秒)
+		// 对数线性分桶, 类似 HdrHistogram: 小于 16 微秒时每微秒一个桶, 之后每个 2 的幂区间分成 16 个桶,
+		// 相对误差不超过 1/16; 超过 2^36 微秒 (约19小时) 的值记录在最后一个桶
+		class latency_histogram
+		{
+		public:
+			static const size_t bucket_count = 528; // 桶的个数
 
 			//*********************************************************
-			// 函数名称 : get_char
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 获取数据, 并将数据强制转换成 char 类型
+			// 函数名称 : latency_histogram
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数, 所有桶为空
 			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置
-			// 返 回 值 : char 数据
 			//*********************************************************
-			char get_char(unsigned long n) const;
+			latency_histogram(void) noexcept;
 
 			//*********************************************************
-			// 函数名称 : get_udata
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 获取数据, 并将数据用 std::vector<unsigned char> 对象保存
+			// 函数名称 : record
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 记录一个延迟
 			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置
-			// 返 回 值 : std::vector<unsigned char> 数据
-			// 异    常 : 如果 std::vector 创建失败时抛出异常
+			// 函数参数 : unsigned long long microseconds 延迟 (微秒)
 			//*********************************************************
-			std::vector<unsigned char> get_udata(unsigned long n) const;
+			void record(unsigned long long microseconds) noexcept;
 
 			//*********************************************************
-			// 函数名称 : get_udata_ptr
-			// 作    者 : Gooeen
-			// 完成日期 : 2016/05/09
-			// 函数说明 : 获取数据, 并将数据用 std::vector<unsigned char> 对象保存
+			// 函数名称 : merge
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 合并另一个直方图
 			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置
-			// 返 回 值 : std::vector<unsigned char> 数据
-			// 异    常 : 如果 std::vector 创建失败时抛出异常
+			// 函数参数 : const latency_histogram & other 另一个直方图
 			//*********************************************************
-			std::shared_ptr<std::vector<unsigned char>> get_udata_ptr(unsigned long n) const;
+			void merge(const latency_histogram &other) noexcept;
 
 			//*********************************************************
-			// 函数名称 : get_data
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 获取数据, 并将数据用 std::vector<char> 对象保存
+			// 函数名称 : count
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取记录的个数
 			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置
-			// 返 回 值 : std::vector<char> 数据
-			// 异    常 : 如果 std::vector 创建失败时抛出异常
+			// 返 回 值 : unsigned long long 个数
 			//*********************************************************
-			std::vector<char> get_data(unsigned long n) const;
+			unsigned long long count(void) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : get_data_ptr
-			// 作    者 : Gooeen
-			// 完成日期 : 2016/05/09
-			// 函数说明 : 获取数据, 并将数据用 std::vector<char> 对象保存
+			// 函数名称 : percentile
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取分位数, 例如 percentile(0.99) 为 p99
 			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置
-			// 返 回 值 : std::vector<char> 数据
-			// 异    常 : 如果 std::vector 创建失败时抛出异常
+			// 函数参数 : double p 分位, 范围为 [0, 1]
+			// 返 回 值 : unsigned long long 分位数所在桶的上限 (微秒); 没有记录时返回 0
 			//*********************************************************
-			std::shared_ptr<std::vector<char>> get_data_ptr(unsigned long n) const;
+			unsigned long long percentile(double p) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : get_double
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 获取数据, 并将数据转换成 double 类型
+			// 函数名称 : index
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取延迟所在的桶
 			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置
-			// 返 回 值 : double 数据
+			// 函数参数 : unsigned long long microseconds 延迟 (微秒)
+			// 返 回 值 : size_t 桶的位置
 			//*********************************************************
-			double get_double(unsigned long n) const;
+			static size_t index(unsigned long long microseconds) noexcept;
 
 			//*********************************************************
-			// 函数名称 : get_float
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 获取数据, 并将数据转换成 float 类型
+			// 函数名称 : upper_bound
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取桶的上限
 			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置
-			// 返 回 值 : float 数据
+			// 函数参数 : size_t n 桶的位置
+			// 返 回 值 : unsigned long long 桶中最大的延迟 (微秒)
 			//*********************************************************
-			float get_float(unsigned long n) const;
+			static unsigned long long upper_bound(size_t n) noexcept;
 
-			//*********************************************************
-			// 函数名称 : get_int
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 获取数据, 并将数据转换成 int 类型
-			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置
-			// 返 回 值 : int 数据
-			//*********************************************************
-			int get_int(unsigned long n) const;
+		private:
+			friend query_stats;
+			unsigned long long m_counts[bucket_count]; // 每个桶的记录个数
+		};
 
-			//*********************************************************
-			// 函数名称 : get_long
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 获取数据, 并将数据转换成 long 类型
-			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置
-			// 返 回 值 : long 数据
-			//*********************************************************
-			long get_long(unsigned long n) const;
+		// SQL语句统计类
+		// 按SQL语句的指纹 (常量替换成 ?) 统计 command 执行SQL语句的次数、失败次数、结果集行数
+		// (或者影响的行数)、发送的字节数和延迟; 每个线程只写入自己的统计数据, 查找指纹时锁住
+		// 本线程的互斥量 (只与 snapshot/reset 竞争), 更新计数器不使用读-改-写原子操作,
+		// snapshot 合并所有线程的数据. 默认不启用, 例子如下:
+		//     sql::mariadb::query_stats::set_enabled(true);
+		//     ...
+		//     for (const auto &item : sql::mariadb::query_stats::snapshot())
+		//         std::cout << item.fingerprint << ' ' << item.latency.percentile(0.99) << std::endl;
+		class query_stats
+		{
+		public:
+
+			// 一个指纹的统计数据
+			struct entry
+			{
+				std::string fingerprint; // SQL语句的指纹
+				unsigned long long calls; // 执行次数
+				unsigned long long errors; // 失败次数
+				unsigned long long rows; // 结果集行数或者影响的行数
+				unsigned long long bytes; // 发送的SQL语句字节数
+				latency_histogram latency; // 执行SQL语句的延迟 (不包括读取结果集)
+			};
 
 			//*********************************************************
-			// 函数名称 : get_longlong
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 获取数据, 并将数据转换成 long long 类型
+			// 函数名称 : set_enabled
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 启用或者停止统计
 			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置
-			// 返 回 值 : long long 数据
+			// 函数参数 : bool enable 是否启用
 			//*********************************************************
-			long long get_longlong(unsigned long n) const;
+			static void set_enabled(bool enable) noexcept;
 
 			//*********************************************************
-			// 函数名称 : get_short
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 获取数据, 并将数据转换成 short 类型
+			// 函数名称 : enabled
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 判断是否启用了统计
 			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置
-			// 返 回 值 : short 数据
+			// 返 回 值 : bool 如果启用返回true; 反之返回false
 			//*********************************************************
-			short get_short(unsigned long n) const;
+			static bool enabled(void) noexcept;
 
 			//*********************************************************
-			// 函数名称 : get_string
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 获取数据
+			// 函数名称 : fingerprint
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 计算SQL语句的指纹: 去掉注释, 合并空白, 关键字和标识符转成小写,
+			//            字符串和数字常量替换成 ?, IN (?, ?, ?) 这样的列表合并成 (?+)
 			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置
-			// 返 回 值 : std::string 数据
-			// 异    常 : 如果数据长度 (length) 超过字符串最大长度(max_size)
-			//            则抛出 std::length_error 异常;
-			//            如果分配资源失败则抛出 std::bad_alloc 异常
+			// 函数参数 : const char * text SQL语句
+			// 函数参数 : unsigned long length SQL语句字符串长度
+			// 返 回 值 : std::string 指纹
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
 			//*********************************************************
-			std::string get_string(unsigned long n) const;
+			static std::string fingerprint(const char *text, unsigned long length);
 
 			//*********************************************************
-			// 函数名称 : get_string_ptr
-			// 作    者 : Gooeen
-			// 完成日期 : 2016/05/09
-			// 函数说明 : 获取数据
+			// 函数名称 : snapshot
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 合并所有线程 (包括已经结束的线程) 的统计数据
 			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置
-			// 返 回 值 : std::string 数据
-			// 异    常 : 如果数据长度 (length) 超过字符串最大长度(max_size)
-			//            则抛出 std::length_error 异常;
-			//            如果分配资源失败则抛出 std::bad_alloc 异常
+			// 返 回 值 : std::vector<entry> 每个指纹的统计数据, 按执行次数从多到少排序
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
 			//*********************************************************
-			std::shared_ptr<std::string> get_string_ptr(unsigned long n) const;
+			static std::vector<entry> snapshot(void);
 
 			//*********************************************************
-			// 函数名称 : get_uchar
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 获取数据, 并将数据强制转换成 unsigned char 类型
+			// 函数名称 : reset
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 清空所有统计数据
 			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置
-			// 返 回 值 : unsigned char 数据
 			//*********************************************************
-			unsigned char get_uchar(unsigned long n) const;
+			static void reset(void) noexcept;
+
+		private:
+			friend command;
+			friend recordset;
+			struct slot; // 一个线程中一个指纹的统计数据
+			struct thread_store; // 一个线程的统计数据
 
 			//*********************************************************
-			// 函数名称 : get_uint
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 获取数据, 并将数据转换成 unsigned int 类型
-			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置
-			// 返 回 值 : unsigned int 数据
-			// 异    常 : 如果强制转换失败, 则抛出 std::invalid_argument 异常;
-			//            如果数据值大于 unsigned int 的取值范围, 则抛出 std::out_of_range 异常
+			// 函数名称 : fingerprint
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 计算SQL语句的指纹, 写入 output, 重复使用 output 的内存
+			// 访问方式 : private
+			// 函数参数 : const char * text SQL语句
+			// 函数参数 : unsigned long length SQL语句字符串长度
+			// 函数参数 : std::string & output 指纹
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
 			//*********************************************************
-			unsigned int get_uint(unsigned long n) const;
+			static void fingerprint(const char *text, unsigned long length, std::string &output);
 
 			//*********************************************************
-			// 函数名称 : get_ulong
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/15
-			// 函数说明 : 获取数据, 并将数据转换成 unsigned long 类型
-			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置
-			// 返 回 值 : unsigned long 数据
-			// 异    常 : 如果强制转换失败, 则抛出 std::invalid_argument 异常;
-			//            如果数据值大于 unsigned long 的取值范围, 则抛出 std::out_of_range 异常
+			// 函数名称 : record
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 记录一次执行SQL语句
+			// 访问方式 : private
+			// 函数参数 : MYSQL * pointer 执行SQL语句的数据库句柄
+			// 函数参数 : const char * text SQL语句
+			// 函数参数 : unsigned long length SQL语句字符串长度
+			// 函数参数 : std::chrono::nanoseconds elapsed 延迟
+			// 函数参数 : bool failed 是否失败
 			//*********************************************************
-			unsigned long get_ulong(unsigned long n) const;
+			static void record(MYSQL *pointer, const char *text, unsigned long length,
+				std::chrono::nanoseconds elapsed, bool failed) noexcept;
 
 			//*********************************************************
-			// 函数名称 : get_ulonglong
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/15
-			// 函数说明 : 获取数据, 并将数据转换成 unsigned long long 类型
-			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置
-			// 返 回 值 : unsigned long long 数据
-			// 异    常 : 如果强制转换失败, 则抛出 std::invalid_argument 异常;
-			//            如果数据值大于 unsigned long long 的取值范围, 则抛出 std::out_of_range 异常
+			// 函数名称 : add_rows
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 把结果集的行数记录到该线程在 pointer 上最后执行的SQL语句
+			// 访问方式 : private
+			// 函数参数 : MYSQL * pointer 数据库句柄
+			// 函数参数 : unsigned long long rows 结果集行数
 			//*********************************************************
-			unsigned long long get_ulonglong(unsigned long n) const;
+			static void add_rows(MYSQL *pointer, unsigned long long rows) noexcept;
+		};
+
+		// 执行SQL语句的阶段
+		enum class query_phase
+		{
+			build, // 生成SQL语句 (command::statement::generate)
+			network, // 发送SQL语句并等待服务器返回 (mysql_real_query)
+			store, // 接收并缓存结果集 (mysql_store_result)
+			decode, // 把结果集中的数据转换成 tuple
+			pool_wait // 等待连接池中的空闲连接
+		};
+
+		// 执行SQL语句各阶段耗时的跟踪接口
+		// 继承该类实现 on_phase, 然后用 install 安装; 同一个SQL语句的各阶段都在执行该语句的线程中报告,
+		// 可以用线程局部变量把它们关联起来. 没有安装时每个阶段只多一次原子读取, 不读取时钟
+		class phase_tracer
+		{
+		public:
 
 			//*********************************************************
-			// 函数名称 : get_ushort
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/15
-			// 函数说明 : 获取数据, 并将数据转换成 unsigned short 类型
+			// 函数名称 : ~phase_tracer
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 析构函数
 			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置
-			// 返 回 值 : unsigned short 数据
 			//*********************************************************
-			unsigned short get_ushort(unsigned long n) const;
+			virtual ~phase_tracer(void);
 
 			//*********************************************************
-			// 函数名称 : get_wchar
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/15
-			// 函数说明 : 获取数据, 并将数据强制转换成 wchar_t 类型
+			// 函数名称 : on_phase
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 一个阶段结束时调用, 可能在多个线程中同时调用
 			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置
-			// 返 回 值 : wchar_t 数据
+			// 函数参数 : query_phase phase 阶段
+			// 函数参数 : std::chrono::nanoseconds elapsed 该阶段的耗时
 			//*********************************************************
-			wchar_t get_wchar(unsigned long n) const;
+			virtual void on_phase(query_phase phase, std::chrono::nanoseconds elapsed) noexcept = 0;
 
 			//*********************************************************
-			// 函数名称 : get_wstring
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/15
-			// 函数说明 : 获取数据, 并将数据强制转换成 std::wstring 类型
+			// 函数名称 : install
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 安装跟踪对象, 替换之前安装的对象; 跟踪对象由调用者管理,
+			//            必须比所有正在执行的SQL语句活得久
 			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置
-			// 返 回 值 : std::wstring 数据
+			// 函数参数 : phase_tracer * tracer 跟踪对象, nullptr 代表停止跟踪
 			//*********************************************************
-			std::wstring get_wstring(unsigned long n) const;
+			static void install(phase_tracer *tracer) noexcept;
 
 			//*********************************************************
-			// 函数名称 : get_wstring_ptr
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/05/09
-			// 函数说明 : 获取数据, 并将数据强制转换成 std::wstring 类型
+			// 函数名称 : installed
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取已安装的跟踪对象
 			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置
-			// 返 回 值 : std::shared_ptr<std::wstring> 数据
+			// 返 回 值 : phase_tracer * 跟踪对象, 没有安装时返回 nullptr
 			//*********************************************************
-			std::shared_ptr<std::wstring> get_wstring_ptr(unsigned long n) const;
+			static phase_tracer * installed(void) noexcept;
+		};
+
+		// 阶段计时类
+		// 构造时开始计时, 析构或者调用 stop 时把耗时报告给已安装的 phase_tracer
+		class phase_timer
+		{
+		public:
 
 			//*********************************************************
-			// 函数名称 : get_raw
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/15
-			// 函数说明 : 不进行转换, 直接获取从数据库返回的数据
+			// 函数名称 : phase_timer
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数, 已安装 phase_tracer 时开始计时
 			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置
-			// 返 回 值 : const char * 数据
+			// 函数参数 : query_phase phase 阶段
 			//*********************************************************
-			const char * get_raw(unsigned long n) const;
+			explicit phase_timer(query_phase phase) noexcept;
 
 			//*********************************************************
-			// 函数名称 : get_bool
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/15
-			// 函数说明 : 获取数据, 并将数据强制转换成 bool 类型
+			// 函数名称 : ~phase_timer
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 析构函数, 还没有报告时报告耗时
 			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置
-			// 返 回 值 : bool 数据
 			//*********************************************************
-			bool get_bool(unsigned long n) const;
+			~phase_timer(void);
 
 			//*********************************************************
-			// 函数名称 : get
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/13
-			// 函数说明 : 获取数据
+			// 函数名称 : stop
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 停止计时并报告耗时, 只报告一次
 			// 访问方式 : public
-			// 函数参数 : unsigned long n 数据的列位置, 从0开始
-			// 返 回 值 : T 数据
 			//*********************************************************
-			template <typename T>
-			T get(unsigned long n) const;
+			void stop(void) noexcept;
 
 		private:
 
 			//*********************************************************
-			// 函数名称 : recordset
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/15
-			// 函数说明 : 由 command 类对象创建 recordset 类对象
-			// 访问方式 : private
-			// 函数参数 : MYSQL * pointer 数据库句柄
-			//*********************************************************
-			recordset(MYSQL *pointer) noexcept;
-
-			//*********************************************************
-			// 函数名称 : recordset
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/15
+			// 函数名称 : phase_timer
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
 			// 函数说明 : 禁止复制
 			// 访问方式 : private
-			// 函数参数 : const recordset &
+			// 函数参数 : const phase_timer &
 			//*********************************************************
-			recordset(const recordset &) = delete;
+			phase_timer(const phase_timer &) = delete;
 
 			//*********************************************************
 			// 函数名称 : operator=
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/15
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
 			// 函数说明 : 禁止复制
 			// 访问方式 : private
-			// 函数参数 : const recordset &
-			// 返 回 值 : recordset &
+			// 函数参数 : const phase_timer &
+			// 返 回 值 : phase_timer &
 			//*********************************************************
-			recordset & operator=(const recordset &) = delete;
+			phase_timer & operator=(const phase_timer &) = delete;
 
 		private:
-			friend command;
-			MYSQL *m_ptr_mysql; // MariaDB 数据库句柄
-			MYSQL_RES *m_ptr_res; // MariaDB 数据库结果集
-			MYSQL_ROW m_row; // MariaDB 数据库结果行
+			phase_tracer *m_ptr_tracer; // 计时开始时安装的跟踪对象, nullptr 代表不计时
+			query_phase m_phase; // 阶段
+			std::chrono::steady_clock::time_point m_start; // 开始时间
 		};
 
-		// 数据库执行类
-		// 一个 command 对象只能用于一个线程
-		// 同一个线程下, 可以多个 command 对象共享一个 数据库连接 connection 对象
-		class command
+		// 堆内存分配计数范围
+		// 编译时定义 SQL_MARIADB_ALLOC_STATS 宏时, 在当前线程有 alloc_scope 存在期间统计 record 报告的
+		// 分配次数和请求的字节数; 类库本身不替换全局的 operator new, 需要统计的程序 (例如性能测试,
+		// 见 Benchmark/alloc_hook.cpp) 自己替换并调用 record. 没有定义该宏时 enabled 返回 false,
+		// 计数始终为 0. 例子如下:
+		//     sql::mariadb::alloc_scope scope;
+		//     auto rows = executer.query_vector<std::tuple<int, std::string>>("select id, name from table1");
+		//     std::cout << scope.allocations() << ' ' << scope.bytes() << std::endl;
+		class alloc_scope
 		{
 		public:
 
 			//*********************************************************
-			// 函数名称 : command
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/15
-			// 函数说明 : 转移构造函数, 转移后原对象不应该使用
+			// 函数名称 : alloc_scope
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数, 开始统计当前线程的分配; 可以嵌套
 			// 访问方式 : public
-			// 函数参数 : command && executor 需要转移的对象
 			//*********************************************************
-			command(command &&executor) noexcept;
+			alloc_scope(void) noexcept;
 
 			//*********************************************************
-			// 函数名称 : command
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/15
-			// 函数说明 : 构造函数
+			// 函数名称 : ~alloc_scope
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 析构函数, 最外层的范围结束后不再统计
 			// 访问方式 : public
-			// 函数参数 : const connection & connector 数据库连接类
 			//*********************************************************
-			explicit command(const connection &connector) noexcept;
+			~alloc_scope(void) noexcept;
 
 			//*********************************************************
-			// 函数名称 : command
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/15
-			// 函数说明 : 构造函数
+			// 函数名称 : allocations
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取构造以来当前线程的分配次数
 			// 访问方式 : public
-			// 函数参数 : const connection & connector 数据库连接类
-			// 函数参数 : const std::string & text SQL语句
-			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			// 返 回 值 : unsigned long long 分配次数
 			//*********************************************************
-			command(const connection &connector, const std::string &text);
+			unsigned long long allocations(void) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : command
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/15
-			// 函数说明 : 构造函数
+			// 函数名称 : bytes
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取构造以来当前线程分配时请求的字节数
 			// 访问方式 : public
-			// 函数参数 : const connection & connector 数据库连接类
-			// 函数参数 : std::string && text SQL语句
+			// 返 回 值 : unsigned long long 字节数
 			//*********************************************************
-			command(const connection &connector, std::string &&text) noexcept;
+			unsigned long long bytes(void) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : error
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/15
-			// 函数说明 : 获取数据库操作失败的错误信息
-			// 访问方式 : public 
-			// 函数参数 : void
-			// 返 回 值 : std::string 错误信息
+			// 函数名称 : enabled
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 判断编译时是否启用了分配统计 (SQL_MARIADB_ALLOC_STATS)
+			// 访问方式 : public
+			// 返 回 值 : bool true 代表启用
 			//*********************************************************
-			std::string error(void) const noexcept;
+			static bool enabled(void) noexcept;
 
 			//*********************************************************
-			// 函数名称 : errorno
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/15
-			// 函数说明 : 获取数据库操作失败的错误代号
+			// 函数名称 : record
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 记录一次分配, 由程序自己替换的 operator new 调用; 只在当前线程有 alloc_scope 时计数
 			// 访问方式 : public
-			// 返 回 值 : unsigned int 错误代号
+			// 函数参数 : std::size_t size 请求的字节数
 			//*********************************************************
-			unsigned int errorno(void) const noexcept;
+			static void record(std::size_t size) noexcept;
+
+		private:
 
 			//*********************************************************
-			// 函数名称 : prepare
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/15
-			// 函数说明 : 预存SQL语句; 可使用以下例子防注入
-			//            executer.prepare("select * from table where id = ?");
-			//            executer.add(12);
-			// 访问方式 : public
-			// 函数参数 : std::string && text SQL语句
+			// 函数名称 : alloc_scope
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const alloc_scope &
 			//*********************************************************
-			void prepare(std::string &&text) noexcept;
+			alloc_scope(const alloc_scope &) = delete;
 
 			//*********************************************************
-			// 函数名称 : prepare
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/15
-			// 函数说明 : 预存SQL语句; 可使用以下例子防注入
-			//            executer.prepare("select * from table1 where id = ?");
-			//            executer.add(0, 12);
+			// 函数名称 : operator=
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const alloc_scope &
+			// 返 回 值 : alloc_scope &
+			//*********************************************************
+			alloc_scope & operator=(const alloc_scope &) = delete;
+
+		private:
+			unsigned long long m_allocations; // 构造时当前线程的分配次数
+			unsigned long long m_bytes; // 构造时当前线程分配的字节数
+		};
+
+		// 执行SQL语句的事件, 由 statement_observer 接收
+		struct statement_event
+		{
+			std::string fingerprint; // SQL语句的指纹, 见 query_stats::fingerprint
+			std::string text; // 完整的SQL语句, 参数已经替换到语句中
+			size_t parameters; // 参数个数, 没有使用参数时为 0
+			std::chrono::nanoseconds duration; // 从开始执行到结束的耗时, on_begin 时为 0
+			unsigned long long rows; // 结果集行数或者影响的行数, on_begin 时为 0
+			unsigned long long bytes; // 发送的SQL语句字节数
+			unsigned int error; // 错误代号, 0 代表成功
+			void *context; // 由观察者在 on_begin 中设置, on_end 时原样传回, 例如用于关联 span
+		};
+
+		// 执行SQL语句的观察者接口
+		// 用 connection::set_observer 或者 command::set_observer 注册; 没有注册时每条SQL语句只多一次指针判断.
+		// 编译时定义 SQL_MARIADB_NO_OBSERVER 宏可以去掉所有回调
+		class statement_observer
+		{
+		public:
+
+			//*********************************************************
+			// 函数名称 : ~statement_observer
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 析构函数
 			// 访问方式 : public
-			// 函数参数 : const std::string & text SQL语句
-			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
 			//*********************************************************
-			void prepare(const std::string &text);
+			virtual ~statement_observer(void);
 
 			//*********************************************************
-			// 函数名称 : add
-			// 作    者 : Gooeen
-			// 完成日期 : 2016/05/12
-			// 函数说明 : 添加数据, 执行SQL语句时将本次添加的数据用单引
-			//            号引起后代替SQL语句中第 pos 个问号; 例子如下:
-			//            executer.prepare("insert into table1 values(?, ?)");
-			//            executer.add(0, 12);
-			//            executer.add(1, std::make_shared<std::string>("data"));
-			//            在执行SQL语句时将产生 SQL语句:
-			//            insert into table1 values(12, 'data')
+			// 函数名称 : on_begin
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 开始执行SQL语句前调用, 在执行该语句的线程中调用
 			// 访问方式 : public
-			// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
-			// 函数参数 : std::shared_ptr<std::string> &&text 数据, 此数据在SQL语句中将以单引号引用
-			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			// 函数参数 : statement_event & event 事件, 可以设置 context
 			//*********************************************************
-			void add(unsigned int pos, std::shared_ptr<std::string> &&text);
+			virtual void on_begin(statement_event &event) noexcept = 0;
 
 			//*********************************************************
-			// 函数名称 : add
-			// 作    者 : Gooeen
-			// 完成日期 : 2016/05/12
-			// 函数说明 : 添加数据, 执行SQL语句时将本次添加的数据用单引
-			//            号引起后代替SQL语句中第 pos 个问号; 例子如下:
-			//            executer.prepare("insert into table1 values(?, ?)");
-			//            executer.add(0, 12);
-			//            executer.add(1, std::make_shared<std::string>("data"));
-			//            在执行SQL语句时将产生 SQL语句:
-			//            insert into table1 values(12, 'data')
+			// 函数名称 : on_end
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : SQL语句结束后调用; 返回结果集的语句在读取结果集后调用,
+			//            结果集没有读取时在该 command 执行下一条SQL语句前或者析构时调用
 			// 访问方式 : public
-			// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
-			// 函数参数 : const std::shared_ptr<std::string> &text 数据, 此数据在SQL语句中将以单引号引用
-			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			// 函数参数 : const statement_event & event 事件
 			//*********************************************************
-			void add(unsigned int pos, const std::shared_ptr<std::string> &text);
+			virtual void on_end(const statement_event &event) noexcept = 0;
+		};
+
+		// 数据库连接选项类
+		// 连接前通过 mysql_options 设置, 字符集等选项在连接握手时即完成设置,
+		// 不需要连接后再执行额外的SQL语句
+		class connection_options
+		{
+		public:
 
 			//*********************************************************
-			// 函数名称 : add
-			// 作    者 : Gooeen
-			// 完成日期 : 2016/05/17
-			// 函数说明 : 添加数据, 执行SQL语句时将本次添加的数据用单引
-			//            号引起后代替SQL语句中第 pos 个问号; 例子如下:
-			//            executer.prepare("insert into table1 values(?, ?)");
-			//            executer.add(0, 12);
-			//            executer.add(1, "data");
-			//            在执行SQL语句时将产生 SQL语句:
-			//            insert into table1 values(12, 'data')
+			// 函数名称 : connection_options
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数, 默认字符集为 utf8, 其他选项使用客户端库的默认值
 			// 访问方式 : public
-			// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
-			// 函数参数 : std::string text 数据, 此数据在SQL语句中将以单引号引用
 			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
 			//*********************************************************
-			void add(unsigned int pos, std::string text);
+			connection_options(void);
 
 			//*********************************************************
-			// 函数名称 : add
-			// 作    者 : Gooeen
-			// 完成日期 : 2016/05/17
-			// 函数说明 : 添加数据, 执行SQL语句时将本次添加的数据用单引
-			//            号引起后代替SQL语句中第 pos 个问号; 例子如下:
-			//            executer.prepare("insert into table1 values(?, ?)");
-			//            executer.add(0, 12);
-			//            executer.add(1, std::vector<char>({1, 2, 3, 4, 5}));
-			//            在执行SQL语句时将产生 SQL语句:
-			//            insert into table1 values(12, 'data')
+			// 函数名称 : set_charset
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置字符集 (MYSQL_SET_CHARSET_NAME), 在连接握手时设置
 			// 访问方式 : public
-			// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
-			// 函数参数 : std::vector<char> data 数据, 此数据在SQL语句中将以单引号引用
-			// 返 回 值 : void
-			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			// 函数参数 : std::string charset 字符集名称, 如 utf8mb4
 			//*********************************************************
-			void add(unsigned int pos, std::vector<char> data);
+			void set_charset(std::string charset) noexcept;
 
 			//*********************************************************
-			// 函数名称 : add
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 添加数据, 执行SQL语句时将本次添加的数据用单引
-			//            号引起后代替SQL语句中第 pos 个问号; 例子如下:
-			//            executer.prepare("insert into table1 values(?, ?)");
-			//            executer.add(0, 12);
-			//            executer.add(1, "data");
-			//            在执行SQL语句时将产生 SQL语句:
-			//            insert into table1 values(12, 'data')
+			// 函数名称 : add_init_command
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 添加连接成功后服务器执行的SQL语句 (MYSQL_INIT_COMMAND);
+			//            重新连接后也会执行; 每条SQL语句需要一次往返
 			// 访问方式 : public
-			// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
-			// 函数参数 : std::vector<unsigned char> data 数据, 此数据在SQL语句中将以单引号引用
+			// 函数参数 : std::string text SQL语句
 			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
 			//*********************************************************
-			void add(unsigned int pos, std::vector<unsigned char> data);
+			void add_init_command(std::string text);
 
 			//*********************************************************
-			// 函数名称 : add
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 添加数据, 执行SQL语句时将本次添加的数据
-			//            代替SQL语句中第 pos 个问号; 例子如下:
-			//            executer.prepare("insert into table1 values(?, ?)");
-			//            executer.add(0, 12);
-			//            executer.add(1, "data");
-			//            在执行SQL语句时将产生 SQL语句:
-			//            insert into table1 values(12, 'data')
+			// 函数名称 : set_session_variable
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置会话变量, 所有会话变量合并成一条 SET 语句在连接成功后
+			//            执行, 只需要一次往返; 例子如下:
+			//            options.set_session_variable("time_zone", "'+00:00'");
+			//            options.set_session_variable("sql_mode", "'STRICT_ALL_TABLES'");
 			// 访问方式 : public
-			// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
-			// 函数参数 : const std::string & text 数据, 此数据在SQL语句中将以单引号引用
+			// 函数参数 : std::string name 变量名
+			// 函数参数 : std::string value 变量值, 会直接写入SQL语句, 字符串需要加上单引号
 			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
 			//*********************************************************
-			template <typename T>
-			void add(unsigned int pos, T value)
-			{
-				// 保存字符串
-				m_strings.push_back(std::make_shared<std::string>(std::to_string(value)));
+			void set_session_variable(std::string name, std::string value);
 
-				// 保存数据的信息
-				const auto p = m_strings.back()->c_str();
-				const auto size = (unsigned long)m_strings.back()->size();
-				const auto pair = std::make_pair(p, size);
-				m_parameters[pos] = std::make_pair(true, pair);
-			}
+			//*********************************************************
+			// 函数名称 : set_compress
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置是否启用协议压缩 (MYSQL_OPT_COMPRESS)
+			// 访问方式 : public
+			// 函数参数 : bool enable true 代表启用, false 代表不启用
+			//*********************************************************
+			void set_compress(bool enable) noexcept;
 
 			//*********************************************************
-			// 函数名称 : escape
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 转换数据并保存到 to 参数所指向的缓冲区
+			// 函数名称 : set_connect_timeout
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置连接超时时间 (MYSQL_OPT_CONNECT_TIMEOUT)
 			// 访问方式 : public
-			// 函数参数 : char * to 保存转换后的字符串的缓冲区, 缓冲区大小应该比 (size * 2 + 1) 大
-			// 函数参数 : const char * from 需要转换的字符串
-			// 函数参数 : unsigned long size from 的长度
-			// 返 回 值 : unsigned long 转换的字节数
+			// 函数参数 : unsigned int seconds 秒数, 0 代表使用默认值
 			//*********************************************************
-			unsigned long escape(char *to, const char *from, unsigned long size) const noexcept;
+			void set_connect_timeout(unsigned int seconds) noexcept;
 
 			//*********************************************************
-			// 函数名称 : escape
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 转换数据并保存到字符串对象中
+			// 函数名称 : set_read_timeout
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置读取数据超时时间 (MYSQL_OPT_READ_TIMEOUT)
 			// 访问方式 : public
-			// 函数参数 : const char * data 需要转换的数据
-			// 函数参数 : unsigned long size 需要转换的数据的长度
-			// 返 回 值 : std::string 转换后的字符串
-			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
-			//            如果执行失败则抛出 std::exception 异常
+			// 函数参数 : unsigned int seconds 秒数, 0 代表使用默认值
 			//*********************************************************
-			std::string escape(const char *data, unsigned long size) const;
+			void set_read_timeout(unsigned int seconds) noexcept;
 
 			//*********************************************************
-			// 函数名称 : escape_with_quote
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 转换数据并以单引号引用保存到字符串对象中
+			// 函数名称 : set_write_timeout
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置发送数据超时时间 (MYSQL_OPT_WRITE_TIMEOUT)
 			// 访问方式 : public
-			// 函数参数 : const char * data 需要转换的数据
-			// 函数参数 : unsigned long size 需要转换的数据的长度
-			// 返 回 值 : std::string 转换后的字符串
-			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
-			//            如果执行失败则抛出 std::exception 异常
+			// 函数参数 : unsigned int seconds 秒数, 0 代表使用默认值
 			//*********************************************************
-			std::string escape_with_quote(const char *data, unsigned long size) const;
+			void set_write_timeout(unsigned int seconds) noexcept;
 
 			//*********************************************************
-			// 函数名称 : escape_buffer
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 转换数据并保存到 std::vector<char> 类型的缓冲区中
+			// 函数名称 : set_net_buffer_length
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置客户端网络缓冲区的初始大小 (MYSQL_OPT_NET_BUFFER_LENGTH);
+			//            客户端库不提供设置 TCP 缓冲区大小的选项
 			// 访问方式 : public
-			// 函数参数 : const char * data 需要转换的数据
-			// 函数参数 : unsigned long size 需要转换的数据的长度
-			// 返 回 值 : std::vector<char> 保存转换后的数据的缓冲区
-			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
-			//            如果执行失败则抛出 std::exception 异常
+			// 函数参数 : unsigned long bytes 字节数, 0 代表使用默认值
 			//*********************************************************
-			std::vector<char> escape_buffer(const char *data, unsigned long size) const;
+			void set_net_buffer_length(unsigned long bytes) noexcept;
 
 			//*********************************************************
-			// 函数名称 : escape_buffer_with_quote
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 转换数据并并以单引号引用保存到 std::vector<char> 类型的缓冲区中
+			// 函数名称 : set_max_allowed_packet
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置客户端允许的最大数据包 (MYSQL_OPT_MAX_ALLOWED_PACKET)
 			// 访问方式 : public
-			// 函数参数 : const char * data 需要转换的数据
-			// 函数参数 : unsigned long size 需要转换的数据的长度
-			// 返 回 值 : std::vector<char> 保存转换后的数据的缓冲区
-			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
-			//            如果执行失败则抛出 std::exception 异常
+			// 函数参数 : unsigned long bytes 字节数, 0 代表使用默认值
 			//*********************************************************
-			std::vector<char> escape_buffer_with_quote(const char *data, unsigned long size) const;
+			void set_max_allowed_packet(unsigned long bytes) noexcept;
 
 			//*********************************************************
-			// 函数名称 : execute
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句
+			// 函数名称 : compression_pays_off
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 估算协议压缩能否缩短结果集的传输时间;
+			//            不压缩的时间 = 数据量 / 带宽,
+			//            压缩的时间 = 数据量 * 压缩比 / 带宽 + 数据量 / 压缩解压速度 + 固定开销;
+			//            固定开销使小结果集不值得压缩; 客户端库不压缩小于 50 字节的数据包,
+			//            因此小数据量始终返回 false;
+			//            压缩比、压缩解压速度和固定开销可以用 Benchmark/compression_bench 测量
 			// 访问方式 : public
-			// 函数参数 : const char * text SQL语句
-			// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+			// 函数参数 : unsigned long long bytes 结果集的数据量 (字节)
+			// 函数参数 : double bandwidth 链路带宽 (字节/秒)
+			// 函数参数 : double ratio 压缩比 (压缩后网络字节数 / 不压缩网络字节数), 文本数据通常为 0.2 ~ 0.5
+			// 函数参数 : double codec_speed zlib 压缩和解压的综合速度 (字节/秒)
+			// 函数参数 : double fixed_cost 每个结果集与数据量无关的压缩开销 (秒)
+			// 返 回 值 : bool 启用压缩能缩短传输时间返回 true; 反之返回 false
 			//*********************************************************
-			bool execute(const char *text) const noexcept;
+			static bool compression_pays_off(unsigned long long bytes, double bandwidth,
+				double ratio = 0.3, double codec_speed = 40.0 * 1024 * 1024, double fixed_cost = 0.0) noexcept;
+
+		private:
 
 			//*********************************************************
-			// 函数名称 : execute
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句
+			// 函数名称 : apply
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 将选项设置到还没有连接的数据库句柄
+			// 访问方式 : private
+			// 函数参数 : MYSQL * pointer 数据库句柄
+			// 返 回 值 : bool 如果设置成功返回true; 反之返回false
+			//*********************************************************
+			bool apply(MYSQL *pointer) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : restore
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 在已经连接的数据库句柄上重新执行连接成功后执行的SQL语句和设置会话变量,
+			//            用于 mysql_reset_connection 之后
+			// 访问方式 : private
+			// 函数参数 : MYSQL * pointer 数据库句柄
+			// 返 回 值 : bool 如果执行成功返回true; 反之返回false
+			//*********************************************************
+			bool restore(MYSQL *pointer) const noexcept;
+
+		private:
+			friend connection;
+			std::string m_charset; // 字符集
+			std::vector<std::string> m_init_commands; // 连接成功后执行的SQL语句
+			std::string m_session_variables; // 会话变量, 格式为 name = value, name = value
+			bool m_compress; // 是否启用协议压缩
+			unsigned int m_connect_timeout; // 连接超时时间
+			unsigned int m_read_timeout; // 读取数据超时时间
+			unsigned int m_write_timeout; // 发送数据超时时间
+			unsigned long m_net_buffer_length; // 客户端网络缓冲区的初始大小
+			unsigned long m_max_allowed_packet; // 客户端允许的最大数据包
+		};
+
+		// 数据库服务器类
+		// 保存连接数据库所需要的所有参数, 用于连接池、重新连接等需要多次连接同一个服务器的场合
+		class endpoint
+		{
+		public:
+
+			//*********************************************************
+			// 函数名称 : endpoint
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数
 			// 访问方式 : public
-			// 函数参数 : const char * text SQL语句
-			// 函数参数 : unsigned long length SQL语句字符串长度
-			// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+			// 函数参数 : std::string user 用户名
+			// 函数参数 : std::string password 密码
+			// 函数参数 : std::string database 数据库名, 空字符串代表不指定
+			// 函数参数 : unsigned int port 服务器端口
+			// 函数参数 : std::string host 服务器 IP 地址
+			// 函数参数 : std::string unix_socket 指定需要使用的 socket 或者 命名管道, 空字符串代表不指定
+			// 函数参数 : unsigned long flags 链接选项
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
 			//*********************************************************
-			bool execute(const char *text, unsigned long length) const noexcept;
+			endpoint(std::string user, std::string password,
+				std::string database, unsigned int port = 3306,
+				std::string host = "127.0.0.1",
+				std::string unix_socket = std::string(),
+				unsigned long flags = 0);
 
 			//*********************************************************
-			// 函数名称 : execute
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句
+			// 函数名称 : options
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取连接选项, 可以在连接前修改
 			// 访问方式 : public
-			// 函数参数 : const std::string & text SQL语句
-			// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+			// 返 回 值 : connection_options & 连接选项
 			//*********************************************************
-			bool execute(const std::string &text) const noexcept;
+			connection_options & options(void) noexcept;
 
 			//*********************************************************
-			// 函数名称 : execute
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句
+			// 函数名称 : options
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取连接选项
 			// 访问方式 : public
-			// 函数参数 : const std::vector<char> & data SQL语句
-			// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+			// 返 回 值 : const connection_options & 连接选项
 			//*********************************************************
-			bool execute(const std::vector<char> &data) const noexcept;
+			const connection_options & options(void) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : execute
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句
+			// 函数名称 : host
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取服务器 IP 地址
 			// 访问方式 : public
-			// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
-			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
-			//            如果生成SQL语句失败则抛出 std::exception 异常
+			// 返 回 值 : const std::string & 服务器 IP 地址
 			//*********************************************************
-			bool execute(void) const;
+			const std::string & host(void) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : execute
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句; 使用例子:
-			//            command(connector).execute("insert into table1 values(?, ?)", std::make_tuple(12, "abc"));
-			//            执行上面语句将生成SQL语句: insert into table1 values(12, 'abc')
-			//            生成SQL语句后执行SQL语句
+			// 函数名称 : port
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取服务器端口
 			// 访问方式 : public
-			// 函数参数 : const char * text SQL语句
-			// 函数参数 : const Tuple & t 数据
-			// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
-			// 异    常 : 如果执行失败则抛出异常
+			// 返 回 值 : unsigned int 服务器端口
 			//*********************************************************
-			template <typename Tuple>
-			bool execute(const std::string &text, const Tuple &t) const
-			{
-				return this->execute(statement<Tuple>().generate(*this, text, t));
-			}
+			unsigned int port(void) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : execute
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句
-			// 访问方式 : public 
-			// 函数参数 : const std::vector<char> & data SQL语句
-			// 函数参数 : const Tuple & t 数据
-			// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
-			// 异    常 : 如果执行失败则抛出异常
+			// 函数名称 : user
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取用户名
+			// 访问方式 : public
+			// 返 回 值 : const std::string & 用户名
 			//*********************************************************
-			template <typename Tuple>
-			bool execute(const std::vector<char> &data, const Tuple &t) const
-			{
-				return this->execute(statement<Tuple>().generate(*this, data, t));
-			}
+			const std::string & user(void) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : execute_reader
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句
+			// 函数名称 : unix_socket
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取 socket 或者 命名管道
 			// 访问方式 : public
-			// 函数参数 : const char * text SQL语句
-			// 返 回 值 : sql::mariadb::recordset 结果集
-			// 异    常 : 如果执行SQL失败则抛出 mariadb_exception 异常
+			// 返 回 值 : const std::string & socket 或者 命名管道
 			//*********************************************************
-			recordset execute_reader(const char *text) const;
+			const std::string & unix_socket(void) const noexcept;
+
+		private:
+			friend connection;
+			connection_options m_options; // 连接选项
+			std::string m_user; // 用户名
+			std::string m_password; // 密码
+			std::string m_database; // 数据库名
+			unsigned int m_port; // 服务器端口
+			std::string m_host; // 服务器 IP 地址
+			std::string m_unix_socket; // socket 或者 命名管道
+			unsigned long m_flags; // 链接选项
+		};
+
+		// 自动重新连接的策略
+		// 使用带随机抖动的指数退避: 第 n 次重新连接前等待 [0, min(max_delay, base_delay * 2^n)] 毫秒,
+		// 避免服务器重启后大量客户端同时重新连接
+		class reconnect_policy
+		{
+		public:
 
 			//*********************************************************
-			// 函数名称 : execute_reader
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句
+			// 函数名称 : reconnect_policy
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数
 			// 访问方式 : public
-			// 函数参数 : const char * text SQL语句
-			// 函数参数 : unsigned long length text的字节数
-			// 返 回 值 : sql::mariadb::recordset 结果集
-			// 异    常 : 如果执行SQL失败则抛出 mariadb_exception 异常
+			// 函数参数 : unsigned int max_attempts 最多尝试重新连接多少次, 0 代表不重新连接
+			// 函数参数 : unsigned int base_delay 退避的基础等待时间 (毫秒)
+			// 函数参数 : unsigned int max_delay 最长的等待时间 (毫秒)
 			//*********************************************************
-			recordset execute_reader(const char *text, unsigned long length) const;
+			explicit reconnect_policy(unsigned int max_attempts = 5,
+				unsigned int base_delay = 50, unsigned int max_delay = 2000) noexcept;
 
 			//*********************************************************
-			// 函数名称 : execute_reader
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句
+			// 函数名称 : max_attempts
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取最多尝试重新连接的次数
 			// 访问方式 : public
-			// 函数参数 : const std::string & text SQL语句
-			// 返 回 值 : sql::mariadb::recordset 结果集
-			// 异    常 : 如果执行SQL失败则抛出 mariadb_exception 异常
+			// 返 回 值 : unsigned int 次数
 			//*********************************************************
-			recordset execute_reader(const std::string &text) const;
+			unsigned int max_attempts(void) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : execute_reader
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句
+			// 函数名称 : delay
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取第 attempt 次重新连接前需要等待的时间 (带随机抖动)
 			// 访问方式 : public
-			// 函数参数 : const std::vector<char> & data SQL语句
-			// 返 回 值 : sql::mariadb::recordset 结果集
-			// 异    常 : 如果执行SQL失败则抛出 mariadb_exception 异常
+			// 函数参数 : unsigned int attempt 第几次重新连接, 从0开始
+			// 返 回 值 : unsigned int 等待时间 (毫秒)
 			//*********************************************************
-			recordset execute_reader(const std::vector<char> &data) const;
+			unsigned int delay(unsigned int attempt) const noexcept;
+
+		private:
+			unsigned int m_max_attempts; // 最多尝试重新连接多少次
+			unsigned int m_base_delay; // 退避的基础等待时间 (毫秒)
+			unsigned int m_max_delay; // 最长的等待时间 (毫秒)
+		};
+
+		// 事务重试的策略
+		// 死锁 (1213)、等待锁超时 (1205) 和 SQLSTATE 40001 时回滚并重新执行整个事务,
+		// 第 n 次重试前等待 [0, min(max_delay, base_delay * 2^n)] 毫秒, 错开冲突的事务
+		class retry_policy
+		{
+		public:
 
 			//*********************************************************
-			// 函数名称 : execute_reader
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句
+			// 函数名称 : retry_policy
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数
 			// 访问方式 : public
-			// 返 回 值 : sql::mariadb::recordset 结果集
-			// 异    常 : 如果执行SQL失败则抛出 mariadb_exception 异常
-			//            如果分配资源失败则抛出 std::bad_alloc 异常;
-			//            如果生成SQL语句失败则抛出 std::exception 异常
+			// 函数参数 : unsigned int max_attempts 最多执行多少次, 包括第一次
+			// 函数参数 : unsigned int base_delay 退避的基础等待时间 (毫秒)
+			// 函数参数 : unsigned int max_delay 最长的等待时间 (毫秒)
 			//*********************************************************
-			recordset execute_reader(void) const;
+			explicit retry_policy(unsigned int max_attempts = 5,
+				unsigned int base_delay = 5, unsigned int max_delay = 500) noexcept;
 
 			//*********************************************************
-			// 函数名称 : execute_reader
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句; 使用例子:
-			//            command(connector).execute_reader("insert into table1 values(?, ?)", std::make_tuple(12, "abc"));
-			//            执行上面语句将生成SQL语句: insert into table1 values(12, 'abc')
-			//            生成SQL语句后执行SQL语句
+			// 函数名称 : max_attempts
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取最多执行的次数
 			// 访问方式 : public
-			// 函数参数 : const std::string & text SQL语句
-			// 函数参数 : const Tuple & t 数据
-			// 返 回 值 : sql::mariadb::recordset 结果集
-			// 异    常 : 如果执行失败则抛出异常
+			// 返 回 值 : unsigned int 次数
 			//*********************************************************
-			template <typename Tuple>
-			recordset execute_reader(const std::string &text, const Tuple &t) const
-			{
-				return this->execute_reader(statement<Tuple>().generate(*this, text, t));
-			}
+			unsigned int max_attempts(void) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : execute_reader
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句
-			// 访问方式 : public 
-			// 函数参数 : const std::vector<char> & data SQL语句
-			// 函数参数 : const Tuple & t 数据
-			// 返 回 值 : sql::mariadb::recordset 结果集
-			// 异    常 : 如果执行失败则抛出异常
+			// 函数名称 : delay
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取第 attempt 次重试前需要等待的时间 (带随机抖动)
+			// 访问方式 : public
+			// 函数参数 : unsigned int attempt 第几次重试, 从0开始
+			// 返 回 值 : unsigned int 等待时间 (毫秒)
 			//*********************************************************
-			template <typename Tuple>
-			recordset execute_reader(const std::vector<char> &data, const Tuple &t) const
-			{
-				return this->execute_reader(statement<Tuple>().generate(*this, data, t));
-			}
+			unsigned int delay(unsigned int attempt) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : execute_scalar
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句并返回第一列的第一个值
+			// 函数名称 : retryable
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 判断错误是否可以通过重新执行事务解决
 			// 访问方式 : public
+			// 函数参数 : const mariadb_exception & exception 事务中抛出的异常
+			// 返 回 值 : bool 如果可以重试返回true; 反之返回false
+			//*********************************************************
+			static bool retryable(const mariadb_exception &exception) noexcept;
+
+		private:
+			unsigned int m_max_attempts; // 最多执行多少次
+			unsigned int m_base_delay; // 退避的基础等待时间 (毫秒)
+			unsigned int m_max_delay; // 最长的等待时间 (毫秒)
+		};
+
+		// 数据库连接的会话状态
+		// 保存重新连接后需要恢复的会话变量; 字符集和 MYSQL_INIT_COMMAND 由客户端库在重新连接时恢复
+		class session_state
+		{
+		private:
+
+			//*********************************************************
+			// 函数名称 : session_state
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数
+			// 访问方式 : private
+			// 函数参数 : const reconnect_policy & policy 重新连接的策略
+			//*********************************************************
+			explicit session_state(const reconnect_policy &policy) noexcept;
+
+			//*********************************************************
+			// 函数名称 : reconnect
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 按照策略重新连接 (使用原来的数据库句柄) 并恢复会话变量;
+			//            每次重新连接成功后 generation 加 1
+			// 访问方式 : private
+			// 函数参数 : MYSQL * pointer 数据库句柄
+			// 返 回 值 : bool 如果重新连接成功返回true; 反之返回false
+			//*********************************************************
+			bool reconnect(MYSQL *pointer) noexcept;
+
+			//*********************************************************
+			// 函数名称 : retryable
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 判断失败的SQL语句能否在重新连接后再执行一次:
+			//            错误必须是连接断开, 执行前不能在事务中 (断开时事务已经回滚),
+			//            并且SQL语句可以重复执行
+			// 访问方式 : private
+			// 函数参数 : unsigned int code 错误代号
+			// 函数参数 : bool in_transaction 执行前是否在事务中
 			// 函数参数 : const char * text SQL语句
-			// 返 回 值 : T 结果集中第一列的第一个值
-			// 异    常 : 如果执行SQL失败或者不能获取结果集或者转换失败则抛出 mariadb_exception 异常
+			// 函数参数 : unsigned long length SQL语句字符串长度
+			// 返 回 值 : bool 如果可以再执行一次返回true; 反之返回false
 			//*********************************************************
-			template <typename T>
-			T execute_scalar(const char *text) const
-			{
-				auto reader = this->execute_reader(text);
-				if_null_throw(reader, text);
-				read_or_throw(reader, text);
-				return reader.get<T>(0);
-			}
+			static bool retryable(unsigned int code, bool in_transaction, const char *text, unsigned long length) noexcept;
 
 			//*********************************************************
-			// 函数名称 : execute_scalar
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句并返回第一列的第一个值
-			// 访问方式 : public
+			// 函数名称 : idempotent
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 判断SQL语句能否重复执行, 与 router::is_read 使用相同的规则: 只有一条SQL语句,
+			//            以 SELECT, SHOW, DESCRIBE, DESC, EXPLAIN 开头, 并且不加锁 (FOR UPDATE,
+			//            LOCK IN SHARE MODE), 不写入 (INTO), 不使用与会话相关的函数 (LAST_INSERT_ID,
+			//            FOUND_ROWS, GET_LOCK, NEXTVAL 等); SET 可能依赖变量原来的值, 不重复执行
+			// 访问方式 : private
 			// 函数参数 : const char * text SQL语句
-			// 函数参数 : unsigned long length text的字节数
-			// 返 回 值 : T 结果集中第一列的第一个值
-			// 异    常 : 如果执行SQL失败或者不能获取结果集或者转换失败则抛出 mariadb_exception 异常
+			// 函数参数 : unsigned long length SQL语句字符串长度
+			// 返 回 值 : bool 如果可以重复执行返回true; 反之返回false
 			//*********************************************************
-			template <typename T>
-			T execute_scalar(const char *text, unsigned long length) const
-			{
-				auto reader = this->execute_reader(text, length);
-				if_null_throw(reader, std::string(text, length));
-				read_or_throw(reader, std::string(text, length));
-				return reader.get<T>(0);
-			}
+			static bool idempotent(const char *text, unsigned long length) noexcept;
+
+		private:
+			friend connection;
+			friend command;
+			friend prepared_statement;
+			reconnect_policy m_policy; // 重新连接的策略
+			std::map<std::string, std::string> m_variables; // 需要恢复的会话变量
+			unsigned long m_generation; // 重新连接的次数, 预处理语句用来判断是否需要重新预处理
+		};
+
+		// 数据库连接类
+		// 一个数据库连接只能用于一个线程
+		class connection
+		{
+		public:
 
 			//*********************************************************
-			// 函数名称 : execute_scalar
+			// 函数名称 : connection
 			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句并返回第一列的第一个值
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 构造函数
 			// 访问方式 : public
-			// 函数参数 : const std::string & text SQL语句
-			// 返 回 值 : T 结果集中第一列的第一个值
-			// 异    常 : 如果执行SQL失败或者不能获取结果集或者转换失败则抛出 mariadb_exception 异常
 			//*********************************************************
-			template <typename T>
-			T execute_scalar(const std::string &text) const
-			{
-				auto reader = this->execute_reader(text);
-				if_null_throw(reader, text);
-				read_or_throw(reader, text);
-				return reader.get<T>(0);
-			}
+			connection(void) noexcept;
 
 			//*********************************************************
-			// 函数名称 : execute_scalar
+			// 函数名称 : connection
 			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句并返回第一列的第一个值
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 转移构造函数, 转移后原对象不应该使用
 			// 访问方式 : public
-			// 函数参数 : const std::vector<char> & data SQL语句
-			// 返 回 值 : T 结果集中第一列的第一个值
-			// 异    常 : 如果执行SQL失败或者不能获取结果集或者转换失败则抛出 mariadb_exception 异常
+			// 函数参数 : connection && connector 需要转移的对象
 			//*********************************************************
-			template <typename T>
-			T execute_scalar(const std::vector<char> &data) const
-			{
-				auto reader = this->execute_reader(data);
-				if_null_throw(reader, std::string(data.begin(), data.end()));
-				read_or_throw(reader, std::string(data.begin(), data.end()));
-				return reader.get<T>(0);
-			}
+			connection(connection &&connector) noexcept;
 
 			//*********************************************************
-			// 函数名称 : execute_scalar
+			// 函数名称 : ~connection
 			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句并返回第一列的第一个值
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 如果数据库连接没有关闭则在析构时自动关闭
 			// 访问方式 : public
-			// 返 回 值 : T 结果集中第一列的第一个值
-			// 异    常 : 如果执行SQL失败或者不能获取结果集或者转换失败则抛出 mariadb_exception 异常
 			//*********************************************************
-			template <typename T>
-			T execute_scalar(void) const
-			{
-				auto reader = this->execute_reader();
-				if_null_throw(reader, m_text);
-				read_or_throw(reader, m_text);
-				return reader.get<T>(0);
-			}
+			~connection(void) noexcept;
 
 			//*********************************************************
-			// 函数名称 : execute_scalar
+			// 函数名称 : operator!=
 			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句并返回第一列的第一个值
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 判断数据库连接器是否创建成功
 			// 访问方式 : public
-			// 函数参数 : const std::string & text SQL语句
-			// 函数参数 : const Tuple & t 数据
-			// 返 回 值 : T 结果集中第一列的第一个值
-			// 异    常 : 如果执行失败则抛出异常
+			// 函数参数 : std::nullptr_t null 与nullptr作比较
+			// 返 回 值 : bool 如果创建成功则 对象 != nullptr;
+			//            反之 对象 == nullptr
 			//*********************************************************
-			template <typename T, typename Tuple>
-			T execute_scalar(const std::string &text, const Tuple &t) const
-			{
-				return this->execute_scalar<T>(statement<Tuple>().generate(*this, text, t));
-			}
+			bool operator!=(std::nullptr_t null) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : execute_scalar
+			// 函数名称 : operator==
 			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句并返回第一列的第一个值
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 判断数据库连接器是否创建成功
 			// 访问方式 : public
-			// 函数参数 : const std::vector<char> & data SQL语句
-			// 函数参数 : const Tuple & t 数据
-			// 返 回 值 : T 结果集中第一列的第一个值
-			// 异    常 : 如果执行失败则抛出异常
+			// 函数参数 : std::nullptr_t null  与nullptr作比较
+			// 返 回 值 : bool 如果创建成功则 对象 != nullptr;
+			//            反之 对象 == nullptr
 			//*********************************************************
-			template <typename T, typename Tuple>
-			T execute_scalar(const std::vector<char> &data, const Tuple &t) const
-			{
-				return this->execute_scalar<T>(statement<Tuple>().generate(*this, data, t));
-			}
+			bool operator==(std::nullptr_t null) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : query
+			// 函数名称 : open
 			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句并返回第一行数据
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 连接数据库
 			// 访问方式 : public
-			// 函数参数 : const char * text SQL语句
-			// 返 回 值 : Tuple 结果集中第一行数据
-			// 异    常 : 如果执行SQL失败或者不能获取结果集或者转换失败则抛出 mariadb_exception 异常
+			// 函数参数 : const char * user 用户名
+			// 函数参数 : const char * password 密码
+			// 函数参数 : const char * database 数据库名
+			// 函数参数 : unsigned int port 服务器端口
+			// 函数参数 : const char * host 服务器 IP 地址
+			// 函数参数 : const char * unix_socket 指定需要使用的 socket 或者 命名管道
+			// 函数参数 : unsigned long flags 链接选项
+			// 返 回 值 : bool true 代表连接成功, false 代表连接失败
 			//*********************************************************
-			template <typename Tuple>
-			Tuple query(const char *text) const
-			{
-				// 获取结果集, 如果获取失败则抛出异常
-				auto reader = this->execute_reader(text);
-				if_null_throw(reader, text);
-				read_or_throw(reader, text);
-				return data_tuple_getter<Tuple>::get(reader);
-			}
+			bool open(const char *user, const char *password,
+				const char *database, unsigned int port = 3306,
+				const char *host = "127.0.0.1",
+				const char *unix_socket = nullptr,
+				unsigned long flags = 0) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : query
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句并返回第一行数据
+			// 函数名称 : open
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 使用连接选项连接数据库, 连接前设置所有选项
 			// 访问方式 : public
-			// 函数参数 : const char * text SQL语句
-			// 函数参数 : unsigned long length text的字节数
-			// 返 回 值 : Tuple 结果集中第一行数据
-			// 异    常 : 如果执行SQL失败或者不能获取结果集或者转换失败则抛出 mariadb_exception 异常
+			// 函数参数 : const connection_options & options 连接选项
+			// 函数参数 : const char * user 用户名
+			// 函数参数 : const char * password 密码
+			// 函数参数 : const char * database 数据库名
+			// 函数参数 : unsigned int port 服务器端口
+			// 函数参数 : const char * host 服务器 IP 地址
+			// 函数参数 : const char * unix_socket 指定需要使用的 socket 或者 命名管道
+			// 函数参数 : unsigned long flags 链接选项
+			// 返 回 值 : bool true 代表连接成功, false 代表连接失败
 			//*********************************************************
-			template <typename Tuple>
-			Tuple query(const char *text, unsigned long length) const
-			{
-				// 获取结果集, 如果获取失败则抛出异常
-				auto reader = this->execute_reader(text, length);
-				if_null_throw(reader, std::string(text, length));
-				read_or_throw(reader, std::string(text, length));
-				return data_tuple_getter<Tuple>::get(reader);
-			}
+			bool open(const connection_options &options,
+				const char *user, const char *password,
+				const char *database, unsigned int port = 3306,
+				const char *host = "127.0.0.1",
+				const char *unix_socket = nullptr,
+				unsigned long flags = 0) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : query
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句并返回第一行数据
+			// 函数名称 : open
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 使用服务器参数连接数据库
 			// 访问方式 : public
-			// 函数参数 : const std::string & text SQL语句
-			// 返 回 值 : Tuple 结果集中第一行数据
-			// 异    常 : 如果执行SQL失败或者不能获取结果集或者转换失败则抛出 mariadb_exception 异常
+			// 函数参数 : const endpoint & point 服务器参数
+			// 返 回 值 : bool true 代表连接成功, false 代表连接失败
 			//*********************************************************
-			template <typename Tuple>
-			Tuple query(const std::string &text) const
-			{
-				// 获取结果集, 如果获取失败则抛出异常
-				auto reader = this->execute_reader(text);
-				if_null_throw(reader, text);
-				read_or_throw(reader, text);
-				return data_tuple_getter<Tuple>::get(reader);
-			}
+			bool open(const endpoint &point) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : query
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句并返回第一行数据
-			// 访问方式 : public 
-			// 函数参数 : const std::vector<char> & data SQL语句
-			// 返 回 值 : Tuple 结果集中第一行数据
-			// 异    常 : 如果执行SQL失败或者不能获取结果集或者转换失败则抛出 mariadb_exception 异常
+			// 函数名称 : open_many
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 使用多个线程同时打开多个数据库连接, 并用 ping 检查连接是否可用;
+			//            多个连接的握手同时进行, 启动时打开大量连接只需要大约一次握手的时间;
+			//            连接失败的不会返回, 返回的连接数可能少于 count; 例子如下:
+			//            auto connectors = sql::mariadb::connection::open_many(point, 32);
+			// 访问方式 : public
+			// 函数参数 : const endpoint & point 服务器参数
+			// 函数参数 : size_t count 需要打开的连接数
+			// 函数参数 : size_t threads 最多使用多少个线程
+			// 返 回 值 : std::vector<connection> 已经连接成功的数据库连接
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+			//            如果无法创建线程则抛出 std::system_error 异常
 			//*********************************************************
-			template <typename Tuple>
-			Tuple query(const std::vector<char> &data) const
-			{
-				// 获取结果集, 如果获取失败则抛出异常
-				auto reader = this->execute_reader(data);
-				if_null_throw(reader, std::string(data.begin(), data.end()));
-				read_or_throw(reader, std::string(data.begin(), data.end()));
-				return data_tuple_getter<Tuple>::get(reader);
-			}
+			static std::vector<connection> open_many(const endpoint &point, size_t count, size_t threads = 8);
 
 			//*********************************************************
-			// 函数名称 : query
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句并返回第一行数据
+			// 函数名称 : ping
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 检查数据库连接是否可用
 			// 访问方式 : public
-			// 返 回 值 : Tuple 结果集中第一行数据
-			// 异    常 :  如果执行SQL失败或者不能获取结果集或者转换失败则抛出 mariadb_exception 异常
+			// 返 回 值 : bool 如果连接可用返回true; 反之返回false
 			//*********************************************************
-			template <typename Tuple>
-			Tuple query(void) const
-			{
-				// 获取结果集, 如果获取失败则抛出异常
-				auto reader = this->execute_reader();
-				if_null_throw(reader, m_text);
-				read_or_throw(reader, m_text);
-				return data_tuple_getter<Tuple>::get(reader);
-			}
+			bool ping(void) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : query
+			// 函数名称 : close
 			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句并返回第一行数据
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 关闭数据库连接, 如果不手动关闭数据库连接, 则析构时自动关闭
 			// 访问方式 : public
-			// 函数参数 : const std::string & text SQL语句
-			// 函数参数 : const InTuple & t 数据
-			// 返 回 值 : OutTuple 结果集中第一行数据
-			// 异    常 : 如果执行失败则抛出异常
 			//*********************************************************
-			template <typename OutTuple, typename InTuple>
-			OutTuple query(const std::string &text, const InTuple &t) const
-			{
-				return this->query<OutTuple>(statement<InTuple>().generate(*this, text, t));
-			}
+			void close(void) noexcept;
 
 			//*********************************************************
-			// 函数名称 : query
+			// 函数名称 : error
 			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句并返回第一行数据
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 获取数据库操作失败的错误信息
 			// 访问方式 : public
-			// 函数参数 : const std::vector<char> & data SQL语句
-			// 函数参数 : const InTuple & t 数据
-			// 返 回 值 : OutTuple 结果集中第一行数据
-			// 异    常 : 如果执行失败则抛出异常
+			// 返 回 值 : std::string 错误信息
 			//*********************************************************
-			template <typename OutTuple, typename InTuple>
-			OutTuple query(const std::vector<char> &data, const InTuple &t) const
-			{
-				return this->query<OutTuple>(statement<InTuple>().generate(*this, data, t));
-			}
+			std::string error(void) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : query_vector
+			// 函数名称 : errorno
 			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句并返回所有数据
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 获取数据库操作失败的错误代号
 			// 访问方式 : public
-			// 函数参数 : const char * text SQL语句
-			// 返 回 值 : std::vector<Tuple> 结果集中所有数据
-			// 异    常 : 如果执行失败则抛出异常
+			// 返 回 值 : unsigned int 错误代号
 			//*********************************************************
-			template <typename Tuple>
-			std::vector<Tuple> query_vector(const char *text) const
-			{
-				// 获取结果集, 如果获取失败则抛出异常
-				auto reader = this->execute_reader(text);
-				if_null_throw(reader, text);
-				return vector_from_recordset<Tuple>(reader);
-			}
+			unsigned int errorno(void) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : query_vector
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句并返回所有数据
-			// 访问方式 : public 
-			// 函数参数 : const char * text SQL语句
-			// 函数参数 : unsigned long length text的字节数
-			// 返 回 值 : std::vector<Tuple> 结果集中所有数据
-			// 异    常 : 如果执行失败则抛出异常
+			// 函数名称 : sqlstate
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取数据库操作失败的 SQLSTATE
+			// 访问方式 : public
+			// 返 回 值 : std::string 五个字符的 SQLSTATE, 成功时为 00000
 			//*********************************************************
-			template <typename Tuple>
-			std::vector<Tuple> query_vector(const char *text, unsigned long length) const
-			{
-				// 获取结果集, 如果获取失败则抛出异常
-				auto reader = this->execute_reader(text, length);
-				if_null_throw(reader, std::string(text, length));
-				return vector_from_recordset<Tuple>(reader);
-			}
+			std::string sqlstate(void) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : query_vector
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句并返回所有数据
-			// 访问方式 : public 
-			// 函数参数 : const std::string & text SQL语句
-			// 返 回 值 : std::vector<Tuple> 结果集中所有数据
-			// 异    常 : 如果执行失败则抛出异常
+			// 函数名称 : set_multi_statements
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 允许或者禁止一次执行多条用分号分隔的SQL语句;
+			//            也可以在 open 时使用 CLIENT_MULTI_STATEMENTS 选项允许;
+			//            执行后使用 recordset::next_result 遍历每条SQL语句的结果集
+			// 访问方式 : public
+			// 函数参数 : bool enable true 代表允许, false 代表禁止
+			// 返 回 值 : bool 如果设置成功返回true; 反之返回false
 			//*********************************************************
-			template <typename Tuple>
-			std::vector<Tuple> query_vector(const std::string &text) const
-			{
-				// 获取结果集, 如果获取失败则抛出异常
-				auto reader = this->execute_reader(text);
-				if_null_throw(reader, text);
-				return vector_from_recordset<Tuple>(reader);
-			}
+			bool set_multi_statements(bool enable) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : query_vector
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句并返回所有数据
+			// 函数名称 : set_reconnect
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 启用自动重新连接: 连接断开 (CR_SERVER_GONE_ERROR, CR_SERVER_LOST) 时,
+			//            如果SQL语句可以重复执行并且不在事务中, 则按照策略重新连接,
+			//            恢复会话变量后再执行一次; 预处理语句在下一次执行时重新预处理;
+			//            必须在连接后、创建 command 和 prepared_statement 之前调用
 			// 访问方式 : public
-			// 函数参数 : const std::vector<char> & data SQL语句
-			// 返 回 值 : std::vector<Tuple> 结果集中所有数据
-			// 异    常 : 如果执行失败则抛出异常
+			// 函数参数 : const reconnect_policy & policy 重新连接的策略
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
 			//*********************************************************
-			template <typename Tuple>
-			std::vector<Tuple> query_vector(const std::vector<char> &data) const
-			{
-				// 获取结果集, 如果获取失败则抛出异常
-				auto reader = this->execute_reader(data);
-				if_null_throw(reader, std::string(data.begin(), data.end()));
-				return vector_from_recordset<Tuple>(reader);
-			}
+			void set_reconnect(const reconnect_policy &policy = reconnect_policy());
 
 			//*********************************************************
-			// 函数名称 : query_vector
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 执行SQL语句并返回所有数据
+			// 函数名称 : set_session_variable
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置会话变量, 启用自动重新连接时会在重新连接后恢复
 			// 访问方式 : public
-			// 返 回 值 : std::vector<Tuple> 结果集中所有数据
-			// 异    常 : 如果执行失败则抛出异常
+			// 函数参数 : const std::string & name 变量名
+			// 函数参数 : const std::string & value 变量值, 会直接写入SQL语句, 字符串需要加上单引号
+			// 返 回 值 : bool 如果设置成功返回true; 反之返回false
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
 			//*********************************************************
-			template <typename Tuple>
-			std::vector<Tuple> query_vector(void) const
-			{
-				// 获取结果集, 如果获取失败则抛出异常
-				auto reader = this->execute_reader();
-				if_null_throw(reader, m_text);
-				return vector_from_recordset<Tuple>(reader);
-			}
+			bool set_session_variable(const std::string &name, const std::string &value) const;
 
 			//*********************************************************
-			// 函数名称 : query_vector
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/17
-			// 函数说明 : 执行SQL语句并返回所有数据
+			// 函数名称 : in_transaction
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 根据服务器最后一次返回的状态判断是否在事务中
 			// 访问方式 : public
-			// 函数参数 : const std::string & text SQL语句
-			// 函数参数 : const InTuple & t 数据
-			// 返 回 值 : std::vector<Tuple> 结果集中所有数据
-			// 异    常 : 如果执行失败则抛出异常
+			// 返 回 值 : bool 如果在事务中返回true; 反之返回false
 			//*********************************************************
-			template <typename OutTuple, typename InTuple>
-			std::vector<OutTuple> query_vector(const std::string &text, const InTuple &t) const
-			{
-				return this->query_vector<OutTuple>(statement<InTuple>().generate(*this, text, t));
-			}
+			bool in_transaction(void) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : query_vector
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/17
-			// 函数说明 : 执行SQL语句并返回所有数据
+			// 函数名称 : autocommit
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 根据服务器最后一次返回的状态判断是否自动提交
 			// 访问方式 : public
-			// 函数参数 : const std::vector<char> & data SQL语句
-			// 函数参数 : const InTuple & t 数据
-			// 返 回 值 : std::vector<Tuple> 结果集中所有数据
-			// 异    常 : 如果执行失败则抛出异常
+			// 返 回 值 : bool 如果自动提交返回true; 反之返回false
 			//*********************************************************
-			template <typename OutTuple, typename InTuple>
-			std::vector<OutTuple> query_vector(const std::vector<char> &data, const InTuple &t) const
-			{
-				return this->query_vector<OutTuple>(statement<InTuple>().generate(*this, data, t));
-			}
+			bool autocommit(void) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : query_list
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/17
-			// 函数说明 : 执行SQL语句并返回所有数据
+			// 函数名称 : thread_id
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取服务器上该连接的线程ID, 可以用于 KILL QUERY
 			// 访问方式 : public
-			// 函数参数 : const char * text SQL语句
-			// 返 回 值 : std::list<Tuple> 结果集中所有数据
-			// 异    常 : 如果执行失败则抛出异常
+			// 返 回 值 : unsigned long 线程ID
 			//*********************************************************
-			template <typename Tuple>
-			std::list<Tuple> query_list(const char *text) const
-			{
-				// 获取结果集, 如果获取失败则抛出异常
-				auto reader = this->execute_reader(text);
-				if_null_throw(reader, text);
-				return list_from_recordset<Tuple>(reader);
-			}
+			unsigned long thread_id(void) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : query_list
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/17
-			// 函数说明 : 执行SQL语句并返回所有数据
+			// 函数名称 : set_observer
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置观察者, 之后由该连接创建的 command 默认使用该观察者
 			// 访问方式 : public
-			// 函数参数 : const char * text SQL语句
-			// 函数参数 : unsigned long length text的字节数
-			// 返 回 值 : std::list<Tuple> 结果集中所有数据
-			// 异    常 : 如果执行失败则抛出异常
+			// 函数参数 : statement_observer * observer 观察者, nullptr 代表不观察;
+			//            观察者由调用者管理, 必须比使用它的 command 活得久
 			//*********************************************************
-			template <typename Tuple>
-			std::list<Tuple> query_list(const char *text, unsigned long length) const
-			{
-				// 获取结果集, 如果获取失败则抛出异常
-				auto reader = this->execute_reader(text, length);
-				if_null_throw(reader, std::string(text, length));
-				return list_from_recordset<Tuple>(reader);
-			}
+			void set_observer(statement_observer *observer) noexcept;
 
 			//*********************************************************
-			// 函数名称 : query_list
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/17
-			// 函数说明 : 执行SQL语句并返回所有数据
+			// 函数名称 : observer
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取观察者
 			// 访问方式 : public
-			// 函数参数 : const std::string & text SQL语句
-			// 返 回 值 : std::list<Tuple> 结果集中所有数据
-			// 异    常 : 如果执行失败则抛出异常
+			// 返 回 值 : statement_observer * 观察者, 没有设置时返回 nullptr
 			//*********************************************************
-			template <typename Tuple>
-			std::list<Tuple> query_list(const std::string &text) const
-			{
-				// 获取结果集, 如果获取失败则抛出异常
-				auto reader = this->execute_reader(text);
-				if_null_throw(reader, text);
-				return list_from_recordset<Tuple>(reader);
-			}
+			statement_observer * observer(void) const noexcept;
+
+		private:
 
 			//*********************************************************
-			// 函数名称 : query_list
+			// 函数名称 : connection
 			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/17
-			// 函数说明 : 执行SQL语句并返回所有数据
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const connection &
+			//*********************************************************
+			connection(const connection &) = delete;
+
+			//*********************************************************
+			// 函数名称 : operator=
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const connection &
+			// 返 回 值 : connection &
+			//*********************************************************
+			connection & operator=(const connection &) = delete;
+
+			//*********************************************************
+			// 函数名称 : reset
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 清除会话状态, 连接池在放回连接前调用; full 为 true 并且客户端库支持时
+			//            使用 mysql_reset_connection 回滚事务并清除会话变量、用户变量、临时表和预处理语句,
+			//            然后重新执行 point 中连接成功后执行的SQL语句; 否则只回滚还没有结束的事务
+			// 访问方式 : private
+			// 函数参数 : const endpoint & point 打开该连接时使用的服务器参数
+			// 函数参数 : bool full 是否清除所有会话状态
+			// 返 回 值 : bool 如果清除成功返回true; 反之返回false, 连接不应该再使用
+			//*********************************************************
+			bool reset(const endpoint &point, bool full) const noexcept;
+
+		private:
+			friend command;
+			friend recordset;
+			friend prepared_statement;
+			friend pipeline;
+			friend connection_pool;
+			MYSQL *m_ptr_mysql; // MariaDB 数据库句柄
+			std::unique_ptr<session_state> m_session; // 会话状态, 没有启用自动重新连接时为 nullptr
+			statement_observer *m_ptr_observer; // 观察者, 没有设置时为 nullptr
+		};
+
+		// 数据库结果集类
+		class recordset
+		{
+		public:
+
+			//*********************************************************
+			// 函数名称 : recordset
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 转移构造函数, 转移后原对象不应该使用
+			// 访问方式 : private
+			// 函数参数 : recordset && reader 需要转移的对象
+			//*********************************************************
+			recordset(recordset &&reader) noexcept;
+
+			//*********************************************************
+			// 函数名称 : ~recordset
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 如果结果集没有释放关闭则在析构时自动关闭
 			// 访问方式 : public
-			// 函数参数 : const std::vector<char> & data SQL语句
-			// 返 回 值 : std::list<Tuple> 结果集中所有数据
-			// 异    常 : 如果执行失败则抛出异常
 			//*********************************************************
-			template <typename Tuple>
-			std::list<Tuple> query_list(const std::vector<char> &data) const
-			{
-				// 获取结果集, 如果获取失败则抛出异常
-				auto reader = this->execute_reader(data);
-				if_null_throw(reader, std::string(data.begin(), data.end()));
-				return list_from_recordset<Tuple>(reader);
-			}
+			~recordset(void) noexcept;
 
 			//*********************************************************
-			// 函数名称 : query_list
+			// 函数名称 : operator!=
 			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/17
-			// 函数说明 : 执行SQL语句并返回所有数据
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 判断数据库连接器是否创建成功
 			// 访问方式 : public
-			// 返 回 值 : std::list<Tuple> 结果集中所有数据
-			// 异    常 : 如果执行失败则抛出异常
+			// 函数参数 : std::nullptr_t null 与nullptr作比较
+			// 返 回 值 : bool 如果创建成功则 对象 != nullptr;
+			//            反之 对象 == nullptr
 			//*********************************************************
-			template <typename Tuple>
-			std::list<Tuple> query_list(void) const
-			{
-				// 获取结果集, 如果获取失败则抛出异常
-				auto reader = this->execute_reader();
-				if_null_throw(reader, m_text);
-				return list_from_recordset<Tuple>(reader);
-			}
+			bool operator!=(std::nullptr_t null) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : query_list
+			// 函数名称 : operator==
 			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/17
-			// 函数说明 : 执行SQL语句并返回所有数据
-			// 访问方式 : public 
-			// 函数参数 : const std::string & text SQL语句
-			// 函数参数 : const InTuple & t 数据
-			// 返 回 值 : std::list<Tuple> 结果集中所有数据
-			// 异    常 : 如果执行失败则抛出异常
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 判断数据库连接器是否创建成功
+			// 访问方式 : public
+			// 函数参数 : std::nullptr_t null  与nullptr作比较
+			// 返 回 值 : bool 如果创建成功则 对象 != nullptr;
+			//            反之 对象 == nullptr
 			//*********************************************************
-			template <typename OutTuple, typename InTuple>
-			std::list<OutTuple> query_list(const std::string &text, const InTuple &t) const
-			{
-				return this->query_list<OutTuple>(statement<InTuple>().generate(*this, text, t));
-			}
+			bool operator==(std::nullptr_t null) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : query_list
+			// 函数名称 : close
 			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/17
-			// 函数说明 : 执行SQL语句并返回所有数据
-			// 访问方式 : public 
-			// 函数参数 : const std::vector<char> & data SQL语句
-			// 函数参数 : const InTuple & t 数据
-			// 返 回 值 : std::list<Tuple> 结果集中所有数据
-			// 异    常 : 如果执行失败则抛出异常
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 释放结果集所占用的资源, 如果不手动释放资源, 则析构时自动释放
+			// 访问方式 : public
 			//*********************************************************
-			template <typename OutTuple, typename InTuple>
-			std::list<OutTuple> query_list(const std::vector<char> &data, const InTuple &t) const
-			{
-				return this->query_list<OutTuple>(statement<InTuple>().generate(*this, data, t));
-			}
+			void close(void) noexcept;
 
-		private:
+			//*********************************************************
+			// 函数名称 : error
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 获取数据库操作失败的错误信息
+			// 访问方式 : public
+			// 返 回 值 : std::string 错误信息
+			//*********************************************************
+			std::string error(void) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : vector_from_recordset
+			// 函数名称 : errorno
 			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 从结果集中读取数据并填充到 std::vector 对象中返回
-			// 访问方式 : private
-			// 函数参数 : recordset & reader 结果集
-			// 返 回 值 : std::vector<Tuple> 结果集中的所有数据
-			// 异    常 : 如果执行失败则抛出异常
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 获取数据库操作失败的错误代号
+			// 访问方式 : public
+			// 返 回 值 : unsigned int 错误代号
 			//*********************************************************
-			template <typename Tuple>
-			static std::vector<Tuple> vector_from_recordset(recordset &reader)
-			{
-				// 分配内存
-				std::vector<Tuple> data; // 保存数据
-				data.reserve((unsigned int)reader.row_count());
+			unsigned int errorno(void) const noexcept;
 
-				// 赋值
-				while (reader.read())
-				{
-					data.push_back(data_tuple_getter<Tuple>::get(reader));
-				}
-				return data;
-			}
+			//*********************************************************
+			// 函数名称 : row_count
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 获取数据的行数
+			// 访问方式 : public
+			// 返 回 值 : unsigned long long 行数
+			//*********************************************************
+			unsigned long long row_count(void) const noexcept;
 
 			//*********************************************************
-			// 函数名称 : list_from_recordset
+			// 函数名称 : field_count
 			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 从结果集中读取数据并填充到 std::list 对象中返回
-			// 访问方式 : private
-			// 函数参数 : recordset & reader 结果集
-			// 返 回 值 : std::list<Tuple> 结果集中的所有数据
-			// 异    常 : 如果执行失败则抛出异常
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 获取数据的列数(字段数量)
+			// 访问方式 : public
+			// 返 回 值 : unsigned long 列数(字段数量)
 			//*********************************************************
-			template <typename Tuple>
-			static std::list<Tuple> list_from_recordset(recordset &reader)
+			unsigned long field_count(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : data_size
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 获取单条数据的长度
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置; 如果超出数据的列数则可能出现数组越界的问题
+			// 返 回 值 : unsigned long 单条数据的字节数
+			//*********************************************************
+			unsigned long data_size(unsigned long n) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : field_index
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 根据列名获取列位置
+			// 访问方式 : public
+			// 函数参数 : const char * name 列名
+			// 返 回 值 : unsigned long 列位置; 如果没有该列则返回 field_count()
+			//*********************************************************
+			unsigned long field_index(const char *name) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : is_null
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 判断当前行的数据是否为 NULL
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : bool 如果是 NULL 返回true; 反之返回false
+			//*********************************************************
+			bool is_null(unsigned long n) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : read
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 读取下一条数据
+			// 访问方式 : public
+			// 返 回 值 : bool 成功返回true, 失败返回false
+			//*********************************************************
+			bool read(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : next_result
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 释放当前结果集并切换到下一条SQL语句的结果集; 用于一次执行
+			//            多条SQL语句或者调用存储过程; 例子如下:
+			//            auto reader = executer.execute_reader("select 1; update table1 set id = 2; select 3");
+			//            do
+			//            {
+			//                if (reader != nullptr) while (reader.read()) { ... }
+			//                else reader.affected_rows();
+			//            } while (reader.next_result());
+			//            没有结果集的SQL语句 (如 update) 切换后 对象 == nullptr
+			// 访问方式 : public
+			// 返 回 值 : bool 如果切换成功返回true; 如果没有下一个结果集或者
+			//            下一条SQL语句执行失败则返回false, 失败时 errorno 不为 0
+			//*********************************************************
+			bool next_result(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : affected_rows
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取当前结果集所对应的SQL语句所影响的行数
+			// 访问方式 : public
+			// 返 回 值 : unsigned long long 影响的行数
+			//*********************************************************
+			unsigned long long affected_rows(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : get_char
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 获取数据, 并将数据强制转换成 char 类型
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : char 数据
+			//*********************************************************
+			char get_char(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get_udata
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 获取数据, 并将数据用 std::vector<unsigned char> 对象保存
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : std::vector<unsigned char> 数据
+			// 异    常 : 如果 std::vector 创建失败时抛出异常
+			//*********************************************************
+			std::vector<unsigned char> get_udata(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get_udata_ptr
+			// 作    者 : Gooeen
+			// 完成日期 : 2016/05/09
+			// 函数说明 : 获取数据, 并将数据用 std::vector<unsigned char> 对象保存
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : std::vector<unsigned char> 数据
+			// 异    常 : 如果 std::vector 创建失败时抛出异常
+			//*********************************************************
+			std::shared_ptr<std::vector<unsigned char>> get_udata_ptr(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get_data
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 获取数据, 并将数据用 std::vector<char> 对象保存
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : std::vector<char> 数据
+			// 异    常 : 如果 std::vector 创建失败时抛出异常
+			//*********************************************************
+			std::vector<char> get_data(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get_data_ptr
+			// 作    者 : Gooeen
+			// 完成日期 : 2016/05/09
+			// 函数说明 : 获取数据, 并将数据用 std::vector<char> 对象保存
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : std::vector<char> 数据
+			// 异    常 : 如果 std::vector 创建失败时抛出异常
+			//*********************************************************
+			std::shared_ptr<std::vector<char>> get_data_ptr(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get_double
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 获取数据, 并将数据转换成 double 类型
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : double 数据
+			//*********************************************************
+			double get_double(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get_float
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 获取数据, 并将数据转换成 float 类型
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : float 数据
+			//*********************************************************
+			float get_float(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get_int
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 获取数据, 并将数据转换成 int 类型
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : int 数据
+			//*********************************************************
+			int get_int(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get_long
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 获取数据, 并将数据转换成 long 类型
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : long 数据
+			//*********************************************************
+			long get_long(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get_longlong
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 获取数据, 并将数据转换成 long long 类型
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : long long 数据
+			//*********************************************************
+			long long get_longlong(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get_short
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 获取数据, 并将数据转换成 short 类型
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : short 数据
+			//*********************************************************
+			short get_short(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get_string
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 获取数据
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : std::string 数据
+			// 异    常 : 如果数据长度 (length) 超过字符串最大长度(max_size)
+			//            则抛出 std::length_error 异常;
+			//            如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			std::string get_string(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get_string_ptr
+			// 作    者 : Gooeen
+			// 完成日期 : 2016/05/09
+			// 函数说明 : 获取数据
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : std::string 数据
+			// 异    常 : 如果数据长度 (length) 超过字符串最大长度(max_size)
+			//            则抛出 std::length_error 异常;
+			//            如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			std::shared_ptr<std::string> get_string_ptr(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get_uchar
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 获取数据, 并将数据强制转换成 unsigned char 类型
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : unsigned char 数据
+			//*********************************************************
+			unsigned char get_uchar(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get_uint
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 获取数据, 并将数据转换成 unsigned int 类型
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : unsigned int 数据
+			// 异    常 : 如果强制转换失败, 则抛出 std::invalid_argument 异常;
+			//            如果数据值大于 unsigned int 的取值范围, 则抛出 std::out_of_range 异常
+			//*********************************************************
+			unsigned int get_uint(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get_ulong
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/15
+			// 函数说明 : 获取数据, 并将数据转换成 unsigned long 类型
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : unsigned long 数据
+			// 异    常 : 如果强制转换失败, 则抛出 std::invalid_argument 异常;
+			//            如果数据值大于 unsigned long 的取值范围, 则抛出 std::out_of_range 异常
+			//*********************************************************
+			unsigned long get_ulong(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get_ulonglong
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/15
+			// 函数说明 : 获取数据, 并将数据转换成 unsigned long long 类型
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : unsigned long long 数据
+			// 异    常 : 如果强制转换失败, 则抛出 std::invalid_argument 异常;
+			//            如果数据值大于 unsigned long long 的取值范围, 则抛出 std::out_of_range 异常
+			//*********************************************************
+			unsigned long long get_ulonglong(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get_ushort
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/15
+			// 函数说明 : 获取数据, 并将数据转换成 unsigned short 类型
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : unsigned short 数据
+			//*********************************************************
+			unsigned short get_ushort(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get_wchar
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/15
+			// 函数说明 : 获取数据, 并将数据强制转换成 wchar_t 类型
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : wchar_t 数据
+			//*********************************************************
+			wchar_t get_wchar(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get_wstring
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/15
+			// 函数说明 : 获取数据, 并将数据强制转换成 std::wstring 类型
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : std::wstring 数据
+			//*********************************************************
+			std::wstring get_wstring(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get_wstring_ptr
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/05/09
+			// 函数说明 : 获取数据, 并将数据强制转换成 std::wstring 类型
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : std::shared_ptr<std::wstring> 数据
+			//*********************************************************
+			std::shared_ptr<std::wstring> get_wstring_ptr(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get_raw
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/15
+			// 函数说明 : 不进行转换, 直接获取从数据库返回的数据
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : const char * 数据
+			//*********************************************************
+			const char * get_raw(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get_bool
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/15
+			// 函数说明 : 获取数据, 并将数据强制转换成 bool 类型
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : bool 数据
+			//*********************************************************
+			bool get_bool(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/13
+			// 函数说明 : 获取数据
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置, 从0开始
+			// 返 回 值 : T 数据
+			//*********************************************************
+			template <typename T>
+			T get(unsigned long n) const;
+
+		private:
+
+			//*********************************************************
+			// 函数名称 : recordset
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/15
+			// 函数说明 : 由 command 类对象创建 recordset 类对象
+			// 访问方式 : private
+			// 函数参数 : MYSQL * pointer 数据库句柄
+			//*********************************************************
+			recordset(MYSQL *pointer) noexcept;
+
+			//*********************************************************
+			// 函数名称 : recordset
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/15
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const recordset &
+			//*********************************************************
+			recordset(const recordset &) = delete;
+
+			//*********************************************************
+			// 函数名称 : operator=
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/15
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const recordset &
+			// 返 回 值 : recordset &
+			//*********************************************************
+			recordset & operator=(const recordset &) = delete;
+
+			//*********************************************************
+			// 函数名称 : discard_results
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 丢弃还没有读取的结果集, 使数据库连接可以继续执行SQL语句
+			// 访问方式 : private
+			//*********************************************************
+			void discard_results(void) noexcept;
+
+		private:
+			friend command;
+			friend pipeline;
+			MYSQL *m_ptr_mysql; // MariaDB 数据库句柄
+			MYSQL_RES *m_ptr_res; // MariaDB 数据库结果集
+			MYSQL_ROW m_row; // MariaDB 数据库结果行
+			bool m_more_results; // 是否还有没有读取的结果集
+		};
+
+		// 数据库执行类
+		// 一个 command 对象只能用于一个线程
+		// 同一个线程下, 可以多个 command 对象共享一个 数据库连接 connection 对象
+		class command
+		{
+		public:
+
+			//*********************************************************
+			// 函数名称 : command
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/15
+			// 函数说明 : 转移构造函数, 转移后原对象不应该使用
+			// 访问方式 : public
+			// 函数参数 : command && executor 需要转移的对象
+			//*********************************************************
+			command(command &&executor) noexcept;
+
+			//*********************************************************
+			// 函数名称 : ~command
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 析构函数, 结束还没有结束的观察
+			// 访问方式 : public
+			//*********************************************************
+			~command(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : command
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/15
+			// 函数说明 : 构造函数
+			// 访问方式 : public
+			// 函数参数 : const connection & connector 数据库连接类
+			//*********************************************************
+			explicit command(const connection &connector) noexcept;
+
+			//*********************************************************
+			// 函数名称 : command
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/15
+			// 函数说明 : 构造函数
+			// 访问方式 : public
+			// 函数参数 : const connection & connector 数据库连接类
+			// 函数参数 : const std::string & text SQL语句
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			command(const connection &connector, const std::string &text);
+
+			//*********************************************************
+			// 函数名称 : command
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/15
+			// 函数说明 : 构造函数
+			// 访问方式 : public
+			// 函数参数 : const connection & connector 数据库连接类
+			// 函数参数 : std::string && text SQL语句
+			//*********************************************************
+			command(const connection &connector, std::string &&text) noexcept;
+
+			//*********************************************************
+			// 函数名称 : error
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/15
+			// 函数说明 : 获取数据库操作失败的错误信息
+			// 访问方式 : public 
+			// 函数参数 : void
+			// 返 回 值 : std::string 错误信息
+			//*********************************************************
+			std::string error(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : errorno
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/15
+			// 函数说明 : 获取数据库操作失败的错误代号
+			// 访问方式 : public
+			// 返 回 值 : unsigned int 错误代号
+			//*********************************************************
+			unsigned int errorno(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : prepare
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/15
+			// 函数说明 : 预存SQL语句; 可使用以下例子防注入
+			//            executer.prepare("select * from table where id = ?");
+			//            executer.add(12);
+			// 访问方式 : public
+			// 函数参数 : std::string && text SQL语句
+			//*********************************************************
+			void prepare(std::string &&text) noexcept;
+
+			//*********************************************************
+			// 函数名称 : prepare
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/15
+			// 函数说明 : 预存SQL语句; 可使用以下例子防注入
+			//            executer.prepare("select * from table1 where id = ?");
+			//            executer.add(0, 12);
+			// 访问方式 : public
+			// 函数参数 : const std::string & text SQL语句
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			void prepare(const std::string &text);
+
+			//*********************************************************
+			// 函数名称 : add
+			// 作    者 : Gooeen
+			// 完成日期 : 2016/05/12
+			// 函数说明 : 添加数据, 执行SQL语句时将本次添加的数据用单引
+			//            号引起后代替SQL语句中第 pos 个问号; 例子如下:
+			//            executer.prepare("insert into table1 values(?, ?)");
+			//            executer.add(0, 12);
+			//            executer.add(1, std::make_shared<std::string>("data"));
+			//            在执行SQL语句时将产生 SQL语句:
+			//            insert into table1 values(12, 'data')
+			// 访问方式 : public
+			// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
+			// 函数参数 : std::shared_ptr<std::string> &&text 数据, 此数据在SQL语句中将以单引号引用
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			void add(unsigned int pos, std::shared_ptr<std::string> &&text);
+
+			//*********************************************************
+			// 函数名称 : add
+			// 作    者 : Gooeen
+			// 完成日期 : 2016/05/12
+			// 函数说明 : 添加数据, 执行SQL语句时将本次添加的数据用单引
+			//            号引起后代替SQL语句中第 pos 个问号; 例子如下:
+			//            executer.prepare("insert into table1 values(?, ?)");
+			//            executer.add(0, 12);
+			//            executer.add(1, std::make_shared<std::string>("data"));
+			//            在执行SQL语句时将产生 SQL语句:
+			//            insert into table1 values(12, 'data')
+			// 访问方式 : public
+			// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
+			// 函数参数 : const std::shared_ptr<std::string> &text 数据, 此数据在SQL语句中将以单引号引用
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			void add(unsigned int pos, const std::shared_ptr<std::string> &text);
+
+			//*********************************************************
+			// 函数名称 : add
+			// 作    者 : Gooeen
+			// 完成日期 : 2016/05/17
+			// 函数说明 : 添加数据, 执行SQL语句时将本次添加的数据用单引
+			//            号引起后代替SQL语句中第 pos 个问号; 例子如下:
+			//            executer.prepare("insert into table1 values(?, ?)");
+			//            executer.add(0, 12);
+			//            executer.add(1, "data");
+			//            在执行SQL语句时将产生 SQL语句:
+			//            insert into table1 values(12, 'data')
+			// 访问方式 : public
+			// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
+			// 函数参数 : std::string text 数据, 此数据在SQL语句中将以单引号引用
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			void add(unsigned int pos, std::string text);
+
+			//*********************************************************
+			// 函数名称 : add
+			// 作    者 : Gooeen
+			// 完成日期 : 2016/05/17
+			// 函数说明 : 添加数据, 执行SQL语句时将本次添加的数据用单引
+			//            号引起后代替SQL语句中第 pos 个问号; 例子如下:
+			//            executer.prepare("insert into table1 values(?, ?)");
+			//            executer.add(0, 12);
+			//            executer.add(1, std::vector<char>({1, 2, 3, 4, 5}));
+			//            在执行SQL语句时将产生 SQL语句:
+			//            insert into table1 values(12, 'data')
+			// 访问方式 : public
+			// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
+			// 函数参数 : std::vector<char> data 数据, 此数据在SQL语句中将以单引号引用
+			// 返 回 值 : void
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			void add(unsigned int pos, std::vector<char> data);
+
+			//*********************************************************
+			// 函数名称 : add
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 添加数据, 执行SQL语句时将本次添加的数据用单引
+			//            号引起后代替SQL语句中第 pos 个问号; 例子如下:
+			//            executer.prepare("insert into table1 values(?, ?)");
+			//            executer.add(0, 12);
+			//            executer.add(1, "data");
+			//            在执行SQL语句时将产生 SQL语句:
+			//            insert into table1 values(12, 'data')
+			// 访问方式 : public
+			// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
+			// 函数参数 : std::vector<unsigned char> data 数据, 此数据在SQL语句中将以单引号引用
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			void add(unsigned int pos, std::vector<unsigned char> data);
+
+			//*********************************************************
+			// 函数名称 : add
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 添加数据, 执行SQL语句时将本次添加的数据
+			//            代替SQL语句中第 pos 个问号; 例子如下:
+			//            executer.prepare("insert into table1 values(?, ?)");
+			//            executer.add(0, 12);
+			//            executer.add(1, "data");
+			//            在执行SQL语句时将产生 SQL语句:
+			//            insert into table1 values(12, 'data')
+			// 访问方式 : public
+			// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
+			// 函数参数 : const std::string & text 数据, 此数据在SQL语句中将以单引号引用
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			template <typename T>
+			void add(unsigned int pos, T value)
+			{
+				// 保存字符串
+				m_strings.push_back(std::make_shared<std::string>(std::to_string(value)));
+
+				// 保存数据的信息
+				const auto p = m_strings.back()->c_str();
+				const auto size = (unsigned long)m_strings.back()->size();
+				const auto pair = std::make_pair(p, size);
+				m_parameters[pos] = std::make_pair(true, pair);
+			}
+
+			//*********************************************************
+			// 函数名称 : escape
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 转换数据并保存到 to 参数所指向的缓冲区
+			// 访问方式 : public
+			// 函数参数 : char * to 保存转换后的字符串的缓冲区, 缓冲区大小应该比 (size * 2 + 1) 大
+			// 函数参数 : const char * from 需要转换的字符串
+			// 函数参数 : unsigned long size from 的长度
+			// 返 回 值 : unsigned long 转换的字节数
+			//*********************************************************
+			unsigned long escape(char *to, const char *from, unsigned long size) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : escape
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 转换数据并保存到字符串对象中
+			// 访问方式 : public
+			// 函数参数 : const char * data 需要转换的数据
+			// 函数参数 : unsigned long size 需要转换的数据的长度
+			// 返 回 值 : std::string 转换后的字符串
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+			//            如果执行失败则抛出 std::exception 异常
+			//*********************************************************
+			std::string escape(const char *data, unsigned long size) const;
+
+			//*********************************************************
+			// 函数名称 : escape_with_quote
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 转换数据并以单引号引用保存到字符串对象中
+			// 访问方式 : public
+			// 函数参数 : const char * data 需要转换的数据
+			// 函数参数 : unsigned long size 需要转换的数据的长度
+			// 返 回 值 : std::string 转换后的字符串
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+			//            如果执行失败则抛出 std::exception 异常
+			//*********************************************************
+			std::string escape_with_quote(const char *data, unsigned long size) const;
+
+			//*********************************************************
+			// 函数名称 : escape_buffer
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 转换数据并保存到 std::vector<char> 类型的缓冲区中
+			// 访问方式 : public
+			// 函数参数 : const char * data 需要转换的数据
+			// 函数参数 : unsigned long size 需要转换的数据的长度
+			// 返 回 值 : std::vector<char> 保存转换后的数据的缓冲区
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+			//            如果执行失败则抛出 std::exception 异常
+			//*********************************************************
+			std::vector<char> escape_buffer(const char *data, unsigned long size) const;
+
+			//*********************************************************
+			// 函数名称 : escape_buffer_with_quote
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 转换数据并并以单引号引用保存到 std::vector<char> 类型的缓冲区中
+			// 访问方式 : public
+			// 函数参数 : const char * data 需要转换的数据
+			// 函数参数 : unsigned long size 需要转换的数据的长度
+			// 返 回 值 : std::vector<char> 保存转换后的数据的缓冲区
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+			//            如果执行失败则抛出 std::exception 异常
+			//*********************************************************
+			std::vector<char> escape_buffer_with_quote(const char *data, unsigned long size) const;
+
+			//*********************************************************
+			// 函数名称 : execute
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句, 如果返回结果集则读取后丢弃
+			// 访问方式 : public
+			// 函数参数 : const char * text SQL语句
+			// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+			//*********************************************************
+			bool execute(const char *text) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : execute
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句, 如果返回结果集则读取后丢弃
+			// 访问方式 : public
+			// 函数参数 : const char * text SQL语句
+			// 函数参数 : unsigned long length SQL语句字符串长度
+			// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+			//*********************************************************
+			bool execute(const char *text, unsigned long length) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : execute
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句, 如果返回结果集则读取后丢弃
+			// 访问方式 : public
+			// 函数参数 : const std::string & text SQL语句
+			// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+			//*********************************************************
+			bool execute(const std::string &text) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : execute
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句, 如果返回结果集则读取后丢弃
+			// 访问方式 : public
+			// 函数参数 : const std::vector<char> & data SQL语句
+			// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+			//*********************************************************
+			bool execute(const std::vector<char> &data) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : execute
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句, 如果返回结果集则读取后丢弃
+			// 访问方式 : public
+			// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+			//            如果生成SQL语句失败则抛出 std::exception 异常
+			//*********************************************************
+			bool execute(void) const;
+
+			//*********************************************************
+			// 函数名称 : execute
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句; 使用例子:
+			//            command(connector).execute("insert into table1 values(?, ?)", std::make_tuple(12, "abc"));
+			//            执行上面语句将生成SQL语句: insert into table1 values(12, 'abc')
+			//            生成SQL语句后执行SQL语句
+			// 访问方式 : public
+			// 函数参数 : const char * text SQL语句
+			// 函数参数 : const Tuple & t 数据
+			// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename Tuple>
+			bool execute(const std::string &text, const Tuple &t) const
+			{
+				return this->execute(statement<Tuple>().generate(*this, text, t));
+			}
+
+			//*********************************************************
+			// 函数名称 : execute
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句
+			// 访问方式 : public 
+			// 函数参数 : const std::vector<char> & data SQL语句
+			// 函数参数 : const Tuple & t 数据
+			// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename Tuple>
+			bool execute(const std::vector<char> &data, const Tuple &t) const
+			{
+				return this->execute(statement<Tuple>().generate(*this, data, t));
+			}
+
+			//*********************************************************
+			// 函数名称 : execute_reader
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句
+			// 访问方式 : public
+			// 函数参数 : const char * text SQL语句
+			// 返 回 值 : sql::mariadb::recordset 结果集
+			// 异    常 : 如果执行SQL失败则抛出 mariadb_exception 异常
+			//*********************************************************
+			recordset execute_reader(const char *text) const;
+
+			//*********************************************************
+			// 函数名称 : execute_reader
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句
+			// 访问方式 : public
+			// 函数参数 : const char * text SQL语句
+			// 函数参数 : unsigned long length text的字节数
+			// 返 回 值 : sql::mariadb::recordset 结果集
+			// 异    常 : 如果执行SQL失败则抛出 mariadb_exception 异常
+			//*********************************************************
+			recordset execute_reader(const char *text, unsigned long length) const;
+
+			//*********************************************************
+			// 函数名称 : execute_reader
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句
+			// 访问方式 : public
+			// 函数参数 : const std::string & text SQL语句
+			// 返 回 值 : sql::mariadb::recordset 结果集
+			// 异    常 : 如果执行SQL失败则抛出 mariadb_exception 异常
+			//*********************************************************
+			recordset execute_reader(const std::string &text) const;
+
+			//*********************************************************
+			// 函数名称 : execute_reader
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句
+			// 访问方式 : public
+			// 函数参数 : const std::vector<char> & data SQL语句
+			// 返 回 值 : sql::mariadb::recordset 结果集
+			// 异    常 : 如果执行SQL失败则抛出 mariadb_exception 异常
+			//*********************************************************
+			recordset execute_reader(const std::vector<char> &data) const;
+
+			//*********************************************************
+			// 函数名称 : execute_reader
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句
+			// 访问方式 : public
+			// 返 回 值 : sql::mariadb::recordset 结果集
+			// 异    常 : 如果执行SQL失败则抛出 mariadb_exception 异常
+			//            如果分配资源失败则抛出 std::bad_alloc 异常;
+			//            如果生成SQL语句失败则抛出 std::exception 异常
+			//*********************************************************
+			recordset execute_reader(void) const;
+
+			//*********************************************************
+			// 函数名称 : execute_reader
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句; 使用例子:
+			//            command(connector).execute_reader("insert into table1 values(?, ?)", std::make_tuple(12, "abc"));
+			//            执行上面语句将生成SQL语句: insert into table1 values(12, 'abc')
+			//            生成SQL语句后执行SQL语句
+			// 访问方式 : public
+			// 函数参数 : const std::string & text SQL语句
+			// 函数参数 : const Tuple & t 数据
+			// 返 回 值 : sql::mariadb::recordset 结果集
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename Tuple>
+			recordset execute_reader(const std::string &text, const Tuple &t) const
+			{
+				return this->execute_reader(statement<Tuple>().generate(*this, text, t));
+			}
+
+			//*********************************************************
+			// 函数名称 : execute_reader
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句
+			// 访问方式 : public 
+			// 函数参数 : const std::vector<char> & data SQL语句
+			// 函数参数 : const Tuple & t 数据
+			// 返 回 值 : sql::mariadb::recordset 结果集
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename Tuple>
+			recordset execute_reader(const std::vector<char> &data, const Tuple &t) const
+			{
+				return this->execute_reader(statement<Tuple>().generate(*this, data, t));
+			}
+
+			//*********************************************************
+			// 函数名称 : execute_batch
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 将多条SQL语句用分号连接后一次发送到服务器执行, 只需要一次往返;
+			//            需要先使用 connection::set_multi_statements 或者
+			//            CLIENT_MULTI_STATEMENTS 选项允许执行多条SQL语句;
+			//            返回的结果集对应第一条SQL语句, 使用 recordset::next_result 切换
+			// 访问方式 : public
+			// 函数参数 : const std::vector<std::string> & texts SQL语句, 结尾不需要分号
+			// 返 回 值 : sql::mariadb::recordset 第一条SQL语句的结果集
+			// 异    常 : 如果第一条SQL语句执行失败则抛出 mariadb_exception 异常;
+			//            如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			recordset execute_batch(const std::vector<std::string> &texts) const;
+
+			//*********************************************************
+			// 函数名称 : try_execute
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 执行SQL语句, 不抛出异常
+			// 访问方式 : public
+			// 函数参数 : const std::string & text SQL语句
+			// 返 回 值 : result<unsigned long long> 成功时为影响的行数; 失败时为错误信息,
+			//            例如主键重复时 error().duplicate_key() 返回 true
+			//*********************************************************
+			result<unsigned long long> try_execute(const std::string &text) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : try_execute_reader
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 执行SQL语句并获取结果集, 不抛出异常
+			// 访问方式 : public
+			// 函数参数 : const std::string & text SQL语句
+			// 返 回 值 : result<recordset> 成功时为结果集; 失败时为错误信息
+			//*********************************************************
+			result<recordset> try_execute_reader(const std::string &text) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : try_execute_scalar
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 执行SQL语句并返回第一列的第一个值, 不抛出异常
+			// 访问方式 : public
+			// 函数参数 : const std::string & text SQL语句
+			// 返 回 值 : result<T> 成功时为第一列的第一个值; 失败时为错误信息,
+			//            没有数据时 error().not_found() 返回 true
+			//*********************************************************
+			template <typename T>
+			result<T> try_execute_scalar(const std::string &text) const noexcept
+			{
+				auto reader = this->try_execute_reader(text);
+				if (!reader)
+				{
+					return reader.error();
+				}
+
+				if (reader.value() == nullptr)
+				{
+					return this->last_error();
+				}
+
+				try
+				{
+					if (!reader.value().read())
+					{
+						return error_info::no_data();
+					}
+					return reader.value().get<T>(0);
+				}
+				catch (const std::exception &exception)
+				{
+					return error_info(exception);
+				}
+			}
+
+			//*********************************************************
+			// 函数名称 : try_query
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 执行SQL语句并返回第一行数据, 不抛出异常
+			// 访问方式 : public
+			// 函数参数 : const std::string & text SQL语句
+			// 返 回 值 : result<Tuple> 成功时为结果集中第一行数据; 失败时为错误信息,
+			//            没有数据时 error().not_found() 返回 true
+			//*********************************************************
+			template <typename Tuple>
+			result<Tuple> try_query(const std::string &text) const noexcept
+			{
+				auto reader = this->try_execute_reader(text);
+				if (!reader)
+				{
+					return reader.error();
+				}
+
+				if (reader.value() == nullptr)
+				{
+					return this->last_error();
+				}
+
+				try
+				{
+					if (!reader.value().read())
+					{
+						return error_info::no_data();
+					}
+					return decode_row<Tuple>(reader.value());
+				}
+				catch (const std::exception &exception)
+				{
+					return error_info(exception);
+				}
+			}
+
+			//*********************************************************
+			// 函数名称 : try_query_vector
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 执行SQL语句并返回所有数据, 不抛出异常
+			// 访问方式 : public
+			// 函数参数 : const std::string & text SQL语句
+			// 返 回 值 : result<std::vector<Tuple>> 成功时为结果集中所有数据 (可以为空); 失败时为错误信息
+			//*********************************************************
+			template <typename Tuple>
+			result<std::vector<Tuple>> try_query_vector(const std::string &text) const noexcept
+			{
+				auto reader = this->try_execute_reader(text);
+				if (!reader)
+				{
+					return reader.error();
+				}
+
+				if (reader.value() == nullptr)
+				{
+					return this->last_error();
+				}
+
+				try
+				{
+					return vector_from_recordset<Tuple>(reader.value());
+				}
+				catch (const std::exception &exception)
+				{
+					return error_info(exception);
+				}
+			}
+
+			//*********************************************************
+			// 函数名称 : set_idempotent
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 声明本对象执行的所有SQL语句都可以重复执行, 启用自动重新连接时
+			//            INSERT ... ON DUPLICATE KEY UPDATE 等语句也可以在重新连接后再执行一次
+			// 访问方式 : public
+			// 函数参数 : bool enable true 代表可以重复执行, false 代表根据SQL语句判断
+			//*********************************************************
+			void set_idempotent(bool enable) noexcept;
+
+			//*********************************************************
+			// 函数名称 : set_timeout
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置每次执行SQL语句的超时时间; 连接的是 MariaDB 服务器时
+			//            SELECT/INSERT/UPDATE/DELETE/REPLACE 语句会加上
+			//            SET STATEMENT max_statement_time=... FOR 由服务器限制执行时间;
+			//            如果设置了 point, 超时后还会通过另一个连接发送 KILL QUERY 取消该语句
+			//            (MySQL 等其他服务器只能以这种方式取消);
+			//            同一服务器共用一个保持打开的连接, 不同服务器互不等待.
+			//            KILL QUERY 发送前语句已经执行完的视为成功; 语句返回时不等待
+			//            正在发送的 KILL QUERY, 改为在该连接执行下一条SQL语句前等待.
+			//            超时后 execute 返回 false 并且 timed_out 返回 true,
+			//            execute_reader/execute_scalar/query/query_vector 抛出 timeout_exception 异常
+			// 访问方式 : public
+			// 函数参数 : unsigned int milliseconds 超时时间 (毫秒), 0 代表不限制
+			// 函数参数 : const endpoint * point 该连接的服务器参数, 执行SQL语句期间必须有效
+			//*********************************************************
+			void set_timeout(unsigned int milliseconds, const endpoint *point = nullptr) noexcept;
+
+			//*********************************************************
+			// 函数名称 : timed_out
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 判断最后一次执行SQL语句是否超时
+			// 访问方式 : public
+			// 返 回 值 : bool 如果超时返回true; 反之返回false
+			//*********************************************************
+			bool timed_out(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : set_observer
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置观察者, 替换从 connection 继承的观察者
+			// 访问方式 : public
+			// 函数参数 : statement_observer * observer 观察者, nullptr 代表不观察
+			//*********************************************************
+			void set_observer(statement_observer *observer) noexcept;
+
+			//*********************************************************
+			// 函数名称 : execute_scalar
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句并返回第一列的第一个值
+			// 访问方式 : public
+			// 函数参数 : const char * text SQL语句
+			// 返 回 值 : T 结果集中第一列的第一个值
+			// 异    常 : 如果执行SQL失败或者不能获取结果集或者转换失败则抛出 mariadb_exception 异常
+			//*********************************************************
+			template <typename T>
+			T execute_scalar(const char *text) const
+			{
+				auto reader = this->execute_reader(text);
+				if_null_throw(reader, text);
+				read_or_throw(reader, text);
+				return reader.get<T>(0);
+			}
+
+			//*********************************************************
+			// 函数名称 : execute_scalar
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句并返回第一列的第一个值
+			// 访问方式 : public
+			// 函数参数 : const char * text SQL语句
+			// 函数参数 : unsigned long length text的字节数
+			// 返 回 值 : T 结果集中第一列的第一个值
+			// 异    常 : 如果执行SQL失败或者不能获取结果集或者转换失败则抛出 mariadb_exception 异常
+			//*********************************************************
+			template <typename T>
+			T execute_scalar(const char *text, unsigned long length) const
+			{
+				auto reader = this->execute_reader(text, length);
+				if_null_throw(reader, std::string(text, length));
+				read_or_throw(reader, std::string(text, length));
+				return reader.get<T>(0);
+			}
+
+			//*********************************************************
+			// 函数名称 : execute_scalar
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句并返回第一列的第一个值
+			// 访问方式 : public
+			// 函数参数 : const std::string & text SQL语句
+			// 返 回 值 : T 结果集中第一列的第一个值
+			// 异    常 : 如果执行SQL失败或者不能获取结果集或者转换失败则抛出 mariadb_exception 异常
+			//*********************************************************
+			template <typename T>
+			T execute_scalar(const std::string &text) const
+			{
+				auto reader = this->execute_reader(text);
+				if_null_throw(reader, text);
+				read_or_throw(reader, text);
+				return reader.get<T>(0);
+			}
+
+			//*********************************************************
+			// 函数名称 : execute_scalar
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句并返回第一列的第一个值
+			// 访问方式 : public
+			// 函数参数 : const std::vector<char> & data SQL语句
+			// 返 回 值 : T 结果集中第一列的第一个值
+			// 异    常 : 如果执行SQL失败或者不能获取结果集或者转换失败则抛出 mariadb_exception 异常
+			//*********************************************************
+			template <typename T>
+			T execute_scalar(const std::vector<char> &data) const
+			{
+				auto reader = this->execute_reader(data);
+				if_null_throw(reader, std::string(data.begin(), data.end()));
+				read_or_throw(reader, std::string(data.begin(), data.end()));
+				return reader.get<T>(0);
+			}
+
+			//*********************************************************
+			// 函数名称 : execute_scalar
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句并返回第一列的第一个值
+			// 访问方式 : public
+			// 返 回 值 : T 结果集中第一列的第一个值
+			// 异    常 : 如果执行SQL失败或者不能获取结果集或者转换失败则抛出 mariadb_exception 异常
+			//*********************************************************
+			template <typename T>
+			T execute_scalar(void) const
+			{
+				auto reader = this->execute_reader();
+				if_null_throw(reader, m_text);
+				read_or_throw(reader, m_text);
+				return reader.get<T>(0);
+			}
+
+			//*********************************************************
+			// 函数名称 : execute_scalar
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句并返回第一列的第一个值
+			// 访问方式 : public
+			// 函数参数 : const std::string & text SQL语句
+			// 函数参数 : const Tuple & t 数据
+			// 返 回 值 : T 结果集中第一列的第一个值
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename T, typename Tuple>
+			T execute_scalar(const std::string &text, const Tuple &t) const
+			{
+				return this->execute_scalar<T>(statement<Tuple>().generate(*this, text, t));
+			}
+
+			//*********************************************************
+			// 函数名称 : execute_scalar
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句并返回第一列的第一个值
+			// 访问方式 : public
+			// 函数参数 : const std::vector<char> & data SQL语句
+			// 函数参数 : const Tuple & t 数据
+			// 返 回 值 : T 结果集中第一列的第一个值
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename T, typename Tuple>
+			T execute_scalar(const std::vector<char> &data, const Tuple &t) const
+			{
+				return this->execute_scalar<T>(statement<Tuple>().generate(*this, data, t));
+			}
+
+			//*********************************************************
+			// 函数名称 : query
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句并返回第一行数据
+			// 访问方式 : public
+			// 函数参数 : const char * text SQL语句
+			// 返 回 值 : Tuple 结果集中第一行数据
+			// 异    常 : 如果执行SQL失败或者不能获取结果集或者转换失败则抛出 mariadb_exception 异常
+			//*********************************************************
+			template <typename Tuple>
+			Tuple query(const char *text) const
+			{
+				// 获取结果集, 如果获取失败则抛出异常
+				auto reader = this->execute_reader(text);
+				if_null_throw(reader, text);
+				read_or_throw(reader, text);
+				return decode_row<Tuple>(reader);
+			}
+
+			//*********************************************************
+			// 函数名称 : query
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句并返回第一行数据
+			// 访问方式 : public
+			// 函数参数 : const char * text SQL语句
+			// 函数参数 : unsigned long length text的字节数
+			// 返 回 值 : Tuple 结果集中第一行数据
+			// 异    常 : 如果执行SQL失败或者不能获取结果集或者转换失败则抛出 mariadb_exception 异常
+			//*********************************************************
+			template <typename Tuple>
+			Tuple query(const char *text, unsigned long length) const
+			{
+				// 获取结果集, 如果获取失败则抛出异常
+				auto reader = this->execute_reader(text, length);
+				if_null_throw(reader, std::string(text, length));
+				read_or_throw(reader, std::string(text, length));
+				return decode_row<Tuple>(reader);
+			}
+
+			//*********************************************************
+			// 函数名称 : query
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句并返回第一行数据
+			// 访问方式 : public
+			// 函数参数 : const std::string & text SQL语句
+			// 返 回 值 : Tuple 结果集中第一行数据
+			// 异    常 : 如果执行SQL失败或者不能获取结果集或者转换失败则抛出 mariadb_exception 异常
+			//*********************************************************
+			template <typename Tuple>
+			Tuple query(const std::string &text) const
+			{
+				// 获取结果集, 如果获取失败则抛出异常
+				auto reader = this->execute_reader(text);
+				if_null_throw(reader, text);
+				read_or_throw(reader, text);
+				return decode_row<Tuple>(reader);
+			}
+
+			//*********************************************************
+			// 函数名称 : query
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句并返回第一行数据
+			// 访问方式 : public 
+			// 函数参数 : const std::vector<char> & data SQL语句
+			// 返 回 值 : Tuple 结果集中第一行数据
+			// 异    常 : 如果执行SQL失败或者不能获取结果集或者转换失败则抛出 mariadb_exception 异常
+			//*********************************************************
+			template <typename Tuple>
+			Tuple query(const std::vector<char> &data) const
+			{
+				// 获取结果集, 如果获取失败则抛出异常
+				auto reader = this->execute_reader(data);
+				if_null_throw(reader, std::string(data.begin(), data.end()));
+				read_or_throw(reader, std::string(data.begin(), data.end()));
+				return decode_row<Tuple>(reader);
+			}
+
+			//*********************************************************
+			// 函数名称 : query
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句并返回第一行数据
+			// 访问方式 : public
+			// 返 回 值 : Tuple 结果集中第一行数据
+			// 异    常 :  如果执行SQL失败或者不能获取结果集或者转换失败则抛出 mariadb_exception 异常
+			//*********************************************************
+			template <typename Tuple>
+			Tuple query(void) const
+			{
+				// 获取结果集, 如果获取失败则抛出异常
+				auto reader = this->execute_reader();
+				if_null_throw(reader, m_text);
+				read_or_throw(reader, m_text);
+				return decode_row<Tuple>(reader);
+			}
+
+			//*********************************************************
+			// 函数名称 : query
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句并返回第一行数据
+			// 访问方式 : public
+			// 函数参数 : const std::string & text SQL语句
+			// 函数参数 : const InTuple & t 数据
+			// 返 回 值 : OutTuple 结果集中第一行数据
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename OutTuple, typename InTuple>
+			OutTuple query(const std::string &text, const InTuple &t) const
+			{
+				return this->query<OutTuple>(statement<InTuple>().generate(*this, text, t));
+			}
+
+			//*********************************************************
+			// 函数名称 : query
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句并返回第一行数据
+			// 访问方式 : public
+			// 函数参数 : const std::vector<char> & data SQL语句
+			// 函数参数 : const InTuple & t 数据
+			// 返 回 值 : OutTuple 结果集中第一行数据
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename OutTuple, typename InTuple>
+			OutTuple query(const std::vector<char> &data, const InTuple &t) const
+			{
+				return this->query<OutTuple>(statement<InTuple>().generate(*this, data, t));
+			}
+
+			//*********************************************************
+			// 函数名称 : query_vector
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句并返回所有数据
+			// 访问方式 : public
+			// 函数参数 : const char * text SQL语句
+			// 返 回 值 : std::vector<Tuple> 结果集中所有数据
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename Tuple>
+			std::vector<Tuple> query_vector(const char *text) const
+			{
+				// 获取结果集, 如果获取失败则抛出异常
+				auto reader = this->execute_reader(text);
+				if_null_throw(reader, text);
+				return vector_from_recordset<Tuple>(reader);
+			}
+
+			//*********************************************************
+			// 函数名称 : query_vector
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句并返回所有数据
+			// 访问方式 : public 
+			// 函数参数 : const char * text SQL语句
+			// 函数参数 : unsigned long length text的字节数
+			// 返 回 值 : std::vector<Tuple> 结果集中所有数据
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename Tuple>
+			std::vector<Tuple> query_vector(const char *text, unsigned long length) const
+			{
+				// 获取结果集, 如果获取失败则抛出异常
+				auto reader = this->execute_reader(text, length);
+				if_null_throw(reader, std::string(text, length));
+				return vector_from_recordset<Tuple>(reader);
+			}
+
+			//*********************************************************
+			// 函数名称 : query_vector
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句并返回所有数据
+			// 访问方式 : public 
+			// 函数参数 : const std::string & text SQL语句
+			// 返 回 值 : std::vector<Tuple> 结果集中所有数据
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename Tuple>
+			std::vector<Tuple> query_vector(const std::string &text) const
+			{
+				// 获取结果集, 如果获取失败则抛出异常
+				auto reader = this->execute_reader(text);
+				if_null_throw(reader, text);
+				return vector_from_recordset<Tuple>(reader);
+			}
+
+			//*********************************************************
+			// 函数名称 : query_vector
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句并返回所有数据
+			// 访问方式 : public
+			// 函数参数 : const std::vector<char> & data SQL语句
+			// 返 回 值 : std::vector<Tuple> 结果集中所有数据
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename Tuple>
+			std::vector<Tuple> query_vector(const std::vector<char> &data) const
+			{
+				// 获取结果集, 如果获取失败则抛出异常
+				auto reader = this->execute_reader(data);
+				if_null_throw(reader, std::string(data.begin(), data.end()));
+				return vector_from_recordset<Tuple>(reader);
+			}
+
+			//*********************************************************
+			// 函数名称 : query_vector
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 执行SQL语句并返回所有数据
+			// 访问方式 : public
+			// 返 回 值 : std::vector<Tuple> 结果集中所有数据
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename Tuple>
+			std::vector<Tuple> query_vector(void) const
+			{
+				// 获取结果集, 如果获取失败则抛出异常
+				auto reader = this->execute_reader();
+				if_null_throw(reader, m_text);
+				return vector_from_recordset<Tuple>(reader);
+			}
+
+			//*********************************************************
+			// 函数名称 : query_vector
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/17
+			// 函数说明 : 执行SQL语句并返回所有数据
+			// 访问方式 : public
+			// 函数参数 : const std::string & text SQL语句
+			// 函数参数 : const InTuple & t 数据
+			// 返 回 值 : std::vector<Tuple> 结果集中所有数据
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename OutTuple, typename InTuple>
+			std::vector<OutTuple> query_vector(const std::string &text, const InTuple &t) const
+			{
+				return this->query_vector<OutTuple>(statement<InTuple>().generate(*this, text, t));
+			}
+
+			//*********************************************************
+			// 函数名称 : query_vector
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/17
+			// 函数说明 : 执行SQL语句并返回所有数据
+			// 访问方式 : public
+			// 函数参数 : const std::vector<char> & data SQL语句
+			// 函数参数 : const InTuple & t 数据
+			// 返 回 值 : std::vector<Tuple> 结果集中所有数据
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename OutTuple, typename InTuple>
+			std::vector<OutTuple> query_vector(const std::vector<char> &data, const InTuple &t) const
+			{
+				return this->query_vector<OutTuple>(statement<InTuple>().generate(*this, data, t));
+			}
+
+			//*********************************************************
+			// 函数名称 : query_list
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/17
+			// 函数说明 : 执行SQL语句并返回所有数据
+			// 访问方式 : public
+			// 函数参数 : const char * text SQL语句
+			// 返 回 值 : std::list<Tuple> 结果集中所有数据
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename Tuple>
+			std::list<Tuple> query_list(const char *text) const
+			{
+				// 获取结果集, 如果获取失败则抛出异常
+				auto reader = this->execute_reader(text);
+				if_null_throw(reader, text);
+				return list_from_recordset<Tuple>(reader);
+			}
+
+			//*********************************************************
+			// 函数名称 : query_list
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/17
+			// 函数说明 : 执行SQL语句并返回所有数据
+			// 访问方式 : public
+			// 函数参数 : const char * text SQL语句
+			// 函数参数 : unsigned long length text的字节数
+			// 返 回 值 : std::list<Tuple> 结果集中所有数据
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename Tuple>
+			std::list<Tuple> query_list(const char *text, unsigned long length) const
+			{
+				// 获取结果集, 如果获取失败则抛出异常
+				auto reader = this->execute_reader(text, length);
+				if_null_throw(reader, std::string(text, length));
+				return list_from_recordset<Tuple>(reader);
+			}
+
+			//*********************************************************
+			// 函数名称 : query_list
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/17
+			// 函数说明 : 执行SQL语句并返回所有数据
+			// 访问方式 : public
+			// 函数参数 : const std::string & text SQL语句
+			// 返 回 值 : std::list<Tuple> 结果集中所有数据
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename Tuple>
+			std::list<Tuple> query_list(const std::string &text) const
+			{
+				// 获取结果集, 如果获取失败则抛出异常
+				auto reader = this->execute_reader(text);
+				if_null_throw(reader, text);
+				return list_from_recordset<Tuple>(reader);
+			}
+
+			//*********************************************************
+			// 函数名称 : query_list
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/17
+			// 函数说明 : 执行SQL语句并返回所有数据
+			// 访问方式 : public
+			// 函数参数 : const std::vector<char> & data SQL语句
+			// 返 回 值 : std::list<Tuple> 结果集中所有数据
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename Tuple>
+			std::list<Tuple> query_list(const std::vector<char> &data) const
+			{
+				// 获取结果集, 如果获取失败则抛出异常
+				auto reader = this->execute_reader(data);
+				if_null_throw(reader, std::string(data.begin(), data.end()));
+				return list_from_recordset<Tuple>(reader);
+			}
+
+			//*********************************************************
+			// 函数名称 : query_list
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/17
+			// 函数说明 : 执行SQL语句并返回所有数据
+			// 访问方式 : public
+			// 返 回 值 : std::list<Tuple> 结果集中所有数据
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename Tuple>
+			std::list<Tuple> query_list(void) const
+			{
+				// 获取结果集, 如果获取失败则抛出异常
+				auto reader = this->execute_reader();
+				if_null_throw(reader, m_text);
+				return list_from_recordset<Tuple>(reader);
+			}
+
+			//*********************************************************
+			// 函数名称 : query_list
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/17
+			// 函数说明 : 执行SQL语句并返回所有数据
+			// 访问方式 : public 
+			// 函数参数 : const std::string & text SQL语句
+			// 函数参数 : const InTuple & t 数据
+			// 返 回 值 : std::list<Tuple> 结果集中所有数据
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename OutTuple, typename InTuple>
+			std::list<OutTuple> query_list(const std::string &text, const InTuple &t) const
+			{
+				return this->query_list<OutTuple>(statement<InTuple>().generate(*this, text, t));
+			}
+
+			//*********************************************************
+			// 函数名称 : query_list
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/17
+			// 函数说明 : 执行SQL语句并返回所有数据
+			// 访问方式 : public 
+			// 函数参数 : const std::vector<char> & data SQL语句
+			// 函数参数 : const InTuple & t 数据
+			// 返 回 值 : std::list<Tuple> 结果集中所有数据
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename OutTuple, typename InTuple>
+			std::list<OutTuple> query_list(const std::vector<char> &data, const InTuple &t) const
+			{
+				return this->query_list<OutTuple>(statement<InTuple>().generate(*this, data, t));
+			}
+
+		private:
+
+			//*********************************************************
+			// 函数名称 : vector_from_recordset
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 从结果集中读取数据并填充到 std::vector 对象中返回
+			// 访问方式 : private
+			// 函数参数 : recordset & reader 结果集
+			// 返 回 值 : std::vector<Tuple> 结果集中的所有数据
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename Tuple>
+			static std::vector<Tuple> vector_from_recordset(recordset &reader)
+			{
+				// 分配内存
+				std::vector<Tuple> data; // 保存数据
+				data.reserve((unsigned int)reader.row_count());
+
+				// 赋值
+				phase_timer timer(query_phase::decode);
+				while (reader.read())
+				{
+					data.push_back(data_tuple_getter<Tuple>::get(reader));
+				}
+				return data;
+			}
+
+			//*********************************************************
+			// 函数名称 : list_from_recordset
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 从结果集中读取数据并填充到 std::list 对象中返回
+			// 访问方式 : private
+			// 函数参数 : recordset & reader 结果集
+			// 返 回 值 : std::list<Tuple> 结果集中的所有数据
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename Tuple>
+			static std::list<Tuple> list_from_recordset(recordset &reader)
+			{
+				// 赋值
+				std::list<Tuple> data; // 保存数据
+				phase_timer timer(query_phase::decode);
+				while (reader.read())
+				{
+					data.push_back(data_tuple_getter<Tuple>::get(reader));
+				}
+				return data;
+			}
+
+			//*********************************************************
+			// 函数名称 : decode_row
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 把结果集的当前行转换成 tuple, 并记录 decode 阶段的耗时
+			// 访问方式 : private
+			// 函数参数 : const recordset & reader 结果集对象
+			// 返 回 值 : Tuple 从结果集中读取到的数据
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			template <typename Tuple>
+			static Tuple decode_row(const recordset &reader)
+			{
+				phase_timer timer(query_phase::decode);
+				return data_tuple_getter<Tuple>::get(reader);
+			}
+
+			// 用于将结果集中读取到的数据保存到 tuple 对象中并返回
+			template <typename Tuple>
+			struct data_tuple_getter
+			{
+				//*********************************************************
+				// 函数名称 : get
+				// 作    者 : Gooeen
+				// 完成日期 : 2015/09/16
+				// 函数说明 : 返回从结果集中读取到的数据, 并用 tuple 对象保存
+				// 访问方式 : public
+				// 函数参数 : const recordset & reader 结果集对象
+				// 返 回 值 : Tuple 从结果集中读取到的数据
+				// 异    常 : 如果执行失败则抛出异常
+				//*********************************************************
+				static Tuple get(const recordset &reader)
+				{
+					Tuple t;
+					data_tuple_setter<Tuple, std::tuple_size<Tuple>::value>::set(t, reader);
+					return t;
+				}
+			};
+
+			// 用于将结果集中读取到的数据保存到 tuple 对象中并返回
+			template <typename Tuple, size_t Size>
+			struct data_tuple_setter
+			{
+				//*********************************************************
+				// 函数名称 : set
+				// 作    者 : Gooeen
+				// 完成日期 : 2015/09/16
+				// 函数说明 : 将结果集中读取到的数据保存到指定的参数 t 中
+				// 模板参数 : size_t Size 函数参数 t 的元素数量
+				// 访问方式 : public
+				// 函数参数 : Tuple & t 用于将从结果集中读取到的数据填充到该参数指定位置
+				// 函数参数 : const recordset & reader 结果集对象
+				// 异    常 : 如果执行失败则抛出异常
+				//*********************************************************
+				static void set(Tuple &t, const recordset &reader)
+				{
+					const auto n = Size - 1;
+					std::get<n>(t) = reader.get<typename std::tuple_element<n, Tuple>::type>(n);
+					data_tuple_setter<Tuple, n>::set(t, reader);
+				}
+			};
+
+			// 根据提供的带问号的SQL语句和 tuple 对象生成完整的SQL语句
+			// tuple 的元素类型只能是 数 和 std::string 型字符串
+			// 和 std::vector<char> 型和 std::vector<unsigned char> 型缓冲区
+			template <typename Tuple>
+			class statement
+			{
+			public:
+
+				//*********************************************************
+				// 函数名称 : generate
+				// 作    者 : Gooeen
+				// 完成日期 : 2015/09/16
+				// 函数说明 : 生成SQL语句并保存到 std::vector<char> 对象中
+				// 访问方式 : public
+				// 函数参数 : const command & executer command 对象
+				// 函数参数 : const Type & text SQL语句, std::string 或者 std::vector<char>
+				// 函数参数 : const Tuple & t 数据
+				// 返 回 值 : std::vector<char> 完整的SQL语句
+				// 异    常 : 如果执行失败则抛出 std::exception 异常
+				//*********************************************************
+				template <typename Type>
+				std::vector<char> generate(const command &executer, const Type &text, const Tuple &t)
+				{
+					phase_timer timer(query_phase::build);
+					executer.m_parameter_count = std::tuple_size<Tuple>::value;
+
+					// 重置最终完整的SQL语句的字节数
+					m_size = text.size();
+
+					// 减去问号数量
+					m_size -= std::count(text.begin(), text.end(), '?');
+
+					// 获取转换后的数据并且计算最终完整的SQL语句的字节数
+					std::pair<std::list<std::vector<char>>, size_t> datas = statement_escape<Tuple, std::tuple_size<Tuple>::value>::escape(executer, t);
+
+					// 加上字符数
+					m_size += datas.second;
+
+					// 用于保存最终完整的SQL语句
+					std::vector<char> data(m_size);
+
+					// 用于赋值操作
+					auto vect_iter = data.begin();
+					auto list_iter = datas.first.begin();
+
+					// 生成SQL语句
+					for (auto ch : text)
+					{
+						// 如果不等于问号则直接复制字符
+						if (ch != '?')
+						{
+							*vect_iter = ch;
+							++vect_iter;
+						}
+						// 如果等于问号则复制数据
+						else
+						{
+							const auto p = data.data() + (vect_iter - data.begin());
+							std::memcpy(p, list_iter->data(), list_iter->size());
+							vect_iter += list_iter->size();
+							++list_iter;
+						}
+					}
+
+					return data;
+				}
+
+			private:
+				size_t m_size; // 最终完整的SQL语句的字节数
+			};
+
+			// 根据提供的带问号的SQL语句和 tuple 对象生成完整的SQL语句
+			// tuple 的元素类型只能是 数 和 std::string 型字符串
+			// 和 std::vector<char> 型和 std::vector<unsigned char> 型缓冲区
+			template <typename Tuple, size_t size>
+			class statement_escape
+			{
+			private:
+
+				//*********************************************************
+				// 函数名称 : escape_buffer
+				// 作    者 : Gooeen
+				// 完成日期 : 2015/09/16
+				// 函数说明 : 将数转换成字符串并保存到 std::vector<char> 对象中
+				// 访问方式 : public
+				// 函数参数 : const command & command 对象
+				// 函数参数 : Type type 数
+				// 返 回 值 : std::vector<char> 字符串形式的数字
+				// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+				//            如果执行失败则抛出 std::exception 异常
+				//*********************************************************
+				template <typename Type>
+				static std::vector<char> escape_buffer(const command &, Type type)
+				{
+					const auto text = std::to_string(type);
+					return std::vector<char>(text.begin(), text.end());
+				}
+
+				//*********************************************************
+				// 函数名称 : escape_buffer
+				// 作    者 : Gooeen
+				// 完成日期 : 2015/09/16
+				// 函数说明 : 转换数据
+				// 访问方式 : public
+				// 函数参数 : const command & executer command 对象
+				// 函数参数 : const std::string & data 字符串
+				// 返 回 值 : std::vector<char> 字符串形式的数字
+				// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+				//            如果执行失败则抛出 std::exception 异常
+				//*********************************************************
+				static std::vector<char> escape_buffer(const command &executer, const std::string &data)
+				{
+					return executer.escape_buffer_with_quote(data.c_str(), data.size());
+				}
+
+				//*********************************************************
+				// 函数名称 : escape_buffer
+				// 作    者 : Gooeen
+				// 完成日期 : 2015/09/16
+				// 函数说明 : 转换数据
+				// 访问方式 : public
+				// 函数参数 : const command & executer command 对象
+				// 函数参数 : const std::vector<char> & data 数据
+				// 返 回 值 : std::vector<char> 字符串形式的数字
+				// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+				//            如果执行失败则抛出 std::exception 异常
+				//*********************************************************
+				static std::vector<char> escape_buffer(const command &executer, const std::vector<char> &data)
+				{
+					return executer.escape_buffer_with_quote(data.data(), data.size());
+				}
+
+				//*********************************************************
+				// 函数名称 : escape_buffer
+				// 作    者 : Gooeen
+				// 完成日期 : 2015/09/16
+				// 函数说明 : 转换数据
+				// 访问方式 : public
+				// 函数参数 : const command & executer command 对象
+				// 函数参数 : const std::vector<unsigned char> & data 数据
+				// 返 回 值 : std::vector<char> 字符串形式的数字
+				// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+				//            如果执行失败则抛出 std::exception 异常
+				//*********************************************************
+				static std::vector<char> escape_buffer(const command &executer, const std::vector<unsigned char> &data)
+				{
+					return executer.escape_buffer_with_quote((const char *)data.data(), data.size());
+				}
+
+			public:
+
+				//*********************************************************
+				// 函数名称 : escape
+				// 作    者 : Gooeen
+				// 完成日期 : 2015/09/16
+				// 函数说明 : 将 t 所保存的数据进行转化后保存到 list 对象中
+				// 访问方式 : public
+				// 函数参数 : const command & executer command 对象
+				// 函数参数 : const Tuple & t 数据
+				// 返 回 值 : std::list<std::vector<char>> 转化后的数据
+				// 异    常 : 如果执行失败则抛出 std::exception 异常
+				//*********************************************************
+				static std::pair<std::list<std::vector<char>>, size_t> escape(const command &executer, const Tuple &t)
+				{
+					// 保存数据
+					std::pair<std::list<std::vector<char>>, size_t> datas = statement_escape<Tuple, size - 1>::escape(executer, t);
+					datas.first.push_back(escape_buffer(executer, std::get<size - 1>(t)));
+
+					// 添加字节数
+					datas.second += datas.first.back().size();
+
+					return datas;
+				}
+			};
+
+		private:
+
+			//*********************************************************
+			// 函数名称 : command
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const command &
+			//*********************************************************
+			command(const command &) = delete;
+
+			//*********************************************************
+			// 函数名称 : operator=
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const command &
+			// 返 回 值 : command &
+			//*********************************************************
+			command & operator=(const command &) = delete;
+
+			//*********************************************************
+			// 函数名称 : real_query
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 执行SQL语句, 记录 network 阶段的耗时, 启用了 query_stats 时记录延迟,
+			//            设置了观察者时通知观察者
+			// 访问方式 : private
+			// 函数参数 : const char * text SQL语句
+			// 函数参数 : unsigned long length SQL语句字符串长度
+			// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+			//*********************************************************
+			bool real_query(const char *text, unsigned long length) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : complete_query
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 执行SQL语句, 如果返回结果集则读取后丢弃, 在本次调用中结束对该语句的观察,
+			//            连接可以继续执行SQL语句
+			// 访问方式 : private
+			// 函数参数 : const char * text SQL语句
+			// 函数参数 : unsigned long length SQL语句字符串长度
+			// 返 回 值 : bool 如果SQL语句执行成功并且读取结果集成功返回true; 反之返回false
+			//*********************************************************
+			bool complete_query(const char *text, unsigned long length) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : make_statement
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 用添加的数据代替SQL语句中的问号, 生成需要执行的SQL语句
+			// 访问方式 : private
+			// 返 回 值 : std::vector<char> 生成的SQL语句
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+			//            如果生成SQL语句失败则抛出 std::exception 异常
+			//*********************************************************
+			std::vector<char> make_statement(void) const;
+
+			//*********************************************************
+			// 函数名称 : send_query
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 执行SQL语句; 启用自动重新连接时, 如果连接断开并且SQL语句
+			//            可以重复执行, 则重新连接后再执行一次
+			// 访问方式 : private
+			// 函数参数 : const char * text SQL语句
+			// 函数参数 : unsigned long length SQL语句字符串长度
+			// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+			//*********************************************************
+			bool send_query(const char *text, unsigned long length) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : timed_query
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 在超时时间内执行SQL语句; 超时后取消该语句, 丢弃还没有读取的结果集
+			//            使数据库连接可以继续使用, 并设置 m_timed_out
+			// 访问方式 : private
+			// 函数参数 : const char * text SQL语句
+			// 函数参数 : unsigned long length SQL语句字符串长度
+			// 返 回 值 : bool 如果SQL语句在超时时间内执行成功返回true; 反之返回false
+			//*********************************************************
+			bool timed_query(const char *text, unsigned long length) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : last_error
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取最后一次执行SQL语句的错误信息
+			// 访问方式 : private
+			// 返 回 值 : error_info 错误信息
+			//*********************************************************
+			error_info last_error(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : open_reader
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取SQL语句的结果集, 并结束对该语句的观察
+			// 访问方式 : private
+			// 返 回 值 : recordset 结果集
+			//*********************************************************
+			recordset open_reader(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : begin_observe
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 结束上一条还没有结束的观察, 然后通知观察者开始执行SQL语句
+			// 访问方式 : private
+			// 函数参数 : const char * text SQL语句
+			// 函数参数 : unsigned long length SQL语句字符串长度
+			//*********************************************************
+			void begin_observe(const char *text, unsigned long length) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : end_observe
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 通知观察者SQL语句已经结束
+			// 访问方式 : private
+			// 函数参数 : unsigned int error 错误代号, 0 代表成功
+			// 函数参数 : unsigned long long rows 结果集行数或者影响的行数
+			//*********************************************************
+			void end_observe(unsigned int error, unsigned long long rows) const noexcept;
+
+		private:
+			friend recordset;
+			friend pipeline;
+			typedef std::pair<const char *, unsigned long> byte_data; // 数据开始位置和大小
+			typedef std::pair<bool, byte_data> alnum_data; // 是否一个数和数据
+
+			MYSQL *m_ptr_mysql; // MariaDB 数据库句柄
+			session_state *m_ptr_session; // 会话状态, 没有启用自动重新连接时为 nullptr
+			bool m_idempotent; // 是否所有SQL语句都可以重复执行
+			unsigned int m_timeout; // 执行SQL语句的超时时间 (毫秒), 0 代表不限制
+			const endpoint *m_ptr_endpoint; // 用于取消超时SQL语句的服务器参数
+			mutable bool m_timed_out; // 最后一次执行SQL语句是否超时
+			statement_observer *m_ptr_observer; // 观察者, 没有设置时为 nullptr
+			mutable size_t m_parameter_count; // 下一条SQL语句的参数个数
+			mutable bool m_observing; // 是否有还没有结束的观察
+			mutable std::chrono::steady_clock::time_point m_observe_start; // 观察开始的时间
+			mutable statement_event m_event; // 正在观察的事件
+			std::string m_text; // SQL语句
+			std::list<std::shared_ptr<std::string>> m_strings; // 保存字符串数据
+			std::list<std::shared_ptr<std::vector<char>>> m_datas; // 保存数据
+			std::list<std::shared_ptr<std::vector<unsigned char>>> m_udatas; // 保存数据
+			std::map<unsigned int, alnum_data> m_parameters; // 保存SQL语句的数据
+		};
+
+		// 用于将结果集中读取到的数据保存到 tuple 对象中并返回
+		template <typename Tuple>
+		struct command::data_tuple_setter<Tuple, 1>
+		{
+			//*********************************************************
+			// 函数名称 : set
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 将结果集中读取到的数据保存到指定的参数 t 中
+			// 模板参数 : size_t Size 函数参数 t 的元素数量
+			// 访问方式 : public
+			// 函数参数 : Tuple & t 用于将从结果集中读取到的数据填充到该参数指定位置
+			// 函数参数 : const recordset & reader 结果集对象
+			// 异    常 : 如果执行失败则抛出异常
+			//*********************************************************
+			static void set(Tuple &t, const sql::mariadb::recordset &reader)
+			{
+				std::get<0>(t) = reader.get<typename std::tuple_element<0, Tuple>::type>(0);
+			}
+		};
+
+		// 根据提供的带问号的SQL语句和 tuple 对象生成完整的SQL语句
+		// tuple 的元素类型只能是 数 和 std::string 型字符串
+		// 和 std::vector<char> 型和 std::vector<unsigned char> 型缓冲区
+		template <typename Tuple>
+		class command::statement_escape<Tuple, 1>
+		{
+		private:
+
+			//*********************************************************
+			// 函数名称 : escape_buffer
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 将数转换成字符串并保存到 std::vector<char> 对象中
+			// 访问方式 : public
+			// 函数参数 : const command & command 对象
+			// 函数参数 : Type type 数
+			// 返 回 值 : std::vector<char> 字符串形式的数字
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+			//            如果执行失败则抛出 std::exception 异常
+			//*********************************************************
+			template <typename Type>
+			static std::vector<char> escape_buffer(const command &, Type type)
+			{
+				const auto text = std::to_string(type);
+				return std::vector<char>(text.begin(), text.end());
+			}
+
+			//*********************************************************
+			// 函数名称 : escape_buffer
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 转换数据
+			// 访问方式 : public
+			// 函数参数 : const command & executer command 对象
+			// 函数参数 : const std::string & data 字符串
+			// 返 回 值 : std::vector<char> 字符串形式的数字
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+			//            如果执行失败则抛出 std::exception 异常
+			//*********************************************************
+			static std::vector<char> escape_buffer(const command &executer, const std::string &data)
+			{
+				return executer.escape_buffer_with_quote(data.c_str(), data.size());
+			}
+
+			//*********************************************************
+			// 函数名称 : escape_buffer
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 转换数据
+			// 访问方式 : public
+			// 函数参数 : const command & executer command 对象
+			// 函数参数 : const std::vector<char> & data 数据
+			// 返 回 值 : std::vector<char> 字符串形式的数字
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+			//            如果执行失败则抛出 std::exception 异常
+			//*********************************************************
+			static std::vector<char> escape_buffer(const command &executer, const std::vector<char> &data)
+			{
+				return executer.escape_buffer_with_quote(data.data(), data.size());
+			}
+
+			//*********************************************************
+			// 函数名称 : escape_buffer
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 转换数据
+			// 访问方式 : public
+			// 函数参数 : const command & executer command 对象
+			// 函数参数 : const std::vector<unsigned char> & data 数据
+			// 返 回 值 : std::vector<char> 字符串形式的数字
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+			//            如果执行失败则抛出 std::exception 异常
+			//*********************************************************
+			static std::vector<char> escape_buffer(const command &executer, const std::vector<unsigned char> &data)
+			{
+				return executer.escape_buffer_with_quote((const char *)data.data(), data.size());
+			}
+
+		public:
+
+			//*********************************************************
+			// 函数名称 : escape
+			// 作    者 : Gooeen
+			// 完成日期 : 2015/09/16
+			// 函数说明 : 将 t 所保存的数据进行转化后保存到 list 对象中
+			// 访问方式 : public
+			// 函数参数 : const command & executer command 对象
+			// 函数参数 : const Tuple & t 数据
+			// 返 回 值 : std::list<std::vector<char>> 转化后的数据
+			// 异    常 : 如果执行失败则抛出 std::exception 异常
+			//*********************************************************
+			static std::pair<std::list<std::vector<char>>, size_t> escape(const command &executer, const Tuple &t)
+			{
+				// 保存数据
+				std::pair<std::list<std::vector<char>>, size_t> datas;
+				datas.first.push_back(escape_buffer(executer, std::get<0>(t)));
+
+				// 添加字节数
+				datas.second = datas.first.back().size();
+
+				return datas;
+			}
+		};
+
+		// 数据库预处理语句类, 使用服务器端预处理语句和二进制协议传输数据
+		// 大数据可以通过 add_stream 分块发送, 客户端最多只保存一块数据
+		// 一个 prepared_statement 对象只能用于一个线程
+		class prepared_statement
+		{
+		public:
+
+			// 分块读取数据的函数; 参数为缓冲区和缓冲区大小,
+			// 返回读取到的字节数, 返回 0 代表数据读取完毕, 返回负数代表读取失败
+			typedef std::function<long(char *buffer, unsigned long size)> stream_reader;
+
+			// stream_reader 返回负数时 errorno 返回的错误代号 (SQLSTATE 为 HY000),
+			// 不在客户端库和服务器的错误代号范围内
+			static constexpr unsigned int stream_read_error = 50001;
+
+			// 分块接收数据的函数; 参数为数据和数据大小, 返回 false 代表停止接收
+			typedef std::function<bool(const char *data, unsigned long size)> stream_writer;
+
+			//*********************************************************
+			// 函数名称 : prepared_statement
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 转移构造函数, 转移后原对象不应该使用
+			// 访问方式 : public
+			// 函数参数 : prepared_statement && statement 需要转移的对象
+			//*********************************************************
+			prepared_statement(prepared_statement &&statement) noexcept;
+
+			//*********************************************************
+			// 函数名称 : prepared_statement
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数
+			// 访问方式 : public
+			// 函数参数 : const connection & connector 数据库连接类
+			//*********************************************************
+			explicit prepared_statement(const connection &connector) noexcept;
+
+			//*********************************************************
+			// 函数名称 : ~prepared_statement
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 如果预处理语句没有关闭则在析构时自动关闭
+			// 访问方式 : public
+			//*********************************************************
+			~prepared_statement(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : operator!=
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 判断预处理语句是否创建成功
+			// 访问方式 : public
+			// 函数参数 : std::nullptr_t null 与nullptr作比较
+			// 返 回 值 : bool 如果创建成功则 对象 != nullptr;
+			//            反之 对象 == nullptr
+			//*********************************************************
+			bool operator!=(std::nullptr_t null) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : operator==
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 判断预处理语句是否创建成功
+			// 访问方式 : public
+			// 函数参数 : std::nullptr_t null 与nullptr作比较
+			// 返 回 值 : bool 如果创建成功则 对象 != nullptr;
+			//            反之 对象 == nullptr
+			//*********************************************************
+			bool operator==(std::nullptr_t null) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : close
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 关闭预处理语句, 如果不手动关闭, 则析构时自动关闭
+			// 访问方式 : public
+			//*********************************************************
+			void close(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : error
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取数据库操作失败的错误信息
+			// 访问方式 : public
+			// 返 回 值 : std::string 错误信息
+			//*********************************************************
+			std::string error(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : errorno
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取数据库操作失败的错误代号
+			// 访问方式 : public
+			// 返 回 值 : unsigned int 错误代号
+			//*********************************************************
+			unsigned int errorno(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : last_error
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取数据库操作失败的错误信息, 包括错误代号和 SQLSTATE;
+			//            分块发送数据失败时为发送失败时的错误, 而不是丢弃数据后的状态
+			// 访问方式 : public
+			// 返 回 值 : error_info 错误信息
+			//*********************************************************
+			error_info last_error(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : prepare
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 将SQL语句发送到服务器进行预处理, 并清除之前添加的数据;
+			//            SQL语句中的问号代表数据, 例子如下:
+			//            statement.prepare("insert into table1 values(?, ?)");
+			// 访问方式 : public
+			// 函数参数 : const std::string & text SQL语句
+			// 返 回 值 : bool 如果预处理成功返回true; 反之返回false
+			//*********************************************************
+			bool prepare(const std::string &text) noexcept;
+
+			//*********************************************************
+			// 函数名称 : param_count
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取预处理语句中问号的数量
+			// 访问方式 : public
+			// 返 回 值 : unsigned long 问号的数量
+			//*********************************************************
+			unsigned long param_count(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : set_chunk_size
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置 add_stream 添加的数据每次发送的字节数, 默认为 64KB
+			// 访问方式 : public
+			// 函数参数 : unsigned long size 每次发送的字节数, 必须大于 0
+			//*********************************************************
+			void set_chunk_size(unsigned long size) noexcept;
+
+			//*********************************************************
+			// 函数名称 : add
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 添加数据, 执行SQL语句时本次添加的数据代替第 pos 个问号
+			// 访问方式 : public
+			// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
+			// 函数参数 : std::string text 数据
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			void add(unsigned int pos, std::string text);
+
+			//*********************************************************
+			// 函数名称 : add
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 添加数据, 执行SQL语句时本次添加的数据代替第 pos 个问号
+			// 访问方式 : public
+			// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
+			// 函数参数 : std::vector<char> data 数据
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			void add(unsigned int pos, std::vector<char> data);
+
+			//*********************************************************
+			// 函数名称 : add
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 添加数, 执行SQL语句时本次添加的数代替第 pos 个问号
+			// 访问方式 : public
+			// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
+			// 函数参数 : T value 数
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			template <typename T>
+			void add(unsigned int pos, T value)
+			{
+				const auto text = std::to_string(value);
+				this->add(pos, std::vector<char>(text.begin(), text.end()));
+			}
+
+			//*********************************************************
+			// 函数名称 : add_stream
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 添加分块读取的数据, 执行SQL语句时调用 reader 读取数据,
+			//            并通过 mysql_stmt_send_long_data 分块发送到服务器; 例子如下:
+			//            statement.prepare("insert into table1 values(?, ?)");
+			//            statement.add(0, 12);
+			//            statement.add_stream(1, reader);
+			//            数据的总长度受服务器的 max_allowed_packet 限制
+			// 访问方式 : public
+			// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
+			// 函数参数 : stream_reader reader 分块读取数据的函数
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			void add_stream(unsigned int pos, stream_reader reader);
+
+			//*********************************************************
+			// 函数名称 : add_stream
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 添加从文件描述符读取的数据, 执行SQL语句时从 fd 当前位置
+			//            读取到文件结尾, 并分块发送到服务器; 不会关闭 fd
+			// 访问方式 : public
+			// 函数参数 : unsigned int pos 需要代替问号的位置, 从0开始
+			// 函数参数 : int fd 文件描述符
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			void add_stream(unsigned int pos, int fd);
+
+			//*********************************************************
+			// 函数名称 : execute
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 执行预处理语句, 执行前先分块发送 add_stream 添加的数据
+			// 访问方式 : public
+			// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+			//            如果有问号没有添加数据则抛出 std::out_of_range 异常;
+			//            如果 reader 抛出异常则继续抛出该异常
+			//*********************************************************
+			bool execute(void);
+
+			//*********************************************************
+			// 函数名称 : affected_rows
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取上一次执行SQL语句所影响的行数
+			// 访问方式 : public
+			// 返 回 值 : unsigned long long 影响的行数
+			//*********************************************************
+			unsigned long long affected_rows(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : field_count
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取结果集的列数(字段数量)
+			// 访问方式 : public
+			// 返 回 值 : unsigned long 列数(字段数量), 没有结果集则返回 0
+			//*********************************************************
+			unsigned long field_count(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : read
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 从服务器读取下一条数据; 数据不会整行复制到客户端的缓冲区,
+			//            需要使用 read_column 分块读取各列的数据;
+			//            读取完所有数据或者调用 free_result 之前不能执行其他SQL语句
+			// 访问方式 : public
+			// 返 回 值 : bool 成功返回true, 没有数据或者失败返回false
+			//*********************************************************
+			bool read(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : free_result
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 丢弃还没有读取的数据
+			// 访问方式 : public
+			//*********************************************************
+			void free_result(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : is_null
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 判断当前行的数据是否为 NULL
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : bool 如果数据为 NULL 返回true; 反之返回false
+			//*********************************************************
+			bool is_null(unsigned long n) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : data_size
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取当前行单条数据的长度
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : unsigned long 单条数据的字节数
+			//*********************************************************
+			unsigned long data_size(unsigned long n) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : read_column
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 通过 mysql_stmt_fetch_column 读取当前行单条数据从 offset
+			//            开始的一部分, 保存到 buffer 中; 例子如下:
+			//            unsigned long offset = 0, count = 0;
+			//            while ((count = statement.read_column(0, buffer, size, offset)) != 0)
+			//            {
+			//                offset += count;
+			//            }
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 函数参数 : char * buffer 保存数据的缓冲区
+			// 函数参数 : unsigned long size 缓冲区的大小
+			// 函数参数 : unsigned long offset 数据的开始位置
+			// 返 回 值 : unsigned long 读取到的字节数; 如果 offset 已经到达数据结尾或者读取失败则返回 0
+			//*********************************************************
+			unsigned long read_column(unsigned long n, char *buffer, unsigned long size, unsigned long offset) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : read_column
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 分块读取当前行单条数据, 每读取一块数据就调用一次 writer;
+			//            每块数据的大小由 set_chunk_size 设置
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 函数参数 : const stream_writer & writer 分块接收数据的函数
+			// 返 回 值 : bool 如果读取完所有数据返回true; 如果读取失败或者 writer 返回 false 则返回false
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+			//            如果 writer 抛出异常则继续抛出该异常
+			//*********************************************************
+			bool read_column(unsigned long n, const stream_writer &writer) const;
+
+			//*********************************************************
+			// 函数名称 : get_data
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取当前行单条数据, 并将数据用 std::vector<char> 对象保存
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : std::vector<char> 数据
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			std::vector<char> get_data(unsigned long n) const;
+
+			//*********************************************************
+			// 函数名称 : get_string
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取当前行单条数据, 并将数据用 std::string 对象保存
+			// 访问方式 : public
+			// 函数参数 : unsigned long n 数据的列位置
+			// 返 回 值 : std::string 数据
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			std::string get_string(unsigned long n) const;
+
+		private:
+
+			//*********************************************************
+			// 函数名称 : prepared_statement
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const prepared_statement &
+			//*********************************************************
+			prepared_statement(const prepared_statement &) = delete;
+
+			//*********************************************************
+			// 函数名称 : operator=
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const prepared_statement &
+			// 返 回 值 : prepared_statement &
+			//*********************************************************
+			prepared_statement & operator=(const prepared_statement &) = delete;
+
+			//*********************************************************
+			// 函数名称 : send_stream
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 从 reader 分块读取数据并发送到服务器; 失败时把错误信息保存到 m_stream_error,
+			//            因为之后丢弃数据的 mysql_stmt_reset 会清除预处理语句中的错误信息
+			// 访问方式 : private
+			// 函数参数 : unsigned int pos 问号的位置
+			// 函数参数 : const stream_reader & reader 分块读取数据的函数
+			// 函数参数 : std::vector<char> & buffer 分块缓冲区
+			// 返 回 值 : bool 如果发送成功返回true; 反之返回false
+			//*********************************************************
+			bool send_stream(unsigned int pos, const stream_reader &reader, std::vector<char> &buffer);
+
+			//*********************************************************
+			// 函数名称 : bind_result
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 绑定结果集, 不分配数据缓冲区, 只接收各列的长度和是否为 NULL
+			// 访问方式 : private
+			// 返 回 值 : bool 如果绑定成功返回true; 反之返回false
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			bool bind_result(void);
+
+			//*********************************************************
+			// 函数名称 : refresh
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 如果连接已经自动重新连接过, 则重新创建预处理语句句柄并重新预处理
+			// 访问方式 : private
+			// 返 回 值 : bool 如果预处理语句可用返回true; 反之返回false
+			//*********************************************************
+			bool refresh(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : execute_once
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 绑定数据、分块发送数据并执行预处理语句
+			// 访问方式 : private
+			// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+			//            如果有问号没有添加数据则抛出 std::out_of_range 异常;
+			//            如果 reader 抛出异常则继续抛出该异常
+			//*********************************************************
+			bool execute_once(void);
+
+		private:
+			typedef std::pair<std::vector<char>, stream_reader> parameter_data; // 数据和分块读取数据的函数
+			typedef std::remove_pointer<decltype(MYSQL_BIND::is_null)>::type bind_flag; // MYSQL_BIND 中的 is_null 类型
+
+			MYSQL *m_ptr_mysql; // MariaDB 数据库句柄
+			MYSQL_STMT *m_ptr_stmt; // MariaDB 预处理语句句柄
+			session_state *m_ptr_session; // 会话状态, 没有启用自动重新连接时为 nullptr
+			unsigned long m_generation; // 预处理时连接的重新连接次数
+			std::string m_text; // 预处理的SQL语句
+			unsigned long m_chunk_size; // 分块发送和接收数据的字节数
+			std::map<unsigned int, parameter_data> m_parameters; // 保存SQL语句的数据
+			std::vector<MYSQL_BIND> m_results; // 绑定的结果集
+			std::vector<std::pair<unsigned long, bind_flag>> m_columns; // 当前行各列数据的长度和是否为 NULL
+			error_info m_stream_error; // 分块发送数据失败的错误信息, 没有失败时错误代号为 0
+		};
+
+		// 数据库流水线类
+		// 将多条SQL语句连续发送到服务器后再按顺序读取结果, 多条SQL语句只需要一次往返;
+		// 每条SQL语句单独执行, 一条SQL语句失败不影响其他SQL语句; 例子如下:
+		//            pipeline executer(connector);
+		//            auto users = executer.add_query_vector<std::tuple<int>>("select id from user");
+		//            auto count = executer.add_execute("update user set visits = visits + 1");
+		//            executer.run();
+		//            users.get(); count.get();
+		// 连续发送需要 MariaDB Connector/C, 使用其他客户端库时逐条执行
+		// 一个 pipeline 对象只能用于一个线程
+		class pipeline
+		{
+		public:
+
+			// 处理结果集的函数, 没有结果集的SQL语句 (如 update) 的 reader == nullptr
+			typedef std::function<void(recordset &reader)> result_handler;
+
+			// 处理错误的函数; 参数为错误代号和错误信息
+			typedef std::function<void(unsigned int code, const std::string &message)> error_handler;
+
+			//*********************************************************
+			// 函数名称 : pipeline
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 转移构造函数, 转移后原对象不应该使用
+			// 访问方式 : public
+			// 函数参数 : pipeline && executer 需要转移的对象
+			//*********************************************************
+			pipeline(pipeline &&executer) noexcept;
+
+			//*********************************************************
+			// 函数名称 : pipeline
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数
+			// 访问方式 : public
+			// 函数参数 : const connection & connector 数据库连接类
+			//*********************************************************
+			explicit pipeline(const connection &connector) noexcept;
+
+			//*********************************************************
+			// 函数名称 : size
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取还没有执行的SQL语句的数量
+			// 访问方式 : public
+			// 返 回 值 : size_t SQL语句的数量
+			//*********************************************************
+			size_t size(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : set_window
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置最多有多少条已经发送但还没有读取结果的SQL语句, 默认为 16;
+			//            限制数量可以避免客户端和服务器的网络缓冲区同时被填满
+			// 访问方式 : public
+			// 函数参数 : size_t count SQL语句的数量, 必须大于 0
+			//*********************************************************
+			void set_window(size_t count) noexcept;
+
+			//*********************************************************
+			// 函数名称 : add
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 添加SQL语句, 执行 run 时按添加的顺序执行
+			// 访问方式 : public
+			// 函数参数 : std::string text SQL语句
+			// 函数参数 : result_handler on_result SQL语句执行成功后处理结果集的函数
+			// 函数参数 : error_handler on_error SQL语句执行失败后处理错误的函数
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			void add(std::string text, result_handler on_result, error_handler on_error = error_handler());
+
+			//*********************************************************
+			// 函数名称 : add_execute
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 添加SQL语句, 执行 run 后可以从返回值获取影响的行数
+			// 访问方式 : public
+			// 函数参数 : std::string text SQL语句
+			// 返 回 值 : std::future<unsigned long long> 影响的行数;
+			//            如果执行失败则 get 时抛出 mariadb_exception 异常
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			std::future<unsigned long long> add_execute(std::string text);
+
+			//*********************************************************
+			// 函数名称 : add_query_vector
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 添加SQL语句, 执行 run 后可以从返回值获取结果集中所有数据
+			// 访问方式 : public
+			// 函数参数 : std::string text SQL语句
+			// 返 回 值 : std::future<std::vector<Tuple>> 结果集中所有数据;
+			//            如果执行失败则 get 时抛出 mariadb_exception 异常;
+			//            如果转换数据失败则 get 时抛出转换时的异常
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			template <typename Tuple>
+			std::future<std::vector<Tuple>> add_query_vector(std::string text)
+			{
+				const auto promise = std::make_shared<std::promise<std::vector<Tuple>>>();
+				const auto message = text;
+
+				this->add(std::move(text), [promise](recordset &reader)
+				{
+					try
+					{
+						std::vector<Tuple> data; // 保存数据
+						if (reader != nullptr)
+						{
+							data = command::vector_from_recordset<Tuple>(reader);
+						}
+						promise->set_value(std::move(data));
+					}
+					catch (...)
+					{
+						// 转换数据失败时把异常交给 get, 否则只能得到 broken_promise
+						promise->set_exception(std::current_exception());
+					}
+				}, [promise, message](unsigned int, const std::string &error)
+				{
+					promise->set_exception(std::make_exception_ptr(mariadb_exception(error + "\r\nSQL: " + message, __FILE__, __LINE__)));
+				});
+
+				return promise->get_future();
+			}
+
+			//*********************************************************
+			// 函数名称 : run
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 连续发送添加的SQL语句, 然后按顺序读取结果并调用处理函数;
+			//            执行后清空已添加的SQL语句; 如果处理函数抛出异常, 会先读取
+			//            剩余的结果使数据库连接可以继续使用, 然后再抛出第一个异常
+			// 访问方式 : public
+			// 返 回 值 : size_t 执行成功的SQL语句的数量
+			// 异    常 : 如果处理函数抛出异常则继续抛出该异常
+			//*********************************************************
+			size_t run(void);
+
+		private:
+
+			//*********************************************************
+			// 函数名称 : pipeline
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const pipeline &
+			//*********************************************************
+			pipeline(const pipeline &) = delete;
+
+			//*********************************************************
+			// 函数名称 : operator=
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const pipeline &
+			// 返 回 值 : pipeline &
+			//*********************************************************
+			pipeline & operator=(const pipeline &) = delete;
+
+			//*********************************************************
+			// 函数名称 : send
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 发送SQL语句, 不等待服务器返回结果
+			// 访问方式 : private
+			// 函数参数 : const std::string & text SQL语句
+			// 返 回 值 : bool 如果发送成功返回true; 反之返回false
+			//*********************************************************
+			bool send(const std::string &text) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : receive
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 读取已经发送的SQL语句的执行结果
+			// 访问方式 : private
+			// 函数参数 : const std::string & text SQL语句
+			// 返 回 值 : bool 如果SQL语句执行成功返回true; 反之返回false
+			//*********************************************************
+			bool receive(const std::string &text) const noexcept;
+
+		private:
+			// SQL语句和处理函数
+			struct item
+			{
+				std::string text; // SQL语句
+				result_handler on_result; // 处理结果集的函数
+				error_handler on_error; // 处理错误的函数
+			};
+
+			MYSQL *m_ptr_mysql; // MariaDB 数据库句柄
+			size_t m_window; // 最多有多少条已经发送但还没有读取结果的SQL语句
+			std::vector<item> m_items; // 还没有执行的SQL语句
+		};
+
+		// 从连接池借出的数据库连接
+		// 析构时自动归还给连接池, 可以像 connection 一样用于构造 command 等类
+		class pooled_connection
+		{
+		public:
+
+			//*********************************************************
+			// 函数名称 : pooled_connection
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 转移构造函数, 转移后原对象不应该使用
+			// 访问方式 : public
+			// 函数参数 : pooled_connection && connector 需要转移的对象
+			//*********************************************************
+			pooled_connection(pooled_connection &&connector) noexcept;
+
+			//*********************************************************
+			// 函数名称 : ~pooled_connection
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 将数据库连接归还给连接池
+			// 访问方式 : public
+			//*********************************************************
+			~pooled_connection(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : operator!=
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 判断是否持有数据库连接
+			// 访问方式 : public
+			// 函数参数 : std::nullptr_t null 与nullptr作比较
+			// 返 回 值 : bool 如果持有数据库连接则 对象 != nullptr;
+			//            反之 对象 == nullptr
+			//*********************************************************
+			bool operator!=(std::nullptr_t null) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : operator==
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 判断是否持有数据库连接
+			// 访问方式 : public
+			// 函数参数 : std::nullptr_t null 与nullptr作比较
+			// 返 回 值 : bool 如果持有数据库连接则 对象 != nullptr;
+			//            反之 对象 == nullptr
+			//*********************************************************
+			bool operator==(std::nullptr_t null) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : get
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取数据库连接
+			// 访问方式 : public
+			// 返 回 值 : const connection & 数据库连接
+			//*********************************************************
+			const connection & get(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : operator const connection &
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 转换成数据库连接, 例子如下:
+			//            auto connector = pool.acquire();
+			//            sql::mariadb::command executer(connector);
+			// 访问方式 : public
+			// 返 回 值 : const connection & 数据库连接
+			//*********************************************************
+			operator const connection &(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : discard
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 标记数据库连接已经不可用, 归还时关闭而不是放回连接池
+			// 访问方式 : public
+			//*********************************************************
+			void discard(void) noexcept;
+
+		private:
+
+			//*********************************************************
+			// 函数名称 : pooled_connection
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数
+			// 访问方式 : private
+			// 函数参数 : connection_pool * pool 连接池
+			// 函数参数 : std::unique_ptr<connection> && connector 数据库连接
+			//*********************************************************
+			pooled_connection(connection_pool *pool, std::unique_ptr<connection> &&connector) noexcept;
+
+			//*********************************************************
+			// 函数名称 : pooled_connection
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const pooled_connection &
+			//*********************************************************
+			pooled_connection(const pooled_connection &) = delete;
+
+			//*********************************************************
+			// 函数名称 : operator=
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const pooled_connection &
+			// 返 回 值 : pooled_connection &
+			//*********************************************************
+			pooled_connection & operator=(const pooled_connection &) = delete;
+
+		private:
+			friend connection_pool;
+			connection_pool *m_ptr_pool; // 连接池
+			std::unique_ptr<connection> m_connection; // 数据库连接
+			bool m_reuse; // 归还时是否放回连接池
+		};
+
+		// 数据库连接池类
+		// 可以在多个线程中同时使用; 连接池必须比借出的所有连接存在得更久
+		class connection_pool
+		{
+		public:
+
+			//*********************************************************
+			// 函数名称 : connection_pool
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数, 不会马上打开连接, 需要时再打开或者使用 warm_up 预先打开
+			// 访问方式 : public
+			// 函数参数 : endpoint point 服务器参数
+			// 函数参数 : size_t capacity 最多打开多少个连接
+			//*********************************************************
+			connection_pool(endpoint point, size_t capacity) noexcept;
+
+			//*********************************************************
+			// 函数名称 : warm_up
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 使用多个线程同时打开连接并放入连接池, 连接总数不超过 capacity;
+			//            一般在服务启动或者故障切换后调用
+			// 访问方式 : public
+			// 函数参数 : size_t count 需要打开的连接数
+			// 函数参数 : size_t threads 最多使用多少个线程
+			// 返 回 值 : size_t 成功打开的连接数
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+			//            如果无法创建线程则抛出 std::system_error 异常
+			//*********************************************************
+			size_t warm_up(size_t count, size_t threads = 8);
+
+			//*********************************************************
+			// 函数名称 : acquire
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 借出一个数据库连接; 如果没有空闲的连接并且连接数没有达到上限
+			//            则打开新的连接, 否则等待其他线程归还连接, 最多等待 set_acquire_timeout
+			//            设置的时间; 空闲超过 set_validation_interval 设置的时间的连接先 ping,
+			//            不可用的连接关闭后借出其他连接
+			// 访问方式 : public
+			// 返 回 值 : pooled_connection 数据库连接, 析构时自动归还
+			// 异    常 : 如果等待超时则抛出 timeout_exception 异常;
+			//            如果连接数据库失败则抛出 mariadb_exception 异常;
+			//            如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			pooled_connection acquire(void);
+
+			//*********************************************************
+			// 函数名称 : set_acquire_timeout
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置 acquire 等待其他线程归还连接的最长时间, 默认为 0
+			// 访问方式 : public
+			// 函数参数 : unsigned int milliseconds 等待时间 (毫秒), 0 代表一直等待
+			//*********************************************************
+			void set_acquire_timeout(unsigned int milliseconds) noexcept;
+
+			//*********************************************************
+			// 函数名称 : set_validation_interval
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置空闲多久的连接在借出前需要 ping 检查是否可用, 默认为 30 秒;
+			//            服务器的 wait_timeout 或者中间的防火墙可能已经关闭了空闲太久的连接
+			// 访问方式 : public
+			// 函数参数 : unsigned int milliseconds 空闲时间 (毫秒), 0 代表不检查
+			//*********************************************************
+			void set_validation_interval(unsigned int milliseconds) noexcept;
+
+			//*********************************************************
+			// 函数名称 : set_reset_on_release
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置归还时是否使用 mysql_reset_connection 清除所有会话状态, 默认为 true;
+			//            false 代表只回滚还没有结束的事务, 可以省去一次往返, 但是会话变量、
+			//            用户变量和临时表会留给下一个借用者
+			// 访问方式 : public
+			// 函数参数 : bool enable true 代表清除所有会话状态
+			//*********************************************************
+			void set_reset_on_release(bool enable) noexcept;
+
+			//*********************************************************
+			// 函数名称 : size
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取已经打开的连接数, 包括借出的连接
+			// 访问方式 : public
+			// 返 回 值 : size_t 连接数
+			//*********************************************************
+			size_t size(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : idle
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取空闲的连接数
+			// 访问方式 : public
+			// 返 回 值 : size_t 连接数
+			//*********************************************************
+			size_t idle(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : capacity
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取最多可以打开的连接数
+			// 访问方式 : public
+			// 返 回 值 : size_t 连接数
+			//*********************************************************
+			size_t capacity(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : get_endpoint
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取服务器参数
+			// 访问方式 : public
+			// 返 回 值 : const endpoint & 服务器参数
+			//*********************************************************
+			const endpoint & get_endpoint(void) const noexcept;
+
+		private:
+
+			//*********************************************************
+			// 函数名称 : connection_pool
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const connection_pool &
+			//*********************************************************
+			connection_pool(const connection_pool &) = delete;
+
+			//*********************************************************
+			// 函数名称 : operator=
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const connection_pool &
+			// 返 回 值 : connection_pool &
+			//*********************************************************
+			connection_pool & operator=(const connection_pool &) = delete;
+
+			//*********************************************************
+			// 函数名称 : reset
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 放回连接池前清除会话状态, 下一个借用者不会看到上一个借用者的事务和会话变量
+			// 访问方式 : private
+			// 函数参数 : const connection & connector 数据库连接
+			// 返 回 值 : bool 如果清除成功返回true; 反之返回false, 连接需要关闭
+			//*********************************************************
+			bool reset(const connection &connector) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : release
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 归还数据库连接
+			// 访问方式 : private
+			// 函数参数 : std::unique_ptr<connection> && connector 数据库连接, 可以是 nullptr
+			// 函数参数 : bool reuse 是否放回连接池, false 代表关闭连接
+			//*********************************************************
+			void release(std::unique_ptr<connection> &&connector, bool reuse) noexcept;
+
+		private:
+			friend pooled_connection;
+			endpoint m_endpoint; // 服务器参数
+			size_t m_capacity; // 最多打开多少个连接
+			size_t m_size; // 已经打开或者正在打开的连接数
+			std::vector<std::pair<std::unique_ptr<connection>, std::chrono::steady_clock::time_point>> m_idle; // 空闲的连接和归还时间, 后归还的先借出
+			std::chrono::milliseconds m_acquire_timeout; // 等待归还的最长时间, 0 代表一直等待
+			std::chrono::milliseconds m_validation_interval; // 空闲多久的连接需要 ping, 0 代表不检查
+			bool m_reset_on_release; // 归还时是否清除所有会话状态
+			mutable std::mutex m_mutex; // 保护以上成员
+			std::condition_variable m_available; // 有连接归还时通知等待的线程
+		};
+
+		// 从服务器连接池负载均衡类
+		// 记录每个连接池的延迟 (指数加权移动平均, EWMA) 和正在执行的请求数,
+		// 每次随机选出两个连接池, 使用 延迟 * (请求数 + 1) 较小的一个 (power of two choices);
+		// 延迟远高于其他连接池或者连续失败的连接池会被暂时移除 (outlier ejection);
+		// acquire 和 router 借出的连接通过 statement_observer 记录每条SQL语句本身的耗时和是否失败,
+		// 定义 SQL_MARIADB_NO_OBSERVER 时只能由调用者使用 begin 和 end 记录;
+		// 可以在多个线程中同时使用; 连接池必须比负载均衡对象存在得更久
+		class balancer
+		{
+		public:
+
+			//*********************************************************
+			// 函数名称 : balancer
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数
+			// 访问方式 : public
+			// 函数参数 : const std::vector<connection_pool *> & pools 连接池
+			// 函数参数 : double decay EWMA 中新样本的权重, 范围为 (0, 1]
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			explicit balancer(const std::vector<connection_pool *> &pools, double decay = 0.2);
+
+			//*********************************************************
+			// 函数名称 : set_ejection
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置移除异常连接池的条件: 至少有 min_samples 个样本并且延迟超过
+			//            其他连接池延迟中位数的 factor 倍, 或者连续失败 max_failures 次;
+			//            移除 cooldown 毫秒后重新使用; 至少保留一个连接池
+			// 访问方式 : public
+			// 函数参数 : double factor 延迟倍数, 默认为 3
+			// 函数参数 : unsigned int cooldown 移除的时间 (毫秒), 默认为 10000
+			// 函数参数 : unsigned int min_samples 最少样本数, 默认为 20
+			// 函数参数 : unsigned int max_failures 连续失败次数, 默认为 5
+			//*********************************************************
+			void set_ejection(double factor, unsigned int cooldown,
+				unsigned int min_samples = 20, unsigned int max_failures = 5) noexcept;
+
+			//*********************************************************
+			// 函数名称 : select
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 从所有没有被移除的连接池中选择一个
+			// 访问方式 : public
+			// 返 回 值 : connection_pool * 连接池; 如果没有连接池则返回 nullptr
+			//*********************************************************
+			connection_pool * select(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : select
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 从 candidates 中没有被移除的连接池中选择一个;
+			//            如果都被移除了则从 candidates 中选择
+			// 访问方式 : public
+			// 函数参数 : const std::vector<connection_pool *> & candidates 可以选择的连接池
+			// 返 回 值 : connection_pool * 连接池; 如果 candidates 为空则返回 nullptr
+			//*********************************************************
+			connection_pool * select(const std::vector<connection_pool *> &candidates) noexcept;
+
+			//*********************************************************
+			// 函数名称 : acquire
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 选择连接池并借出一个数据库连接, 归还前记录在该连接上执行的每条SQL语句的延迟
+			// 访问方式 : public
+			// 返 回 值 : balanced_connection 数据库连接, 析构时自动归还
+			// 异    常 : 如果没有连接池或者连接数据库失败则抛出 mariadb_exception 异常;
+			//            如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			balanced_connection acquire(void);
+
+			//*********************************************************
+			// 函数名称 : begin
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 记录连接池开始执行一个请求
+			// 访问方式 : public
+			// 函数参数 : connection_pool * pool 连接池
+			//*********************************************************
+			void begin(connection_pool *pool) noexcept;
+
+			//*********************************************************
+			// 函数名称 : end
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 记录连接池完成一个请求, 更新延迟并检查是否需要移除
+			// 访问方式 : public
+			// 函数参数 : connection_pool * pool 连接池
+			// 函数参数 : std::chrono::nanoseconds elapsed 请求的执行时间
+			// 函数参数 : bool failed 请求是否失败, 失败的请求不更新延迟
+			//*********************************************************
+			void end(connection_pool *pool, std::chrono::nanoseconds elapsed, bool failed) noexcept;
+
+			//*********************************************************
+			// 函数名称 : latency
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取连接池的平均延迟 (EWMA)
+			// 访问方式 : public
+			// 函数参数 : connection_pool * pool 连接池
+			// 返 回 值 : double 平均延迟 (纳秒); 如果没有样本则返回 0
+			//*********************************************************
+			double latency(connection_pool *pool) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : ejected
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 判断连接池是否被暂时移除
+			// 访问方式 : public
+			// 函数参数 : connection_pool * pool 连接池
+			// 返 回 值 : bool 如果被移除返回true; 反之返回false
+			//*********************************************************
+			bool ejected(connection_pool *pool) const noexcept;
+
+		private:
+
+			//*********************************************************
+			// 函数名称 : balancer
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const balancer &
+			//*********************************************************
+			balancer(const balancer &) = delete;
+
+			//*********************************************************
+			// 函数名称 : operator=
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const balancer &
+			// 返 回 值 : balancer &
+			//*********************************************************
+			balancer & operator=(const balancer &) = delete;
+
+			// 连接池的统计数据
+			struct statistics
 			{
-				// 赋值
-				std::list<Tuple> data; // 保存数据
-				while (reader.read())
-				{
-					data.push_back(data_tuple_getter<Tuple>::get(reader));
-				}
-				return data;
-			}
+				connection_pool *pool; // 连接池
+				double latency; // 平均延迟 (纳秒)
+				unsigned long long samples; // 样本数
+				unsigned int in_flight; // 正在执行的请求数
+				unsigned int failures; // 连续失败次数
+				std::chrono::steady_clock::time_point ejected_until; // 移除到什么时候
+			};
+
+			// 注册到借出的数据库连接上的观察者, 把每条SQL语句的开始和结束记录到负载均衡对象,
+			// 并转发给该连接原来的观察者
+			class probe : public statement_observer
+			{
+			public:
+
+				//*********************************************************
+				// 函数名称 : probe
+				// 作    者 : agent
+				// 完成日期 : 2026/10/19
+				// 函数说明 : 构造函数, 没有注册到任何数据库连接
+				// 访问方式 : public
+				//*********************************************************
+				probe(void) noexcept;
+
+				//*********************************************************
+				// 函数名称 : ~probe
+				// 作    者 : agent
+				// 完成日期 : 2026/10/19
+				// 函数说明 : 取消注册
+				// 访问方式 : public
+				//*********************************************************
+				~probe(void) noexcept;
+
+				//*********************************************************
+				// 函数名称 : attach
+				// 作    者 : agent
+				// 完成日期 : 2026/10/19
+				// 函数说明 : 取消之前的注册, 然后注册到数据库连接上; 之后用该连接创建的
+				//            command 执行的SQL语句都会记录到连接池的统计数据
+				// 访问方式 : public
+				// 函数参数 : balancer * balance 负载均衡对象
+				// 函数参数 : connection_pool * pool 数据库连接所属的连接池
+				// 函数参数 : const connection & connector 数据库连接
+				//*********************************************************
+				void attach(balancer *balance, connection_pool *pool, const connection &connector) noexcept;
+
+				//*********************************************************
+				// 函数名称 : detach
+				// 作    者 : agent
+				// 完成日期 : 2026/10/19
+				// 函数说明 : 恢复数据库连接原来的观察者; 还没有结束的SQL语句按已经执行的时间记录
+				// 访问方式 : public
+				//*********************************************************
+				void detach(void) noexcept;
+
+				//*********************************************************
+				// 函数名称 : on_begin
+				// 作    者 : agent
+				// 完成日期 : 2026/10/19
+				// 函数说明 : 记录连接池开始执行一条SQL语句
+				// 访问方式 : public
+				// 函数参数 : statement_event & event 事件
+				//*********************************************************
+				virtual void on_begin(statement_event &event) noexcept override;
+
+				//*********************************************************
+				// 函数名称 : on_end
+				// 作    者 : agent
+				// 完成日期 : 2026/10/19
+				// 函数说明 : 记录SQL语句的耗时; 网络错误和超时记录为失败, 其他错误 (例如语法错误)
+				//            与服务器无关, 按正常的响应记录
+				// 访问方式 : public
+				// 函数参数 : const statement_event & event 事件
+				//*********************************************************
+				virtual void on_end(const statement_event &event) noexcept override;
+
+			private:
+
+				//*********************************************************
+				// 函数名称 : probe
+				// 作    者 : agent
+				// 完成日期 : 2026/10/19
+				// 函数说明 : 禁止复制
+				// 访问方式 : private
+				// 函数参数 : const probe &
+				//*********************************************************
+				probe(const probe &) = delete;
+
+				//*********************************************************
+				// 函数名称 : operator=
+				// 作    者 : agent
+				// 完成日期 : 2026/10/19
+				// 函数说明 : 禁止复制
+				// 访问方式 : private
+				// 函数参数 : const probe &
+				// 返 回 值 : probe &
+				//*********************************************************
+				probe & operator=(const probe &) = delete;
+
+			private:
+				balancer *m_ptr_balancer; // 负载均衡对象
+				connection_pool *m_ptr_pool; // 注册的数据库连接所属的连接池
+				connection *m_ptr_connection; // 注册的数据库连接
+				statement_observer *m_ptr_next; // 数据库连接原来的观察者
+				connection_pool *m_ptr_running; // 正在执行SQL语句的连接池, 没有时为 nullptr
+				std::chrono::steady_clock::time_point m_start; // 正在执行的SQL语句的开始时间
+			};
+
+			//*********************************************************
+			// 函数名称 : find
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 查找连接池的统计数据, 调用前需要加锁
+			// 访问方式 : private
+			// 函数参数 : connection_pool * pool 连接池
+			// 返 回 值 : statistics * 统计数据; 如果不是本对象的连接池则返回 nullptr
+			//*********************************************************
+			statistics * find(connection_pool *pool) noexcept;
+
+			//*********************************************************
+			// 函数名称 : eject
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 检查连接池是否需要移除, 调用前需要加锁
+			// 访问方式 : private
+			// 函数参数 : statistics & state 连接池的统计数据
+			// 函数参数 : std::chrono::steady_clock::time_point now 当前时间
+			//*********************************************************
+			void eject(statistics &state, std::chrono::steady_clock::time_point now) noexcept;
+
+			//*********************************************************
+			// 函数名称 : fail
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 记录连接池的一次失败 (例如无法连接), 不改变正在执行的请求数
+			// 访问方式 : private
+			// 函数参数 : connection_pool * pool 连接池
+			//*********************************************************
+			void fail(connection_pool *pool) noexcept;
+
+		private:
+			friend balanced_connection;
+			friend routed_session;
+			std::vector<statistics> m_pools; // 连接池的统计数据
+			double m_decay; // EWMA 中新样本的权重
+			double m_factor; // 移除连接池的延迟倍数
+			std::chrono::milliseconds m_cooldown; // 移除的时间
+			unsigned int m_min_samples; // 移除前最少的样本数
+			unsigned int m_max_failures; // 移除前最多的连续失败次数
+			mutable std::mutex m_mutex; // 保护以上成员
+		};
+
+		// 从负载均衡对象借出的数据库连接
+		// 借出期间在该连接上执行的每条SQL语句的耗时记录到负载均衡对象, 析构时归还给连接池
+		class balanced_connection
+		{
+		public:
+
+			//*********************************************************
+			// 函数名称 : balanced_connection
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 转移构造函数, 转移后原对象不应该使用
+			// 访问方式 : public
+			// 函数参数 : balanced_connection && connector 需要转移的对象
+			//*********************************************************
+			balanced_connection(balanced_connection &&connector) noexcept;
+
+			//*********************************************************
+			// 函数名称 : ~balanced_connection
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 停止记录延迟并将数据库连接归还给连接池
+			// 访问方式 : public
+			//*********************************************************
+			~balanced_connection(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : get
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取数据库连接
+			// 访问方式 : public
+			// 返 回 值 : const connection & 数据库连接
+			//*********************************************************
+			const connection & get(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : operator const connection &
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 转换成数据库连接
+			// 访问方式 : public
+			// 返 回 值 : const connection & 数据库连接
+			//*********************************************************
+			operator const connection &(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : discard
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 标记请求失败, 归还时关闭连接并记录一次失败
+			// 访问方式 : public
+			//*********************************************************
+			void discard(void) noexcept;
+
+		private:
+
+			//*********************************************************
+			// 函数名称 : balanced_connection
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数
+			// 访问方式 : private
+			// 函数参数 : balancer * balance 负载均衡对象
+			// 函数参数 : connection_pool * pool 连接池
+			// 函数参数 : pooled_connection && connector 数据库连接
+			// 函数参数 : std::unique_ptr<balancer::probe> && observer 注册到数据库连接上的观察者
+			//*********************************************************
+			balanced_connection(balancer *balance, connection_pool *pool, pooled_connection &&connector,
+				std::unique_ptr<balancer::probe> &&observer) noexcept;
+
+			//*********************************************************
+			// 函数名称 : balanced_connection
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const balanced_connection &
+			//*********************************************************
+			balanced_connection(const balanced_connection &) = delete;
+
+			//*********************************************************
+			// 函数名称 : operator=
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const balanced_connection &
+			// 返 回 值 : balanced_connection &
+			//*********************************************************
+			balanced_connection & operator=(const balanced_connection &) = delete;
+
+		private:
+			friend balancer;
+			balancer *m_ptr_balancer; // 负载均衡对象
+			connection_pool *m_ptr_pool; // 连接池
+			pooled_connection m_connection; // 数据库连接
+			std::unique_ptr<balancer::probe> m_ptr_probe; // 记录延迟的观察者, 地址不随转移改变
+			bool m_failed; // 请求是否失败
+		};
+
+		// 读写分离路由类
+		// 读语句发送到从服务器连接池, 写语句和事务中的语句发送到主服务器连接池;
+		// 复制延迟超过上限或者无法连接的从服务器不会被选中, 没有可用的从服务器时
+		// 读语句也发送到主服务器; 复制延迟由后台线程在每个从服务器的单独连接上定期检查,
+		// 选择从服务器时不访问网络, 也不从连接池借出连接;
+		// 可以在多个线程中同时使用, 每个请求使用一个 routed_session;
+		// 主服务器和从服务器连接池必须比路由对象存在得更久
+		class router
+		{
+		public:
+
+			//*********************************************************
+			// 函数名称 : router
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数, 有从服务器时启动检查复制延迟的后台线程
+			// 访问方式 : public
+			// 函数参数 : connection_pool & primary 主服务器连接池
+			// 函数参数 : const std::vector<connection_pool *> & replicas 从服务器连接池
+			// 函数参数 : unsigned int max_lag 允许的最大复制延迟 (秒)
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
+			//            如果创建线程失败则抛出 std::system_error 异常
+			//*********************************************************
+			router(connection_pool &primary, const std::vector<connection_pool *> &replicas, unsigned int max_lag = 5);
+
+			//*********************************************************
+			// 函数名称 : ~router
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 结束检查复制延迟的后台线程
+			// 访问方式 : public
+			//*********************************************************
+			~router(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : set_lag_check_interval
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置检查从服务器复制延迟 (SHOW SLAVE STATUS) 的间隔, 默认为 1000 毫秒
+			// 访问方式 : public
+			// 函数参数 : unsigned int milliseconds 毫秒数
+			//*********************************************************
+			void set_lag_check_interval(unsigned int milliseconds) noexcept;
+
+			//*********************************************************
+			// 函数名称 : set_gtid_wait_timeout
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置从服务器等待读写一致性令牌的最长时间, 超时后改为从主服务器读取;
+			//            默认为 50 毫秒
+			// 访问方式 : public
+			// 函数参数 : unsigned int milliseconds 毫秒数
+			//*********************************************************
+			void set_gtid_wait_timeout(unsigned int milliseconds) noexcept;
+
+			//*********************************************************
+			// 函数名称 : set_balancer
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置负载均衡对象, 设置后从复制延迟没有超过上限的从服务器中
+			//            按照延迟和请求数选择, 而不是轮流选择; 负载均衡对象必须使用
+			//            相同的从服务器连接池, 并且比路由对象存在得更久
+			// 访问方式 : public
+			// 函数参数 : balancer * balance 负载均衡对象, nullptr 代表轮流选择
+			//*********************************************************
+			void set_balancer(balancer *balance) noexcept;
+
+			//*********************************************************
+			// 函数名称 : primary
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取主服务器连接池
+			// 访问方式 : public
+			// 返 回 值 : connection_pool & 主服务器连接池
+			//*********************************************************
+			connection_pool & primary(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : select_replica
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 选择一个复制延迟没有超过上限的从服务器连接池, 没有设置负载均衡
+			//            对象时轮流选择; 使用后台线程最后一次检查的复制延迟, 不等待网络
+			// 访问方式 : public
+			// 返 回 值 : connection_pool * 从服务器连接池; 如果没有可用的从服务器则返回 nullptr
+			//*********************************************************
+			connection_pool * select_replica(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : is_read
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 判断SQL语句能否发送到从服务器: 以 SELECT, SHOW, DESCRIBE, DESC, EXPLAIN
+			//            开头, 并且不加锁 (FOR UPDATE, LOCK IN SHARE MODE), 不写入 (INTO),
+			//            不使用与会话相关的函数 (LAST_INSERT_ID, GET_LOCK 等), 只有一条SQL语句;
+			//            开头的注释可以指定路由: /*route:primary*/ 或者 /*route:replica*/
+			// 访问方式 : public
+			// 函数参数 : const char * text SQL语句
+			// 函数参数 : unsigned long length SQL语句字符串长度
+			// 返 回 值 : bool 如果可以发送到从服务器返回true; 反之返回false
+			//*********************************************************
+			static bool is_read(const char *text, unsigned long length) noexcept;
+
+		private:
+
+			//*********************************************************
+			// 函数名称 : router
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const router &
+			//*********************************************************
+			router(const router &) = delete;
+
+			//*********************************************************
+			// 函数名称 : operator=
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const router &
+			// 返 回 值 : router &
+			//*********************************************************
+			router & operator=(const router &) = delete;
+
+			//*********************************************************
+			// 函数名称 : healthy
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 判断从服务器最后一次检查的复制延迟是否没有超过上限
+			// 访问方式 : private
+			// 函数参数 : size_t index 从服务器的位置
+			// 返 回 值 : bool 如果可以使用返回true; 反之返回false
+			//*********************************************************
+			bool healthy(size_t index) noexcept;
+
+			//*********************************************************
+			// 函数名称 : run
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 后台线程, 每隔 m_check_interval 检查一次所有从服务器的复制延迟
+			// 访问方式 : private
+			//*********************************************************
+			void run(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : check_lag
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 在检查用的连接上使用 SHOW SLAVE STATUS 获取从服务器的复制延迟;
+			//            连接没有打开或者已经断开时重新连接
+			// 访问方式 : private
+			// 函数参数 : std::unique_ptr<connection> & prober 检查用的连接, 失败时被关闭
+			// 函数参数 : const endpoint & point 从服务器参数
+			// 返 回 值 : long long 复制延迟 (秒); 如果无法连接或者复制已经停止则返回 -1;
+			//            如果服务器不是从服务器则返回 0
+			//*********************************************************
+			static long long check_lag(std::unique_ptr<connection> &prober, const endpoint &point) noexcept;
+
+		private:
+			friend routed_session;
+
+			// 从服务器的状态
+			struct replica
+			{
+				connection_pool *pool; // 从服务器连接池
+				long long lag; // 最后一次检查的复制延迟 (秒), -1 代表不可用
+				std::unique_ptr<endpoint> point; // 检查用的服务器参数, 使用较短的超时时间, 只在后台线程中使用
+				std::unique_ptr<connection> prober; // 检查用的连接, 只在后台线程中使用
+			};
+
+			connection_pool &m_primary; // 主服务器连接池
+			std::vector<replica> m_replicas; // 从服务器
+			long long m_max_lag; // 允许的最大复制延迟 (秒)
+			std::chrono::milliseconds m_check_interval; // 检查复制延迟的间隔
+			unsigned int m_gtid_wait_timeout; // 等待读写一致性令牌的最长时间 (毫秒)
+			std::atomic<size_t> m_next; // 下一次从哪个从服务器开始选择
+			balancer *m_ptr_balancer; // 负载均衡对象
+			bool m_stop; // 是否结束后台线程
+			std::mutex m_mutex; // 保护 m_replicas 中的 lag, m_check_interval 和 m_stop
+			std::condition_variable m_changed; // 修改检查间隔或者结束时通知后台线程
+			std::thread m_thread; // 检查复制延迟的后台线程
+		};
+
+		// 路由会话类
+		// 一个请求 (一个线程) 使用一个路由会话, 根据SQL语句借出主服务器或者从服务器的连接;
+		// 事务中的语句都发送到主服务器; 写入后的读语句使用 GTID 令牌保证能读到写入的数据
+		// (读写一致性, 需要 MariaDB 的 @@last_gtid 和 MASTER_GTID_WAIT); 例子如下:
+		//     sql::mariadb::routed_session session(route);
+		//     sql::mariadb::command(session.route(text)).execute_reader(text);
+		class routed_session
+		{
+		public:
+
+			//*********************************************************
+			// 函数名称 : routed_session
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数
+			// 访问方式 : public
+			// 函数参数 : router & route 路由对象
+			//*********************************************************
+			explicit routed_session(router &route) noexcept;
+
+			//*********************************************************
+			// 函数名称 : ~routed_session
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 归还数据库连接
+			// 访问方式 : public
+			//*********************************************************
+			~routed_session(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : route
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 根据SQL语句选择数据库连接, 会话结束前借出的连接会被重复使用
+			// 访问方式 : public
+			// 函数参数 : const std::string & text SQL语句
+			// 返 回 值 : const connection & 用于执行该SQL语句的数据库连接
+			// 异    常 : 如果无法连接主服务器则抛出 mariadb_exception 异常;
+			//            如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			const connection & route(const std::string &text);
+
+			//*********************************************************
+			// 函数名称 : primary
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取主服务器的数据库连接
+			// 访问方式 : public
+			// 返 回 值 : const connection & 主服务器的数据库连接
+			// 异    常 : 如果无法连接主服务器则抛出 mariadb_exception 异常;
+			//            如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			const connection & primary(void);
+
+			//*********************************************************
+			// 函数名称 : token
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取读写一致性令牌 (最后一次写入的 GTID); 可以传给其他请求的
+			//            set_token, 使其他请求也能读到本次写入的数据
+			// 访问方式 : public
+			// 返 回 值 : std::string 令牌; 如果没有写入过或者获取失败则返回空字符串
+			//*********************************************************
+			std::string token(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : set_token
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置读写一致性令牌, 之后发送到从服务器的读语句会等待从服务器
+			//            复制到令牌对应的位置
+			// 访问方式 : public
+			// 函数参数 : std::string token 其他会话的 token 返回的令牌
+			//*********************************************************
+			void set_token(std::string token) noexcept;
+
+		private:
+
+			//*********************************************************
+			// 函数名称 : routed_session
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const routed_session &
+			//*********************************************************
+			routed_session(const routed_session &) = delete;
+
+			//*********************************************************
+			// 函数名称 : operator=
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const routed_session &
+			// 返 回 值 : routed_session &
+			//*********************************************************
+			routed_session & operator=(const routed_session &) = delete;
+
+			//*********************************************************
+			// 函数名称 : replica
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 选择从服务器的数据库连接并等待读写一致性令牌
+			// 访问方式 : private
+			// 返 回 值 : const connection * 从服务器的数据库连接; 如果没有可用的从服务器,
+			//            等待令牌超时, 或者写入后无法获取令牌则返回 nullptr
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			const connection * replica(void);
+
+		private:
+			router &m_router; // 路由对象
+			std::unique_ptr<pooled_connection> m_primary; // 主服务器的数据库连接
+			std::unique_ptr<pooled_connection> m_replica; // 从服务器的数据库连接
+			connection_pool *m_replica_pool; // m_replica 所属的连接池
+			bool m_written; // 最后一次获取令牌后是否写入过
+			bool m_pinned; // 写入后无法获取令牌 (例如没有 GTID), 之后的读语句都发送到主服务器
+			bool m_synced; // m_replica 是否已经复制到令牌对应的位置
+			std::string m_token; // 读写一致性令牌
+			balancer::probe m_probe; // 设置了负载均衡对象时记录从服务器上读语句的延迟
+		};
+
+		// 对冲读取的策略
+		// 第一次读取超过最近延迟的 percentile 分位数 (限制在 [min_delay, max_delay] 毫秒之间) 还没有完成时,
+		// 把同一条SQL语句发送到另一个从服务器; 对冲的次数不超过读取次数的 budget 倍, 避免服务器变慢时负载加倍
+		class hedging_policy
+		{
+		public:
+
+			//*********************************************************
+			// 函数名称 : hedging_policy
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数
+			// 访问方式 : public
+			// 函数参数 : double percentile 使用最近延迟的哪个分位数作为对冲的等待时间, 范围为 (0, 1)
+			// 函数参数 : unsigned int min_delay 最短的等待时间 (毫秒)
+			// 函数参数 : unsigned int max_delay 最长的等待时间 (毫秒), 样本不足时使用
+			// 函数参数 : double budget 对冲次数最多占读取次数的比例
+			//*********************************************************
+			explicit hedging_policy(double percentile = 0.95, unsigned int min_delay = 1,
+				unsigned int max_delay = 100, double budget = 0.05) noexcept;
 
-			// 用于将结果集中读取到的数据保存到 tuple 对象中并返回
-			template <typename Tuple>
-			struct data_tuple_getter
-			{
-				//*********************************************************
-				// 函数名称 : get
-				// 作    者 : Gooeen
-				// 完成日期 : 2015/09/16
-				// 函数说明 : 返回从结果集中读取到的数据, 并用 tuple 对象保存
-				// 访问方式 : public
-				// 函数参数 : const recordset & reader 结果集对象
-				// 返 回 值 : Tuple 从结果集中读取到的数据
-				// 异    常 : 如果执行失败则抛出异常
-				//*********************************************************
-				static Tuple get(const recordset &reader)
-				{
-					Tuple t;
-					data_tuple_setter<Tuple, std::tuple_size<Tuple>::value>::set(t, reader);
-					return t;
-				}
-			};
+			//*********************************************************
+			// 函数名称 : percentile
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取作为等待时间的延迟分位数
+			// 访问方式 : public
+			// 返 回 值 : double 分位数
+			//*********************************************************
+			double percentile(void) const noexcept;
 
-			// 用于将结果集中读取到的数据保存到 tuple 对象中并返回
-			template <typename Tuple, size_t Size>
-			struct data_tuple_setter
+			//*********************************************************
+			// 函数名称 : min_delay
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取最短的等待时间
+			// 访问方式 : public
+			// 返 回 值 : std::chrono::milliseconds 等待时间
+			//*********************************************************
+			std::chrono::milliseconds min_delay(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : max_delay
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取最长的等待时间
+			// 访问方式 : public
+			// 返 回 值 : std::chrono::milliseconds 等待时间
+			//*********************************************************
+			std::chrono::milliseconds max_delay(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : budget
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取对冲次数最多占读取次数的比例
+			// 访问方式 : public
+			// 返 回 值 : double 比例
+			//*********************************************************
+			double budget(void) const noexcept;
+
+		private:
+			double m_percentile; // 作为等待时间的延迟分位数
+			unsigned int m_min_delay; // 最短的等待时间 (毫秒)
+			unsigned int m_max_delay; // 最长的等待时间 (毫秒)
+			double m_budget; // 对冲次数最多占读取次数的比例
+		};
+
+		// 对冲读取类
+		// 只对冲 router::is_read 判断为读语句的SQL语句, 其他SQL语句在主服务器上执行;
+		// 第一次读取在调用线程上执行; 客户端库没有异步接口, 所以由一个定时线程在等待时间
+		// 到期时创建线程执行对冲, 不需要对冲的读取不创建线程; 先成功的一次在后台用 KILL QUERY
+		// 取消另一次并且关闭它的连接, 调用线程等待先成功的一次. 例子如下:
+		//     sql::mariadb::hedged_reader reader(route);
+		//     auto users = reader.query_vector<std::tuple<int, std::string>>("select id, name from user");
+		class hedged_reader
+		{
+		public:
+
+			//*********************************************************
+			// 函数名称 : hedged_reader
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数
+			// 访问方式 : public
+			// 函数参数 : router & route 路由对象, 从中选择从服务器
+			// 函数参数 : const hedging_policy & policy 对冲读取的策略
+			//*********************************************************
+			explicit hedged_reader(router &route, const hedging_policy &policy = hedging_policy()) noexcept;
+
+			//*********************************************************
+			// 函数名称 : ~hedged_reader
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 停止定时线程, 等待所有输掉的读取结束
+			// 访问方式 : public
+			//*********************************************************
+			~hedged_reader(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : query
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 执行SQL语句并返回第一行数据, 读语句超过等待时间时发送到另一个从服务器
+			// 访问方式 : public
+			// 函数参数 : const std::string & text SQL语句
+			// 返 回 值 : Tuple 结果集中第一行数据
+			// 异    常 : 如果所有读取都失败则抛出第一次读取的异常
+			//*********************************************************
+			template <typename Tuple>
+			Tuple query(const std::string &text)
 			{
-				//*********************************************************
-				// 函数名称 : set
-				// 作    者 : Gooeen
-				// 完成日期 : 2015/09/16
-				// 函数说明 : 将结果集中读取到的数据保存到指定的参数 t 中
-				// 模板参数 : size_t Size 函数参数 t 的元素数量
-				// 访问方式 : public
-				// 函数参数 : Tuple & t 用于将从结果集中读取到的数据填充到该参数指定位置
-				// 函数参数 : const recordset & reader 结果集对象
-				// 异    常 : 如果执行失败则抛出异常
-				//*********************************************************
-				static void set(Tuple &t, const recordset &reader)
+				// 输掉的一次可能在返回后才结束, 所以结果由共享指针保存
+				const auto results = std::make_shared<std::vector<Tuple>>(2);
+				const auto index = this->run(text, [results, text](const connection &connector, size_t i)
 				{
-					const auto n = Size - 1;
-					std::get<n>(t) = reader.get<std::tuple_element<n, Tuple>::type>(n);
-					data_tuple_setter<Tuple, n>::set(t, reader);
-				}
-			};
+					(*results)[i] = command(connector).query<Tuple>(text);
+				});
+				return std::move((*results)[index]);
+			}
 
-			// 根据提供的带问号的SQL语句和 tuple 对象生成完整的SQL语句
-			// tuple 的元素类型只能是 数 和 std::string 型字符串
-			// 和 std::vector<char> 型和 std::vector<unsigned char> 型缓冲区
+			//*********************************************************
+			// 函数名称 : query_vector
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 执行SQL语句并返回所有数据, 读语句超过等待时间时发送到另一个从服务器
+			// 访问方式 : public
+			// 函数参数 : const std::string & text SQL语句
+			// 返 回 值 : std::vector<Tuple> 结果集中所有数据
+			// 异    常 : 如果所有读取都失败则抛出第一次读取的异常
+			//*********************************************************
 			template <typename Tuple>
-			class statement
+			std::vector<Tuple> query_vector(const std::string &text)
 			{
-			public:
-
-				//*********************************************************
-				// 函数名称 : generate
-				// 作    者 : Gooeen
-				// 完成日期 : 2015/09/16
-				// 函数说明 : 生成SQL语句并保存到 std::vector<char> 对象中
-				// 访问方式 : public
-				// 函数参数 : const command & executer command 对象
-				// 函数参数 : const Type & text SQL语句, std::string 或者 std::vector<char>
-				// 函数参数 : const Tuple & t 数据
-				// 返 回 值 : std::vector<char> 完整的SQL语句
-				// 异    常 : 如果执行失败则抛出 std::exception 异常
-				//*********************************************************
-				template <typename Type>
-				std::vector<char> generate(const command &executer, const Type &text, const Tuple &t)
+				// 输掉的一次可能在返回后才结束, 所以结果由共享指针保存
+				const auto results = std::make_shared<std::vector<std::vector<Tuple>>>(2);
+				const auto index = this->run(text, [results, text](const connection &connector, size_t i)
 				{
-					// 重置最终完整的SQL语句的字节数
-					m_size = text.size();
+					(*results)[i] = command(connector).query_vector<Tuple>(text);
+				});
+				return std::move((*results)[index]);
+			}
 
-					// 减去问号数量
-					m_size -= std::count(text.begin(), text.end(), '?');
+			//*********************************************************
+			// 函数名称 : delay
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取当前的对冲等待时间
+			// 访问方式 : public
+			// 返 回 值 : std::chrono::microseconds 等待时间
+			//*********************************************************
+			std::chrono::microseconds delay(void) const noexcept;
 
-					// 获取转换后的数据并且计算最终完整的SQL语句的字节数
-					std::pair<std::list<std::vector<char>>, size_t> datas = statement_escape<Tuple, std::tuple_size<Tuple>::value>::escape(executer, t);
+			//*********************************************************
+			// 函数名称 : reads
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取发送到从服务器的读取次数
+			// 访问方式 : public
+			// 返 回 值 : unsigned long long 次数
+			//*********************************************************
+			unsigned long long reads(void) const noexcept;
 
-					// 加上字符数
-					m_size += datas.second;
+			//*********************************************************
+			// 函数名称 : hedges
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取对冲的次数
+			// 访问方式 : public
+			// 返 回 值 : unsigned long long 次数
+			//*********************************************************
+			unsigned long long hedges(void) const noexcept;
 
-					// 用于保存最终完整的SQL语句
-					std::vector<char> data(m_size);
+		private:
+			typedef std::function<void(const connection &connector, size_t index)> work;
+			struct race; // 一次对冲读取的共享状态
 
-					// 用于赋值操作
-					auto vect_iter = data.begin();
-					auto list_iter = datas.first.begin();
+			//*********************************************************
+			// 函数名称 : hedged_reader
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const hedged_reader &
+			//*********************************************************
+			hedged_reader(const hedged_reader &) = delete;
 
-					// 生成SQL语句
-					for (auto ch : text)
-					{
-						// 如果不等于问号则直接复制字符
-						if (ch != '?')
-						{
-							*vect_iter = ch;
-							++vect_iter;
-						}
-						// 如果等于问号则复制数据
-						else
-						{
-							const auto p = data.data() + (vect_iter - data.begin());
-							std::memcpy(p, list_iter->data(), list_iter->size());
-							vect_iter += list_iter->size();
-							++list_iter;
-						}
-					}
+			//*********************************************************
+			// 函数名称 : operator=
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const hedged_reader &
+			// 返 回 值 : hedged_reader &
+			//*********************************************************
+			hedged_reader & operator=(const hedged_reader &) = delete;
 
-					return data;
-				}
+			//*********************************************************
+			// 函数名称 : run
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 在调用线程上执行 task, 等待时间到期时由定时线程在第二个从服务器上
+			//            再执行一次; 第一次失败时在调用线程上立即对冲
+			// 访问方式 : private
+			// 函数参数 : const std::string & text SQL语句
+			// 函数参数 : const work & task 在数据库连接上执行SQL语句并保存第 index 次的结果
+			// 返 回 值 : size_t 先成功的是第几次 (0 或者 1)
+			// 异    常 : 如果所有读取都失败则抛出第一次读取的异常
+			//*********************************************************
+			size_t run(const std::string &text, const work &task);
 
-			private:
-				size_t m_size; // 最终完整的SQL语句的字节数
-			};
+			//*********************************************************
+			// 函数名称 : claim
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 如果还没有结果、还没有对冲并且没有超过对冲预算, 则占用第二次读取
+			// 访问方式 : private
+			// 函数参数 : const std::shared_ptr<race> & state 共享状态
+			// 返 回 值 : bool 如果占用成功返回true, 调用者负责执行第二次读取; 反之返回false
+			//*********************************************************
+			bool claim(const std::shared_ptr<race> &state) noexcept;
 
-			// 根据提供的带问号的SQL语句和 tuple 对象生成完整的SQL语句
-			// tuple 的元素类型只能是 数 和 std::string 型字符串
-			// 和 std::vector<char> 型和 std::vector<unsigned char> 型缓冲区
-			template <typename Tuple, size_t size>
-			class statement_escape
-			{
-			private:
+			//*********************************************************
+			// 函数名称 : schedule
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 定时线程, 等待时间到期时为还没有结果的读取创建对冲线程
+			// 访问方式 : private
+			//*********************************************************
+			void schedule(void) noexcept;
 
-				//*********************************************************
-				// 函数名称 : escape_buffer
-				// 作    者 : Gooeen
-				// 完成日期 : 2015/09/16
-				// 函数说明 : 将数转换成字符串并保存到 std::vector<char> 对象中
-				// 访问方式 : public
-				// 函数参数 : const command & command 对象
-				// 函数参数 : Type type 数
-				// 返 回 值 : std::vector<char> 字符串形式的数字
-				// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
-				//            如果执行失败则抛出 std::exception 异常
-				//*********************************************************
-				template <typename Type>
-				static std::vector<char> escape_buffer(const command &, Type type)
-				{
-					const auto text = std::to_string(type);
-					return std::vector<char>(text.begin(), text.end());
-				}
+			//*********************************************************
+			// 函数名称 : hedge
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 对冲线程, 执行第二次读取
+			// 访问方式 : private
+			// 函数参数 : std::shared_ptr<race> state 共享状态
+			//*********************************************************
+			void hedge(std::shared_ptr<race> state) noexcept;
 
-				//*********************************************************
-				// 函数名称 : escape_buffer
-				// 作    者 : Gooeen
-				// 完成日期 : 2015/09/16
-				// 函数说明 : 转换数据
-				// 访问方式 : public
-				// 函数参数 : const command & executer command 对象
-				// 函数参数 : const std::string & data 字符串
-				// 返 回 值 : std::vector<char> 字符串形式的数字
-				// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
-				//            如果执行失败则抛出 std::exception 异常
-				//*********************************************************
-				static std::vector<char> escape_buffer(const command &executer, const std::string &data)
-				{
-					return executer.escape_buffer_with_quote(data.c_str(), data.size());
-				}
+			//*********************************************************
+			// 函数名称 : attempt
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 在当前线程中执行第 index 次读取; 第二次读取选择另一个从服务器
+			// 访问方式 : private
+			// 函数参数 : const std::shared_ptr<race> & state 共享状态
+			// 函数参数 : size_t index 第几次读取
+			//*********************************************************
+			void attempt(const std::shared_ptr<race> &state, size_t index) noexcept;
 
-				//*********************************************************
-				// 函数名称 : escape_buffer
-				// 作    者 : Gooeen
-				// 完成日期 : 2015/09/16
-				// 函数说明 : 转换数据
-				// 访问方式 : public
-				// 函数参数 : const command & executer command 对象
-				// 函数参数 : const std::vector<char> & data 数据
-				// 返 回 值 : std::vector<char> 字符串形式的数字
-				// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
-				//            如果执行失败则抛出 std::exception 异常
-				//*********************************************************
-				static std::vector<char> escape_buffer(const command &executer, const std::vector<char> &data)
-				{
-					return executer.escape_buffer_with_quote(data.data(), data.size());
-				}
+			//*********************************************************
+			// 函数名称 : record
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 记录成功的读取的延迟, 并定期重新计算对冲等待时间
+			// 访问方式 : private
+			// 函数参数 : std::chrono::nanoseconds elapsed 延迟
+			//*********************************************************
+			void record(std::chrono::nanoseconds elapsed) noexcept;
 
-				//*********************************************************
-				// 函数名称 : escape_buffer
-				// 作    者 : Gooeen
-				// 完成日期 : 2015/09/16
-				// 函数说明 : 转换数据
-				// 访问方式 : public
-				// 函数参数 : const command & executer command 对象
-				// 函数参数 : const std::vector<unsigned char> & data 数据
-				// 返 回 值 : std::vector<char> 字符串形式的数字
-				// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
-				//            如果执行失败则抛出 std::exception 异常
-				//*********************************************************
-				static std::vector<char> escape_buffer(const command &executer, const std::vector<unsigned char> &data)
-				{
-					return executer.escape_buffer_with_quote((const char *)data.data(), data.size());
-				}
+		private:
+			router &m_router; // 路由对象
+			hedging_policy m_policy; // 对冲读取的策略
+			std::vector<double> m_samples; // 最近成功的读取的延迟 (微秒), 环形缓冲区
+			size_t m_next_sample; // 下一个样本写入的位置
+			std::chrono::microseconds m_delay; // 当前的对冲等待时间
+			unsigned long long m_reads; // 发送到从服务器的读取次数
+			unsigned long long m_hedges; // 对冲的次数
+			size_t m_outstanding; // 还没有结束的对冲线程数
+			std::multimap<std::chrono::steady_clock::time_point, std::weak_ptr<race>> m_deadlines; // 等待对冲的读取
+			bool m_stop; // 是否停止定时线程
+			std::thread m_timer; // 定时线程, 第一次读取时创建
+			mutable std::mutex m_mutex; // 保护以上成员
+			std::condition_variable m_finished; // 对冲线程结束时通知析构函数
+			std::condition_variable m_wakeup; // 添加等待对冲的读取或者停止时通知定时线程
+		};
 
-			public:
+		// 数据库事务类
+		// 构造时开始事务, 析构时如果没有提交则自动回滚, 例子如下:
+		//     sql::mariadb::transaction scope(connector);
+		//     sql::mariadb::command(connector).execute_reader("update account set money = money - 1 where id = 1");
+		//     scope.commit();
+		class transaction
+		{
+		public:
 
-				//*********************************************************
-				// 函数名称 : escape
-				// 作    者 : Gooeen
-				// 完成日期 : 2015/09/16
-				// 函数说明 : 将 t 所保存的数据进行转化后保存到 list 对象中
-				// 访问方式 : public
-				// 函数参数 : const command & executer command 对象
-				// 函数参数 : const Tuple & t 数据
-				// 返 回 值 : std::list<std::vector<char>> 转化后的数据
-				// 异    常 : 如果执行失败则抛出 std::exception 异常
-				//*********************************************************
-				static std::pair<std::list<std::vector<char>>, size_t> escape(const command &executer, const Tuple &t)
-				{
-					// 保存数据
-					std::pair<std::list<std::vector<char>>, size_t> datas = escape<size - 1>(executer, t);
-					datas.first.push_back(escape_buffer(executer, std::get<size - 1>(t)));
+			//*********************************************************
+			// 函数名称 : transaction
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数, 开始事务
+			// 访问方式 : public
+			// 函数参数 : const connection & connector 数据库连接, 不能已经在事务中
+			// 异    常 : 如果开始事务失败则抛出 mariadb_exception 异常
+			//*********************************************************
+			explicit transaction(const connection &connector);
 
-					// 添加字节数
-					datas.second += datas.first.back().size();
+			//*********************************************************
+			// 函数名称 : transaction
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 转移构造函数, 转移后原对象不应该使用
+			// 访问方式 : public
+			// 函数参数 : transaction && scope 需要转移的对象
+			//*********************************************************
+			transaction(transaction &&scope) noexcept;
 
-					return datas;
-				}
-			};
+			//*********************************************************
+			// 函数名称 : ~transaction
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 如果事务没有提交或者回滚则在析构时自动回滚
+			// 访问方式 : public
+			//*********************************************************
+			~transaction(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : commit
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 提交事务
+			// 访问方式 : public
+			// 异    常 : 如果提交失败则抛出 mariadb_exception 异常, 事务已经结束
+			//*********************************************************
+			void commit(void);
+
+			//*********************************************************
+			// 函数名称 : rollback
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 回滚事务
+			// 访问方式 : public
+			// 返 回 值 : bool 如果回滚成功返回true; 反之返回false
+			//*********************************************************
+			bool rollback(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : active
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 判断事务是否还没有提交或者回滚
+			// 访问方式 : public
+			// 返 回 值 : bool 如果还没有结束返回true; 反之返回false
+			//*********************************************************
+			bool active(void) const noexcept;
 
 		private:
 
 			//*********************************************************
-			// 函数名称 : command
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
+			// 函数名称 : transaction
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
 			// 函数说明 : 禁止复制
 			// 访问方式 : private
-			// 函数参数 : const command &
+			// 函数参数 : const transaction &
 			//*********************************************************
-			command(const command &) = delete;
+			transaction(const transaction &) = delete;
 
 			//*********************************************************
 			// 函数名称 : operator=
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
 			// 函数说明 : 禁止复制
 			// 访问方式 : private
-			// 函数参数 : const command &
-			// 返 回 值 : command &
+			// 函数参数 : const transaction &
+			// 返 回 值 : transaction &
 			//*********************************************************
-			command & operator=(const command &) = delete;
+			transaction & operator=(const transaction &) = delete;
 
-		private:
-			friend recordset;
-			typedef std::pair<const char *, unsigned long> byte_data; // 数据开始位置和大小
-			typedef std::pair<bool, byte_data> alnum_data; // 是否一个数和数据
+			//*********************************************************
+			// 函数名称 : control
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 执行事务控制语句
+			// 访问方式 : private
+			// 函数参数 : const char * text SQL语句
+			// 异    常 : 如果执行失败则抛出 mariadb_exception 异常
+			//*********************************************************
+			void control(const char *text) const;
 
-			MYSQL *m_ptr_mysql; // MariaDB 数据库句柄
-			std::string m_text; // SQL语句
-			std::list<std::shared_ptr<std::string>> m_strings; // 保存字符串数据
-			std::list<std::shared_ptr<std::vector<char>>> m_datas; // 保存数据
-			std::list<std::shared_ptr<std::vector<unsigned char>>> m_udatas; // 保存数据
-			std::map<unsigned int, alnum_data> m_parameters; // 保存SQL语句的数据
+		private:
+			const connection *m_ptr_connection; // 数据库连接
+			bool m_active; // 事务是否还没有提交或者回滚
 		};
 
-		// 用于将结果集中读取到的数据保存到 tuple 对象中并返回
-		template <typename Tuple>
-		struct command::data_tuple_setter<Tuple, 1>
+		// 合并提交类
+		// 多个线程提交的小写入单元由一个后台线程放在同一个事务中执行, 每隔 interval 毫秒
+		// 或者积累了 max_batch 个单元时提交一次, 多个单元只需要服务器刷新一次日志;
+		// 每个单元在自己的保存点中执行, 失败时只回滚该单元, 例子如下:
+		//     sql::mariadb::group_commit batcher(pool);
+		//     auto done = batcher.submit([](const sql::mariadb::connection &c)
+		//     {
+		//         sql::mariadb::command(c).execute_reader("insert into log values(1)");
+		//     });
+		//     done.get(); // 提交后返回, 失败时抛出异常
+		class group_commit
 		{
+		public:
+			typedef std::function<void(const connection &connector)> unit; // 写入单元, 失败时需要抛出异常
+
 			//*********************************************************
-			// 函数名称 : set
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 将结果集中读取到的数据保存到指定的参数 t 中
-			// 模板参数 : size_t Size 函数参数 t 的元素数量
+			// 函数名称 : group_commit
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数, 创建后台线程
 			// 访问方式 : public
-			// 函数参数 : Tuple & t 用于将从结果集中读取到的数据填充到该参数指定位置
-			// 函数参数 : const recordset & reader 结果集对象
-			// 异    常 : 如果执行失败则抛出异常
+			// 函数参数 : connection_pool & pool 连接池, 后台线程每次提交借出一个连接
+			// 函数参数 : unsigned int interval 第一个单元最多等待多少毫秒后提交
+			// 函数参数 : size_t max_batch 一次最多提交多少个单元
+			// 异    常 : 如果创建线程失败则抛出 std::system_error 异常
 			//*********************************************************
-			static void set(Tuple &t, const sql::mariadb::recordset &reader)
+			explicit group_commit(connection_pool &pool, unsigned int interval = 2, size_t max_batch = 64);
+
+			//*********************************************************
+			// 函数名称 : ~group_commit
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 提交剩余的单元并结束后台线程
+			// 访问方式 : public
+			//*********************************************************
+			~group_commit(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : submit
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 提交一个写入单元
+			// 访问方式 : public
+			// 函数参数 : unit work 写入单元, 在后台线程中执行
+			// 返 回 值 : std::future<void> 事务提交后就绪; 单元或者提交失败时 get 抛出异常
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			std::future<void> submit(unit work);
+
+		private:
+
+			// 等待提交的写入单元
+			struct entry
 			{
-				std::get<0>(t) = reader.get<std::tuple_element<0, Tuple>::type>(0);
-			}
+				unit work; // 写入单元
+				std::promise<void> done; // 提交的结果
+			};
+
+			//*********************************************************
+			// 函数名称 : group_commit
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const group_commit &
+			//*********************************************************
+			group_commit(const group_commit &) = delete;
+
+			//*********************************************************
+			// 函数名称 : operator=
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const group_commit &
+			// 返 回 值 : group_commit &
+			//*********************************************************
+			group_commit & operator=(const group_commit &) = delete;
+
+			//*********************************************************
+			// 函数名称 : run
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 后台线程, 收集写入单元并提交
+			// 访问方式 : private
+			//*********************************************************
+			void run(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : flush
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 在一个事务中执行所有写入单元并提交, 然后通知每个单元的结果
+			// 访问方式 : private
+			// 函数参数 : std::vector<entry> & batch 写入单元
+			//*********************************************************
+			void flush(std::vector<entry> &batch) noexcept;
+
+		private:
+			connection_pool &m_pool; // 连接池
+			std::chrono::milliseconds m_interval; // 第一个单元最多等待多久后提交
+			size_t m_max_batch; // 一次最多提交多少个单元
+			std::vector<entry> m_queue; // 等待提交的写入单元
+			bool m_stop; // 是否结束后台线程
+			std::mutex m_mutex; // 保护以上成员
+			std::condition_variable m_changed; // 有新单元或者结束时通知后台线程
+			std::thread m_thread; // 后台线程
 		};
 
-		// 根据提供的带问号的SQL语句和 tuple 对象生成完整的SQL语句
-		// tuple 的元素类型只能是 数 和 std::string 型字符串
-		// 和 std::vector<char> 型和 std::vector<unsigned char> 型缓冲区
-		template <typename Tuple>
-		class command::statement_escape<Tuple, 1>
+		// 客户端慢查询日志类
+		// 耗时超过阈值的SQL语句由后台线程写入日志文件, 每行一个 JSON 对象, 文件超过大小后轮转;
+		// 按比例抽样的语句在另一个连接上执行 EXPLAIN FORMAT=JSON 并把执行计划一起写入, 例子如下:
+		//     sql::mariadb::slow_query_log log("slow.log", std::chrono::milliseconds(200));
+		//     log.set_explain(point, 0.1);
+		//     connector.set_observer(&log);
+		// 设置函数可以在任何时候调用, 从后台线程写下一批记录时开始生效
+		class slow_query_log : public statement_observer
 		{
-		private:
+		public:
 
 			//*********************************************************
-			// 函数名称 : escape_buffer
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 将数转换成字符串并保存到 std::vector<char> 对象中
+			// 函数名称 : slow_query_log
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 构造函数, 启动写日志的后台线程
 			// 访问方式 : public
-			// 函数参数 : const command & command 对象
-			// 函数参数 : Type type 数
-			// 返 回 值 : std::vector<char> 字符串形式的数字
+			// 函数参数 : std::string path 日志文件路径, 轮转后的文件为 path.1, path.2, ...
+			// 函数参数 : std::chrono::microseconds threshold 耗时不小于该值的SQL语句写入日志
 			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
-			//            如果执行失败则抛出 std::exception 异常
+			//            如果创建线程失败则抛出 std::system_error 异常
 			//*********************************************************
-			template <typename Type>
-			static std::vector<char> escape_buffer(const command &, Type type)
-			{
-				const auto text = std::to_string(type);
-				return std::vector<char>(text.begin(), text.end());
-			}
+			slow_query_log(std::string path, std::chrono::microseconds threshold);
 
 			//*********************************************************
-			// 函数名称 : escape_buffer
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 转换数据
+			// 函数名称 : ~slow_query_log
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 写完队列中的记录后结束后台线程
 			// 访问方式 : public
-			// 函数参数 : const command & executer command 对象
-			// 函数参数 : const std::string & data 字符串
-			// 返 回 值 : std::vector<char> 字符串形式的数字
-			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
-			//            如果执行失败则抛出 std::exception 异常
 			//*********************************************************
-			static std::vector<char> escape_buffer(const command &executer, const std::string &data)
-			{
-				return executer.escape_buffer_with_quote(data.c_str(), data.size());
-			}
+			~slow_query_log(void) noexcept;
 
 			//*********************************************************
-			// 函数名称 : escape_buffer
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 转换数据
+			// 函数名称 : set_redact
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置是否隐藏SQL语句中的数据; 隐藏时不写入完整的SQL语句,
+			//            只写入指纹, 执行计划中的条件也可能包含数据, 需要时请同时关闭 EXPLAIN
 			// 访问方式 : public
-			// 函数参数 : const command & executer command 对象
-			// 函数参数 : const std::vector<char> & data 数据
-			// 返 回 值 : std::vector<char> 字符串形式的数字
-			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
-			//            如果执行失败则抛出 std::exception 异常
+			// 函数参数 : bool enable 是否隐藏
 			//*********************************************************
-			static std::vector<char> escape_buffer(const command &executer, const std::vector<char> &data)
-			{
-				return executer.escape_buffer_with_quote(data.data(), data.size());
-			}
+			void set_redact(bool enable) noexcept;
 
 			//*********************************************************
-			// 函数名称 : escape_buffer
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 转换数据
+			// 函数名称 : set_explain
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置抽样执行 EXPLAIN FORMAT=JSON; 只对 SELECT/UPDATE/DELETE 语句执行,
+			//            EXPLAIN 不会执行语句本身; 在后台线程中使用另一个连接, 不阻塞调用线程
 			// 访问方式 : public
-			// 函数参数 : const command & executer command 对象
-			// 函数参数 : const std::vector<unsigned char> & data 数据
-			// 返 回 值 : std::vector<char> 字符串形式的数字
-			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常;
-			//            如果执行失败则抛出 std::exception 异常
+			// 函数参数 : const endpoint & point 执行 EXPLAIN 的服务器参数
+			// 函数参数 : double rate 抽样比例, 范围为 [0, 1], 0 代表不执行
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
 			//*********************************************************
-			static std::vector<char> escape_buffer(const command &executer, const std::vector<unsigned char> &data)
-			{
-				return executer.escape_buffer_with_quote((const char *)data.data(), data.size());
-			}
+			void set_explain(const endpoint &point, double rate);
 
-		public:
+			//*********************************************************
+			// 函数名称 : set_rotation
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置日志文件轮转
+			// 访问方式 : public
+			// 函数参数 : unsigned long long max_bytes 文件超过该大小后轮转, 0 代表不轮转
+			// 函数参数 : unsigned int max_files 最多保留多少个轮转后的文件
+			//*********************************************************
+			void set_rotation(unsigned long long max_bytes, unsigned int max_files) noexcept;
 
 			//*********************************************************
-			// 函数名称 : escape
-			// 作    者 : Gooeen
-			// 完成日期 : 2015/09/16
-			// 函数说明 : 将 t 所保存的数据进行转化后保存到 list 对象中
+			// 函数名称 : set_capacity
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 设置队列中最多等待写入的记录数, 队列满时丢弃新的记录
 			// 访问方式 : public
-			// 函数参数 : const command & executer command 对象
-			// 函数参数 : const Tuple & t 数据
-			// 返 回 值 : std::list<std::vector<char>> 转化后的数据
-			// 异    常 : 如果执行失败则抛出 std::exception 异常
+			// 函数参数 : size_t capacity 最多等待写入的记录数
 			//*********************************************************
-			static std::pair<std::list<std::vector<char>>, size_t> escape(const command &executer, const Tuple &t)
+			void set_capacity(size_t capacity) noexcept;
+
+			//*********************************************************
+			// 函数名称 : flush
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 等待队列中的记录全部写入文件
+			// 访问方式 : public
+			//*********************************************************
+			void flush(void);
+
+			//*********************************************************
+			// 函数名称 : dropped
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 获取因为队列满而丢弃的记录数
+			// 访问方式 : public
+			// 返 回 值 : unsigned long long 丢弃的记录数
+			//*********************************************************
+			unsigned long long dropped(void) const noexcept;
+
+			//*********************************************************
+			// 函数名称 : on_begin
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 开始执行SQL语句前调用, 不做任何事
+			// 访问方式 : public
+			// 函数参数 : statement_event & event 事件
+			//*********************************************************
+			virtual void on_begin(statement_event &event) noexcept override;
+
+			//*********************************************************
+			// 函数名称 : on_end
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : SQL语句结束后调用, 耗时超过阈值时放入队列
+			// 访问方式 : public
+			// 函数参数 : const statement_event & event 事件
+			//*********************************************************
+			virtual void on_end(const statement_event &event) noexcept override;
+
+		private:
+
+			// 等待写入的一条记录
+			struct entry
 			{
-				// 保存数据
-				std::pair<std::list<std::vector<char>>, size_t> datas;
-				datas.first.push_back(escape_buffer(executer, std::get<0>(t)));
+				std::chrono::system_clock::time_point time; // 结束时间
+				statement_event event; // 执行SQL语句的事件
+			};
 
-				// 添加字节数
-				datas.second = datas.first.back().size();
+			// 日志设置, 后台线程每写一批记录前在锁内复制一份
+			struct settings
+			{
+				bool redact; // 是否隐藏SQL语句中的数据
+				std::shared_ptr<const endpoint> ptr_endpoint; // 执行 EXPLAIN 的服务器参数, 不执行时为 nullptr
+				double explain_rate; // 执行 EXPLAIN 的抽样比例
+				unsigned long long max_bytes; // 文件超过该大小后轮转, 0 代表不轮转
+				unsigned int max_files; // 最多保留多少个轮转后的文件
+			};
 
-				return datas;
-			}
+			//*********************************************************
+			// 函数名称 : slow_query_log
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const slow_query_log &
+			//*********************************************************
+			slow_query_log(const slow_query_log &) = delete;
+
+			//*********************************************************
+			// 函数名称 : operator=
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 禁止复制
+			// 访问方式 : private
+			// 函数参数 : const slow_query_log &
+			// 返 回 值 : slow_query_log &
+			//*********************************************************
+			slow_query_log & operator=(const slow_query_log &) = delete;
+
+			//*********************************************************
+			// 函数名称 : run
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 后台线程, 取出队列中的记录写入文件
+			// 访问方式 : private
+			//*********************************************************
+			void run(void) noexcept;
+
+			//*********************************************************
+			// 函数名称 : write
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 把一条记录格式化成 JSON 并写入文件, 需要时执行 EXPLAIN 和轮转
+			// 访问方式 : private
+			// 函数参数 : const entry & record 记录
+			// 函数参数 : const settings & config 日志设置
+			// 异    常 : 如果分配资源失败则抛出 std::bad_alloc 异常
+			//*********************************************************
+			void write(const entry &record, const settings &config);
+
+			//*********************************************************
+			// 函数名称 : explain
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 在另一个连接上执行 EXPLAIN FORMAT=JSON; 服务器参数改变时先关闭原来的连接
+			// 访问方式 : private
+			// 函数参数 : const std::string & text SQL语句
+			// 函数参数 : const std::shared_ptr<const endpoint> & point 执行 EXPLAIN 的服务器参数
+			// 返 回 值 : std::string 执行计划 (JSON); 失败时返回空字符串
+			//*********************************************************
+			std::string explain(const std::string &text, const std::shared_ptr<const endpoint> &point) noexcept;
+
+			//*********************************************************
+			// 函数名称 : rotate
+			// 作    者 : agent
+			// 完成日期 : 2026/10/19
+			// 函数说明 : 关闭日志文件, 把 path.n 改名为 path.n+1, path 改名为 path.1, 然后打开新文件
+			// 访问方式 : private
+			// 函数参数 : unsigned int max_files 最多保留多少个轮转后的文件
+			//*********************************************************
+			void rotate(unsigned int max_files) noexcept;
+
+		private:
+			std::string m_path; // 日志文件路径
+			std::chrono::microseconds m_threshold; // 慢查询的阈值
+			std::unique_ptr<connection> m_ptr_explainer; // 执行 EXPLAIN 的连接, 只在后台线程中使用
+			std::shared_ptr<const endpoint> m_ptr_explained; // m_ptr_explainer 连接的服务器参数, 只在后台线程中使用
+			std::unique_ptr<std::ofstream> m_ptr_file; // 日志文件, 只在后台线程中使用
+			unsigned long long m_file_size; // 当前日志文件的大小, 只在后台线程中使用
+			std::atomic<unsigned long long> m_dropped; // 丢弃的记录数
+			settings m_settings; // 日志设置
+			size_t m_capacity; // 队列中最多等待写入的记录数
+			std::vector<entry> m_queue; // 等待写入的记录
+			size_t m_writing; // 后台线程正在写入的记录数
+			bool m_stop; // 是否结束后台线程
+			std::mutex m_mutex; // 保护以上五个成员
+			std::condition_variable m_changed; // 有新记录或者结束时通知后台线程
+			std::condition_variable m_drained; // 队列中的记录写完时通知 flush
+			std::thread m_thread; // 后台线程
 		};
+
+		//*********************************************************
+		// 函数名称 : run_in_transaction
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 在事务中执行 unit 并提交; unit 或者提交抛出可以重试的 mariadb_exception 异常时
+		//            回滚并等待一段时间后重新执行整个 unit, 所以 unit 可能被执行多次. 例子如下:
+		//            sql::mariadb::run_in_transaction(connector, [&](const sql::mariadb::connection &c)
+		//            {
+		//                sql::mariadb::command(c).execute_reader("update account set money = money - 1 where id = 1");
+		//            });
+		// 访问方式 : public
+		// 函数参数 : const connection & connector 数据库连接, 调用前不能在事务中
+		// 函数参数 : const std::function<void(const connection&)> & unit 事务中执行的操作, 失败时需要抛出异常
+		// 函数参数 : const retry_policy & policy 重试的策略
+		// 异    常 : 如果不能重试或者重试次数用完则抛出最后一次的异常; unit 抛出的其他异常回滚后直接抛出
+		//*********************************************************
+		void run_in_transaction(const connection &connector,
+			const std::function<void(const connection &)> &unit, const retry_policy &policy = retry_policy());
 	}
 }
 
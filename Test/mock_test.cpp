@@ -0,0 +1,484 @@
+﻿//*********************************************************
+// 文件名称 : mock_test.cpp
+// 作    者 : agent
+// 完成日期 : 2026/10/19
+// 文件说明 : 通过本机的模拟服务器 (Benchmark/mock_server.h) 检查需要服务器配合的行为:
+//            断开后重新连接并恢复会话变量, 流水线中一条SQL语句失败不影响其他SQL语句,
+//            写入后读语句固定发送到主服务器, 对冲读取取消输掉的一次, 合并提交中每个单元的结果;
+//            不需要真实的数据库服务器, 只支持 POSIX;
+//            使用方法:
+//            mock_test
+//            全部通过时返回 0, 否则输出失败的检查并返回 1
+//*********************************************************
+
+#include "../LibMariaDbConnectivity/mariadb.h"
+#include "../Benchmark/mock_server.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <future>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+	unsigned int failures = 0; // 失败的检查数量
+
+
+	//*********************************************************
+	// 函数名称 : check
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 检查条件, 不成立时输出信息并计入失败
+	// 函数参数 : bool condition 条件
+	// 函数参数 : const char * message 检查的内容
+	//*********************************************************
+	void check(bool condition, const char *message)
+	{
+		if (!condition)
+		{
+			std::printf("    FAILED: %s\n", message);
+			++failures;
+		}
+	}
+
+
+	// 模拟服务器收到的SQL语句, 处理函数可能在多个线程中同时调用
+	class journal
+	{
+	public:
+
+		//*********************************************************
+		// 函数名称 : add
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 记录一条SQL语句
+		// 访问方式 : public
+		// 函数参数 : const std::string & query SQL语句
+		//*********************************************************
+		void add(const std::string &query)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_queries.push_back(query);
+		}
+
+		//*********************************************************
+		// 函数名称 : all
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 获取按顺序收到的所有SQL语句
+		// 访问方式 : public
+		// 返 回 值 : std::vector<std::string> SQL语句
+		//*********************************************************
+		std::vector<std::string> all(void) const
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_queries;
+		}
+
+		//*********************************************************
+		// 函数名称 : count
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 获取以 prefix 开头的SQL语句数量
+		// 访问方式 : public
+		// 函数参数 : const std::string & prefix 开头的字符串
+		// 返 回 值 : size_t 数量
+		//*********************************************************
+		size_t count(const std::string &prefix) const
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return (size_t)std::count_if(m_queries.begin(), m_queries.end(), [&prefix](const std::string &query)
+			{
+				return query.compare(0, prefix.size(), prefix) == 0;
+			});
+		}
+
+		//*********************************************************
+		// 函数名称 : last
+		// 作    者 : agent
+		// 完成日期 : 2026/10/19
+		// 函数说明 : 获取最后收到的SQL语句
+		// 访问方式 : public
+		// 返 回 值 : std::string SQL语句, 没有时返回空字符串
+		//*********************************************************
+		std::string last(void) const
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			return m_queries.empty() ? std::string() : m_queries.back();
+		}
+
+	private:
+		mutable std::mutex m_mutex; // 保护 m_queries
+		std::vector<std::string> m_queries; // 收到的SQL语句
+	};
+
+
+	//*********************************************************
+	// 函数名称 : replica_status
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 从服务器对 SHOW SLAVE STATUS 的响应, 复制延迟为 0 秒
+	// 返 回 值 : sql::mariadb::mock_result 响应
+	//*********************************************************
+	sql::mariadb::mock_result replica_status(void)
+	{
+		return sql::mariadb::mock_result::rows({ "Seconds_Behind_Master" }, { { "0" } });
+	}
+
+
+	//*********************************************************
+	// 函数名称 : test_reconnect_replay
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 连接断开后读语句重新连接, 先恢复会话变量再执行一次;
+	//            写语句不重复执行
+	//*********************************************************
+	void test_reconnect_replay(void)
+	{
+		journal log;
+		std::atomic<unsigned int> drops(0);
+		sql::mariadb::mock_server server([&log, &drops](const std::string &query)
+		{
+			log.add(query);
+			if ((query == "select 'replay'" && drops++ == 0) || query == "insert into t values(1)")
+			{
+				return sql::mariadb::mock_result::disconnect();
+			}
+			if (query == "select 'replay'")
+			{
+				return sql::mariadb::mock_result::rows({ "v" }, { { "replayed" } });
+			}
+			return sql::mariadb::mock_result::ok(0);
+		});
+
+		sql::mariadb::connection connector;
+		check(connector.open("test", "test", "test", server.port(), "127.0.0.1"), "connect");
+		connector.set_reconnect(sql::mariadb::reconnect_policy(3, 1, 10));
+		check(connector.set_session_variable("sql_mode", "'ANSI'"), "set session variable");
+
+		const sql::mariadb::command executer(connector);
+		std::string value;
+		try
+		{
+			value = std::get<0>(executer.query<std::tuple<std::string>>("select 'replay'"));
+		}
+		catch (const std::exception &e)
+		{
+			std::printf("    %s\n", e.what());
+		}
+		check(value == "replayed", "read statement is executed again after reconnecting");
+
+		// 断开后的第一条语句之后应该先恢复会话变量, 再执行第二次
+		const auto queries = log.all();
+		const auto first = std::find(queries.begin(), queries.end(), "select 'replay'");
+		const auto restore = std::find(first, queries.end(), "SET @@session.sql_mode = 'ANSI'");
+		const auto second = first == queries.end() ? queries.end() : std::find(first + 1, queries.end(), "select 'replay'");
+		check(restore != queries.end() && second != queries.end() && restore < second, "session variable is restored before the replay");
+
+		check(!executer.execute("insert into t values(1)"), "write statement fails after the connection is lost");
+		check(log.count("insert into t values(1)") == 1, "write statement is not executed again");
+	}
+
+
+	//*********************************************************
+	// 函数名称 : test_pipeline_isolation
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 流水线中失败的SQL语句只影响自己的结果, 之后的SQL语句和连接都可以继续使用
+	//*********************************************************
+	void test_pipeline_isolation(void)
+	{
+		sql::mariadb::mock_server server([](const std::string &query)
+		{
+			if (query == "select missing")
+			{
+				return sql::mariadb::mock_result::error(1146, "42S02", "Table 'test.missing' doesn't exist");
+			}
+			if (query == "select 2")
+			{
+				return sql::mariadb::mock_result::rows({ "n" }, { { "2" } });
+			}
+			return sql::mariadb::mock_result::ok(1);
+		});
+
+		sql::mariadb::connection connector;
+		check(connector.open("test", "test", "test", server.port(), "127.0.0.1"), "connect");
+
+		sql::mariadb::pipeline executer(connector);
+		auto first = executer.add_execute("insert into t values(1)");
+		auto broken = executer.add_query_vector<std::tuple<int>>("select missing");
+		auto last = executer.add_query_vector<std::tuple<int>>("select 2");
+		check(executer.run() == 2, "two of three statements succeed");
+
+		check(first.get() == 1, "statement before the failure keeps its result");
+
+		auto thrown = false;
+		try
+		{
+			broken.get();
+		}
+		catch (const sql::mariadb::mariadb_exception &)
+		{
+			thrown = true;
+		}
+		check(thrown, "failed statement reports its error");
+
+		const auto rows = last.get();
+		check(rows.size() == 1 && std::get<0>(rows[0]) == 2, "statement after the failure keeps its result");
+		check(std::get<0>(sql::mariadb::command(connector).query<std::tuple<int>>("select 2")) == 2, "connection is usable after the pipeline");
+	}
+
+
+	//*********************************************************
+	// 函数名称 : test_router_stickiness
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 写入后无法获取 GTID 时, 该会话之后的读语句都发送到主服务器;
+	//            没有写入的会话继续读取从服务器
+	//*********************************************************
+	void test_router_stickiness(void)
+	{
+		journal primary_log, replica_log;
+		sql::mariadb::mock_server primary([&primary_log](const std::string &query)
+		{
+			primary_log.add(query);
+			if (query == "SELECT @@last_gtid")
+			{
+				// 没有启用 GTID
+				return sql::mariadb::mock_result::rows({ "@@last_gtid" }, { { sql::mariadb::mock_cell() } });
+			}
+			if (query.compare(0, 7, "select ") == 0)
+			{
+				return sql::mariadb::mock_result::rows({ "server" }, { { "primary" } });
+			}
+			return sql::mariadb::mock_result::ok(1);
+		});
+		sql::mariadb::mock_server replica([&replica_log](const std::string &query)
+		{
+			if (query == "SHOW SLAVE STATUS")
+			{
+				return replica_status();
+			}
+			replica_log.add(query);
+			return sql::mariadb::mock_result::rows({ "server" }, { { "replica" } });
+		});
+
+		sql::mariadb::connection_pool primary_pool(sql::mariadb::endpoint("test", "test", "test", primary.port()), 2);
+		sql::mariadb::connection_pool replica_pool(sql::mariadb::endpoint("test", "test", "test", replica.port()), 2);
+		sql::mariadb::router route(primary_pool, { &replica_pool });
+
+		sql::mariadb::routed_session session(route);
+		const auto server = [&session](const std::string &text)
+		{
+			return std::get<0>(sql::mariadb::command(session.route(text)).query<std::tuple<std::string>>(text));
+		};
+
+		try
+		{
+			check(server("select 'before'") == "replica", "read before writing goes to the replica");
+			check(sql::mariadb::command(session.route("insert into t values(1)")).execute("insert into t values(1)"), "write succeeds");
+			check(primary_log.count("insert into t values(1)") == 1, "write goes to the primary");
+			check(server("select 'after'") == "primary", "read after a write without GTID goes to the primary");
+			check(server("select 'later'") == "primary", "later reads stay on the primary");
+			check(replica_log.count("select 'after'") == 0 && replica_log.count("select 'later'") == 0, "replica sees no read after the write");
+
+			sql::mariadb::routed_session other(route);
+			check(std::get<0>(sql::mariadb::command(other.route("select 'other'")).query<std::tuple<std::string>>("select 'other'")) == "replica",
+				"another session without writes still reads the replica");
+		}
+		catch (const std::exception &e)
+		{
+			check(false, e.what());
+		}
+	}
+
+
+	//*********************************************************
+	// 函数名称 : test_hedging_cancel
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 第一个从服务器没有及时响应时对冲到第二个从服务器,
+	//            第二次先成功后用 KILL QUERY 取消第一次, 调用者不需要等待慢的从服务器
+	//*********************************************************
+	void test_hedging_cancel(void)
+	{
+		journal slow_log;
+		std::mutex mutex;
+		std::condition_variable changed;
+		bool killed = false;
+
+		// 慢的从服务器一直执行到收到 KILL QUERY, 最多 5 秒
+		sql::mariadb::mock_server slow([&](const std::string &query)
+		{
+			if (query == "SHOW SLAVE STATUS")
+			{
+				return replica_status();
+			}
+			slow_log.add(query);
+			if (query.compare(0, 11, "KILL QUERY ") == 0)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				killed = true;
+				changed.notify_all();
+				return sql::mariadb::mock_result::ok(0);
+			}
+
+			std::unique_lock<std::mutex> lock(mutex);
+			if (changed.wait_for(lock, std::chrono::seconds(5), [&killed]() { return killed; }))
+			{
+				return sql::mariadb::mock_result::error(1317, "70100", "Query execution was interrupted");
+			}
+			return sql::mariadb::mock_result::rows({ "server" }, { { "slow" } });
+		});
+		sql::mariadb::mock_server fast([](const std::string &query)
+		{
+			if (query == "SHOW SLAVE STATUS")
+			{
+				return replica_status();
+			}
+			return sql::mariadb::mock_result::rows({ "server" }, { { "fast" } });
+		});
+		sql::mariadb::mock_server primary([](const std::string &)
+		{
+			return sql::mariadb::mock_result::rows({ "server" }, { { "primary" } });
+		});
+
+		sql::mariadb::connection_pool primary_pool(sql::mariadb::endpoint("test", "test", "test", primary.port()), 2);
+		sql::mariadb::connection_pool slow_pool(sql::mariadb::endpoint("test", "test", "test", slow.port()), 2);
+		sql::mariadb::connection_pool fast_pool(sql::mariadb::endpoint("test", "test", "test", fast.port()), 2);
+
+		// 轮流选择时第一次读取使用第一个从服务器
+		sql::mariadb::router route(primary_pool, { &slow_pool, &fast_pool });
+		sql::mariadb::hedged_reader reader(route, sql::mariadb::hedging_policy(0.95, 1, 20, 1.0));
+
+		try
+		{
+			const auto start = std::chrono::steady_clock::now();
+			const auto rows = reader.query_vector<std::tuple<std::string>>("select 'hedge'");
+			const auto elapsed = std::chrono::steady_clock::now() - start;
+
+			check(rows.size() == 1 && std::get<0>(rows[0]) == "fast", "hedged read returns the faster replica");
+			check(reader.hedges() == 1, "one hedge is sent");
+			check(elapsed < std::chrono::seconds(2), "slow read is cancelled instead of running to the end");
+			check(slow_log.count("KILL QUERY ") == 1, "losing read receives KILL QUERY");
+		}
+		catch (const std::exception &e)
+		{
+			check(false, e.what());
+		}
+	}
+
+
+	//*********************************************************
+	// 函数名称 : test_group_commit_units
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 合并提交中失败的单元 (包括释放保存点失败) 只回滚自己,
+	//            其他单元在同一个事务中提交, 每个单元得到自己的结果
+	//*********************************************************
+	void test_group_commit_units(void)
+	{
+		journal log;
+		sql::mariadb::mock_server server([&log](const std::string &query)
+		{
+			const auto previous = log.last();
+			log.add(query);
+			if (query == "insert into t values(2)")
+			{
+				return sql::mariadb::mock_result::error(1062, "23000", "Duplicate entry '2' for key 'PRIMARY'");
+			}
+			if (query == "RELEASE SAVEPOINT group_commit_unit" && previous == "insert into t values(4)")
+			{
+				return sql::mariadb::mock_result::error(1105, "HY000", "release failed");
+			}
+			return sql::mariadb::mock_result::ok(1);
+		});
+
+		sql::mariadb::connection_pool pool(sql::mariadb::endpoint("test", "test", "test", server.port()), 1);
+		sql::mariadb::group_commit batcher(pool, 50);
+
+		const auto unit = [](const char *text)
+		{
+			return [text](const sql::mariadb::connection &connector)
+			{
+				sql::mariadb::command(connector).execute_reader(text);
+			};
+		};
+
+		// 返回单元失败时的错误代号, 成功时返回 0
+		const auto outcome = [](std::future<void> &done) -> unsigned int
+		{
+			try
+			{
+				done.get();
+				return 0;
+			}
+			catch (const sql::mariadb::mariadb_exception &e)
+			{
+				return e.code() == 0 ? 1 : e.code();
+			}
+			catch (const std::exception &)
+			{
+				return 1;
+			}
+		};
+
+		auto first = batcher.submit(unit("insert into t values(1)"));
+		auto second = batcher.submit(unit("insert into t values(2)"));
+		auto third = batcher.submit(unit("insert into t values(3)"));
+		check(outcome(first) == 0, "unit before the failing unit commits");
+		check(outcome(second) == 1062, "failing unit reports its own error");
+		check(outcome(third) == 0, "unit after the failing unit commits");
+		check(log.count("ROLLBACK TO SAVEPOINT group_commit_unit") == 1, "only the failing unit is rolled back");
+		check(log.count("COMMIT") == 1, "all units share one commit");
+
+		auto fourth = batcher.submit(unit("insert into t values(4)"));
+		auto fifth = batcher.submit(unit("insert into t values(5)"));
+		check(outcome(fourth) == 1105, "unit whose savepoint cannot be released fails");
+		check(outcome(fifth) == 0, "next unit still commits");
+		check(log.count("ROLLBACK TO SAVEPOINT group_commit_unit") == 2, "unit with a failed release is rolled back");
+		check(log.count("COMMIT") == 2, "second batch commits once");
+	}
+
+
+	//*********************************************************
+	// 函数名称 : run
+	// 作    者 : agent
+	// 完成日期 : 2026/10/19
+	// 函数说明 : 执行一个测试并输出结果
+	// 函数参数 : const char * name 测试名称
+	// 函数参数 : void (*test)(void) 测试函数
+	//*********************************************************
+	void run(const char *name, void (*test)(void))
+	{
+		const auto before = failures;
+		try
+		{
+			test();
+		}
+		catch (const std::exception &e)
+		{
+			std::printf("    %s\n", e.what());
+			++failures;
+		}
+		std::printf("%-32s %s\n", name, failures == before ? "ok" : "FAILED");
+		std::fflush(stdout);
+	}
+}
+
+
+int main(void)
+{
+	run("reconnect replay", test_reconnect_replay);
+	run("pipeline error isolation", test_pipeline_isolation);
+	run("router stickiness", test_router_stickiness);
+	run("hedging cancel", test_hedging_cancel);
+	run("group commit unit status", test_group_commit_units);
+
+	return failures == 0 ? 0 : 1;
+}